@@ -47,18 +47,18 @@ namespace implementation {
 using ::android::hardware::gnss::V1_0::IGnssMeasurement;
 using ::android::hardware::gnss::V2_0::IGnssMeasurementCallback;
 
-static void convertGnssData(GnssMeasurementsNotification& in,
+static void convertGnssData(const GnssMeasurementsNotification& in,
         V1_0::IGnssMeasurementCallback::GnssData& out);
-static void convertGnssData_1_1(GnssMeasurementsNotification& in,
+static void convertGnssData_1_1(const GnssMeasurementsNotification& in,
         V1_1::IGnssMeasurementCallback::GnssData& out);
-static void convertGnssData_2_0(GnssMeasurementsNotification& in,
+static void convertGnssData_2_0(const GnssMeasurementsNotification& in,
         V2_0::IGnssMeasurementCallback::GnssData& out);
-static void convertGnssMeasurement(GnssMeasurementsData& in,
+static void convertGnssMeasurement(const GnssMeasurementsData& in,
         V1_0::IGnssMeasurementCallback::GnssMeasurement& out);
-static void convertGnssClock(GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out);
-static void convertGnssMeasurementsCodeType(GnssMeasurementsCodeType& in,
+static void convertGnssClock(const GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out);
+static void convertGnssMeasurementsCodeType(const GnssMeasurementsCodeType& in,
         ::android::hardware::hidl_string& out);
-static void convertElapsedRealtimeNanos(GnssMeasurementsNotification& in,
+static void convertElapsedRealtimeNanos(const GnssMeasurementsNotification& in,
         ::android::hardware::gnss::V2_0::ElapsedRealtime& elapsedRealtimeNanos);
 
 MeasurementAPIClient::MeasurementAPIClient() :
@@ -228,7 +228,7 @@ void MeasurementAPIClient::onGnssMeasurementsCb(
     }
 }
 
-static void convertGnssMeasurement(GnssMeasurementsData& in,
+static void convertGnssMeasurement(const GnssMeasurementsData& in,
         V1_0::IGnssMeasurementCallback::GnssMeasurement& out)
 {
     memset(&out, 0, sizeof(out));
@@ -307,7 +307,7 @@ static void convertGnssMeasurement(GnssMeasurementsData& in,
     out.agcLevelDb = in.agcLevelDb;
 }
 
-static void convertGnssClock(GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out)
+static void convertGnssClock(const GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out)
 {
     memset(&out, 0, sizeof(out));
     if (in.flags & GNSS_MEASUREMENTS_CLOCK_FLAGS_LEAP_SECOND_BIT)
@@ -335,7 +335,7 @@ static void convertGnssClock(GnssMeasurementsClock& in, IGnssMeasurementCallback
     out.hwClockDiscontinuityCount = in.hwClockDiscontinuityCount;
 }
 
-static void convertGnssData(GnssMeasurementsNotification& in,
+static void convertGnssData(const GnssMeasurementsNotification& in,
         V1_0::IGnssMeasurementCallback::GnssData& out)
 {
     memset(&out, 0, sizeof(out));
@@ -351,7 +351,7 @@ static void convertGnssData(GnssMeasurementsNotification& in,
     convertGnssClock(in.clock, out.clock);
 }
 
-static void convertGnssData_1_1(GnssMeasurementsNotification& in,
+static void convertGnssData_1_1(const GnssMeasurementsNotification& in,
         V1_1::IGnssMeasurementCallback::GnssData& out)
 {
     memset(&out, 0, sizeof(out));
@@ -374,7 +374,7 @@ static void convertGnssData_1_1(GnssMeasurementsNotification& in,
     convertGnssClock(in.clock, out.clock);
 }
 
-static void convertGnssData_2_0(GnssMeasurementsNotification& in,
+static void convertGnssData_2_0(const GnssMeasurementsNotification& in,
         V2_0::IGnssMeasurementCallback::GnssData& out)
 {
     memset(&out, 0, sizeof(out));
@@ -434,7 +434,7 @@ static void convertGnssData_2_0(GnssMeasurementsNotification& in,
     convertElapsedRealtimeNanos(in, out.elapsedRealtime);
 }
 
-static void convertElapsedRealtimeNanos(GnssMeasurementsNotification& in,
+static void convertElapsedRealtimeNanos(const GnssMeasurementsNotification& in,
         ::android::hardware::gnss::V2_0::ElapsedRealtime& elapsedRealtime)
 {
     struct timespec currentTime;
@@ -511,7 +511,7 @@ static void convertElapsedRealtimeNanos(GnssMeasurementsNotification& in,
              elapsedRealtime.timeUncertaintyNs, elapsedRealtime.flags);
 }
 
-static void convertGnssMeasurementsCodeType(GnssMeasurementsCodeType& in,
+static void convertGnssMeasurementsCodeType(const GnssMeasurementsCodeType& in,
         ::android::hardware::hidl_string& out)
 {
     switch(in) {
@@ -47,29 +47,29 @@ namespace implementation {
 using ::android::hardware::gnss::V1_0::IGnssMeasurement;
 using ::android::hardware::gnss::V2_0::IGnssMeasurementCallback;
 
-static void convertGnssData(GnssMeasurementsNotification& in,
+static void convertGnssData(const GnssMeasurementsNotification& in,
         V1_0::IGnssMeasurementCallback::GnssData& out);
-static void convertGnssData_1_1(GnssMeasurementsNotification& in,
+static void convertGnssData_1_1(const GnssMeasurementsNotification& in,
         V1_1::IGnssMeasurementCallback::GnssData& out);
-static void convertGnssData_2_0(GnssMeasurementsNotification& in,
+static void convertGnssData_2_0(const GnssMeasurementsNotification& in,
         V2_0::IGnssMeasurementCallback::GnssData& out);
-static void convertGnssData_2_1(GnssMeasurementsNotification& in,
+static void convertGnssData_2_1(const GnssMeasurementsNotification& in,
         V2_1::IGnssMeasurementCallback::GnssData& out);
-static void convertGnssMeasurement(GnssMeasurementsData& in,
+static void convertGnssMeasurement(const GnssMeasurementsData& in,
         V1_0::IGnssMeasurementCallback::GnssMeasurement& out);
-static void convertGnssClock(GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out);
-static void convertGnssClock_2_1(GnssMeasurementsClock& in,
+static void convertGnssClock(const GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out);
+static void convertGnssClock_2_1(const GnssMeasurementsClock& in,
         V2_1::IGnssMeasurementCallback::GnssClock& out);
-static void convertGnssMeasurementsCodeType(GnssMeasurementsCodeType& inCodeType,
-        char* inOtherCodeTypeName,
+static void convertGnssMeasurementsCodeType(const GnssMeasurementsCodeType& inCodeType,
+        const char* inOtherCodeTypeName,
         ::android::hardware::hidl_string& out);
-static void convertGnssMeasurementsAccumulatedDeltaRangeState(GnssMeasurementsAdrStateMask& in,
+static void convertGnssMeasurementsAccumulatedDeltaRangeState(const GnssMeasurementsAdrStateMask& in,
         ::android::hardware::hidl_bitfield
                 <V1_1::IGnssMeasurementCallback::GnssAccumulatedDeltaRangeState>& out);
-static void convertGnssMeasurementsState(GnssMeasurementsStateMask& in,
+static void convertGnssMeasurementsState(const GnssMeasurementsStateMask& in,
         ::android::hardware::hidl_bitfield
                 <V2_0::IGnssMeasurementCallback::GnssMeasurementState>& out);
-static void convertElapsedRealtimeNanos(GnssMeasurementsNotification& in,
+static void convertElapsedRealtimeNanos(const GnssMeasurementsNotification& in,
         ::android::hardware::gnss::V2_0::ElapsedRealtime& elapsedRealtimeNanos);
 
 MeasurementAPIClient::MeasurementAPIClient() :
@@ -266,7 +266,7 @@ void MeasurementAPIClient::onGnssMeasurementsCb(
     }
 }
 
-static void convertGnssMeasurement(GnssMeasurementsData& in,
+static void convertGnssMeasurement(const GnssMeasurementsData& in,
         V1_0::IGnssMeasurementCallback::GnssMeasurement& out)
 {
     memset(&out, 0, sizeof(out));
@@ -345,7 +345,7 @@ static void convertGnssMeasurement(GnssMeasurementsData& in,
     out.agcLevelDb = in.agcLevelDb;
 }
 
-static void convertGnssClock(GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out)
+static void convertGnssClock(const GnssMeasurementsClock& in, IGnssMeasurementCallback::GnssClock& out)
 {
     memset(&out, 0, sizeof(out));
     if (in.flags & GNSS_MEASUREMENTS_CLOCK_FLAGS_LEAP_SECOND_BIT)
@@ -373,7 +373,7 @@ static void convertGnssClock(GnssMeasurementsClock& in, IGnssMeasurementCallback
     out.hwClockDiscontinuityCount = in.hwClockDiscontinuityCount;
 }
 
-static void convertGnssClock_2_1(GnssMeasurementsClock& in,
+static void convertGnssClock_2_1(const GnssMeasurementsClock& in,
         V2_1::IGnssMeasurementCallback::GnssClock& out)
 {
     memset(&out, 0, sizeof(out));
@@ -387,7 +387,7 @@ static void convertGnssClock_2_1(GnssMeasurementsClock& in,
             out.referenceSignalTypeForIsb.codeType);
 }
 
-static void convertGnssData(GnssMeasurementsNotification& in,
+static void convertGnssData(const GnssMeasurementsNotification& in,
         V1_0::IGnssMeasurementCallback::GnssData& out)
 {
     memset(&out, 0, sizeof(out));
@@ -403,7 +403,7 @@ static void convertGnssData(GnssMeasurementsNotification& in,
     convertGnssClock(in.clock, out.clock);
 }
 
-static void convertGnssData_1_1(GnssMeasurementsNotification& in,
+static void convertGnssData_1_1(const GnssMeasurementsNotification& in,
         V1_1::IGnssMeasurementCallback::GnssData& out)
 {
     memset(&out, 0, sizeof(out));
@@ -416,7 +416,7 @@ static void convertGnssData_1_1(GnssMeasurementsNotification& in,
     convertGnssClock(in.clock, out.clock);
 }
 
-static void convertGnssData_2_0(GnssMeasurementsNotification& in,
+static void convertGnssData_2_0(const GnssMeasurementsNotification& in,
         V2_0::IGnssMeasurementCallback::GnssData& out)
 {
     memset(&out, 0, sizeof(out));
@@ -435,8 +435,8 @@ static void convertGnssData_2_0(GnssMeasurementsNotification& in,
     convertElapsedRealtimeNanos(in, out.elapsedRealtime);
 }
 
-static void convertGnssMeasurementsCodeType(GnssMeasurementsCodeType& inCodeType,
-        char* inOtherCodeTypeName, ::android::hardware::hidl_string& out)
+static void convertGnssMeasurementsCodeType(const GnssMeasurementsCodeType& inCodeType,
+        const char* inOtherCodeTypeName, ::android::hardware::hidl_string& out)
 {
     memset(&out, 0, sizeof(out));
     switch(inCodeType) {
@@ -489,7 +489,7 @@ static void convertGnssMeasurementsCodeType(GnssMeasurementsCodeType& inCodeType
     }
 }
 
-static void convertGnssMeasurementsAccumulatedDeltaRangeState(GnssMeasurementsAdrStateMask& in,
+static void convertGnssMeasurementsAccumulatedDeltaRangeState(const GnssMeasurementsAdrStateMask& in,
         ::android::hardware::hidl_bitfield
                 <V1_1::IGnssMeasurementCallback::GnssAccumulatedDeltaRangeState>& out)
 {
@@ -505,7 +505,7 @@ static void convertGnssMeasurementsAccumulatedDeltaRangeState(GnssMeasurementsAd
                 GnssAccumulatedDeltaRangeState::ADR_STATE_HALF_CYCLE_RESOLVED;
 }
 
-static void convertGnssMeasurementsState(GnssMeasurementsStateMask& in,
+static void convertGnssMeasurementsState(const GnssMeasurementsStateMask& in,
         ::android::hardware::hidl_bitfield
                 <V2_0::IGnssMeasurementCallback::GnssMeasurementState>& out)
 {
@@ -546,7 +546,7 @@ static void convertGnssMeasurementsState(GnssMeasurementsStateMask& in,
         out |= IGnssMeasurementCallback::GnssMeasurementState::STATE_2ND_CODE_LOCK;
 }
 
-static void convertGnssData_2_1(GnssMeasurementsNotification& in,
+static void convertGnssData_2_1(const GnssMeasurementsNotification& in,
         V2_1::IGnssMeasurementCallback::GnssData& out)
 {
     memset(&out, 0, sizeof(out));
@@ -620,7 +620,7 @@ static void convertGnssData_2_1(GnssMeasurementsNotification& in,
     convertElapsedRealtimeNanos(in, out.elapsedRealtime);
 }
 
-static void convertElapsedRealtimeNanos(GnssMeasurementsNotification& in,
+static void convertElapsedRealtimeNanos(const GnssMeasurementsNotification& in,
         ::android::hardware::gnss::V2_0::ElapsedRealtime& elapsedRealtime)
 {
     struct timespec currentTime;
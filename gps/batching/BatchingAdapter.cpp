@@ -607,7 +607,7 @@ BatchingAdapter::reportLocationsEvent(const Location* locations, size_t count,
                                   BatchingMode batchingMode) :
             LocMsg(),
             mAdapter(adapter),
-            mLocations(new Location[count]),
+            mLocations(LocMsgPool::allocArray<Location>(count)),
             mCount(count),
             mBatchingMode(batchingMode)
         {
@@ -620,15 +620,15 @@ BatchingAdapter::reportLocationsEvent(const Location* locations, size_t count,
             }
         }
         inline virtual ~MsgReportLocations() {
-            if (nullptr != mLocations)
-                delete[] mLocations;
+            LocMsgPool::freeArray(mLocations);
         }
         inline virtual void proc() const {
             mAdapter.reportLocations(mLocations, mCount, mBatchingMode);
         }
     };
 
-    sendMsg(new MsgReportLocations(*this, locations, count, batchingMode));
+    sendMsg(new MsgReportLocations(*this, locations, count, batchingMode),
+            LOC_MSG_PRIORITY_REPORT);
 }
 
 void
@@ -36,6 +36,9 @@
 #include <loc_target.h>
 #include <loc_pla.h>
 #include <loc_log.h>
+#include <LocConfWatcher.h>
+
+using loc_util::LocConfWatcher;
 
 namespace loc_core {
 
@@ -49,7 +52,11 @@ bool ContextBase::sIsEngineCapabilitiesKnown = false;
 uint64_t ContextBase::sSupportedMsgMask = 0;
 bool ContextBase::sGnssMeasurementSupported = false;
 uint8_t ContextBase::sFeaturesSupported[MAX_FEATURE_LENGTH];
-GnssNMEARptRate ContextBase::sNmeaReportRate = GNSS_NMEA_REPORT_RATE_NHZ;
+std::atomic<GnssNMEARptRate> ContextBase::sNmeaReportRate(GNSS_NMEA_REPORT_RATE_NHZ);
+std::atomic<const loc_gps_cfg_s_type*> ContextBase::sGpsConf(nullptr);
+std::mutex ContextBase::sGpsConfLock;
+std::vector<std::pair<const MsgTask*, ContextBase::GpsConfListener>>
+        ContextBase::sGpsConfListeners;
 
 const loc_param_s_type ContextBase::mGps_conf_table[] =
 {
@@ -115,35 +122,89 @@ const loc_param_s_type ContextBase::mSap_conf_table[] =
   {"SENSOR_ALGORITHM_CONFIG_MASK",   &mSap_conf.SENSOR_ALGORITHM_CONFIG_MASK,   NULL, 'n'}
 };
 
+// gps.conf defaults, for the items the file leaves out
+static void setGpsConfDefaults(loc_gps_cfg_s_type& conf)
+{
+    conf.INTERMEDIATE_POS = 0;
+    conf.ACCURACY_THRES = 0;
+    conf.NMEA_PROVIDER = 0;
+    conf.GPS_LOCK = GNSS_CONFIG_GPS_LOCK_MO_AND_NI;
+    conf.SUPL_VER = 0x10000;
+    conf.SUPL_MODE = 0x1;
+    conf.SUPL_ES = 0;
+    conf.CP_MTLR_ES = 0;
+    conf.SUPL_HOST[0] = 0;
+    conf.SUPL_PORT = 0;
+    conf.CAPABILITIES = 0x7;
+    /* LTE Positioning Profile configuration is disable by default*/
+    conf.LPP_PROFILE = 0;
+    /*By default no positioning protocol is selected on A-GLONASS system*/
+    conf.A_GLONASS_POS_PROTOCOL_SELECT = 0;
+    /*Use emergency PDN by default*/
+    conf.USE_EMERGENCY_PDN_FOR_EMERGENCY_SUPL = 1;
+    /* By default no LPPe CP technology is enabled*/
+    conf.LPPE_CP_TECHNOLOGY = 0;
+    /* By default no LPPe UP technology is enabled*/
+    conf.LPPE_UP_TECHNOLOGY = 0;
+    /* By default we use unknown modem type*/
+    conf.MODEM_TYPE = 2;
+
+    /* None of the 10 slots for agps certificates are writable by default */
+    conf.AGPS_CERT_WRITABLE_MASK = 0;
+
+    /* inject supl config to modem with config values from config.xml or gps.conf, default 1 */
+    conf.AGPS_CONFIG_INJECT = 1;
+
+    /* default configuration value of constrained time uncertainty mode:
+       feature disabled, time uncertainty threshold defined by modem,
+       and unlimited power budget */
+#ifdef FEATURE_AUTOMOTIVE
+    conf.CONSTRAINED_TIME_UNCERTAINTY_ENABLED = 1;
+#else
+    conf.CONSTRAINED_TIME_UNCERTAINTY_ENABLED = 0;
+#endif
+    conf.CONSTRAINED_TIME_UNCERTAINTY_THRESHOLD = 0.0;
+    conf.CONSTRAINED_TIME_UNCERTAINTY_ENERGY_BUDGET = 0;
+
+    /* default configuration value of position assisted clock estimator mode */
+    conf.POSITION_ASSISTED_CLOCK_ESTIMATOR_ENABLED = 0;
+    /* default configuration QTI GNSS H/W */
+    conf.GNSS_DEPLOYMENT = 0;
+    conf.CUSTOM_NMEA_GGA_FIX_QUALITY_ENABLED = 0;
+    /* default configuration for NI_SUPL_DENY_ON_NFW_LOCKED */
+    conf.NI_SUPL_DENY_ON_NFW_LOCKED = 1;
+    /* By default NMEA Printing is disabled */
+    conf.ENABLE_NMEA_PRINT = 0;
+}
+
+// what is derived from gps.conf once it is read
+static GnssNMEARptRate fixUpGpsConf(loc_gps_cfg_s_type& conf)
+{
+    switch (getTargetGnssType(loc_get_target())) {
+      case GNSS_GSS:
+      case GNSS_AUTO:
+         // For APQ targets, MSA/MSB capabilities should be reset
+         conf.CAPABILITIES &= ~(LOC_GPS_CAPABILITY_MSA | LOC_GPS_CAPABILITY_MSB);
+         break;
+      default:
+         break;
+    }
+
+    if (strncmp(conf.NMEA_REPORT_RATE, "1HZ", sizeof(conf.NMEA_REPORT_RATE)) == 0) {
+        /* NMEA reporting is configured at 1Hz*/
+        return GNSS_NMEA_REPORT_RATE_1HZ;
+    } else {
+        return GNSS_NMEA_REPORT_RATE_NHZ;
+    }
+}
+
 void ContextBase::readConfig()
 {
     static bool confReadDone = false;
     if (!confReadDone) {
         confReadDone = true;
         /*Defaults for gps.conf*/
-        mGps_conf.INTERMEDIATE_POS = 0;
-        mGps_conf.ACCURACY_THRES = 0;
-        mGps_conf.NMEA_PROVIDER = 0;
-        mGps_conf.GPS_LOCK = GNSS_CONFIG_GPS_LOCK_MO_AND_NI;
-        mGps_conf.SUPL_VER = 0x10000;
-        mGps_conf.SUPL_MODE = 0x1;
-        mGps_conf.SUPL_ES = 0;
-        mGps_conf.CP_MTLR_ES = 0;
-        mGps_conf.SUPL_HOST[0] = 0;
-        mGps_conf.SUPL_PORT = 0;
-        mGps_conf.CAPABILITIES = 0x7;
-        /* LTE Positioning Profile configuration is disable by default*/
-        mGps_conf.LPP_PROFILE = 0;
-        /*By default no positioning protocol is selected on A-GLONASS system*/
-        mGps_conf.A_GLONASS_POS_PROTOCOL_SELECT = 0;
-        /*Use emergency PDN by default*/
-        mGps_conf.USE_EMERGENCY_PDN_FOR_EMERGENCY_SUPL = 1;
-        /* By default no LPPe CP technology is enabled*/
-        mGps_conf.LPPE_CP_TECHNOLOGY = 0;
-        /* By default no LPPe UP technology is enabled*/
-        mGps_conf.LPPE_UP_TECHNOLOGY = 0;
-        /* By default we use unknown modem type*/
-        mGps_conf.MODEM_TYPE = 2;
+        setGpsConfDefaults(mGps_conf);
 
         /*Defaults for sap.conf*/
         mSap_conf.GYRO_BIAS_RANDOM_WALK = 0;
@@ -169,56 +230,90 @@ void ContextBase::readConfig()
         mSap_conf.RATE_RANDOM_WALK_SPECTRAL_DENSITY_VALID = 0;
         mSap_conf.VELOCITY_RANDOM_WALK_SPECTRAL_DENSITY_VALID = 0;
 
-        /* None of the 10 slots for agps certificates are writable by default */
-        mGps_conf.AGPS_CERT_WRITABLE_MASK = 0;
-
-        /* inject supl config to modem with config values from config.xml or gps.conf, default 1 */
-        mGps_conf.AGPS_CONFIG_INJECT = 1;
-
-        /* default configuration value of constrained time uncertainty mode:
-           feature disabled, time uncertainty threshold defined by modem,
-           and unlimited power budget */
-#ifdef FEATURE_AUTOMOTIVE
-        mGps_conf.CONSTRAINED_TIME_UNCERTAINTY_ENABLED = 1;
-#else
-        mGps_conf.CONSTRAINED_TIME_UNCERTAINTY_ENABLED = 0;
-#endif
-        mGps_conf.CONSTRAINED_TIME_UNCERTAINTY_THRESHOLD = 0.0;
-        mGps_conf.CONSTRAINED_TIME_UNCERTAINTY_ENERGY_BUDGET = 0;
-
-        /* default configuration value of position assisted clock estimator mode */
-        mGps_conf.POSITION_ASSISTED_CLOCK_ESTIMATOR_ENABLED = 0;
-        /* default configuration QTI GNSS H/W */
-        mGps_conf.GNSS_DEPLOYMENT = 0;
-        mGps_conf.CUSTOM_NMEA_GGA_FIX_QUALITY_ENABLED = 0;
-        /* default configuration for NI_SUPL_DENY_ON_NFW_LOCKED */
-        mGps_conf.NI_SUPL_DENY_ON_NFW_LOCKED = 1;
-        /* By default NMEA Printing is disabled */
-        mGps_conf.ENABLE_NMEA_PRINT = 0;
-
         UTIL_READ_CONF(LOC_PATH_GPS_CONF, mGps_conf_table);
         UTIL_READ_CONF(LOC_PATH_SAP_CONF, mSap_conf_table);
 
-        if (strncmp(mGps_conf.NMEA_REPORT_RATE, "1HZ", sizeof(mGps_conf.NMEA_REPORT_RATE)) == 0) {
-            /* NMEA reporting is configured at 1Hz*/
-            sNmeaReportRate = GNSS_NMEA_REPORT_RATE_1HZ;
-        } else {
-            sNmeaReportRate = GNSS_NMEA_REPORT_RATE_NHZ;
-        }
+        sNmeaReportRate = fixUpGpsConf(mGps_conf);
         LOC_LOGI("%s] GNSS Deployment: %s", __FUNCTION__,
                 ((mGps_conf.GNSS_DEPLOYMENT == 1) ? "SS5" :
                 ((mGps_conf.GNSS_DEPLOYMENT == 2) ? "QFUSION" : "QGNSS")));
 
-        switch (getTargetGnssType(loc_get_target())) {
-          case GNSS_GSS:
-          case GNSS_AUTO:
-             // For APQ targets, MSA/MSB capabilities should be reset
-             mGps_conf.CAPABILITIES &= ~(LOC_GPS_CAPABILITY_MSA | LOC_GPS_CAPABILITY_MSB);
-             break;
-          default:
-             break;
+        // the first snapshot, later ones come from edits to gps.conf
+        sGpsConf.store(new loc_gps_cfg_s_type(mGps_conf), std::memory_order_release);
+        LocConfWatcher::getInstance().watch(LOC_PATH_GPS_CONF, [](const char*) {
+            reloadGpsConf();
+        });
+    }
+}
+
+// Compares the items of mGps_conf_table one by one; memcmp() would also
+// compare the struct padding, and whatever is left after a string's '\0'.
+bool ContextBase::isSameGpsConf(const loc_gps_cfg_s_type& a, const loc_gps_cfg_s_type& b)
+{
+    for (const loc_param_s_type& param : mGps_conf_table) {
+        size_t offset = (const char*)param.param_ptr - (const char*)&mGps_conf;
+        const char* itemA = (const char*)&a + offset;
+        const char* itemB = (const char*)&b + offset;
+        bool same = true;
+        switch (param.param_type) {
+        case 's':
+            same = (0 == strncmp(itemA, itemB, LOC_MAX_PARAM_STRING));
+            break;
+        case 'f':
+            same = (*(const double*)itemA == *(const double*)itemB);
+            break;
+        default:
+            same = (*(const uint32_t*)itemA == *(const uint32_t*)itemB);
+            break;
+        }
+        if (!same) {
+            return false;
         }
     }
+    return true;
+}
+
+void ContextBase::reloadGpsConf()
+{
+    std::lock_guard<std::mutex> guard(sGpsConfLock);
+    const loc_gps_cfg_s_type* oldConf = sGpsConf.load(std::memory_order_relaxed);
+    loc_gps_cfg_s_type* newConf = new loc_gps_cfg_s_type();
+    setGpsConfDefaults(*newConf);
+
+    // mGps_conf_table, pointed at newConf
+    const size_t tableLength = sizeof(mGps_conf_table) / sizeof(mGps_conf_table[0]);
+    loc_param_s_type table[tableLength];
+    for (size_t i = 0; i < tableLength; i++) {
+        table[i] = mGps_conf_table[i];
+        table[i].param_ptr = (char*)newConf +
+                ((char*)mGps_conf_table[i].param_ptr - (char*)&mGps_conf);
+    }
+    loc_read_conf(LOC_PATH_GPS_CONF, table, tableLength);
+    GnssNMEARptRate nmeaReportRate = fixUpGpsConf(*newConf);
+
+    if (nullptr != oldConf && isSameGpsConf(*oldConf, *newConf)) {
+        delete newConf;
+        return;
+    }
+    // the old one is not freed, a hot path may still read it; it is only
+    // left behind when gps.conf is edited
+    sGpsConf.store(newConf, std::memory_order_release);
+    sNmeaReportRate = nmeaReportRate;
+    LOC_LOGI("%s] gps.conf reloaded, %zu listeners", __FUNCTION__, sGpsConfListeners.size());
+    for (auto& listener : sGpsConfListeners) {
+        GpsConfListener onChange = listener.second;
+        listener.first->sendMsg(new LocApiMsg([onChange, oldConf, newConf] () {
+            onChange(*oldConf, *newConf);
+        }));
+    }
+}
+
+void ContextBase::addGpsConfListener(const MsgTask* msgTask, const GpsConfListener& listener)
+{
+    if (nullptr != msgTask && nullptr != listener) {
+        std::lock_guard<std::mutex> guard(sGpsConfLock);
+        sGpsConfListeners.push_back(std::make_pair(msgTask, listener));
+    }
 }
 
 uint32_t ContextBase::getCarrierCapabilities() {
@@ -35,6 +35,10 @@
 #include <LocApiBase.h>
 #include <LBSProxyBase.h>
 #include <loc_cfg.h>
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <functional>
 
 /* GPS.conf support */
 /* NOTE: the implementaiton of the parser casts number
@@ -119,6 +123,16 @@ class ContextBase {
     LocApiBase* createLocApi(LOC_API_ADAPTER_EVENT_MASK_T excludedMask);
     static const loc_param_s_type mGps_conf_table[];
     static const loc_param_s_type mSap_conf_table[];
+public:
+    typedef std::function<void(const loc_gps_cfg_s_type& oldConf,
+                               const loc_gps_cfg_s_type& newConf)> GpsConfListener;
+private:
+    // gps.conf as last read, defaults and file only, published whole
+    static std::atomic<const loc_gps_cfg_s_type*> sGpsConf;
+    static std::mutex sGpsConfLock;
+    static std::vector<std::pair<const MsgTask*, GpsConfListener>> sGpsConfListeners;
+    static void reloadGpsConf();
+    static bool isSameGpsConf(const loc_gps_cfg_s_type& a, const loc_gps_cfg_s_type& b);
 protected:
     const LBSProxyBase* mLBSProxy;
     const MsgTask* mMsgTask;
@@ -157,9 +171,21 @@ public:
     static uint64_t sSupportedMsgMask;
     static uint8_t sFeaturesSupported[MAX_FEATURE_LENGTH];
     static bool sGnssMeasurementSupported;
-    static GnssNMEARptRate sNmeaReportRate;
+    static std::atomic<GnssNMEARptRate> sNmeaReportRate;
 
+    // reads gps.conf and sap.conf into mGps_conf and mSap_conf, once, then
+    // reloads gps.conf into a new snapshot whenever the file is edited
     void readConfig();
+    // The latest snapshot of gps.conf, for the items that take effect
+    // without a restart, e.g. INTERMEDIATE_POS, ACCURACY_THRES and
+    // NMEA_PROVIDER. Lock free, a snapshot is never changed or freed.
+    // mGps_conf stays as read at start up, plus what is set at run time.
+    static inline const loc_gps_cfg_s_type& getGpsConf() {
+        const loc_gps_cfg_s_type* conf = sGpsConf.load(std::memory_order_acquire);
+        return (nullptr != conf) ? *conf : mGps_conf;
+    }
+    // listener runs on msgTask, each time gps.conf is reloaded with changes
+    static void addGpsConfListener(const MsgTask* msgTask, const GpsConfListener& listener);
     static uint32_t getCarrierCapabilities();
     void setEngineCapabilities(uint64_t supportedMsgMask,
             uint8_t *featureList, bool gnssMeasurementSupported);
@@ -130,6 +130,19 @@ public:
         mMsgTask->sendMsg(msg);
     }
 
+    inline void sendMsg(const LocMsg* msg, LocMsgPriority priority) const {
+        mMsgTask->sendMsg(msg, priority);
+    }
+
+    inline void sendMsg(const LocMsg* msg, LocMsgPriority priority) {
+        mMsgTask->sendMsg(msg, priority);
+    }
+
+    inline void sendLatestMsg(const LocMsg* msg, LocMsgLatestSlot& slot,
+                              LocMsgPriority priority = LOC_MSG_PRIORITY_REPORT) const {
+        mMsgTask->sendLatestMsg(msg, slot, priority);
+    }
+
     inline void updateEvtMask(LOC_API_ADAPTER_EVENT_MASK_T event,
                               loc_registration_mask_status status)
     {
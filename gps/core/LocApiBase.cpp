@@ -31,16 +31,195 @@
 
 #include <dlfcn.h>
 #include <inttypes.h>
+#include <atomic>
+#include <mutex>
+#include <sstream>
 #include <gps_extended_c.h>
 #include <LocApiBase.h>
 #include <LocAdapterBase.h>
 #include <log_util.h>
+#include <LogBuffer.h>
 #include <LocContext.h>
 
 namespace loc_core {
 
-#define TO_ALL_LOCADAPTERS(call) TO_ALL_ADAPTERS(mLocAdapters, (call))
-#define TO_1ST_HANDLING_LOCADAPTERS(call) TO_1ST_HANDLING_ADAPTER(mLocAdapters, (call))
+// deliver to the adapters on the dispatch list of the given type
+#define TO_ALL_LOCADAPTERS(type, call) do {                              \
+        LocAdapterBase* adapters[MAX_ADAPTERS];                           \
+        LocApiDispatch& dispatch = getDispatch();                         \
+        countDispatch(dispatch, (type), getAdapters(dispatch, (type), adapters)); \
+        TO_ALL_ADAPTERS(adapters, (call));                                \
+    } while (0)
+#define TO_1ST_HANDLING_LOCADAPTERS(type, call) do {                     \
+        LocAdapterBase* adapters[MAX_ADAPTERS];                           \
+        LocApiDispatch& dispatch = getDispatch();                         \
+        countDispatch(dispatch, (type), getAdapters(dispatch, (type), adapters)); \
+        TO_1ST_HANDLING_ADAPTER(adapters, (call));                        \
+    } while (0)
+
+// event mask bits that put an adapter on each dispatch list. Position and
+// SV reports also go to NMEA registrants, as NMEA may be generated from them.
+static const LOC_API_ADAPTER_EVENT_MASK_T sDispatchMask[LOC_API_DISPATCH_MAX] = {
+    // LOC_API_DISPATCH_ALL
+    ~(LOC_API_ADAPTER_EVENT_MASK_T)0,
+    // LOC_API_DISPATCH_POSITION
+    LOC_API_ADAPTER_BIT_PARSED_POSITION_REPORT |
+    LOC_API_ADAPTER_BIT_PARSED_UNPROPAGATED_POSITION_REPORT |
+    LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT | LOC_API_ADAPTER_BIT_NMEA_POSITION_REPORT,
+    // LOC_API_DISPATCH_SV
+    LOC_API_ADAPTER_BIT_SATELLITE_REPORT |
+    LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT | LOC_API_ADAPTER_BIT_NMEA_POSITION_REPORT,
+    // LOC_API_DISPATCH_SV_POLYNOMIAL
+    LOC_API_ADAPTER_BIT_GNSS_SV_POLYNOMIAL_REPORT,
+    // LOC_API_DISPATCH_SV_EPHEMERIS
+    LOC_API_ADAPTER_BIT_GNSS_SV_EPHEMERIS_REPORT,
+    // LOC_API_DISPATCH_NMEA
+    LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT | LOC_API_ADAPTER_BIT_NMEA_POSITION_REPORT,
+    // LOC_API_DISPATCH_DATA
+    LOC_API_ADAPTER_BIT_PARSED_POSITION_REPORT |
+    LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT | LOC_API_ADAPTER_BIT_NMEA_POSITION_REPORT,
+    // LOC_API_DISPATCH_MEASUREMENTS
+    LOC_API_ADAPTER_BIT_GNSS_MEASUREMENT | LOC_API_ADAPTER_BIT_GNSS_NHZ_MEASUREMENT |
+    LOC_API_ADAPTER_BIT_GNSS_MEASUREMENT_REPORT,
+    // LOC_API_DISPATCH_SYSTEM_INFO
+    LOC_API_ADAPTER_BIT_LOC_SYSTEM_INFO
+};
+
+static const char* const sDispatchNames[LOC_API_DISPATCH_MAX] = {
+    "all", "position", "sv", "sv polynomial", "sv ephemeris", "nmea", "data",
+    "measurements", "system info"
+};
+
+// Dispatch lists and counters of one LocApiBase. Never freed: once its
+// LocApiBase is gone, api is cleared and the entry is reused by the next one,
+// so a getDispatch() walking the list never reads a freed entry.
+struct LocApiDispatch {
+    // NULL terminated copies of mLocAdapters, one per LocApiDispatchType,
+    // rebuilt under lock and read without locks via seq
+    std::atomic<LocAdapterBase*> lists[LOC_API_DISPATCH_MAX][MAX_ADAPTERS];
+    std::atomic<uint32_t> seq;
+    std::mutex lock;
+    // only counted on the LocApi thread of api, see countDispatch()
+    std::atomic<uint64_t> events[LOC_API_DISPATCH_MAX];
+    std::atomic<uint64_t> adapters[LOC_API_DISPATCH_MAX];
+    std::atomic<const LocApiBase*> api;
+    LocApiDispatch* next;
+
+    inline LocApiDispatch() : seq(0), api(nullptr), next(nullptr) {}
+    // called before the entry is published for api, or reused for it
+    void reset(const LocApiBase* locApi) {
+        for (int type = 0; type < LOC_API_DISPATCH_MAX; type++) {
+            for (int i = 0; i < MAX_ADAPTERS; i++) {
+                lists[type][i].store(nullptr, std::memory_order_relaxed);
+            }
+            events[type].store(0, std::memory_order_relaxed);
+            adapters[type].store(0, std::memory_order_relaxed);
+        }
+        api.store(locApi, std::memory_order_release);
+    }
+};
+
+// The LocApiDispatch entries, newest first. There is one LocApiBase per
+// process or few, so getDispatch() finds its entry in a compare or two,
+// without a lock. Entries are only added or reassigned under lock.
+static std::mutex sDispatchLock;
+static std::atomic<LocApiDispatch*> sDispatchHead(nullptr);
+
+// Gives api an entry, reusing a free one or, as a prebuilt LocApi built with
+// the inline destructor of an older LocApiBase.h does not clear its own, the
+// one left by a LocApiBase that had the same address.
+static LocApiDispatch& registerDispatch(const LocApiBase* api) {
+    std::lock_guard<std::mutex> guard(sDispatchLock);
+    LocApiDispatch* spare = nullptr;
+    for (LocApiDispatch* entry = sDispatchHead.load(std::memory_order_relaxed);
+         nullptr != entry; entry = entry->next) {
+        const LocApiBase* owner = entry->api.load(std::memory_order_relaxed);
+        if (api == owner) {
+            spare = entry;
+            break;
+        } else if (nullptr == owner && nullptr == spare) {
+            spare = entry;
+        }
+    }
+    if (nullptr == spare) {
+        spare = new LocApiDispatch();
+        spare->reset(api);
+        spare->next = sDispatchHead.load(std::memory_order_relaxed);
+        sDispatchHead.store(spare, std::memory_order_release);
+    } else {
+        spare->reset(api);
+    }
+    return *spare;
+}
+
+// inline, as every event looks its list up through it
+inline LocApiDispatch& LocApiBase::getDispatch() const
+{
+    for (LocApiDispatch* entry = sDispatchHead.load(std::memory_order_acquire);
+         nullptr != entry; entry = entry->next) {
+        if (this == entry->api.load(std::memory_order_acquire)) {
+            return *entry;
+        }
+    }
+    // the constructor registers every LocApiBase, so this is not expected
+    return registerDispatch(this);
+}
+
+// no LOC_LOG* in here, LogBuffer::dump() may be what calls this
+static void dumpDispatchStats(const std::function<void(std::stringstream&)>& log) {
+    std::lock_guard<std::mutex> guard(sDispatchLock);
+    for (LocApiDispatch* entry = sDispatchHead.load(std::memory_order_relaxed);
+         nullptr != entry; entry = entry->next) {
+        const LocApiBase* api = entry->api.load(std::memory_order_relaxed);
+        if (nullptr == api) {
+            continue;
+        }
+        std::stringstream ss;
+        ss << "LocApi " << api << " dispatch";
+        for (int type = 0; type < LOC_API_DISPATCH_MAX; type++) {
+            ss << (0 == type ? ": " : ", ") << sDispatchNames[type] << " "
+               << entry->events[type].load(std::memory_order_relaxed) << " events to "
+               << entry->adapters[type].load(std::memory_order_relaxed) << " adapters";
+        }
+        ss << std::endl;
+        log(ss);
+    }
+}
+
+// Copies the dispatch list of the given type into adapters, NULL terminated
+// if shorter than MAX_ADAPTERS, and returns its length. Lists are only
+// rebuilt on adapter and event mask changes, so a reader retries at most
+// when it races one of those.
+static inline int getAdapters(LocApiDispatch& dispatch, LocApiDispatchType type,
+                              LocAdapterBase* adapters[MAX_ADAPTERS])
+{
+    int count;
+    uint32_t seq;
+
+    do {
+        while ((seq = dispatch.seq.load(std::memory_order_acquire)) & 1);
+        for (count = 0; count < MAX_ADAPTERS; count++) {
+            adapters[count] = dispatch.lists[type][count].load(std::memory_order_relaxed);
+            if (nullptr == adapters[count]) {
+                break;
+            }
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while (seq != dispatch.seq.load(std::memory_order_relaxed));
+
+    return count;
+}
+
+// Events of a LocApiBase all come in on its own LocApi thread, so the
+// counters need no atomic add; atomic loads and stores only keep the reads
+// of getDispatchStats() from other threads untorn.
+static inline void countDispatch(LocApiDispatch& dispatch, LocApiDispatchType type, int count)
+{
+    dispatch.events[type].store(dispatch.events[type].load(std::memory_order_relaxed) + 1,
+                                std::memory_order_relaxed);
+    dispatch.adapters[type].store(dispatch.adapters[type].load(std::memory_order_relaxed) + count,
+                                  std::memory_order_relaxed);
+}
 
 int hexcode(char *hexstring, int string_size,
             const char *data, int data_size)
@@ -157,6 +336,11 @@ LocApiBase::LocApiBase(LOC_API_ADAPTER_EVENT_MASK_T excludedMask,
     mMask(0), mExcludedMask(excludedMask)
 {
     memset(mLocAdapters, 0, sizeof(mLocAdapters));
+    static std::once_flag sDumpHookOnce;
+    std::call_once(sDumpHookOnce, []() {
+        loc_util::LogBuffer::registerDumpHook(&dumpDispatchStats);
+    });
+    registerDispatch(this);
 
     android_atomic_inc(&mMsgTaskRefCount);
     if (nullptr == mMsgTask) {
@@ -167,8 +351,12 @@ LocApiBase::LocApiBase(LOC_API_ADAPTER_EVENT_MASK_T excludedMask,
 LOC_API_ADAPTER_EVENT_MASK_T LocApiBase::getEvtMask()
 {
     LOC_API_ADAPTER_EVENT_MASK_T mask = 0;
+    LocAdapterBase* adapters[MAX_ADAPTERS];
+    int count = getAdapters(getDispatch(), LOC_API_DISPATCH_ALL, adapters);
 
-    TO_ALL_LOCADAPTERS(mask |= mLocAdapters[i]->getEvtMask());
+    for (int i = 0; i < count; i++) {
+        mask |= adapters[i]->getEvtMask();
+    }
 
     return mask & ~mExcludedMask;
 }
@@ -176,11 +364,11 @@ LOC_API_ADAPTER_EVENT_MASK_T LocApiBase::getEvtMask()
 bool LocApiBase::isMaster()
 {
     bool isMaster = false;
+    LocAdapterBase* adapters[MAX_ADAPTERS];
+    int count = getAdapters(getDispatch(), LOC_API_DISPATCH_ALL, adapters);
 
-    for (int i = 0;
-            !isMaster && i < MAX_ADAPTERS && NULL != mLocAdapters[i];
-            i++) {
-        isMaster |= mLocAdapters[i]->isAdapterMaster();
+    for (int i = 0; !isMaster && i < count; i++) {
+        isMaster |= adapters[i]->isAdapterMaster();
     }
     return isMaster;
 }
@@ -188,21 +376,69 @@ bool LocApiBase::isMaster()
 bool LocApiBase::isInSession()
 {
     bool inSession = false;
+    LocAdapterBase* adapters[MAX_ADAPTERS];
+    int count = getAdapters(getDispatch(), LOC_API_DISPATCH_ALL, adapters);
 
-    for (int i = 0;
-         !inSession && i < MAX_ADAPTERS && NULL != mLocAdapters[i];
-         i++) {
-        inSession = mLocAdapters[i]->isInSession();
+    for (int i = 0; !inSession && i < count; i++) {
+        inSession = adapters[i]->isInSession();
     }
 
     return inSession;
 }
 
+void LocApiBase::unregisterDispatch()
+{
+    std::lock_guard<std::mutex> guard(sDispatchLock);
+    for (LocApiDispatch* entry = sDispatchHead.load(std::memory_order_relaxed);
+         nullptr != entry; entry = entry->next) {
+        if (this == entry->api.load(std::memory_order_relaxed)) {
+            entry->api.store(nullptr, std::memory_order_relaxed);
+        }
+    }
+}
+
+// Rebuilds the dispatch lists from mLocAdapters and the adapters' current
+// event masks. Caller holds dispatch.lock.
+void LocApiBase::rebuildDispatch(LocApiDispatch& dispatch)
+{
+    LocAdapterBase* lists[LOC_API_DISPATCH_MAX][MAX_ADAPTERS] = {};
+
+    for (int type = 0; type < LOC_API_DISPATCH_MAX; type++) {
+        for (int i = 0, n = 0; i < MAX_ADAPTERS && NULL != mLocAdapters[i]; i++) {
+            if (mLocAdapters[i]->getEvtMask() & sDispatchMask[type] ||
+                LOC_API_DISPATCH_ALL == type) {
+                lists[type][n++] = mLocAdapters[i];
+            }
+        }
+    }
+
+    // odd sequence while the lists are being written, see getAdapters()
+    uint32_t seq = dispatch.seq.load(std::memory_order_relaxed);
+    dispatch.seq.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (int type = 0; type < LOC_API_DISPATCH_MAX; type++) {
+        for (int i = 0; i < MAX_ADAPTERS; i++) {
+            dispatch.lists[type][i].store(lists[type][i], std::memory_order_relaxed);
+        }
+    }
+    dispatch.seq.store(seq + 2, std::memory_order_release);
+}
+
+void LocApiBase::getDispatchStats(LocApiDispatchStats& stats) const
+{
+    LocApiDispatch& dispatch = getDispatch();
+    for (int type = 0; type < LOC_API_DISPATCH_MAX; type++) {
+        stats.events[type] = dispatch.events[type].load(std::memory_order_relaxed);
+        stats.adapters[type] = dispatch.adapters[type].load(std::memory_order_relaxed);
+    }
+}
+
 bool LocApiBase::needReport(const UlpLocation& ulpLocation,
                             enum loc_sess_status status,
                             LocPosTechMask techMask)
 {
     bool reported = false;
+    const loc_gps_cfg_s_type& gpsConf = ContextBase::getGpsConf();
 
     if (LOC_SESS_SUCCESS == status) {
         // this is a final fix
@@ -212,7 +448,7 @@ bool LocApiBase::needReport(const UlpLocation& ulpLocation,
         reported = (mask & techMask);
     }
     else if (LOC_SESS_INTERMEDIATE == status &&
-        LOC_SESS_INTERMEDIATE == ContextBase::mGps_conf.INTERMEDIATE_POS) {
+        LOC_SESS_INTERMEDIATE == gpsConf.INTERMEDIATE_POS) {
         // this is a intermediate fix and we accept intermediate
 
         // it is NOT the case that
@@ -220,8 +456,8 @@ bool LocApiBase::needReport(const UlpLocation& ulpLocation,
         // we care about inaccuracy; and
         // the inaccuracy exceeds our tolerance
         reported = !((ulpLocation.gpsLocation.flags & LOC_GPS_LOCATION_HAS_ACCURACY) &&
-            (ContextBase::mGps_conf.ACCURACY_THRES != 0) &&
-            (ulpLocation.gpsLocation.accuracy > ContextBase::mGps_conf.ACCURACY_THRES));
+            (gpsConf.ACCURACY_THRES != 0) &&
+            (ulpLocation.gpsLocation.accuracy > gpsConf.ACCURACY_THRES));
     }
 
     return reported;
@@ -229,9 +465,12 @@ bool LocApiBase::needReport(const UlpLocation& ulpLocation,
 
 void LocApiBase::addAdapter(LocAdapterBase* adapter)
 {
+    LocApiDispatch& dispatch = getDispatch();
+    std::lock_guard<std::mutex> guard(dispatch.lock);
     for (int i = 0; i < MAX_ADAPTERS && mLocAdapters[i] != adapter; i++) {
         if (mLocAdapters[i] == NULL) {
             mLocAdapters[i] = adapter;
+            rebuildDispatch(dispatch);
             sendMsg(new LocOpenMsg(this,  adapter));
             break;
         }
@@ -240,6 +479,8 @@ void LocApiBase::addAdapter(LocAdapterBase* adapter)
 
 void LocApiBase::removeAdapter(LocAdapterBase* adapter)
 {
+    LocApiDispatch& dispatch = getDispatch();
+    std::lock_guard<std::mutex> guard(dispatch.lock);
     for (int i = 0;
          i < MAX_ADAPTERS && NULL != mLocAdapters[i];
          i++) {
@@ -262,6 +503,7 @@ void LocApiBase::removeAdapter(LocAdapterBase* adapter)
             mLocAdapters[j] = mLocAdapters[i];
             // this makes sure that we exit the for loop
             mLocAdapters[i] = NULL;
+            rebuildDispatch(dispatch);
 
             // if we have an empty list of adapters
             if (0 == i) {
@@ -276,6 +518,11 @@ void LocApiBase::removeAdapter(LocAdapterBase* adapter)
 
 void LocApiBase::updateEvtMask()
 {
+    {
+        LocApiDispatch& dispatch = getDispatch();
+        std::lock_guard<std::mutex> guard(dispatch.lock);
+        rebuildDispatch(dispatch);
+    }
     sendMsg(new LocOpenMsg(this));
 }
 
@@ -306,7 +553,7 @@ void LocApiBase::updateNmeaMask(uint32_t mask)
 void LocApiBase::handleEngineUpEvent()
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->handleEngineUpEvent());
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->handleEngineUpEvent());
 }
 
 void LocApiBase::handleEngineDownEvent()
@@ -314,7 +561,7 @@ void LocApiBase::handleEngineDownEvent()
     sendMsg(new LocSsrMsg(this));
 
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->handleEngineDownEvent());
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->handleEngineDownEvent());
 }
 
 void LocApiBase::reportPosition(UlpLocation& location,
@@ -343,60 +590,62 @@ void LocApiBase::reportPosition(UlpLocation& location,
              locationExtended.gnss_sv_used_ids.qzss_sv_used_ids_mask,
              locationExtended.gnss_sv_used_ids.navic_sv_used_ids_mask);
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportPositionEvent(location, locationExtended,
-                                             status, loc_technology_mask,
-                                             pDataNotify, msInWeek)
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_POSITION,
+        adapters[i]->reportPositionEvent(location, locationExtended,
+                                         status, loc_technology_mask,
+                                         pDataNotify, msInWeek)
     );
 }
 
 void LocApiBase::reportWwanZppFix(LocGpsLocation &zppLoc)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->reportWwanZppFix(zppLoc));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->reportWwanZppFix(zppLoc));
 }
 
 void LocApiBase::reportZppBestAvailableFix(LocGpsLocation &zppLoc,
         GpsLocationExtended &location_extended, LocPosTechMask tech_mask)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->reportZppBestAvailableFix(zppLoc,
-            location_extended, tech_mask));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportZppBestAvailableFix(zppLoc, location_extended, tech_mask));
 }
 
 void LocApiBase::requestOdcpi(OdcpiRequestInfo& request)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->requestOdcpiEvent(request));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->requestOdcpiEvent(request));
 }
 
 void LocApiBase::reportGnssEngEnergyConsumedEvent(uint64_t energyConsumedSinceFirstBoot)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportGnssEngEnergyConsumedEvent(
-            energyConsumedSinceFirstBoot));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportGnssEngEnergyConsumedEvent(energyConsumedSinceFirstBoot));
 }
 
 void LocApiBase::reportDeleteAidingDataEvent(GnssAidingData& aidingData) {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->reportDeleteAidingDataEvent(aidingData));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportDeleteAidingDataEvent(aidingData));
 }
 
 void LocApiBase::reportKlobucharIonoModel(GnssKlobucharIonoModel & ionoModel) {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->reportKlobucharIonoModelEvent(ionoModel));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportKlobucharIonoModelEvent(ionoModel));
 }
 
 void LocApiBase::reportGnssAdditionalSystemInfo(GnssAdditionalSystemInfo& additionalSystemInfo) {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->reportGnssAdditionalSystemInfoEvent(
-            additionalSystemInfo));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportGnssAdditionalSystemInfoEvent(additionalSystemInfo));
 }
 
 void LocApiBase::sendNfwNotification(GnssNfwNotification& notification)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportNfwNotificationEvent(notification));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->reportNfwNotificationEvent(notification));
 
 }
 
@@ -430,99 +679,101 @@ void LocApiBase::reportSv(GnssSvNotification& svNotify)
             svNotify.gnssSvs[i].gnssSignalTypeMask);
     }
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportSvEvent(svNotify)
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_SV,
+        adapters[i]->reportSvEvent(svNotify)
         );
 }
 
 void LocApiBase::reportSvPolynomial(GnssSvPolynomial &svPolynomial)
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportSvPolynomialEvent(svPolynomial)
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_SV_POLYNOMIAL,
+        adapters[i]->reportSvPolynomialEvent(svPolynomial)
     );
 }
 
 void LocApiBase::reportSvEphemeris(GnssSvEphemerisReport & svEphemeris)
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(
-        mLocAdapters[i]->reportSvEphemerisEvent(svEphemeris)
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_SV_EPHEMERIS,
+        adapters[i]->reportSvEphemerisEvent(svEphemeris)
     );
 }
 
 void LocApiBase::reportStatus(LocGpsStatusValue status)
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportStatus(status));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->reportStatus(status));
 }
 
 void LocApiBase::reportData(GnssDataNotification& dataNotify, int msInWeek)
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportDataEvent(dataNotify, msInWeek));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_DATA, adapters[i]->reportDataEvent(dataNotify, msInWeek));
 }
 
 void LocApiBase::reportNmea(const char* nmea, int length)
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportNmeaEvent(nmea, length));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_NMEA, adapters[i]->reportNmeaEvent(nmea, length));
 }
 
 void LocApiBase::reportXtraServer(const char* url1, const char* url2,
                                   const char* url3, const int maxlength)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->reportXtraServer(url1, url2, url3, maxlength));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportXtraServer(url1, url2, url3, maxlength));
 
 }
 
 void LocApiBase::reportLocationSystemInfo(const LocationSystemInfo& locationSystemInfo)
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportLocationSystemInfoEvent(locationSystemInfo));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_SYSTEM_INFO,
+            adapters[i]->reportLocationSystemInfoEvent(locationSystemInfo));
 }
 
 void LocApiBase::requestXtraData()
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->requestXtraData());
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->requestXtraData());
 }
 
 void LocApiBase::requestTime()
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->requestTime());
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->requestTime());
 }
 
 void LocApiBase::requestLocation()
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->requestLocation());
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->requestLocation());
 }
 
 void LocApiBase::requestATL(int connHandle, LocAGpsType agps_type,
                             LocApnTypeMask apn_type_mask)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(
-            mLocAdapters[i]->requestATL(connHandle, agps_type, apn_type_mask));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->requestATL(connHandle, agps_type, apn_type_mask));
 }
 
 void LocApiBase::releaseATL(int connHandle)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(mLocAdapters[i]->releaseATL(connHandle));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->releaseATL(connHandle));
 }
 
 void LocApiBase::requestNiNotify(GnssNiNotification &notify, const void* data,
                                  const LocInEmergency emergencyState)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_1ST_HANDLING_LOCADAPTERS(
-            mLocAdapters[i]->requestNiNotifyEvent(notify,
-                                                  data,
-                                                  emergencyState));
+    TO_1ST_HANDLING_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->requestNiNotifyEvent(notify,
+                                              data,
+                                              emergencyState));
 }
 
 void* LocApiBase :: getSibling()
@@ -534,7 +785,8 @@ LocApiProxyBase* LocApiBase :: getLocApiProxy()
 void LocApiBase::reportGnssMeasurements(GnssMeasurements& gnssMeasurements, int msInWeek)
 {
     // loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportGnssMeasurementsEvent(gnssMeasurements, msInWeek));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_MEASUREMENTS,
+            adapters[i]->reportGnssMeasurementsEvent(gnssMeasurements, msInWeek));
 }
 
 void LocApiBase::reportGnssSvIdConfig(const GnssSvIdConfig& config)
@@ -547,7 +799,7 @@ void LocApiBase::reportGnssSvIdConfig(const GnssSvIdConfig& config)
              config.qzssBlacklistSvMask, config.galBlacklistSvMask, config.navicBlacklistSvMask);
 
     // Loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportGnssSvIdConfigEvent(config));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->reportGnssSvIdConfigEvent(config));
 }
 
 void LocApiBase::reportGnssSvTypeConfig(const GnssSvTypeConfig& config)
@@ -557,47 +809,53 @@ void LocApiBase::reportGnssSvTypeConfig(const GnssSvTypeConfig& config)
              config.blacklistedSvTypesMask, config.enabledSvTypesMask);
 
     // Loop through adapters, and deliver to all adapters.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportGnssSvTypeConfigEvent(config));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->reportGnssSvTypeConfigEvent(config));
 }
 
 void LocApiBase::geofenceBreach(size_t count, uint32_t* hwIds, Location& location,
                                 GeofenceBreachType breachType, uint64_t timestamp)
 {
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->geofenceBreachEvent(count, hwIds, location, breachType,
-                                                            timestamp));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->geofenceBreachEvent(count, hwIds, location, breachType,
+                                             timestamp));
 }
 
 void LocApiBase::geofenceStatus(GeofenceStatusAvailable available)
 {
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->geofenceStatusEvent(available));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL, adapters[i]->geofenceStatusEvent(available));
 }
 
 void LocApiBase::reportDBTPosition(UlpLocation &location, GpsLocationExtended &locationExtended,
                                    enum loc_sess_status status, LocPosTechMask loc_technology_mask)
 {
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportPositionEvent(location, locationExtended, status,
-                                                            loc_technology_mask));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_POSITION,
+            adapters[i]->reportPositionEvent(location, locationExtended, status,
+                                             loc_technology_mask));
 }
 
 void LocApiBase::reportLocations(Location* locations, size_t count, BatchingMode batchingMode)
 {
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportLocationsEvent(locations, count, batchingMode));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportLocationsEvent(locations, count, batchingMode));
 }
 
 void LocApiBase::reportCompletedTrips(uint32_t accumulated_distance)
 {
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportCompletedTripsEvent(accumulated_distance));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportCompletedTripsEvent(accumulated_distance));
 }
 
 void LocApiBase::handleBatchStatusEvent(BatchingStatus batchStatus)
 {
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportBatchStatusChangeEvent(batchStatus));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportBatchStatusChangeEvent(batchStatus));
 }
 
 void LocApiBase::reportGnssConfig(uint32_t sessionId, const GnssConfig& gnssConfig)
 {
     // loop through adapters, and deliver to the first handling adapter.
-    TO_ALL_LOCADAPTERS(mLocAdapters[i]->reportGnssConfigEvent(sessionId, gnssConfig));
+    TO_ALL_LOCADAPTERS(LOC_API_DISPATCH_ALL,
+            adapters[i]->reportGnssConfigEvent(sessionId, gnssConfig));
 }
 
 enum loc_api_adapter_err LocApiBase::
@@ -59,7 +59,32 @@ int decodeAddress(char *addr_string, int string_size,
 #define TO_1ST_HANDLING_ADAPTER(adapters, call)                              \
     for (int i = 0; i <MAX_ADAPTERS && NULL != (adapters)[i] && !(call); i++);
 
+// Adapter dispatch lists kept by LocApiBase. An adapter is on the list of an
+// event class if its event mask has any of the bits of that class, see
+// sDispatchMask in LocApiBase.cpp. Events without a class of their own go to
+// LOC_API_DISPATCH_ALL, i.e. to every adapter as before.
+typedef enum {
+    LOC_API_DISPATCH_ALL = 0,
+    LOC_API_DISPATCH_POSITION,
+    LOC_API_DISPATCH_SV,
+    LOC_API_DISPATCH_SV_POLYNOMIAL,
+    LOC_API_DISPATCH_SV_EPHEMERIS,
+    LOC_API_DISPATCH_NMEA,
+    LOC_API_DISPATCH_DATA,
+    LOC_API_DISPATCH_MEASUREMENTS,
+    LOC_API_DISPATCH_SYSTEM_INFO,
+    LOC_API_DISPATCH_MAX
+} LocApiDispatchType;
+
+typedef struct {
+    // number of events dispatched on each list
+    uint64_t events[LOC_API_DISPATCH_MAX];
+    // number of adapters those events were dispatched to
+    uint64_t adapters[LOC_API_DISPATCH_MAX];
+} LocApiDispatchStats;
+
 class LocAdapterBase;
+struct LocApiDispatch;
 struct LocSsrMsg;
 struct LocOpenMsg;
 
@@ -105,6 +130,11 @@ class LocApiBase {
     static MsgTask* mMsgTask;
     static volatile int32_t mMsgTaskRefCount;
     LocAdapterBase* mLocAdapters[MAX_ADAPTERS];
+    // the dispatch lists live in LocApiBase.cpp, keyed by this, so that the
+    // layout of LocApiBase stays that of the prebuilt LocApi implementations
+    LocApiDispatch& getDispatch() const;
+    void rebuildDispatch(LocApiDispatch& dispatch);
+    void unregisterDispatch();
 
 protected:
     ContextBase *mContext;
@@ -118,6 +148,7 @@ protected:
     LocApiBase(LOC_API_ADAPTER_EVENT_MASK_T excludedMask,
                ContextBase* context = NULL);
     inline virtual ~LocApiBase() {
+        unregisterDispatch();
         android_atomic_dec(&mMsgTaskRefCount);
         if (nullptr != mMsgTask && 0 == mMsgTaskRefCount) {
             mMsgTask->destroy();
@@ -152,6 +183,7 @@ public:
 
     void addAdapter(LocAdapterBase* adapter);
     void removeAdapter(LocAdapterBase* adapter);
+    void getDispatchStats(LocApiDispatchStats& stats) const;
 
     // upward calls
     void handleEngineUpEvent();
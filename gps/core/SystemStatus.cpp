@@ -32,6 +32,7 @@
 #include <string>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
 #include <sys/time.h>
 #include <pthread.h>
 #include <loc_pla.h>
@@ -50,44 +51,211 @@ namespace loc_core
 ******************************************************************************/
 class SystemStatusNmeaBase
 {
-protected:
-    std::vector<std::string> mField;
+public:
+    static const uint32_t NMEA_MINSIZE = DEBUG_NMEA_MINSIZE;
+    static const uint32_t NMEA_MAXSIZE = DEBUG_NMEA_MAXSIZE;
+    // $PQWP7 is the longest at 2 + SV_ALL_NUM*3 fields
+    static const uint32_t NMEA_FIELD_MAX = 512;
+
+    // debug sentences, in the order of sIds
+    enum SentenceId
+    {
+        ePQWM1 = 0,
+        ePQWP1,
+        ePQWP2,
+        ePQWP3,
+        ePQWP4,
+        ePQWP5,
+        ePQWP6,
+        ePQWP7,
+        ePQWS1,
+        eUnknown
+    };
+
+    // data must have passed loc_nmea_is_debug()
+    static inline SentenceId getSentenceId(const char* data)
+    {
+        static const char sIds[eUnknown][NMEA_MINSIZE + 1] = {
+            "$PQWM1", "$PQWP1", "$PQWP2", "$PQWP3", "$PQWP4",
+            "$PQWP5", "$PQWP6", "$PQWP7", "$PQWS1"
+        };
+        // "$PQW" is already known, the next two chars pick the one entry to compare
+        uint32_t id = eUnknown;
+        switch (data[4]) {
+            case 'M': id = ePQWM1; break;
+            case 'P':
+                if (data[5] >= '1' && data[5] <= '7') {
+                    id = ePQWP1 + (data[5] - '1');
+                }
+                break;
+            case 'S': id = ePQWS1; break;
+            default: break;
+        }
+        if (id >= eUnknown || 0 != memcmp(data, sIds[id], NMEA_MINSIZE)) {
+            return eUnknown;
+        }
+        return (SentenceId)id;
+    }
 
-    SystemStatusNmeaBase(const char *str_in, uint32_t len_in)
+protected:
+    // fields point into the caller's sentence, which must outlive the parser
+    const char* mData;
+    uint32_t    mFieldCount;
+    // field i spans [mFieldStart[i], mFieldStart[i + 1] - 1)
+    uint16_t    mFieldStart[NMEA_FIELD_MAX + 1];
+
+    SystemStatusNmeaBase(const char *str_in, uint32_t len_in) :
+        mData(str_in),
+        mFieldCount(0)
     {
         // check size and talker
         if (!loc_nmea_is_debug(str_in, len_in)) {
             return;
         }
 
-        std::string parser(str_in);
-        std::string::size_type index = 0;
+        // split in one pass up to the checksum field, a sentence without
+        // one has no fields
+        uint32_t count = 0;
+        mFieldStart[0] = 0;
+        for (uint32_t i = 0; i < len_in && '\0' != str_in[i]; i++) {
+            if (',' != str_in[i] && '*' != str_in[i]) {
+                continue;
+            }
+            if (count < NMEA_FIELD_MAX) {
+                mFieldStart[++count] = i + 1;
+            }
+            if ('*' == str_in[i]) {
+                mFieldCount = count;
+                break;
+            }
+        }
+    }
 
-        // verify checksum field
-        index = parser.find("*");
-        if (index == std::string::npos) {
-            return;
+    virtual ~SystemStatusNmeaBase() { }
+
+    inline const char* fieldBegin(uint32_t index) const {
+        return mData + mFieldStart[index];
+    }
+    inline const char* fieldEnd(uint32_t index) const {
+        return mData + mFieldStart[index + 1] - 1;
+    }
+
+    // NUL terminated copy of a field for the libc parsers, cut at 63 chars
+    inline void copyField(uint32_t index, char (&field)[64]) const {
+        uint32_t length = fieldEnd(index) - fieldBegin(index);
+        if (length >= sizeof(field)) {
+            length = sizeof(field) - 1;
         }
-        parser[index] = ',';
+        memcpy(field, fieldBegin(index), length);
+        field[length] = '\0';
+    }
 
-        // tokenize parser
-        while (1) {
-            std::string str;
-            index = parser.find(",");
-            if (index == std::string::npos) {
+    // as atoi()/strtoull(, 10)
+    uint64_t getUint64(uint32_t index) const
+    {
+        const char* p = fieldBegin(index);
+        const char* end = fieldEnd(index);
+        bool negative = false;
+        uint64_t value = 0;
+        while (p < end && ' ' == *p) {
+            p++;
+        }
+        if (p < end && ('-' == *p || '+' == *p)) {
+            negative = ('-' == *p++);
+        }
+        // 19 digits always fit, longer fields go to strtoull() for its clamping
+        uint32_t digits = 0;
+        for (; p < end && *p >= '0' && *p <= '9'; p++, digits++) {
+            if (digits >= 19) {
+                char field[64];
+                copyField(index, field);
+                return strtoull(field, nullptr, 10);
+            }
+            value = value * 10 + (*p - '0');
+        }
+        return negative ? (uint64_t)(-(int64_t)value) : value;
+    }
+
+    inline int32_t getInt(uint32_t index) const
+    {
+        return (int32_t)getUint64(index);
+    }
+
+    // as strtol(, 16)
+    uint64_t getHex(uint32_t index) const
+    {
+        const char* p = fieldBegin(index);
+        const char* end = fieldEnd(index);
+        bool negative = false;
+        uint64_t value = 0;
+        while (p < end && ' ' == *p) {
+            p++;
+        }
+        if (p < end && ('-' == *p || '+' == *p)) {
+            negative = ('-' == *p++);
+        }
+        if (end - p > 2 && '0' == p[0] && ('x' == p[1] || 'X' == p[1]) && isxdigit(p[2])) {
+            p += 2;
+        }
+        for (; p < end; p++) {
+            uint32_t digit;
+            if (*p >= '0' && *p <= '9') {
+                digit = *p - '0';
+            } else if (*p >= 'a' && *p <= 'f') {
+                digit = *p - 'a' + 10;
+            } else if (*p >= 'A' && *p <= 'F') {
+                digit = *p - 'A' + 10;
+            } else {
                 break;
             }
-            str = parser.substr(0, index);
-            parser = parser.substr(index + 1);
-            mField.push_back(str);
+            value = (value << 4) | digit;
         }
+        return negative ? (uint64_t)(-(int64_t)value) : value;
     }
 
-    virtual ~SystemStatusNmeaBase() { }
+    // as atof()
+    double getDouble(uint32_t index) const
+    {
+        static const double sPow10[] = {
+            1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+            1e12, 1e13, 1e14, 1e15
+        };
+        const char* p = fieldBegin(index);
+        const char* end = fieldEnd(index);
+        bool negative = false;
+        uint64_t mantissa = 0;
+        uint32_t digits = 0;
+        uint32_t decimals = 0;
+        if (p < end && ('-' == *p || '+' == *p)) {
+            negative = ('-' == *p++);
+        }
+        // only the first 15 digits are accumulated, more go to atof() anyway
+        for (; p < end && *p >= '0' && *p <= '9'; p++) {
+            if (++digits <= 15) {
+                mantissa = mantissa * 10 + (*p - '0');
+            }
+        }
+        if (p < end && '.' == *p) {
+            for (p++; p < end && *p >= '0' && *p <= '9'; p++, decimals++) {
+                if (++digits <= 15) {
+                    mantissa = mantissa * 10 + (*p - '0');
+                }
+            }
+        }
+        if (p == end && digits <= 15) {
+            // below 2^53 over an exact power of ten, the one division
+            // rounds the same as strtod
+            double value = (double)mantissa / sPow10[decimals];
+            return (negative && digits > 0) ? -value : value;
+        }
+        // exponents, spaces and long fields
+        char field[64];
+        copyField(index, field);
+        return atof(field);
+    }
 
 public:
-    static const uint32_t NMEA_MINSIZE = DEBUG_NMEA_MINSIZE;
-    static const uint32_t NMEA_MAXSIZE = DEBUG_NMEA_MAXSIZE;
+    inline uint32_t getFieldCount() const { return mFieldCount; }
 };
 
 /******************************************************************************
@@ -209,47 +377,47 @@ public:
         : SystemStatusNmeaBase(str_in, len_in)
     {
         memset(&mM1, 0, sizeof(mM1));
-        if (mField.size() <= eMax0) {
-            LOC_LOGE("PQWM1parser - invalid size=%zu", mField.size());
+        if (mFieldCount <= eMax0) {
+            LOC_LOGE("PQWM1parser - invalid size=%u", mFieldCount);
             mM1.mTimeValid = 0;
             return;
         }
-        mM1.mGpsWeek = atoi(mField[eGpsWeek].c_str());
-        mM1.mGpsTowMs = atoi(mField[eGpsTowMs].c_str());
-        mM1.mTimeValid = atoi(mField[eTimeValid].c_str());
-        mM1.mTimeSource = atoi(mField[eTimeSource].c_str());
-        mM1.mTimeUnc = atoi(mField[eTimeUnc].c_str());
-        mM1.mClockFreqBias = atoi(mField[eClockFreqBias].c_str());
-        mM1.mClockFreqBiasUnc = atoi(mField[eClockFreqBiasUnc].c_str());
-        mM1.mXoState = atoi(mField[eXoState].c_str());
-        mM1.mPgaGain = atoi(mField[ePgaGain].c_str());
-        mM1.mGpsBpAmpI = atoi(mField[eGpsBpAmpI].c_str());
-        mM1.mGpsBpAmpQ = atoi(mField[eGpsBpAmpQ].c_str());
-        mM1.mAdcI = atoi(mField[eAdcI].c_str());
-        mM1.mAdcQ = atoi(mField[eAdcQ].c_str());
-        mM1.mJammerGps = atoi(mField[eJammerGps].c_str());
-        mM1.mJammerGlo = atoi(mField[eJammerGlo].c_str());
-        mM1.mJammerBds = atoi(mField[eJammerBds].c_str());
-        mM1.mJammerGal = atoi(mField[eJammerGal].c_str());
-        mM1.mRecErrorRecovery = atoi(mField[eRecErrorRecovery].c_str());
-        mM1.mAgcGps = atof(mField[eAgcGps].c_str());
-        mM1.mAgcGlo = atof(mField[eAgcGlo].c_str());
-        mM1.mAgcBds = atof(mField[eAgcBds].c_str());
-        mM1.mAgcGal = atof(mField[eAgcGal].c_str());
-        if (mField.size() > eLeapSecUnc) {
-            mM1.mLeapSeconds = atoi(mField[eLeapSeconds].c_str());
-            mM1.mLeapSecUnc = atoi(mField[eLeapSecUnc].c_str());
+        mM1.mGpsWeek = getInt(eGpsWeek);
+        mM1.mGpsTowMs = getInt(eGpsTowMs);
+        mM1.mTimeValid = getInt(eTimeValid);
+        mM1.mTimeSource = getInt(eTimeSource);
+        mM1.mTimeUnc = getInt(eTimeUnc);
+        mM1.mClockFreqBias = getInt(eClockFreqBias);
+        mM1.mClockFreqBiasUnc = getInt(eClockFreqBiasUnc);
+        mM1.mXoState = getInt(eXoState);
+        mM1.mPgaGain = getInt(ePgaGain);
+        mM1.mGpsBpAmpI = getInt(eGpsBpAmpI);
+        mM1.mGpsBpAmpQ = getInt(eGpsBpAmpQ);
+        mM1.mAdcI = getInt(eAdcI);
+        mM1.mAdcQ = getInt(eAdcQ);
+        mM1.mJammerGps = getInt(eJammerGps);
+        mM1.mJammerGlo = getInt(eJammerGlo);
+        mM1.mJammerBds = getInt(eJammerBds);
+        mM1.mJammerGal = getInt(eJammerGal);
+        mM1.mRecErrorRecovery = getInt(eRecErrorRecovery);
+        mM1.mAgcGps = getDouble(eAgcGps);
+        mM1.mAgcGlo = getDouble(eAgcGlo);
+        mM1.mAgcBds = getDouble(eAgcBds);
+        mM1.mAgcGal = getDouble(eAgcGal);
+        if (mFieldCount > eLeapSecUnc) {
+            mM1.mLeapSeconds = getInt(eLeapSeconds);
+            mM1.mLeapSecUnc = getInt(eLeapSecUnc);
         }
-        if (mField.size() > eGalBpAmpQ) {
-            mM1.mGloBpAmpI = atoi(mField[eGloBpAmpI].c_str());
-            mM1.mGloBpAmpQ = atoi(mField[eGloBpAmpQ].c_str());
-            mM1.mBdsBpAmpI = atoi(mField[eBdsBpAmpI].c_str());
-            mM1.mBdsBpAmpQ = atoi(mField[eBdsBpAmpQ].c_str());
-            mM1.mGalBpAmpI = atoi(mField[eGalBpAmpI].c_str());
-            mM1.mGalBpAmpQ = atoi(mField[eGalBpAmpQ].c_str());
+        if (mFieldCount > eGalBpAmpQ) {
+            mM1.mGloBpAmpI = getInt(eGloBpAmpI);
+            mM1.mGloBpAmpQ = getInt(eGloBpAmpQ);
+            mM1.mBdsBpAmpI = getInt(eBdsBpAmpI);
+            mM1.mBdsBpAmpQ = getInt(eBdsBpAmpQ);
+            mM1.mGalBpAmpI = getInt(eGalBpAmpI);
+            mM1.mGalBpAmpQ = getInt(eGalBpAmpQ);
         }
-        if (mField.size() > eTimeUncNs) {
-            mM1.mTimeUncNs = strtoull(mField[eTimeUncNs].c_str(), nullptr, 10);
+        if (mFieldCount > eTimeUncNs) {
+            mM1.mTimeUncNs = getUint64(eTimeUncNs);
         }
     }
 
@@ -301,17 +469,17 @@ public:
     SystemStatusPQWP1parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP1, 0, sizeof(mP1));
-        mP1.mEpiValidity = strtol(mField[eEpiValidity].c_str(), NULL, 16);
-        mP1.mEpiLat = atof(mField[eEpiLat].c_str());
-        mP1.mEpiLon = atof(mField[eEpiLon].c_str());
-        mP1.mEpiAlt = atof(mField[eEpiAlt].c_str());
-        mP1.mEpiHepe = atoi(mField[eEpiHepe].c_str());
-        mP1.mEpiAltUnc = atof(mField[eEpiAltUnc].c_str());
-        mP1.mEpiSrc = atoi(mField[eEpiSrc].c_str());
+        mP1.mEpiValidity = getHex(eEpiValidity);
+        mP1.mEpiLat = getDouble(eEpiLat);
+        mP1.mEpiLon = getDouble(eEpiLon);
+        mP1.mEpiAlt = getDouble(eEpiAlt);
+        mP1.mEpiHepe = getInt(eEpiHepe);
+        mP1.mEpiAltUnc = getDouble(eEpiAltUnc);
+        mP1.mEpiSrc = getInt(eEpiSrc);
     }
 
     inline SystemStatusPQWP1& get() { return mP1;}
@@ -356,15 +524,15 @@ public:
     SystemStatusPQWP2parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP2, 0, sizeof(mP2));
-        mP2.mBestLat = atof(mField[eBestLat].c_str());
-        mP2.mBestLon = atof(mField[eBestLon].c_str());
-        mP2.mBestAlt = atof(mField[eBestAlt].c_str());
-        mP2.mBestHepe = atof(mField[eBestHepe].c_str());
-        mP2.mBestAltUnc = atof(mField[eBestAltUnc].c_str());
+        mP2.mBestLat = getDouble(eBestLat);
+        mP2.mBestLon = getDouble(eBestLon);
+        mP2.mBestAlt = getDouble(eBestAlt);
+        mP2.mBestHepe = getDouble(eBestHepe);
+        mP2.mBestAltUnc = getDouble(eBestAltUnc);
     }
 
     inline SystemStatusPQWP2& get() { return mP2;}
@@ -432,22 +600,22 @@ public:
     SystemStatusPQWP3parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP3, 0, sizeof(mP3));
         // todo: update for navic once available
-        mP3.mXtraValidMask = strtol(mField[eXtraValidMask].c_str(), NULL, 16);
-        mP3.mGpsXtraAge = atoi(mField[eGpsXtraAge].c_str());
-        mP3.mGloXtraAge = atoi(mField[eGloXtraAge].c_str());
-        mP3.mBdsXtraAge = atoi(mField[eBdsXtraAge].c_str());
-        mP3.mGalXtraAge = atoi(mField[eGalXtraAge].c_str());
-        mP3.mQzssXtraAge = atoi(mField[eQzssXtraAge].c_str());
-        mP3.mGpsXtraValid = strtol(mField[eGpsXtraValid].c_str(), NULL, 16);
-        mP3.mGloXtraValid = strtol(mField[eGloXtraValid].c_str(), NULL, 16);
-        mP3.mBdsXtraValid = strtol(mField[eBdsXtraValid].c_str(), NULL, 16);
-        mP3.mGalXtraValid = strtol(mField[eGalXtraValid].c_str(), NULL, 16);
-        mP3.mQzssXtraValid = strtol(mField[eQzssXtraValid].c_str(), NULL, 16);
+        mP3.mXtraValidMask = getHex(eXtraValidMask);
+        mP3.mGpsXtraAge = getInt(eGpsXtraAge);
+        mP3.mGloXtraAge = getInt(eGloXtraAge);
+        mP3.mBdsXtraAge = getInt(eBdsXtraAge);
+        mP3.mGalXtraAge = getInt(eGalXtraAge);
+        mP3.mQzssXtraAge = getInt(eQzssXtraAge);
+        mP3.mGpsXtraValid = getHex(eGpsXtraValid);
+        mP3.mGloXtraValid = getHex(eGloXtraValid);
+        mP3.mBdsXtraValid = getHex(eBdsXtraValid);
+        mP3.mGalXtraValid = getHex(eGalXtraValid);
+        mP3.mQzssXtraValid = getHex(eQzssXtraValid);
     }
 
     inline SystemStatusPQWP3& get() { return mP3;}
@@ -492,15 +660,15 @@ public:
     SystemStatusPQWP4parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP4, 0, sizeof(mP4));
-        mP4.mGpsEpheValid = strtol(mField[eGpsEpheValid].c_str(), NULL, 16);
-        mP4.mGloEpheValid = strtol(mField[eGloEpheValid].c_str(), NULL, 16);
-        mP4.mBdsEpheValid = strtol(mField[eBdsEpheValid].c_str(), NULL, 16);
-        mP4.mGalEpheValid = strtol(mField[eGalEpheValid].c_str(), NULL, 16);
-        mP4.mQzssEpheValid = strtol(mField[eQzssEpheValid].c_str(), NULL, 16);
+        mP4.mGpsEpheValid = getHex(eGpsEpheValid);
+        mP4.mGloEpheValid = getHex(eGloEpheValid);
+        mP4.mBdsEpheValid = getHex(eBdsEpheValid);
+        mP4.mGalEpheValid = getHex(eGalEpheValid);
+        mP4.mQzssEpheValid = getHex(eQzssEpheValid);
     }
 
     inline SystemStatusPQWP4& get() { return mP4;}
@@ -582,26 +750,26 @@ public:
     SystemStatusPQWP5parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP5, 0, sizeof(mP5));
         // todo: update for navic once available
-        mP5.mGpsUnknownMask = strtol(mField[eGpsUnknownMask].c_str(), NULL, 16);
-        mP5.mGloUnknownMask = strtol(mField[eGloUnknownMask].c_str(), NULL, 16);
-        mP5.mBdsUnknownMask = strtol(mField[eBdsUnknownMask].c_str(), NULL, 16);
-        mP5.mGalUnknownMask = strtol(mField[eGalUnknownMask].c_str(), NULL, 16);
-        mP5.mQzssUnknownMask = strtol(mField[eQzssUnknownMask].c_str(), NULL, 16);
-        mP5.mGpsGoodMask = strtol(mField[eGpsGoodMask].c_str(), NULL, 16);
-        mP5.mGloGoodMask = strtol(mField[eGloGoodMask].c_str(), NULL, 16);
-        mP5.mBdsGoodMask = strtol(mField[eBdsGoodMask].c_str(), NULL, 16);
-        mP5.mGalGoodMask = strtol(mField[eGalGoodMask].c_str(), NULL, 16);
-        mP5.mQzssGoodMask = strtol(mField[eQzssGoodMask].c_str(), NULL, 16);
-        mP5.mGpsBadMask = strtol(mField[eGpsBadMask].c_str(), NULL, 16);
-        mP5.mGloBadMask = strtol(mField[eGloBadMask].c_str(), NULL, 16);
-        mP5.mBdsBadMask = strtol(mField[eBdsBadMask].c_str(), NULL, 16);
-        mP5.mGalBadMask = strtol(mField[eGalBadMask].c_str(), NULL, 16);
-        mP5.mQzssBadMask = strtol(mField[eQzssBadMask].c_str(), NULL, 16);
+        mP5.mGpsUnknownMask = getHex(eGpsUnknownMask);
+        mP5.mGloUnknownMask = getHex(eGloUnknownMask);
+        mP5.mBdsUnknownMask = getHex(eBdsUnknownMask);
+        mP5.mGalUnknownMask = getHex(eGalUnknownMask);
+        mP5.mQzssUnknownMask = getHex(eQzssUnknownMask);
+        mP5.mGpsGoodMask = getHex(eGpsGoodMask);
+        mP5.mGloGoodMask = getHex(eGloGoodMask);
+        mP5.mBdsGoodMask = getHex(eBdsGoodMask);
+        mP5.mGalGoodMask = getHex(eGalGoodMask);
+        mP5.mQzssGoodMask = getHex(eQzssGoodMask);
+        mP5.mGpsBadMask = getHex(eGpsBadMask);
+        mP5.mGloBadMask = getHex(eGloBadMask);
+        mP5.mBdsBadMask = getHex(eBdsBadMask);
+        mP5.mGalBadMask = getHex(eGalBadMask);
+        mP5.mQzssBadMask = getHex(eQzssBadMask);
     }
 
     inline SystemStatusPQWP5& get() { return mP5;}
@@ -634,11 +802,11 @@ public:
     SystemStatusPQWP6parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mP6, 0, sizeof(mP6));
-        mP6.mFixInfoMask = strtol(mField[eFixInfoMask].c_str(), NULL, 16);
+        mP6.mFixInfoMask = getHex(eFixInfoMask);
     }
 
     inline SystemStatusPQWP6& get() { return mP6;}
@@ -670,20 +838,20 @@ public:
         : SystemStatusNmeaBase(str_in, len_in)
     {
         uint32_t svLimit = SV_ALL_NUM;
-        if (mField.size() < eMin) {
-            LOC_LOGE("PQWP7parser - invalid size=%zu", mField.size());
+        if (mFieldCount < eMin) {
+            LOC_LOGE("PQWP7parser - invalid size=%u", mFieldCount);
             return;
         }
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             // Try reducing limit, accounting for possibly missing NAVIC support
             svLimit = SV_ALL_NUM_MIN;
         }
 
         memset(mP7.mNav, 0, sizeof(mP7.mNav));
         for (uint32_t i=0; i<svLimit; i++) {
-            mP7.mNav[i].mType   = GnssEphemerisType(atoi(mField[i*3+2].c_str()));
-            mP7.mNav[i].mSource = GnssEphemerisSource(atoi(mField[i*3+3].c_str()));
-            mP7.mNav[i].mAgeSec = atoi(mField[i*3+4].c_str());
+            mP7.mNav[i].mType   = GnssEphemerisType(getInt(i*3+2));
+            mP7.mNav[i].mSource = GnssEphemerisSource(getInt(i*3+3));
+            mP7.mNav[i].mAgeSec = getInt(i*3+4);
         }
     }
 
@@ -720,12 +888,12 @@ public:
     SystemStatusPQWS1parser(const char *str_in, uint32_t len_in)
         : SystemStatusNmeaBase(str_in, len_in)
     {
-        if (mField.size() < eMax) {
+        if (mFieldCount < eMax) {
             return;
         }
         memset(&mS1, 0, sizeof(mS1));
-        mS1.mFixInfoMask = atoi(mField[eFixInfoMask].c_str());
-        mS1.mHepeLimit = atoi(mField[eHepeLimit].c_str());
+        mS1.mFixInfoMask = getInt(eFixInfoMask);
+        mS1.mHepeLimit = getInt(eHepeLimit);
     }
 
     inline SystemStatusPQWS1& get() { return mS1;}
@@ -1351,15 +1519,12 @@ bool SystemStatus::setIteminReport(TYPE_REPORT& report, TYPE_ITEM&& s)
     }
     if (!report.empty() && report.back().equals(static_cast<TYPE_ITEM&>(s.collate(report.back())))) {
         // there is no change - just update reported timestamp
-        report.back().mUtcReported = s.mUtcReported;
+        report.setReported(s.mUtcReported);
         return false;
     }
 
-    // first event or updated
+    // first event or updated, the ring drops the oldest item once full
     report.push_back(s);
-    if (report.size() > s.maxItem) {
-        report.erase(report.begin());
-    }
     return true;
 }
 
@@ -1367,17 +1532,12 @@ template <typename TYPE_REPORT, typename TYPE_ITEM>
 void SystemStatus::setDefaultIteminReport(TYPE_REPORT& report, const TYPE_ITEM& s)
 {
     report.push_back(s);
-    if (report.size() > s.maxItem) {
-        report.erase(report.begin());
-    }
 }
 
 template <typename TYPE_REPORT, typename TYPE_ITEM>
 void SystemStatus::getIteminReport(TYPE_REPORT& reportout, const TYPE_ITEM& c) const
 {
-    reportout.clear();
-    if (c.size() >= 1) {
-        reportout.push_back(c.back());
+    if (0 != c.getLatest(reportout)) {
         reportout.back().dump();
     }
 }
@@ -1396,56 +1556,84 @@ bool SystemStatus::setNmeaString(const char *data, uint32_t len)
         return false;
     }
 
-    char buf[SystemStatusNmeaBase::NMEA_MAXSIZE + 1] = { 0 };
-    strlcpy(buf, data, sizeof(buf));
-
-    pthread_mutex_lock(&mMutexSystemStatus);
-
-    // parse the received nmea strings here
-    if (0 == strncmp(data, "$PQWM1", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        SystemStatusPQWM1 s = SystemStatusPQWM1parser(buf, len).get();
-        setIteminReport(mCache.mTimeAndClock, SystemStatusTimeAndClock(s));
-        setIteminReport(mCache.mXoState, SystemStatusXoState(s));
-        setIteminReport(mCache.mRfAndParams, SystemStatusRfAndParams(s));
-        setIteminReport(mCache.mErrRecovery, SystemStatusErrRecovery(s));
-    }
-    else if (0 == strncmp(data, "$PQWP1", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mInjectedPosition,
-                SystemStatusInjectedPosition(SystemStatusPQWP1parser(buf, len).get()));
-    }
-    else if (0 == strncmp(data, "$PQWP2", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mBestPosition,
-                SystemStatusBestPosition(SystemStatusPQWP2parser(buf, len).get()));
-    }
-    else if (0 == strncmp(data, "$PQWP3", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mXtra,
-                SystemStatusXtra(SystemStatusPQWP3parser(buf, len).get()));
-    }
-    else if (0 == strncmp(data, "$PQWP4", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mEphemeris,
-                SystemStatusEphemeris(SystemStatusPQWP4parser(buf, len).get()));
-    }
-    else if (0 == strncmp(data, "$PQWP5", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mSvHealth,
-                SystemStatusSvHealth(SystemStatusPQWP5parser(buf, len).get()));
-    }
-    else if (0 == strncmp(data, "$PQWP6", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mPdr,
-                SystemStatusPdr(SystemStatusPQWP6parser(buf, len).get()));
-    }
-    else if (0 == strncmp(data, "$PQWP7", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mNavData,
-                SystemStatusNavData(SystemStatusPQWP7parser(buf, len).get()));
-    }
-    else if (0 == strncmp(data, "$PQWS1", SystemStatusNmeaBase::NMEA_MINSIZE)) {
-        setIteminReport(mCache.mPositionFailure,
-                SystemStatusPositionFailure(SystemStatusPQWS1parser(buf, len).get()));
-    }
-    else {
-        // do nothing
+    // parse the received nmea strings here, only the cache update is
+    // done under mMutexSystemStatus
+    switch (SystemStatusNmeaBase::getSentenceId(data)) {
+        case SystemStatusNmeaBase::ePQWM1: {
+            SystemStatusPQWM1 s = SystemStatusPQWM1parser(data, len).get();
+            SystemStatusTimeAndClock timeAndClock(s);
+            SystemStatusXoState xoState(s);
+            SystemStatusRfAndParams rfAndParams(s);
+            SystemStatusErrRecovery errRecovery(s);
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mTimeAndClock, std::move(timeAndClock));
+            setIteminReport(mCache.mXoState, std::move(xoState));
+            setIteminReport(mCache.mRfAndParams, std::move(rfAndParams));
+            setIteminReport(mCache.mErrRecovery, std::move(errRecovery));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWP1: {
+            SystemStatusInjectedPosition s(SystemStatusPQWP1parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mInjectedPosition, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWP2: {
+            SystemStatusBestPosition s(SystemStatusPQWP2parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mBestPosition, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWP3: {
+            SystemStatusXtra s(SystemStatusPQWP3parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mXtra, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWP4: {
+            SystemStatusEphemeris s(SystemStatusPQWP4parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mEphemeris, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWP5: {
+            SystemStatusSvHealth s(SystemStatusPQWP5parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mSvHealth, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWP6: {
+            SystemStatusPdr s(SystemStatusPQWP6parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mPdr, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWP7: {
+            SystemStatusNavData s(SystemStatusPQWP7parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mNavData, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        case SystemStatusNmeaBase::ePQWS1: {
+            SystemStatusPositionFailure s(SystemStatusPQWS1parser(data, len).get());
+            pthread_mutex_lock(&mMutexSystemStatus);
+            setIteminReport(mCache.mPositionFailure, std::move(s));
+            pthread_mutex_unlock(&mMutexSystemStatus);
+            break;
+        }
+        default:
+            // do nothing
+            break;
     }
 
-    pthread_mutex_unlock(&mMutexSystemStatus);
     return true;
 }
 
@@ -1591,10 +1779,9 @@ bool SystemStatus::eventDataItemNotify(IDataItemCore* dataitem)
 ******************************************************************************/
 bool SystemStatus::getReport(SystemStatusReports& report, bool isLatestOnly) const
 {
-    pthread_mutex_lock(&mMutexSystemStatus);
-
     if (isLatestOnly) {
-        // push back only the latest report and return it
+        // each history keeps a copy of its latest item under a lock of its
+        // own, so mMutexSystemStatus is not needed
         getIteminReport(report.mLocation, mCache.mLocation);
 
         getIteminReport(report.mTimeAndClock, mCache.mTimeAndClock);
@@ -1634,51 +1821,51 @@ bool SystemStatus::getReport(SystemStatusReports& report, bool isLatestOnly) con
         getIteminReport(report.mMccMnc, mCache.mMccMnc);
         getIteminReport(report.mBtDeviceScanDetail, mCache.mBtDeviceScanDetail);
         getIteminReport(report.mBtLeDeviceScanDetail, mCache.mBtLeDeviceScanDetail);
+        return true;
     }
-    else {
-        // copy entire reports and return them
-        report.mLocation.clear();
-
-        report.mTimeAndClock.clear();
-        report.mXoState.clear();
-        report.mRfAndParams.clear();
-        report.mErrRecovery.clear();
-
-        report.mInjectedPosition.clear();
-        report.mBestPosition.clear();
-        report.mXtra.clear();
-        report.mEphemeris.clear();
-        report.mSvHealth.clear();
-        report.mPdr.clear();
-        report.mNavData.clear();
-
-        report.mPositionFailure.clear();
-
-        report.mAirplaneMode.clear();
-        report.mENH.clear();
-        report.mGPSState.clear();
-        report.mNLPStatus.clear();
-        report.mWifiHardwareState.clear();
-        report.mNetworkInfo.clear();
-        report.mRilServiceInfo.clear();
-        report.mRilCellInfo.clear();
-        report.mServiceStatus.clear();
-        report.mModel.clear();
-        report.mManufacturer.clear();
-        report.mAssistedGps.clear();
-        report.mScreenState.clear();
-        report.mPowerConnectState.clear();
-        report.mTimeZoneChange.clear();
-        report.mTimeChange.clear();
-        report.mWifiSupplicantStatus.clear();
-        report.mShutdownState.clear();
-        report.mTac.clear();
-        report.mMccMnc.clear();
-        report.mBtDeviceScanDetail.clear();
-        report.mBtLeDeviceScanDetail.clear();
-
-        report = mCache;
-    }
+
+    // copy entire reports and return them
+    pthread_mutex_lock(&mMutexSystemStatus);
+
+    mCache.mLocation.copyTo(report.mLocation);
+
+    mCache.mTimeAndClock.copyTo(report.mTimeAndClock);
+    mCache.mXoState.copyTo(report.mXoState);
+    mCache.mRfAndParams.copyTo(report.mRfAndParams);
+    mCache.mErrRecovery.copyTo(report.mErrRecovery);
+
+    mCache.mInjectedPosition.copyTo(report.mInjectedPosition);
+    mCache.mBestPosition.copyTo(report.mBestPosition);
+    mCache.mXtra.copyTo(report.mXtra);
+    mCache.mEphemeris.copyTo(report.mEphemeris);
+    mCache.mSvHealth.copyTo(report.mSvHealth);
+    mCache.mPdr.copyTo(report.mPdr);
+    mCache.mNavData.copyTo(report.mNavData);
+
+    mCache.mPositionFailure.copyTo(report.mPositionFailure);
+
+    mCache.mAirplaneMode.copyTo(report.mAirplaneMode);
+    mCache.mENH.copyTo(report.mENH);
+    mCache.mGPSState.copyTo(report.mGPSState);
+    mCache.mNLPStatus.copyTo(report.mNLPStatus);
+    mCache.mWifiHardwareState.copyTo(report.mWifiHardwareState);
+    mCache.mNetworkInfo.copyTo(report.mNetworkInfo);
+    mCache.mRilServiceInfo.copyTo(report.mRilServiceInfo);
+    mCache.mRilCellInfo.copyTo(report.mRilCellInfo);
+    mCache.mServiceStatus.copyTo(report.mServiceStatus);
+    mCache.mModel.copyTo(report.mModel);
+    mCache.mManufacturer.copyTo(report.mManufacturer);
+    mCache.mAssistedGps.copyTo(report.mAssistedGps);
+    mCache.mScreenState.copyTo(report.mScreenState);
+    mCache.mPowerConnectState.copyTo(report.mPowerConnectState);
+    mCache.mTimeZoneChange.copyTo(report.mTimeZoneChange);
+    mCache.mTimeChange.copyTo(report.mTimeChange);
+    mCache.mWifiSupplicantStatus.copyTo(report.mWifiSupplicantStatus);
+    mCache.mShutdownState.copyTo(report.mShutdownState);
+    mCache.mTac.copyTo(report.mTac);
+    mCache.mMccMnc.copyTo(report.mMccMnc);
+    mCache.mBtDeviceScanDetail.copyTo(report.mBtDeviceScanDetail);
+    mCache.mBtLeDeviceScanDetail.copyTo(report.mBtLeDeviceScanDetail);
 
     pthread_mutex_unlock(&mMutexSystemStatus);
     return true;
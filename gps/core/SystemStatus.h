@@ -32,6 +32,9 @@
 #include <stdint.h>
 #include <sys/time.h>
 #include <vector>
+#include <memory>
+#include <atomic>
+#include <mutex>
 #include <algorithm>
 #include <iterator>
 #include <loc_pla.h>
@@ -819,6 +822,96 @@ public:
     }
 };
 
+/******************************************************************************
+ SystemStatusHistory - the last maxItem items of one report, kept in a ring
+******************************************************************************/
+template <typename TYPE_ITEM>
+class SystemStatusHistory
+{
+    TYPE_ITEM mItems[SystemStatusItemBase::maxItem];
+    uint32_t mFirst;
+    uint32_t mCount;
+    uint32_t mVersion;
+    // copy of the newest item for readers that do not hold mMutexSystemStatus.
+    // Items are polymorphic and some hold strings, so they can not be read
+    // while being written; mLatestMutex guards this one copy only, and is
+    // held just to copy it in or out, never across mMutexSystemStatus work.
+    mutable std::mutex mLatestMutex;
+    TYPE_ITEM mLatest;
+    // version of mLatest, 0 while the report is empty
+    std::atomic<uint32_t> mLatestVersion;
+
+    inline TYPE_ITEM& item(uint32_t i) {
+        return mItems[(mFirst + i) % SystemStatusItemBase::maxItem];
+    }
+    inline const TYPE_ITEM& item(uint32_t i) const {
+        return mItems[(mFirst + i) % SystemStatusItemBase::maxItem];
+    }
+    SystemStatusHistory(const SystemStatusHistory&) = delete;
+    SystemStatusHistory& operator=(const SystemStatusHistory&) = delete;
+
+public:
+    inline SystemStatusHistory() : mFirst(0), mCount(0), mVersion(0), mLatestVersion(0) {}
+
+    // writer side, all of these need mMutexSystemStatus
+    inline bool empty() const { return 0 == mCount; }
+    inline uint32_t size() const { return mCount; }
+    inline TYPE_ITEM& back() { return item(mCount - 1); }
+
+    // store s as the newest item, dropping the oldest one when full
+    void push_back(const TYPE_ITEM& s) {
+        if (mCount < SystemStatusItemBase::maxItem) {
+            item(mCount++) = s;
+        } else {
+            item(0) = s;
+            mFirst = (mFirst + 1) % SystemStatusItemBase::maxItem;
+        }
+        // copied into the existing item, so nothing is allocated
+        std::lock_guard<std::mutex> lock(mLatestMutex);
+        mLatest = s;
+        mLatestVersion.store(++mVersion, std::memory_order_relaxed);
+    }
+    // newest item did not change, only the time it was last reported
+    void setReported(const timespec& utcReported) {
+        back().mUtcReported = utcReported;
+        std::lock_guard<std::mutex> lock(mLatestMutex);
+        mLatest.mUtcReported = utcReported;
+    }
+    void clear() {
+        mFirst = 0;
+        mCount = 0;
+        std::lock_guard<std::mutex> lock(mLatestMutex);
+        mLatestVersion.store(0, std::memory_order_relaxed);
+    }
+    // whole history, oldest first
+    void copyTo(std::vector<TYPE_ITEM>& reportout) const {
+        reportout.clear();
+        reportout.reserve(mCount);
+        for (uint32_t i = 0; i < mCount; i++) {
+            reportout.push_back(item(i));
+        }
+    }
+
+    // reader side, without mMutexSystemStatus; takes only this history's
+    // mLatestMutex, for as long as it takes to copy one item
+    // returns the version of the newest item, which is bumped on every
+    // push_back(), or 0 while the report is empty
+    uint32_t getLatest(std::vector<TYPE_ITEM>& reportout) const {
+        reportout.clear();
+        reportout.reserve(1);
+        std::lock_guard<std::mutex> lock(mLatestMutex);
+        uint32_t version = mLatestVersion.load(std::memory_order_relaxed);
+        if (0 != version) {
+            reportout.push_back(mLatest);
+        }
+        return version;
+    }
+    // takes no lock
+    uint32_t getVersion() const {
+        return mLatestVersion.load(std::memory_order_relaxed);
+    }
+};
+
 /******************************************************************************
  SystemStatusReports
 ******************************************************************************/
@@ -871,6 +964,181 @@ public:
     std::vector<SystemStatusBtleDeviceScanDetail> mBtLeDeviceScanDetail;
 };
 
+/******************************************************************************
+ SystemStatusCache - report histories kept by SystemStatus
+******************************************************************************/
+class SystemStatusCache
+{
+public:
+    // from QMI_LOC indication
+    SystemStatusHistory<SystemStatusLocation>      mLocation;
+
+    // from ME debug NMEA
+    SystemStatusHistory<SystemStatusTimeAndClock>  mTimeAndClock;
+    SystemStatusHistory<SystemStatusXoState>       mXoState;
+    SystemStatusHistory<SystemStatusRfAndParams>   mRfAndParams;
+    SystemStatusHistory<SystemStatusErrRecovery>   mErrRecovery;
+
+    // from PE debug NMEA
+    SystemStatusHistory<SystemStatusInjectedPosition> mInjectedPosition;
+    SystemStatusHistory<SystemStatusBestPosition>  mBestPosition;
+    SystemStatusHistory<SystemStatusXtra>          mXtra;
+    SystemStatusHistory<SystemStatusEphemeris>     mEphemeris;
+    SystemStatusHistory<SystemStatusSvHealth>      mSvHealth;
+    SystemStatusHistory<SystemStatusPdr>           mPdr;
+    SystemStatusHistory<SystemStatusNavData>       mNavData;
+
+    // from SM debug NMEA
+    SystemStatusHistory<SystemStatusPositionFailure> mPositionFailure;
+
+    // from dataitems observer
+    SystemStatusHistory<SystemStatusAirplaneMode>  mAirplaneMode;
+    SystemStatusHistory<SystemStatusENH>           mENH;
+    SystemStatusHistory<SystemStatusGpsState>      mGPSState;
+    SystemStatusHistory<SystemStatusNLPStatus>     mNLPStatus;
+    SystemStatusHistory<SystemStatusWifiHardwareState> mWifiHardwareState;
+    SystemStatusHistory<SystemStatusNetworkInfo>   mNetworkInfo;
+    SystemStatusHistory<SystemStatusServiceInfo>   mRilServiceInfo;
+    SystemStatusHistory<SystemStatusRilCellInfo>   mRilCellInfo;
+    SystemStatusHistory<SystemStatusServiceStatus> mServiceStatus;
+    SystemStatusHistory<SystemStatusModel>         mModel;
+    SystemStatusHistory<SystemStatusManufacturer>  mManufacturer;
+    SystemStatusHistory<SystemStatusAssistedGps>   mAssistedGps;
+    SystemStatusHistory<SystemStatusScreenState>   mScreenState;
+    SystemStatusHistory<SystemStatusPowerConnectState> mPowerConnectState;
+    SystemStatusHistory<SystemStatusTimeZoneChange> mTimeZoneChange;
+    SystemStatusHistory<SystemStatusTimeChange>    mTimeChange;
+    SystemStatusHistory<SystemStatusWifiSupplicantStatus> mWifiSupplicantStatus;
+    SystemStatusHistory<SystemStatusShutdownState> mShutdownState;
+    SystemStatusHistory<SystemStatusTac>           mTac;
+    SystemStatusHistory<SystemStatusMccMnc>        mMccMnc;
+    SystemStatusHistory<SystemStatusBtDeviceScanDetail> mBtDeviceScanDetail;
+    SystemStatusHistory<SystemStatusBtleDeviceScanDetail> mBtLeDeviceScanDetail;
+
+    // history of the report holding TYPE_ITEM
+    template <typename TYPE_ITEM>
+    inline SystemStatusHistory<TYPE_ITEM>& get() {
+        return history(static_cast<TYPE_ITEM*>(nullptr));
+    }
+    template <typename TYPE_ITEM>
+    inline const SystemStatusHistory<TYPE_ITEM>& get() const {
+        return const_cast<SystemStatusCache*>(this)->get<TYPE_ITEM>();
+    }
+
+private:
+    inline SystemStatusHistory<SystemStatusLocation>& history(SystemStatusLocation*) {
+        return mLocation;
+    }
+    inline SystemStatusHistory<SystemStatusTimeAndClock>& history(SystemStatusTimeAndClock*) {
+        return mTimeAndClock;
+    }
+    inline SystemStatusHistory<SystemStatusXoState>& history(SystemStatusXoState*) {
+        return mXoState;
+    }
+    inline SystemStatusHistory<SystemStatusRfAndParams>& history(SystemStatusRfAndParams*) {
+        return mRfAndParams;
+    }
+    inline SystemStatusHistory<SystemStatusErrRecovery>& history(SystemStatusErrRecovery*) {
+        return mErrRecovery;
+    }
+    inline SystemStatusHistory<SystemStatusInjectedPosition>& history(
+            SystemStatusInjectedPosition*) {
+        return mInjectedPosition;
+    }
+    inline SystemStatusHistory<SystemStatusBestPosition>& history(SystemStatusBestPosition*) {
+        return mBestPosition;
+    }
+    inline SystemStatusHistory<SystemStatusXtra>& history(SystemStatusXtra*) {
+        return mXtra;
+    }
+    inline SystemStatusHistory<SystemStatusEphemeris>& history(SystemStatusEphemeris*) {
+        return mEphemeris;
+    }
+    inline SystemStatusHistory<SystemStatusSvHealth>& history(SystemStatusSvHealth*) {
+        return mSvHealth;
+    }
+    inline SystemStatusHistory<SystemStatusPdr>& history(SystemStatusPdr*) {
+        return mPdr;
+    }
+    inline SystemStatusHistory<SystemStatusNavData>& history(SystemStatusNavData*) {
+        return mNavData;
+    }
+    inline SystemStatusHistory<SystemStatusPositionFailure>& history(SystemStatusPositionFailure*) {
+        return mPositionFailure;
+    }
+    inline SystemStatusHistory<SystemStatusAirplaneMode>& history(SystemStatusAirplaneMode*) {
+        return mAirplaneMode;
+    }
+    inline SystemStatusHistory<SystemStatusENH>& history(SystemStatusENH*) {
+        return mENH;
+    }
+    inline SystemStatusHistory<SystemStatusGpsState>& history(SystemStatusGpsState*) {
+        return mGPSState;
+    }
+    inline SystemStatusHistory<SystemStatusNLPStatus>& history(SystemStatusNLPStatus*) {
+        return mNLPStatus;
+    }
+    inline SystemStatusHistory<SystemStatusWifiHardwareState>& history(
+            SystemStatusWifiHardwareState*) {
+        return mWifiHardwareState;
+    }
+    inline SystemStatusHistory<SystemStatusNetworkInfo>& history(SystemStatusNetworkInfo*) {
+        return mNetworkInfo;
+    }
+    inline SystemStatusHistory<SystemStatusServiceInfo>& history(SystemStatusServiceInfo*) {
+        return mRilServiceInfo;
+    }
+    inline SystemStatusHistory<SystemStatusRilCellInfo>& history(SystemStatusRilCellInfo*) {
+        return mRilCellInfo;
+    }
+    inline SystemStatusHistory<SystemStatusServiceStatus>& history(SystemStatusServiceStatus*) {
+        return mServiceStatus;
+    }
+    inline SystemStatusHistory<SystemStatusModel>& history(SystemStatusModel*) {
+        return mModel;
+    }
+    inline SystemStatusHistory<SystemStatusManufacturer>& history(SystemStatusManufacturer*) {
+        return mManufacturer;
+    }
+    inline SystemStatusHistory<SystemStatusAssistedGps>& history(SystemStatusAssistedGps*) {
+        return mAssistedGps;
+    }
+    inline SystemStatusHistory<SystemStatusScreenState>& history(SystemStatusScreenState*) {
+        return mScreenState;
+    }
+    inline SystemStatusHistory<SystemStatusPowerConnectState>& history(
+            SystemStatusPowerConnectState*) {
+        return mPowerConnectState;
+    }
+    inline SystemStatusHistory<SystemStatusTimeZoneChange>& history(SystemStatusTimeZoneChange*) {
+        return mTimeZoneChange;
+    }
+    inline SystemStatusHistory<SystemStatusTimeChange>& history(SystemStatusTimeChange*) {
+        return mTimeChange;
+    }
+    inline SystemStatusHistory<SystemStatusWifiSupplicantStatus>& history(
+            SystemStatusWifiSupplicantStatus*) {
+        return mWifiSupplicantStatus;
+    }
+    inline SystemStatusHistory<SystemStatusShutdownState>& history(SystemStatusShutdownState*) {
+        return mShutdownState;
+    }
+    inline SystemStatusHistory<SystemStatusTac>& history(SystemStatusTac*) {
+        return mTac;
+    }
+    inline SystemStatusHistory<SystemStatusMccMnc>& history(SystemStatusMccMnc*) {
+        return mMccMnc;
+    }
+    inline SystemStatusHistory<SystemStatusBtDeviceScanDetail>& history(
+            SystemStatusBtDeviceScanDetail*) {
+        return mBtDeviceScanDetail;
+    }
+    inline SystemStatusHistory<SystemStatusBtleDeviceScanDetail>& history(
+            SystemStatusBtleDeviceScanDetail*) {
+        return mBtLeDeviceScanDetail;
+    }
+};
+
 /******************************************************************************
  SystemStatus
 ******************************************************************************/
@@ -886,7 +1154,7 @@ private:
 
     // Data members
     static pthread_mutex_t                    mMutexSystemStatus;
-    SystemStatusReports mCache;
+    SystemStatusCache mCache;
 
     template <typename TYPE_REPORT, typename TYPE_ITEM>
     bool setIteminReport(TYPE_REPORT& report, TYPE_ITEM&& s);
@@ -909,6 +1177,12 @@ public:
     bool eventDataItemNotify(IDataItemCore* dataitem);
     bool setNmeaString(const char *data, uint32_t len);
     bool getReport(SystemStatusReports& reports, bool isLatestonly = false) const;
+    // latest item of the single report holding TYPE_ITEM, without copying the
+    // others and without blocking writers; returns the report version or 0
+    template <typename TYPE_ITEM>
+    inline uint32_t getLatestReport(std::vector<TYPE_ITEM>& reportout) const {
+        return mCache.get<TYPE_ITEM>().getLatest(reportout);
+    }
     bool setDefaultGnssEngineStates(void);
     bool eventConnectionStatus(bool connected, int8_t type,
                                bool roaming, NetworkHandle networkHandle);
@@ -49,14 +49,17 @@ SystemStatusOsObserver::~SystemStatusOsObserver() {
     // Close data-item library handle
     DataItemsFactoryProxy::closeDataItemLibraryHandle();
 
-    // Destroy cache
-    for (auto each : mDataItemCache) {
-        if (nullptr != each.second) {
-            delete each.second;
+    // Destroy cache and pooled data items
+    for (int id = 0; id < MAX_DATA_ITEM_ID_1_1; id++) {
+        if (nullptr != mDataItemCache[id]) {
+            delete mDataItemCache[id];
+            mDataItemCache[id] = nullptr;
         }
+        for (uint32_t i = 0; i < mDataItemPool[id].mCount; i++) {
+            delete mDataItemPool[id].mItems[i];
+        }
+        mDataItemPool[id].mCount = 0;
     }
-
-    mDataItemCache.clear();
 }
 
 void SystemStatusOsObserver::setSubscriptionObj(IDataItemSubscription* subscriptionObj)
@@ -72,7 +75,7 @@ void SystemStatusOsObserver::setSubscriptionObj(IDataItemSubscription* subscript
 
             if (!mContext.mSSObserver->mDataItemToClients.empty()) {
                 list<DataItemId> dis(
-                        containerTransfer<unordered_set<DataItemId>, list<DataItemId>>(
+                        containerTransfer<DataItemIdSet, list<DataItemId>>(
                                 mContext.mSSObserver->mDataItemToClients.getKeys()));
                 mContext.mSubscriptionObj->subscribe(dis, mContext.mSSObserver);
                 mContext.mSubscriptionObj->requestData(dis, mContext.mSSObserver);
@@ -98,12 +101,12 @@ void SystemStatusOsObserver::subscribe(const list<DataItemId>& l, IDataItemObser
         inline HandleSubscribeReq(SystemStatusOsObserver* parent,
                 list<DataItemId>& l, IDataItemObserver* client, bool requestData) :
                 mParent(parent), mClient(client),
-                mDataItemSet(containerTransfer<list<DataItemId>, unordered_set<DataItemId>>(l)),
+                mDataItemSet(containerTransfer<list<DataItemId>, DataItemIdSet>(l)),
                 diItemlist(l),
                 mToRequestData(requestData) {}
 
         void proc() const {
-            unordered_set<DataItemId> dataItemsToSubscribe = {};
+            DataItemIdSet dataItemsToSubscribe = {};
             mParent->mDataItemToClients.add(mDataItemSet, {mClient}, &dataItemsToSubscribe);
             mParent->mClientToDataItems.add(mClient, mDataItemSet);
 
@@ -118,7 +121,7 @@ void SystemStatusOsObserver::subscribe(const list<DataItemId>& l, IDataItemObser
                     LOC_LOGD("Subscribe Request sent to framework for the following");
                     mParent->logMe(dataItemsToSubscribe);
                     mParent->mContext.mSubscriptionObj->subscribe(
-                            containerTransfer<unordered_set<DataItemId>, list<DataItemId>>(
+                            containerTransfer<DataItemIdSet, list<DataItemId>>(
                                     std::move(dataItemsToSubscribe)),
                             mParent);
                 }
@@ -126,7 +129,7 @@ void SystemStatusOsObserver::subscribe(const list<DataItemId>& l, IDataItemObser
         }
         mutable SystemStatusOsObserver* mParent;
         IDataItemObserver* mClient;
-        const unordered_set<DataItemId> mDataItemSet;
+        const DataItemIdSet mDataItemSet;
         const list<DataItemId> diItemlist;
         bool mToRequestData;
     };
@@ -146,11 +149,11 @@ void SystemStatusOsObserver::updateSubscription(
         HandleUpdateSubscriptionReq(SystemStatusOsObserver* parent,
                                     list<DataItemId>& l, IDataItemObserver* client) :
                 mParent(parent), mClient(client),
-                mDataItemSet(containerTransfer<list<DataItemId>, unordered_set<DataItemId>>(l)) {}
+                mDataItemSet(containerTransfer<list<DataItemId>, DataItemIdSet>(l)) {}
 
         void proc() const {
-            unordered_set<DataItemId> dataItemsToSubscribe = {};
-            unordered_set<DataItemId> dataItemsToUnsubscribe = {};
+            DataItemIdSet dataItemsToSubscribe = {};
+            DataItemIdSet dataItemsToUnsubscribe = {};
             unordered_set<IDataItemObserver*> clients({mClient});
             // below removes clients from all entries keyed with the return of the
             // mClientToDataItems.update() call. If leaving an empty set of clients as the
@@ -165,7 +168,7 @@ void SystemStatusOsObserver::updateSubscription(
                     // corresponding entries, and gets a set of the entries that are
                     // removed from the <DataItemId, IDataItemObserver*> map as a result.
                     mParent->mClientToDataItems.update(mClient,
-                                                       (unordered_set<DataItemId>&)mDataItemSet),
+                                                       (DataItemIdSet&)mDataItemSet),
                     clients, &dataItemsToUnsubscribe, nullptr);
             // below adds mClient to <DataItemId, IDataItemObserver*> map, and populates
             // new keys added to that map, which are DataItemIds to be subscribed.
@@ -181,7 +184,7 @@ void SystemStatusOsObserver::updateSubscription(
                     mParent->logMe(dataItemsToSubscribe);
 
                     mParent->mContext.mSubscriptionObj->subscribe(
-                            containerTransfer<unordered_set<DataItemId>, list<DataItemId>>(
+                            containerTransfer<DataItemIdSet, list<DataItemId>>(
                                     std::move(dataItemsToSubscribe)),
                             mParent);
                 }
@@ -192,7 +195,7 @@ void SystemStatusOsObserver::updateSubscription(
                     mParent->logMe(dataItemsToUnsubscribe);
 
                     mParent->mContext.mSubscriptionObj->unsubscribe(
-                            containerTransfer<unordered_set<DataItemId>, list<DataItemId>>(
+                            containerTransfer<DataItemIdSet, list<DataItemId>>(
                                     std::move(dataItemsToUnsubscribe)),
                             mParent);
                 }
@@ -200,7 +203,7 @@ void SystemStatusOsObserver::updateSubscription(
         }
         SystemStatusOsObserver* mParent;
         IDataItemObserver* mClient;
-        unordered_set<DataItemId> mDataItemSet;
+        DataItemIdSet mDataItemSet;
     };
 
     if (l.empty() || nullptr == client) {
@@ -218,12 +221,12 @@ void SystemStatusOsObserver::unsubscribe(
         HandleUnsubscribeReq(SystemStatusOsObserver* parent,
                 list<DataItemId>& l, IDataItemObserver* client) :
                 mParent(parent), mClient(client),
-                mDataItemSet(containerTransfer<list<DataItemId>, unordered_set<DataItemId>>(l)) {}
+                mDataItemSet(containerTransfer<list<DataItemId>, DataItemIdSet>(l)) {}
 
         void proc() const {
-            unordered_set<DataItemId> dataItemsUnusedByClient = {};
+            DataItemIdSet dataItemsUnusedByClient = {};
             unordered_set<IDataItemObserver*> clientToRemove = {};
-            unordered_set<DataItemId> dataItemsToUnsubscribe = {};
+            DataItemIdSet dataItemsToUnsubscribe = {};
             mParent->mClientToDataItems.trimOrRemove({mClient}, mDataItemSet,  &clientToRemove,
                                                      &dataItemsUnusedByClient);
             mParent->mDataItemToClients.trimOrRemove(dataItemsUnusedByClient, {mClient},
@@ -235,14 +238,14 @@ void SystemStatusOsObserver::unsubscribe(
 
                 // Send unsubscribe to framework
                 mParent->mContext.mSubscriptionObj->unsubscribe(
-                        containerTransfer<unordered_set<DataItemId>, list<DataItemId>>(
+                        containerTransfer<DataItemIdSet, list<DataItemId>>(
                                   std::move(dataItemsToUnsubscribe)),
                         mParent);
             }
         }
         SystemStatusOsObserver* mParent;
         IDataItemObserver* mClient;
-        unordered_set<DataItemId> mDataItemSet;
+        DataItemIdSet mDataItemSet;
     };
 
     if (l.empty() || nullptr == client) {
@@ -260,10 +263,10 @@ void SystemStatusOsObserver::unsubscribeAll(IDataItemObserver* client)
                 mParent(parent), mClient(client) {}
 
         void proc() const {
-            unordered_set<DataItemId> diByClient = mParent->mClientToDataItems.getValSet(mClient);
+            DataItemIdSet diByClient = mParent->mClientToDataItems.getValSet(mClient);
 
             if (!diByClient.empty()) {
-                unordered_set<DataItemId> dataItemsToUnsubscribe;
+                DataItemIdSet dataItemsToUnsubscribe;
                 mParent->mClientToDataItems.remove(mClient);
                 mParent->mDataItemToClients.trimOrRemove(diByClient, {mClient},
                                                          &dataItemsToUnsubscribe, nullptr);
@@ -276,7 +279,7 @@ void SystemStatusOsObserver::unsubscribeAll(IDataItemObserver* client)
 
                     // Send unsubscribe to framework
                     mParent->mContext.mSubscriptionObj->unsubscribe(
-                            containerTransfer<unordered_set<DataItemId>, list<DataItemId>>(
+                            containerTransfer<DataItemIdSet, list<DataItemId>>(
                                     std::move(dataItemsToUnsubscribe)),
                             mParent);
                 }
@@ -299,69 +302,71 @@ void SystemStatusOsObserver::unsubscribeAll(IDataItemObserver* client)
 void SystemStatusOsObserver::notify(const list<IDataItemCore*>& dlist)
 {
     struct HandleNotify : public LocMsg {
-        HandleNotify(SystemStatusOsObserver* parent, vector<IDataItemCore*>& v) :
-                mParent(parent), mDiVec(std::move(v)) {}
+        HandleNotify(SystemStatusOsObserver* parent, IDataItemCore** items, uint32_t count) :
+                mParent(parent), mItems(items), mCount(count) {}
 
         inline virtual ~HandleNotify() {
-            for (auto item : mDiVec) {
-                delete item;
+            for (uint32_t i = 0; i < mCount; i++) {
+                mParent->freeDataItem(mItems[i]);
             }
+            LocMsgPool::freeArray(mItems);
         }
 
         void proc() const {
-            // Update Cache with received data items and prepare
-            // list of data items to be sent.
-            unordered_set<DataItemId> dataItemIdsToBeSent = {};
-            for (auto item : mDiVec) {
-                if (mParent->updateCache(item)) {
-                    dataItemIdsToBeSent.insert(item->getId());
+            // Update Cache with received data items and collect
+            // the ids of the ones that changed.
+            DataItemIdSet changed;
+            for (uint32_t i = 0; i < mCount; i++) {
+                if (mParent->updateCache(mItems[i])) {
+                    changed.insert(mItems[i]->getId());
                 }
             }
 
-            // Send data item to all subscribed clients
-            unordered_set<IDataItemObserver*> clientSet = {};
-            for (auto each : dataItemIdsToBeSent) {
-                auto clients = mParent->mDataItemToClients.getValSetPtr(each);
-                if (nullptr != clients) {
-                    clientSet.insert(clients->begin(), clients->end());
+            // Send each subscribed client the changed data items it asked for,
+            // at the first changed id it is found under
+            for (auto id : changed) {
+                auto clients = mParent->mDataItemToClients.getValSetPtr(id);
+                if (nullptr == clients) {
+                    continue;
                 }
-            }
-
-            for (auto client : clientSet) {
-                unordered_set<DataItemId> dataItemIdsForThisClient(
-                        mParent->mClientToDataItems.getValSet(client));
-                for (auto itr = dataItemIdsForThisClient.begin();
-                        itr != dataItemIdsForThisClient.end(); ) {
-                    if (dataItemIdsToBeSent.find(*itr) == dataItemIdsToBeSent.end()) {
-                        itr = dataItemIdsForThisClient.erase(itr);
-                    } else {
-                        itr++;
+                for (auto client : *clients) {
+                    auto dataItems = mParent->mClientToDataItems.getValSetPtr(client);
+                    if (nullptr == dataItems) {
+                        continue;
+                    }
+                    DataItemIdSet toSend = *dataItems & changed;
+                    if (*toSend.begin() == id) {
+                        mParent->sendCachedDataItems(toSend, client);
                     }
                 }
-
-                mParent->sendCachedDataItems(dataItemIdsForThisClient, client);
             }
         }
         SystemStatusOsObserver* mParent;
-        const vector<IDataItemCore*> mDiVec;
+        IDataItemCore** const mItems;
+        const uint32_t mCount;
     };
 
     if (!dlist.empty()) {
-        vector<IDataItemCore*> dataItemVec(dlist.size());
+        IDataItemCore** items = LocMsgPool::allocArray<IDataItemCore*>(dlist.size());
+        if (nullptr == items) {
+            LOC_LOGe("Unable to allocate %zu dataitems", dlist.size());
+            return;
+        }
+        uint32_t count = 0;
 
         for (auto each : dlist) {
 
-            IDataItemCore* di = DataItemsFactoryProxy::createNewDataItem(each->getId());
+            IDataItemCore* di = allocDataItem(each->getId());
             if (nullptr == di) {
                 LOC_LOGw("Unable to create dataitem:%d", each->getId());
                 continue;
             }
 
-            // Copy contents into the newly created data item
+            // Copy contents into the data item, which may be a reused one,
+            // see allocDataItem()
             di->copy(each);
 
-            // add this dataitem if updated from last one
-            dataItemVec.push_back(di);
+            items[count++] = di;
             IF_LOC_LOGD {
                 string dv;
                 di->stringify(dv);
@@ -369,8 +374,11 @@ void SystemStatusOsObserver::notify(const list<IDataItemCore*>& dlist)
             }
         }
 
-        if (!dataItemVec.empty()) {
-            mContext.mMsgTask->sendMsg(new HandleNotify(this, dataItemVec));
+        if (count > 0) {
+            mContext.mMsgTask->sendMsg(new HandleNotify(this, items, count),
+                                       LOC_MSG_PRIORITY_BACKGROUND);
+        } else {
+            LocMsgPool::freeArray(items);
         }
     }
 }
@@ -528,22 +536,26 @@ bool SystemStatusOsObserver::disconnectBackhaul(const string& clientName)
  Helpers
 ******************************************************************************/
 void SystemStatusOsObserver::sendCachedDataItems(
-        const unordered_set<DataItemId>& s, IDataItemObserver* to)
+        const DataItemIdSet& s, IDataItemObserver* to)
 {
     if (nullptr == to) {
         LOC_LOGv("client pointer is NULL.");
     } else {
         string clientName;
-        to->getName(clientName);
+        IF_LOC_LOGI {
+            to->getName(clientName);
+        }
         list<IDataItemCore*> dataItems = {};
 
         for (auto each : s) {
-            auto citer = mDataItemCache.find(each);
-            if (citer != mDataItemCache.end()) {
-                string dv;
-                citer->second->stringify(dv);
-                LOC_LOGI("DataItem: %s >> %s", dv.c_str(), clientName.c_str());
-                dataItems.push_front(citer->second);
+            IDataItemCore* dataitem = mDataItemCache[each];
+            if (nullptr != dataitem) {
+                IF_LOC_LOGI {
+                    string dv;
+                    dataitem->stringify(dv);
+                    LOC_LOGI("DataItem: %s >> %s", dv.c_str(), clientName.c_str());
+                }
+                dataItems.push_front(dataitem);
             }
         }
 
@@ -563,21 +575,20 @@ bool SystemStatusOsObserver::updateCache(IDataItemCore* d)
     // if the return is false, it means that SystemStatus is not
     // handling it, so SystemStatusOsObserver also doesn't.
     // So it has to be true to proceed.
-    if (nullptr != d && mSystemStatus->eventDataItemNotify(d)) {
-        auto citer = mDataItemCache.find(d->getId());
-        if (citer == mDataItemCache.end()) {
+    if (nullptr != d && isValidDataItemId(d->getId()) &&
+            mSystemStatus->eventDataItemNotify(d)) {
+        IDataItemCore*& dataitem = mDataItemCache[d->getId()];
+        if (nullptr == dataitem) {
             // New data item; not found in cache
-            IDataItemCore* dataitem = DataItemsFactoryProxy::createNewDataItem(d->getId());
+            dataitem = DataItemsFactoryProxy::createNewDataItem(d->getId());
             if (nullptr != dataitem) {
                 // Copy the contents of the data item
                 dataitem->copy(d);
-                // Insert in mDataItemCache
-                mDataItemCache.insert(std::make_pair(d->getId(), dataitem));
                 dataItemUpdated = true;
             }
         } else {
             // Found in cache; Update cache if necessary
-            citer->second->copy(d, &dataItemUpdated);
+            dataitem->copy(d, &dataItemUpdated);
         }
 
         if (dataItemUpdated) {
@@ -588,5 +599,34 @@ bool SystemStatusOsObserver::updateCache(IDataItemCore* d)
     return dataItemUpdated;
 }
 
-} // namespace loc_core
+// A pooled item still holds the values of its last use, and notify()
+// overwrites them with IDataItemCore::copy(). Reuse thus assumes that the
+// copy() of every concrete item type sets all of its fields; a type whose
+// copy() skips some must not be pooled.
+IDataItemCore* SystemStatusOsObserver::allocDataItem(DataItemId id)
+{
+    if (isValidDataItemId(id)) {
+        std::lock_guard<std::mutex> guard(mDataItemPoolLock);
+        DataItemPool& pool = mDataItemPool[id];
+        if (pool.mCount > 0) {
+            return pool.mItems[--pool.mCount];
+        }
+    }
+    return DataItemsFactoryProxy::createNewDataItem(id);
+}
 
+void SystemStatusOsObserver::freeDataItem(IDataItemCore* d)
+{
+    DataItemId id = d->getId();
+    if (isValidDataItemId(id)) {
+        std::lock_guard<std::mutex> guard(mDataItemPoolLock);
+        DataItemPool& pool = mDataItemPool[id];
+        if (pool.mCount < DATA_ITEM_POOL_DEPTH) {
+            pool.mItems[pool.mCount++] = d;
+            return;
+        }
+    }
+    delete d;
+}
+
+} // namespace loc_core
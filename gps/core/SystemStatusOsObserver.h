@@ -35,6 +35,7 @@
 #include <map>
 #include <new>
 #include <vector>
+#include <mutex>
 
 #include <MsgTask.h>
 #include <DataItemId.h>
@@ -56,10 +57,13 @@ class IDataItemCore;
 class SystemStatus;
 class SystemStatusOsObserver;
 typedef map<IDataItemObserver*, list<DataItemId>> ObserverReqCache;
-typedef LocUnorderedSetMap<IDataItemObserver*, DataItemId> ClientToDataItems;
-typedef LocUnorderedSetMap<DataItemId, IDataItemObserver*> DataItemToClients;
-typedef unordered_map<DataItemId, IDataItemCore*> DataItemIdToCore;
+// DataItemIds are few and dense, sets of them are kept as bitsets
+typedef LocBitSet<DataItemId, MAX_DATA_ITEM_ID_1_1> DataItemIdSet;
+typedef LocUnorderedSetMap<IDataItemObserver*, DataItemIdSet> ClientToDataItems;
+typedef LocUnorderedSetMap<DataItemIdSet, IDataItemObserver*> DataItemToClients;
 typedef unordered_map<DataItemId, int> DataItemIdToInt;
+// spare data items kept per DataItemId for notify() to reuse
+#define DATA_ITEM_POOL_DEPTH 8
 #ifdef USE_GLIB
 // Cache details of backhaul client requests
 typedef unordered_set<string> ClientBackhaulReqCache;
@@ -87,7 +91,8 @@ public:
     inline SystemStatusOsObserver(SystemStatus* systemstatus, const MsgTask* msgTask) :
             mSystemStatus(systemstatus), mContext(msgTask, this),
             mAddress("SystemStatusOsObserver"),
-            mClientToDataItems(MAX_DATA_ITEM_ID), mDataItemToClients(MAX_DATA_ITEM_ID) {}
+            mClientToDataItems(MAX_DATA_ITEM_ID), mDataItemToClients(MAX_DATA_ITEM_ID),
+            mDataItemCache(), mDataItemPool() {}
 
     // dtor
     ~SystemStatusOsObserver();
@@ -150,9 +155,18 @@ private:
     const string                                     mAddress;
     ClientToDataItems                                mClientToDataItems;
     DataItemToClients                                mDataItemToClients;
-    DataItemIdToCore                                 mDataItemCache;
+    // latest value of each data item, only accessed in mMsgTask thread
+    IDataItemCore*                                   mDataItemCache[MAX_DATA_ITEM_ID_1_1];
     DataItemIdToInt                                  mActiveRequestCount;
 
+    // copies handed from notify() to mMsgTask go back here once processed
+    struct DataItemPool {
+        IDataItemCore* mItems[DATA_ITEM_POOL_DEPTH];
+        uint32_t mCount;
+    };
+    std::mutex                                       mDataItemPoolLock;
+    DataItemPool                                     mDataItemPool[MAX_DATA_ITEM_ID_1_1];
+
     // Cache the subscribe and requestData till subscription obj is obtained
     void cacheObserverRequest(ObserverReqCache& reqCache,
             const list<DataItemId>& l, IDataItemObserver* client);
@@ -164,9 +178,14 @@ private:
     void subscribe(const list<DataItemId>& l, IDataItemObserver* client, bool toRequestData);
 
     // Helpers
-    void sendCachedDataItems(const unordered_set<DataItemId>& s, IDataItemObserver* to);
+    void sendCachedDataItems(const DataItemIdSet& s, IDataItemObserver* to);
     bool updateCache(IDataItemCore* d);
-    inline void logMe(const unordered_set<DataItemId>& l) {
+    IDataItemCore* allocDataItem(DataItemId id);
+    void freeDataItem(IDataItemCore* d);
+    static inline bool isValidDataItemId(DataItemId id) {
+        return id > INVALID_DATA_ITEM_ID && id < MAX_DATA_ITEM_ID_1_1;
+    }
+    inline void logMe(const DataItemIdSet& l) {
         IF_LOC_LOGD {
             for (auto id : l) {
                 LOC_LOGD("DataItem %d", id);
@@ -760,7 +760,7 @@ GeofenceAdapter::geofenceBreachEvent(size_t count, uint32_t* hwIds, Location& lo
             LocMsg(),
             mAdapter(adapter),
             mCount(count),
-            mHwIds(new uint32_t[count]),
+            mHwIds(LocMsgPool::allocArray<uint32_t>(count)),
             mLocation(location),
             mBreachType(breachType),
             mTimestamp(timestamp)
@@ -772,14 +772,15 @@ GeofenceAdapter::geofenceBreachEvent(size_t count, uint32_t* hwIds, Location& lo
             COPY_IF_NOT_NULL(mHwIds, hwIds, mCount);
         }
         inline virtual ~MsgGeofenceBreach() {
-            delete[] mHwIds;
+            LocMsgPool::freeArray(mHwIds);
         }
         inline virtual void proc() const {
             mAdapter.geofenceBreach(mCount, mHwIds, mLocation, mBreachType, mTimestamp);
         }
     };
 
-    sendMsg(new MsgGeofenceBreach(*this, count, hwIds, location, breachType, timestamp));
+    sendMsg(new MsgGeofenceBreach(*this, count, hwIds, location, breachType, timestamp),
+            LOC_MSG_PRIORITY_REPORT);
 
 }
 
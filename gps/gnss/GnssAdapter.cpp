@@ -151,6 +151,10 @@ GnssAdapter::GnssAdapter() :
             };
     mAgpsManager.registerATLCallbacks(atlOpenStatusCb, atlCloseStatusCb);
 
+    ContextBase::addGpsConfListener(mMsgTask,
+            [this](const loc_gps_cfg_s_type& oldConf, const loc_gps_cfg_s_type& newConf) {
+                handleGpsConfChange(oldConf, newConf);
+            });
     readConfigCommand();
     initDefaultAgpsCommand();
     initEngHubProxyCommand();
@@ -819,6 +823,34 @@ GnssAdapter::readConfigCommand()
     }
 }
 
+void
+GnssAdapter::handleGpsConfChange(const loc_gps_cfg_s_type& oldConf,
+                                 const loc_gps_cfg_s_type& newConf)
+{
+    // needReport() and the NMEA paths read the new snapshot by themselves,
+    // what is left is the NMEA mask the modem was given for NMEA_PROVIDER
+    if (oldConf.NMEA_PROVIDER == newConf.NMEA_PROVIDER) {
+        return;
+    }
+    LOC_LOGd("NMEA_PROVIDER %u -> %u", oldConf.NMEA_PROVIDER, newConf.NMEA_PROVIDER);
+    uint32_t mask = 0;
+    if (NMEA_PROVIDER_MP == newConf.NMEA_PROVIDER) {
+        mask |= LOC_NMEA_ALL_GENERAL_SUPPORTED_MASK;
+    }
+    if (ContextBase::isFeatureSupported(LOC_SUPPORTED_FEATURE_DEBUG_NMEA_V02)) {
+        mask |= LOC_NMEA_MASK_DEBUG_V02;
+    }
+    if (mNmeaMask != mask) {
+        mNmeaMask = mask;
+        updateClientsEventMask();
+        if (mask != 0) {
+            mLocApi->sendMsg(new LocApiMsg([this, mask] () {
+                mLocApi->setNMEATypesSync(mask);
+            }));
+        }
+    }
+}
+
 void
 GnssAdapter::setSuplHostServer(const char* server, int port, LocServerType type)
 {
@@ -859,7 +891,7 @@ GnssAdapter::setConfig()
 
     // set nmea mask type
     uint32_t mask = 0;
-    if (NMEA_PROVIDER_MP == ContextBase::mGps_conf.NMEA_PROVIDER) {
+    if (NMEA_PROVIDER_MP == ContextBase::getGpsConf().NMEA_PROVIDER) {
         mask |= LOC_NMEA_ALL_GENERAL_SUPPORTED_MASK;
     }
     if (ContextBase::isFeatureSupported(LOC_SUPPORTED_FEATURE_DEBUG_NMEA_V02)) {
@@ -867,14 +899,9 @@ GnssAdapter::setConfig()
     }
     if (mNmeaMask != mask) {
         mNmeaMask = mask;
-        if (mNmeaMask) {
-            for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-                if ((it->second.gnssNmeaCb != nullptr)) {
-                    updateEvtMask(LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT,
-                                  LOC_REGISTRATION_MASK_ENABLED);
-                    break;
-                }
-            }
+        if (mNmeaMask && !mNmeaSubscribers.empty()) {
+            updateEvtMask(LOC_API_ADAPTER_BIT_NMEA_1HZ_REPORT,
+                          LOC_REGISTRATION_MASK_ENABLED);
         }
     }
 
@@ -938,7 +965,7 @@ GnssAdapter::setConfig()
 
         // set nmea mask type
         uint32_t mask = 0;
-        if (NMEA_PROVIDER_MP == gpsConf.NMEA_PROVIDER) {
+        if (NMEA_PROVIDER_MP == ContextBase::getGpsConf().NMEA_PROVIDER) {
             mask |= LOC_NMEA_ALL_GENERAL_SUPPORTED_MASK;
         }
         if (ContextBase::isFeatureSupported(LOC_SUPPORTED_FEATURE_DEBUG_NMEA_V02)) {
@@ -2452,10 +2479,57 @@ GnssAdapter::stopClientSessions(LocationAPI* client)
 
 }
 
+void
+GnssAdapter::updateClientSubscribers()
+{
+    mLocationInfoSubscribers.clear();
+    mGnssPositionSubscribers.clear();
+    mFlpPositionSubscribers.clear();
+    mEngineLocationsSubscribers.clear();
+    mSvSubscribers.clear();
+    mNmeaSubscribers.clear();
+    mDataSubscribers.clear();
+    mMeasurementsSubscribers.clear();
+
+    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
+        LocationCallbacks& callbacks = it->second;
+        if (nullptr != callbacks.gnssLocationInfoCb) {
+            mLocationInfoSubscribers.push_back(callbacks.gnssLocationInfoCb);
+        } else if (nullptr != callbacks.engineLocationsInfoCb ||
+                   nullptr != callbacks.trackingCb) {
+            PositionSubscriber subscriber = {callbacks.engineLocationsInfoCb,
+                                             callbacks.trackingCb};
+            if (isFlpClient(callbacks)) {
+                mFlpPositionSubscribers.push_back(subscriber);
+            } else {
+                mGnssPositionSubscribers.push_back(subscriber);
+            }
+        }
+        if (nullptr != callbacks.engineLocationsInfoCb) {
+            mEngineLocationsSubscribers.push_back(callbacks.engineLocationsInfoCb);
+        }
+        if (nullptr != callbacks.gnssSvCb) {
+            mSvSubscribers.push_back(callbacks.gnssSvCb);
+        }
+        if (nullptr != callbacks.gnssNmeaCb) {
+            mNmeaSubscribers.push_back(callbacks.gnssNmeaCb);
+        }
+        if (nullptr != callbacks.gnssDataCb) {
+            mDataSubscribers.push_back(callbacks.gnssDataCb);
+        }
+        if (nullptr != callbacks.gnssMeasurementsCb) {
+            mMeasurementsSubscribers.push_back(callbacks.gnssMeasurementsCb);
+        }
+    }
+}
+
 void
 GnssAdapter::updateClientsEventMask()
 {
     LOC_API_ADAPTER_EVENT_MASK_T mask = 0;
+
+    // saveClient() and eraseClient() land here, keep the subscribers in sync
+    updateClientSubscribers();
     for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
         if (it->second.trackingCb != nullptr ||
             it->second.gnssLocationInfoCb != nullptr ||
@@ -3623,8 +3697,8 @@ GnssAdapter::reportPositionEvent(const UlpLocation& ulpLocation,
         }
     };
 
-    sendMsg(new MsgReportPosition(*this, ulpLocation, locationExtended,
-                                  status, techMask));
+    sendLatestMsg(new MsgReportPosition(*this, ulpLocation, locationExtended,
+                                        status, techMask), mPositionReportSlot);
 }
 
 void
@@ -3653,7 +3727,7 @@ GnssAdapter::reportEnginePositionsEvent(unsigned int count,
         }
     };
 
-    sendMsg(new MsgReportEnginePositions(*this, count, locationArr));
+    sendMsg(new MsgReportEnginePositions(*this, count, locationArr), LOC_MSG_PRIORITY_REPORT);
 }
 
 bool
@@ -3700,7 +3774,8 @@ bool GnssAdapter::needToGenerateNmeaReport(const uint32_t &gpsTimeOfWeekMs,
     bool retVal = false;
     uint64_t currentTimeNsec = 0;
 
-    if (NMEA_PROVIDER_AP == ContextBase::mGps_conf.NMEA_PROVIDER && !mTimeBasedTrackingSessions.empty()) {
+    if (NMEA_PROVIDER_AP == ContextBase::getGpsConf().NMEA_PROVIDER &&
+            !mTimeBasedTrackingSessions.empty()) {
         currentTimeNsec = (apTimeStamp.tv_sec * BILLION_NSEC + apTimeStamp.tv_nsec);
         if ((GNSS_NMEA_REPORT_RATE_NHZ == ContextBase::sNmeaReportRate) ||
                 (GPS_DEFAULT_FIX_INTERVAL_MS <= mLocPositionMode.min_interval)) {
@@ -3743,24 +3818,37 @@ GnssAdapter::reportPosition(const UlpLocation& ulpLocation,
         convertLocationInfo(locationInfo, locationExtended);
         convertLocation(locationInfo.location, ulpLocation, locationExtended, techMask);
 
-        for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-            if ((reportToFlpClient && isFlpClient(it->second)) ||
-                    (reportToGnssClient && !isFlpClient(it->second))) {
-                if (nullptr != it->second.gnssLocationInfoCb) {
-                    it->second.gnssLocationInfoCb(locationInfo);
-                } else if ((nullptr != it->second.engineLocationsInfoCb) &&
-                        (false == initEngHubProxy())) {
-                    // if engine hub is disabled, this is SPE fix from modem
-                    // we need to mark one copy marked as fused and one copy marked as PPE
-                    // and dispatch it to the engineLocationsInfoCb
-                    GnssLocationInfoNotification engLocationsInfo[2];
-                    engLocationsInfo[0] = locationInfo;
-                    engLocationsInfo[0].locOutputEngType = LOC_OUTPUT_ENGINE_FUSED;
-                    engLocationsInfo[0].flags |= GNSS_LOCATION_INFO_OUTPUT_ENG_TYPE_BIT;
-                    engLocationsInfo[1] = locationInfo;
-                    it->second.engineLocationsInfoCb(2, engLocationsInfo);
-                } else if (nullptr != it->second.trackingCb) {
-                    it->second.trackingCb(locationInfo.location);
+        if (reportToGnssClient) {
+            for (auto& gnssLocationInfoCb : mLocationInfoSubscribers) {
+                gnssLocationInfoCb(locationInfo);
+            }
+        }
+
+        const std::vector<PositionSubscriber>* subscriberLists[] = {
+            reportToGnssClient ? &mGnssPositionSubscribers : nullptr,
+            reportToFlpClient ? &mFlpPositionSubscribers : nullptr
+        };
+        // if engine hub is disabled, this is SPE fix from modem
+        // we need to mark one copy marked as fused and one copy marked as PPE
+        // and dispatch it to the engineLocationsInfoCb
+        bool reportEngineLocations =
+                !mEngineLocationsSubscribers.empty() && (false == initEngHubProxy());
+        GnssLocationInfoNotification engLocationsInfo[2];
+        if (reportEngineLocations) {
+            engLocationsInfo[0] = locationInfo;
+            engLocationsInfo[0].locOutputEngType = LOC_OUTPUT_ENGINE_FUSED;
+            engLocationsInfo[0].flags |= GNSS_LOCATION_INFO_OUTPUT_ENG_TYPE_BIT;
+            engLocationsInfo[1] = locationInfo;
+        }
+        for (auto subscribers : subscriberLists) {
+            if (nullptr == subscribers) {
+                continue;
+            }
+            for (auto& subscriber : *subscribers) {
+                if ((nullptr != subscriber.engineLocationsInfoCb) && reportEngineLocations) {
+                    subscriber.engineLocationsInfoCb(2, engLocationsInfo);
+                } else if (nullptr != subscriber.trackingCb) {
+                    subscriber.trackingCb(locationInfo.location);
                 }
             }
         }
@@ -3801,22 +3889,20 @@ GnssAdapter::reportPosition(const UlpLocation& ulpLocation,
                           (0 == ulpLocation.gpsLocation.longitude) &&
                           (LOC_RELIABILITY_NOT_SET == locationExtended.horizontal_reliability));
         uint8_t generate_nmea = (reportToGnssClient && status != LOC_SESS_FAILURE && !blank_fix);
-        bool custom_nmea_gga = (1 == ContextBase::mGps_conf.CUSTOM_NMEA_GGA_FIX_QUALITY_ENABLED);
-        std::vector<std::string> nmeaArraystr;
-        int indexOfGGA = -1;
+        bool custom_nmea_gga = (1 == ContextBase::getGpsConf().CUSTOM_NMEA_GGA_FIX_QUALITY_ENABLED);
+        char nmea[NMEA_BUFFER_MAX_LENGTH];
+        LocNmeaBuffer nmeaBuffer;
+        loc_nmea_buffer_init(nmeaBuffer, nmea, sizeof(nmea));
         loc_nmea_generate_pos(ulpLocation, locationExtended, mLocSystemInfo,
-                              generate_nmea, custom_nmea_gga, nmeaArraystr, indexOfGGA);
-        stringstream ss;
-        for (auto itor = nmeaArraystr.begin(); itor != nmeaArraystr.end(); ++itor) {
-            ss << *itor;
-        }
-        string s = ss.str();
-        reportNmea(s.c_str(), s.length());
+                              generate_nmea, custom_nmea_gga, nmeaBuffer);
+        reportNmea(nmeaBuffer.buf, nmeaBuffer.length);
 
         /* DgnssNtrip */
-        if (-1 != indexOfGGA && isDgnssNmeaRequired()) {
+        if (-1 != nmeaBuffer.indexOfGGA && isDgnssNmeaRequired()) {
             mDgnssState |= DGNSS_STATE_NO_NMEA_PENDING;
-            mStartDgnssNtripParams.nmea = std::move(nmeaArraystr[indexOfGGA]);
+            mStartDgnssNtripParams.nmea.assign(
+                    nmeaBuffer.buf + nmeaBuffer.offsets[nmeaBuffer.indexOfGGA],
+                    loc_nmea_sentence_length(nmeaBuffer, nmeaBuffer.indexOfGGA));
             bool isLocationValid = (0 != ulpLocation.gpsLocation.latitude) ||
                     (0 != ulpLocation.gpsLocation.longitude);
             checkUpdateDgnssNtrip(isLocationValid);
@@ -3828,13 +3914,7 @@ void
 GnssAdapter::reportEnginePositions(unsigned int count,
                                    const EngineLocationInfo* locationArr)
 {
-    bool needReportEnginePositions = false;
-    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.engineLocationsInfoCb) {
-            needReportEnginePositions = true;
-            break;
-        }
-    }
+    bool needReportEnginePositions = !mEngineLocationsSubscribers.empty();
 
     GnssLocationInfoNotification locationInfo[LOC_OUTPUT_ENGINE_COUNT] = {};
     for (unsigned int i = 0; i < count; i++) {
@@ -3857,12 +3937,8 @@ GnssAdapter::reportEnginePositions(unsigned int count,
         }
     }
 
-    if (needReportEnginePositions) {
-        for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-            if (nullptr != it->second.engineLocationsInfoCb) {
-                it->second.engineLocationsInfoCb(count, locationInfo);
-            }
-        }
+    for (auto& engineLocationsInfoCb : mEngineLocationsSubscribers) {
+        engineLocationsInfoCb(count, locationInfo);
     }
 }
 
@@ -3890,7 +3966,7 @@ GnssAdapter::reportSvEvent(const GnssSvNotification& svNotify,
         }
     };
 
-    sendMsg(new MsgReportSv(*this, svNotify));
+    sendLatestMsg(new MsgReportSv(*this, svNotify), mSvReportSlot);
 }
 
 void
@@ -4032,22 +4108,17 @@ GnssAdapter::reportSv(GnssSvNotification& svNotify)
         }
     }
 
-    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.gnssSvCb) {
-            it->second.gnssSvCb(svNotify);
-        }
+    for (auto& gnssSvCb : mSvSubscribers) {
+        gnssSvCb(svNotify);
     }
 
-    if (NMEA_PROVIDER_AP == ContextBase::mGps_conf.NMEA_PROVIDER &&
+    if (NMEA_PROVIDER_AP == ContextBase::getGpsConf().NMEA_PROVIDER &&
         !mTimeBasedTrackingSessions.empty()) {
-        std::vector<std::string> nmeaArraystr;
-        loc_nmea_generate_sv(svNotify, nmeaArraystr);
-        stringstream ss;
-        for (auto itor = nmeaArraystr.begin(); itor != nmeaArraystr.end(); ++itor) {
-            ss << *itor;
-        }
-        string s = ss.str();
-        reportNmea(s.c_str(), s.length());
+        char nmea[NMEA_BUFFER_MAX_LENGTH];
+        LocNmeaBuffer nmeaBuffer;
+        loc_nmea_buffer_init(nmeaBuffer, nmea, sizeof(nmea));
+        loc_nmea_generate_sv(svNotify, nmeaBuffer);
+        reportNmea(nmeaBuffer.buf, nmeaBuffer.length);
     }
 
     mGnssSvIdUsedInPosAvail = false;
@@ -4056,7 +4127,7 @@ GnssAdapter::reportSv(GnssSvNotification& svNotify)
 void
 GnssAdapter::reportNmeaEvent(const char* nmea, size_t length)
 {
-    if (NMEA_PROVIDER_AP == ContextBase::mGps_conf.NMEA_PROVIDER &&
+    if (NMEA_PROVIDER_AP == ContextBase::getGpsConf().NMEA_PROVIDER &&
         !loc_nmea_is_debug(nmea, length)) {
         return;
     }
@@ -4070,7 +4141,7 @@ GnssAdapter::reportNmeaEvent(const char* nmea, size_t length)
                              size_t length) :
             LocMsg(),
             mAdapter(adapter),
-            mNmea(new char[length+1]),
+            mNmea(LocMsgPool::allocArray<char>(length+1)),
             mLength(length) {
                 if (mNmea == nullptr) {
                     LOC_LOGE("%s] new allocation failed, fatal error.", __func__);
@@ -4080,7 +4151,7 @@ GnssAdapter::reportNmeaEvent(const char* nmea, size_t length)
             }
         inline virtual ~MsgReportNmea()
         {
-            delete[] mNmea;
+            LocMsgPool::freeArray(mNmea);
         }
         inline virtual void proc() const {
             // extract bug report info - this returns true if consumed by systemstatus
@@ -4098,7 +4169,7 @@ GnssAdapter::reportNmeaEvent(const char* nmea, size_t length)
         }
     };
 
-    sendMsg(new MsgReportNmea(*this, nmea, length));
+    sendMsg(new MsgReportNmea(*this, nmea, length), LOC_MSG_PRIORITY_REPORT);
 }
 
 void
@@ -4114,10 +4185,8 @@ GnssAdapter::reportNmea(const char* nmea, size_t length)
     nmeaNotification.nmea = nmea;
     nmeaNotification.length = length;
 
-    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.gnssNmeaCb) {
-            it->second.gnssNmeaCb(nmeaNotification);
-        }
+    for (auto& gnssNmeaCb : mNmeaSubscribers) {
+        gnssNmeaCb(nmeaNotification);
     }
 
     if (isNMEAPrintEnabled()) {
@@ -4150,7 +4219,7 @@ GnssAdapter::reportDataEvent(const GnssDataNotification& dataNotify,
         }
     };
 
-    sendMsg(new MsgReportData(*this, dataNotify, msInWeek));
+    sendMsg(new MsgReportData(*this, dataNotify, msInWeek), LOC_MSG_PRIORITY_REPORT);
 }
 
 void
@@ -4166,10 +4235,8 @@ GnssAdapter::reportData(GnssDataNotification& dataNotify)
             LOC_LOGv("agc[%d]=%f", sig, dataNotify.agc[sig]);
         }
     }
-    for (auto it = mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.gnssDataCb) {
-            it->second.gnssDataCb(dataNotify);
-        }
+    for (auto& gnssDataCb : mDataSubscribers) {
+        gnssDataCb(dataNotify);
     }
 }
 
@@ -4461,24 +4528,32 @@ GnssAdapter::reportGnssMeasurementsEvent(const GnssMeasurements& gnssMeasurement
     if (0 != gnssMeasurements.gnssMeasNotification.count) {
         struct MsgReportGnssMeasurementData : public LocMsg {
             GnssAdapter& mAdapter;
-            GnssMeasurements mGnssMeasurements;
-            GnssMeasurementsNotification mMeasurementsNotify;
+            std::shared_ptr<const GnssMeasurementsEpoch> mEpoch;
             inline MsgReportGnssMeasurementData(GnssAdapter& adapter,
                                                 const GnssMeasurements& gnssMeasurements,
                                                 int msInWeek) :
                     LocMsg(),
-                    mAdapter(adapter),
-                    mMeasurementsNotify(gnssMeasurements.gnssMeasNotification) {
+                    mAdapter(adapter) {
+                std::shared_ptr<GnssMeasurementsEpoch> epoch =
+                        GnssMeasurementsEpoch::create(gnssMeasurements.gnssMeasNotification);
+                if (nullptr == epoch) {
+                    LOC_LOGE("%s] new allocation failed, fatal error.", __func__);
+                    return;
+                }
                 if (-1 != msInWeek) {
-                    mAdapter.getAgcInformation(mMeasurementsNotify, msInWeek);
+                    mAdapter.getAgcInformation(epoch->measurements, epoch->count, msInWeek);
                 }
+                mEpoch = epoch;
             }
             inline virtual void proc() const {
-                mAdapter.reportGnssMeasurementData(mMeasurementsNotify);
+                if (nullptr != mEpoch) {
+                    mAdapter.reportGnssMeasurementData(*mEpoch);
+                }
             }
         };
 
-        sendMsg(new MsgReportGnssMeasurementData(*this, gnssMeasurements, msInWeek));
+        sendMsg(new MsgReportGnssMeasurementData(*this, gnssMeasurements, msInWeek),
+                LOC_MSG_PRIORITY_REPORT);
     }
     mEngHubProxy->gnssReportSvMeasurement(gnssMeasurements.gnssSvMeasurementSet);
     if (mDGnssNeedReport) {
@@ -4486,12 +4561,44 @@ GnssAdapter::reportGnssMeasurementsEvent(const GnssMeasurements& gnssMeasurement
     }
 }
 
+std::shared_ptr<GnssMeasurementsEpoch>
+GnssMeasurementsEpoch::create(const GnssMeasurementsNotification& in)
+{
+    uint32_t count = (in.count < GNSS_MEASUREMENTS_MAX) ? in.count : GNSS_MEASUREMENTS_MAX;
+    GnssMeasurementsEpoch* epoch = (GnssMeasurementsEpoch*)LocMsgPool::alloc(
+            offsetof(GnssMeasurementsEpoch, measurements) +
+            count * sizeof(GnssMeasurementsData), true);
+    if (nullptr == epoch) {
+        return nullptr;
+    }
+    epoch->size = in.size;
+    epoch->count = count;
+    epoch->clock = in.clock;
+    memcpy(epoch->measurements, in.measurements, count * sizeof(GnssMeasurementsData));
+    return std::shared_ptr<GnssMeasurementsEpoch>(epoch, LocMsgPool::freeArray);
+}
+
 void
-GnssAdapter::reportGnssMeasurementData(const GnssMeasurementsNotification& measurements)
+GnssMeasurementsEpoch::toNotification(GnssMeasurementsNotification& out) const
 {
-    for (auto it=mClientData.begin(); it != mClientData.end(); ++it) {
-        if (nullptr != it->second.gnssMeasurementsCb) {
-            it->second.gnssMeasurementsCb(measurements);
+    out.size = size;
+    out.count = count;
+    memcpy(out.measurements, measurements, count * sizeof(GnssMeasurementsData));
+    memset(out.measurements + count, 0,
+           (GNSS_MEASUREMENTS_MAX - count) * sizeof(GnssMeasurementsData));
+    out.clock = clock;
+}
+
+void
+GnssAdapter::reportGnssMeasurementData(const GnssMeasurementsEpoch& epoch)
+{
+    if (!mMeasurementsSubscribers.empty()) {
+        // the callbacks take the notification by value, so it is built
+        // once per epoch and that one copy is handed to every client
+        GnssMeasurementsNotification measurements;
+        epoch.toNotification(measurements);
+        for (auto& gnssMeasurementsCb : mMeasurementsSubscribers) {
+            gnssMeasurementsCb(measurements);
         }
     }
 }
@@ -5191,8 +5298,14 @@ bool GnssAdapter::getDebugReport(GnssDebugReport& r)
         return false;
     }
 
+    // only the reports used below and by convertSatelliteInfo()
     SystemStatusReports reports = {};
-    systemstatus->getReport(reports, true);
+    systemstatus->getLatestReport(reports.mLocation);
+    systemstatus->getLatestReport(reports.mBestPosition);
+    systemstatus->getLatestReport(reports.mTimeAndClock);
+    systemstatus->getLatestReport(reports.mXtra);
+    systemstatus->getLatestReport(reports.mSvHealth);
+    systemstatus->getLatestReport(reports.mNavData);
 
     r.size = sizeof(r);
 
@@ -5293,45 +5406,47 @@ bool GnssAdapter::getDebugReport(GnssDebugReport& r)
 
 /* get AGC information from system status and fill it */
 void
-GnssAdapter::getAgcInformation(GnssMeasurementsNotification& measurements, int msInWeek)
+GnssAdapter::getAgcInformation(GnssMeasurementsData* measurements, uint32_t count,
+                               int msInWeek)
 {
     SystemStatus* systemstatus = getSystemStatus();
 
     if (nullptr != systemstatus) {
         SystemStatusReports reports = {};
-        systemstatus->getReport(reports, true);
+        systemstatus->getLatestReport(reports.mRfAndParams);
+        systemstatus->getLatestReport(reports.mTimeAndClock);
 
         if ((!reports.mRfAndParams.empty()) && (!reports.mTimeAndClock.empty()) &&
             (abs(msInWeek - (int)reports.mTimeAndClock.back().mGpsTowMs) < 2000)) {
 
-            for (size_t i = 0; i < measurements.count; i++) {
-                switch (measurements.measurements[i].svType) {
+            for (size_t i = 0; i < count; i++) {
+                switch (measurements[i].svType) {
                 case GNSS_SV_TYPE_GPS:
                 case GNSS_SV_TYPE_QZSS:
-                    measurements.measurements[i].agcLevelDb =
+                    measurements[i].agcLevelDb =
                             reports.mRfAndParams.back().mAgcGps;
-                    measurements.measurements[i].flags |=
+                    measurements[i].flags |=
                             GNSS_MEASUREMENTS_DATA_AUTOMATIC_GAIN_CONTROL_BIT;
                     break;
 
                 case GNSS_SV_TYPE_GALILEO:
-                    measurements.measurements[i].agcLevelDb =
+                    measurements[i].agcLevelDb =
                             reports.mRfAndParams.back().mAgcGal;
-                    measurements.measurements[i].flags |=
+                    measurements[i].flags |=
                             GNSS_MEASUREMENTS_DATA_AUTOMATIC_GAIN_CONTROL_BIT;
                     break;
 
                 case GNSS_SV_TYPE_GLONASS:
-                    measurements.measurements[i].agcLevelDb =
+                    measurements[i].agcLevelDb =
                             reports.mRfAndParams.back().mAgcGlo;
-                    measurements.measurements[i].flags |=
+                    measurements[i].flags |=
                             GNSS_MEASUREMENTS_DATA_AUTOMATIC_GAIN_CONTROL_BIT;
                     break;
 
                 case GNSS_SV_TYPE_BEIDOU:
-                    measurements.measurements[i].agcLevelDb =
+                    measurements[i].agcLevelDb =
                             reports.mRfAndParams.back().mAgcBds;
-                    measurements.measurements[i].flags |=
+                    measurements[i].flags |=
                             GNSS_MEASUREMENTS_DATA_AUTOMATIC_GAIN_CONTROL_BIT;
                     break;
 
@@ -5354,7 +5469,8 @@ GnssAdapter::getDataInformation(GnssDataNotification& data, int msInWeek)
     LOC_LOGV("%s]: msInWeek=%d", __func__, msInWeek);
     if (nullptr != systemstatus) {
         SystemStatusReports reports = {};
-        systemstatus->getReport(reports, true);
+        systemstatus->getLatestReport(reports.mRfAndParams);
+        systemstatus->getLatestReport(reports.mTimeAndClock);
 
         if ((!reports.mRfAndParams.empty()) && (!reports.mTimeAndClock.empty()) &&
             (abs(msInWeek - (int)reports.mTimeAndClock.back().mGpsTowMs) < 2000)) {
@@ -38,7 +38,9 @@
 #include <SystemStatus.h>
 #include <XtraSystemStatusObserver.h>
 #include <map>
+#include <vector>
 #include <functional>
+#include <memory>
 
 #define MAX_URL_LEN 256
 #define NMEA_SENTENCE_MAX_LENGTH 200
@@ -158,6 +160,20 @@ typedef std::function<void(
     uint64_t gnssEnergyConsumedFromFirstBoot
 )> GnssEnergyConsumedCallback;
 
+/* One GNSS measurement epoch holding only the count measurements it uses.
+   Allocated from LocMsgPool and ref counted, so whoever holds on to the
+   epoch shares the one buffer instead of copying it. */
+struct GnssMeasurementsEpoch {
+    uint32_t size;
+    uint32_t count;
+    GnssMeasurementsClock clock;
+    GnssMeasurementsData measurements[1];  // count entries
+    static std::shared_ptr<GnssMeasurementsEpoch> create(
+            const GnssMeasurementsNotification& in);
+    // fills in the full notification, zeroing the unused measurements
+    void toNotification(GnssMeasurementsNotification& out) const;
+};
+
 typedef void* QDgnssListenerHDL;
 typedef std::function<void(
     bool    sessionActive
@@ -195,6 +211,28 @@ class GnssAdapter : public LocAdapterBase {
     GnssSvMbUsedInPosition mGnssMbSvIdUsedInPosition;
     bool mGnssMbSvIdUsedInPosAvail;
 
+    // latest wins: a newer report replaces the one still queued
+    LocMsgLatestSlot mPositionReportSlot;
+    LocMsgLatestSlot mSvReportSlot;
+
+    /* ==== SUBSCRIBERS ==================================================================== */
+    // callbacks of mClientData grouped per report kind, rebuilt by
+    // updateClientSubscribers() whenever clients or their callbacks change
+    struct PositionSubscriber {
+        engineLocationsInfoCallback engineLocationsInfoCb;
+        trackingCallback trackingCb;
+    };
+    std::vector<gnssLocationInfoCallback> mLocationInfoSubscribers;
+    // GNSS clients without gnssLocationInfoCb and FLP clients, see isFlpClient()
+    std::vector<PositionSubscriber> mGnssPositionSubscribers;
+    std::vector<PositionSubscriber> mFlpPositionSubscribers;
+    std::vector<engineLocationsInfoCallback> mEngineLocationsSubscribers;
+    std::vector<gnssSvCallback> mSvSubscribers;
+    std::vector<gnssNmeaCallback> mNmeaSubscribers;
+    std::vector<gnssDataCallback> mDataSubscribers;
+    std::vector<gnssMeasurementsCallback> mMeasurementsSubscribers;
+    void updateClientSubscribers();
+
     /* ==== CONTROL ======================================================================== */
     LocationControlCallbacks mControlCallbacks;
     uint32_t mAfwControlId;
@@ -299,6 +337,16 @@ public:
     GnssAdapter();
     virtual inline ~GnssAdapter() { }
 
+    /* ==== STATS ========================================================================== */
+    // number of position / sv reports dropped because a newer one superseded
+    // them while they were still queued
+    inline uint64_t getCoalescedPositionReports() const {
+        return mPositionReportSlot.getCoalescedCount();
+    }
+    inline uint64_t getCoalescedSvReports() const {
+        return mSvReportSlot.getCoalescedCount();
+    }
+
     /* ==== SSR ============================================================================ */
     /* ======== EVENTS ====(Called from QMI Thread)========================================= */
     virtual void handleEngineUpEvent();
@@ -407,6 +455,8 @@ public:
     inline GnssSvTypeConfigCallback gnssGetSvTypeConfigCallback()
     { return mGnssSvTypeConfigCb; }
     void setConfig();
+    void handleGpsConfChange(const loc_gps_cfg_s_type& oldConf,
+                             const loc_gps_cfg_s_type& newConf);
     void gnssSecondaryBandConfigUpdate(LocApiResponse* locApiResponse= nullptr);
 
     /* ========= AGPS ====================================================================== */
@@ -510,7 +560,7 @@ public:
     void reportData(GnssDataNotification& dataNotify);
     bool requestNiNotify(const GnssNiNotification& notify, const void* data,
                          const bool bInformNiAccept);
-    void reportGnssMeasurementData(const GnssMeasurementsNotification& measurements);
+    void reportGnssMeasurementData(const GnssMeasurementsEpoch& epoch);
     void reportGnssSvIdConfig(const GnssSvIdConfig& config);
     void reportGnssSvTypeConfig(const GnssSvTypeConfig& config);
     void reportGnssConfig(uint32_t sessionId, const GnssConfig& gnssConfig);
@@ -540,7 +590,8 @@ public:
     /*======== GNSSDEBUG ================================================================*/
     bool getDebugReport(GnssDebugReport& report);
     /* get AGC information from system status and fill it */
-    void getAgcInformation(GnssMeasurementsNotification& measurements, int msInWeek);
+    void getAgcInformation(GnssMeasurementsData* measurements, uint32_t count,
+                           int msInWeek);
     /* get Data information from system status and fill it */
     void getDataInformation(GnssDataNotification& data, int msInWeek);
 
@@ -595,7 +646,7 @@ public:
     /*==== DGnss Usable Report Flag ====================================================*/
     inline void setDGnssUsableFLag(bool dGnssNeedReport) { mDGnssNeedReport = dGnssNeedReport;}
     inline bool isNMEAPrintEnabled() {
-       return ((mContext != NULL) && (0 != mContext->mGps_conf.ENABLE_NMEA_PRINT));
+       return ((mContext != NULL) && (0 != ContextBase::getGpsConf().ENABLE_NMEA_PRINT));
     }
 
     /*==== DGnss Ntrip Source ==========================================================*/
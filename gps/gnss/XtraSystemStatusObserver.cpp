@@ -112,10 +112,9 @@ XtraSystemStatusObserver::XtraSystemStatusObserver(IOsObserver* sysStatObs,
         mSender(LocIpc::getLocIpcLocalSender(LOC_IPC_XTRA)),
         mDelayLocTimer(*mSender) {
     subscribe(true);
-    auto recver = LocIpc::getLocIpcLocalRecver(
-            make_shared<XtraIpcListener>(sysStatObs, msgTask, *this),
-            LOC_IPC_HAL);
-    mIpc.startNonBlockingListening(recver);
+    mIpcReactor.addLocalRecver(make_shared<XtraIpcListener>(sysStatObs, msgTask, *this),
+                               LOC_IPC_HAL);
+    mIpcReactor.start("LocIpc-XtraObs");
     mDelayLocTimer.start(100 /*.1 sec*/,  false);
 }
 
@@ -380,5 +379,6 @@ void XtraSystemStatusObserver::notify(const list<IDataItemCore*>& dlist)
             }
         }
     };
-    mMsgTask->sendMsg(new (nothrow) HandleOsObserverUpdateMsg(this, dlist));
+    mMsgTask->sendMsg(new (nothrow) HandleOsObserverUpdateMsg(this, dlist),
+                      LOC_MSG_PRIORITY_BACKGROUND);
 }
@@ -63,7 +63,7 @@ public :
     XtraSystemStatusObserver(IOsObserver* sysStatObs, const MsgTask* msgTask);
     inline virtual ~XtraSystemStatusObserver() {
         subscribe(false);
-        mIpc.stopNonBlockingListening();
+        mIpcReactor.stop();
     }
 
     // IDataItemObserver overrides
@@ -88,7 +88,7 @@ private:
     IOsObserver*    mSystemStatusObsrvr;
     const MsgTask* mMsgTask;
     GnssConfigGpsLock mGpsLock;
-    LocIpc mIpc;
+    LocIpcReactor mIpcReactor;
     uint64_t mConnections;
     loc_core::NetworkInfoType mNetworkHandle[MAX_NETWORK_HANDLES];
     string mTac;
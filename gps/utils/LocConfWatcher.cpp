@@ -0,0 +1,155 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#define LOG_TAG "LocSvc_ConfWatcher"
+
+#include <LocConfWatcher.h>
+#include <log_util.h>
+#include <unistd.h>
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <sys/inotify.h>
+
+// an edit is taken as settled once the dir is quiet for this long
+#define LOC_CONF_WATCHER_SETTLE_MS 200
+#define LOC_CONF_WATCHER_MASK (IN_CLOSE_WRITE | IN_MOVED_TO)
+
+namespace loc_util {
+
+class LocConfWatcherRunnable : public LocRunnable {
+    LocConfWatcher& mWatcher;
+public:
+    inline LocConfWatcherRunnable(LocConfWatcher& watcher) : mWatcher(watcher) {}
+    inline virtual bool run() override {
+        return mWatcher.waitAndNotify();
+    }
+};
+
+LocConfWatcher& LocConfWatcher::getInstance() {
+    // never deleted, the thread runs for the life of the process
+    static LocConfWatcher* instance = new LocConfWatcher();
+    return *instance;
+}
+
+LocConfWatcher::LocConfWatcher() :
+        mInotifyFd(inotify_init1(IN_CLOEXEC)) {
+    if (mInotifyFd < 0) {
+        LOC_LOGe("inotify_init1 failed: %s", strerror(errno));
+    }
+}
+
+bool LocConfWatcher::watch(const char* confFile, const Listener& listener) {
+    if (mInotifyFd < 0 || nullptr == confFile || nullptr == listener) {
+        return false;
+    }
+    // the dir is watched, as files replaced by rename take a new inode
+    std::string path(confFile);
+    size_t slash = path.rfind('/');
+    Entry entry;
+    entry.dir = (std::string::npos == slash) ? "." : path.substr(0, slash + 1);
+    entry.name = (std::string::npos == slash) ? path : path.substr(slash + 1);
+    entry.path = path;
+    entry.listener = listener;
+    entry.wd = inotify_add_watch(mInotifyFd, entry.dir.c_str(), LOC_CONF_WATCHER_MASK);
+    if (entry.wd < 0) {
+        LOC_LOGe("failed to watch %s: %s", entry.dir.c_str(), strerror(errno));
+        return false;
+    }
+
+    std::lock_guard<std::mutex> guard(mMutex);
+    mEntries.push_back(entry);
+    if (!mThread.isRunning() &&
+            !mThread.start("LocConfWatcher", new LocConfWatcherRunnable(*this), false)) {
+        LOC_LOGe("failed to start the watcher thread");
+        mEntries.pop_back();
+        return false;
+    }
+    LOC_LOGd("watching %s", confFile);
+    return true;
+}
+
+bool LocConfWatcher::waitAndNotify() {
+    // events are read whole, aligned as struct inotify_event needs
+    char buf[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+    std::vector<bool> changed;
+    int timeout = -1;
+    while (true) {
+        struct pollfd pfd = {mInotifyFd, POLLIN, 0};
+        int ready = poll(&pfd, 1, timeout);
+        if (ready < 0 && EINTR == errno) {
+            continue;
+        } else if (ready < 0) {
+            LOC_LOGe("poll failed: %s", strerror(errno));
+            return false;
+        } else if (0 == ready) {
+            // settled
+            break;
+        }
+        ssize_t len = read(mInotifyFd, buf, sizeof(buf));
+        if (len < 0 && (EINTR == errno || EAGAIN == errno)) {
+            continue;
+        } else if (len <= 0) {
+            LOC_LOGe("read failed: %s", strerror(errno));
+            return false;
+        }
+        std::lock_guard<std::mutex> guard(mMutex);
+        changed.resize(mEntries.size(), false);
+        for (char* p = buf; p < buf + len; ) {
+            struct inotify_event* event = (struct inotify_event*)p;
+            p += sizeof(struct inotify_event) + event->len;
+            if (0 == event->len) {
+                continue;
+            }
+            for (size_t i = 0; i < mEntries.size(); i++) {
+                if (mEntries[i].wd == event->wd && mEntries[i].name == event->name) {
+                    changed[i] = true;
+                    timeout = LOC_CONF_WATCHER_SETTLE_MS;
+                }
+            }
+        }
+    }
+
+    std::vector<Entry> toNotify;
+    {
+        std::lock_guard<std::mutex> guard(mMutex);
+        for (size_t i = 0; i < changed.size() && i < mEntries.size(); i++) {
+            if (changed[i]) {
+                toNotify.push_back(mEntries[i]);
+            }
+        }
+    }
+    for (auto& entry : toNotify) {
+        LOC_LOGi("%s changed", entry.path.c_str());
+        entry.listener(entry.path.c_str());
+    }
+    return true;
+}
+
+}
@@ -0,0 +1,78 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef LOC_CONF_WATCHER_H
+#define LOC_CONF_WATCHER_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <LocThread.h>
+
+namespace loc_util {
+
+class LocConfWatcherRunnable;
+
+// Watches conf files, e.g. gps.conf and its siblings, with inotify, and
+// tells the listeners of a file once it was written or replaced and has
+// settled. One thread for all the files of the process, started by the
+// first watch().
+class LocConfWatcher {
+public:
+    // runs on the watcher thread, with the path given to watch()
+    typedef std::function<void(const char* confFile)> Listener;
+
+    static LocConfWatcher& getInstance();
+    bool watch(const char* confFile, const Listener& listener);
+
+private:
+    friend class LocConfWatcherRunnable;
+    struct Entry {
+        int wd;
+        std::string dir;
+        std::string name;
+        std::string path;
+        Listener listener;
+    };
+
+    int mInotifyFd;
+    LocThread mThread;
+    std::mutex mMutex;
+    std::vector<Entry> mEntries;
+
+    LocConfWatcher();
+    ~LocConfWatcher() = delete;
+    // waits for changes, then runs the listeners of the changed files
+    bool waitAndNotify();
+};
+
+}
+
+#endif // LOC_CONF_WATCHER_H
@@ -28,250 +28,130 @@
  */
 #include <LocHeap.h>
 
-class LocHeapNode {
-    friend class LocHeap;
+// number of children per node. 4 keeps the heap shallow and the children
+// of a node in one cache line, at the price of more compares per level.
+#define LOC_HEAP_ARITY 4
+#define LOC_HEAP_MIN_CAPACITY 16
 
-    // size of of the subtree, excluding self, 1 if no subtree
-    int mSize;
-    LocHeapNode* mLeft;
-    LocHeapNode* mRight;
-    LocRankable* mData;
-public:
-    inline LocHeapNode(LocRankable& data) :
-        mSize(1), mLeft(NULL), mRight(NULL), mData(&data) {}
-    ~LocHeapNode();
-
-    // this only swaps the data of the two nodes, so no
-    // detach / re-attached is necessary
-    void swap(LocHeapNode& node);
-
-    LocRankable* detachData();
-
-    // push a node into the tree stucture, keeping sorted by rank
-    void push(LocHeapNode& node);
-
-    // pop the head node out of the tree stucture. keeping sorted by rank
-    static LocHeapNode* pop(LocHeapNode*& top);
-
-    // remove a specific node from the tree
-    // returns the pointer to the node removed, which would be either the
-    //         same as input (if successfully removed); or NULL (if failed).
-    static LocHeapNode* remove(LocHeapNode*& top, LocRankable& data);
-
-    // convenience method to compare data ranking
-    inline bool outRanks(LocHeapNode& node) { return mData->outRanks(*node.mData); }
-    inline bool outRanks(LocRankable& data) { return mData->outRanks(data); }
-
-    // checks if mSize is correct, AND this node is the highest ranking
-    // of the entire subtree
-    bool checkNodes();
-
-    inline int getSize() { return mSize; }
-};
-
-inline
-LocHeapNode::~LocHeapNode() {
-    if (mLeft) {
-        delete mLeft;
-        mLeft = NULL;
-    }
-    if (mRight) {
-        delete mRight;
-        mRight = NULL;
-    }
-    if (mData) {
-        mData = NULL;
+LocHeap::~LocHeap() {
+    for (uint32_t i = 0; i < mSize; i++) {
+        mNodes[i]->mHeapIndex = -1;
     }
+    delete[] mNodes;
 }
 
 inline
-void LocHeapNode::swap(LocHeapNode& node) {
-    LocRankable* tmpData = node.mData;
-    node.mData = mData;
-    mData = tmpData;
-}
-
-inline
-LocRankable* LocHeapNode::detachData()  {
-    LocRankable* data = mData;
-    mData = NULL;
-    return data;
-}
-
-// push keeps the tree sorted by rank, it also tries to balance the
-// tree by adding the new node to the smaller of the subtrees.
-// The pointer to the tree and internal links never change. If the
-// mData of tree top ranks lower than that of the incoming node,
-// mData will be swapped with that of the incoming node to ensure
-// ranking, no restructuring the container nodes.
-void LocHeapNode::push(LocHeapNode& node) {
-    // ensure the current node ranks higher than in the incoming one
-    if (node.outRanks(*this)) {
-        swap(node);
-    }
-
-    // now drop the new node (ensured lower than *this) into a subtree
-    if (NULL == mLeft) {
-        mLeft = &node;
-    } else if (NULL == mRight) {
-        mRight = &node;
-    } else if (mLeft->mSize <= mRight->mSize) {
-        mLeft->push(node);
-    } else {
-        mRight->push(node);
-    }
-    mSize++;
+void LocHeap::place(LocRankable& node, uint32_t index) {
+    mNodes[index] = &node;
+    node.mHeapIndex = (int)index;
 }
 
-// pop keeps the tree sorted by rank, but it does not try to balance
-// the tree. It recursively swaps with the higher ranked top of the
-// subtrees.
-// The return is a popped out node from leaf level, that has the data
-// swapped all the way down from the top. The pinter to the tree and
-// internal links will not be changed or restructured, except for the
-// node that is popped out.
-// If the return pointer == this, this the last node in the tree.
-LocHeapNode* LocHeapNode::pop(LocHeapNode*& top) {
-    // we know the top has the highest ranking at this point, else
-    // the tree is broken. This top will be popped out.  But we need
-    // a node from the left or right child, whichever ranks higher,
-    // to replace the current top. This then will need to be done
-    // recursively to the leaf level. So we swap the mData of the
-    // current top node all the way down to the leaf level.
-    LocHeapNode* poppedNode = top;
-    // top is losing a node in its subtree
-    top->mSize--;
-    if (top->mLeft || top->mRight) {
-        // if mLeft is NULL, mRight for sure is NOT NULL, take that;
-        // else if mRight is NULL, mLeft for sure is NOT, take that;
-        // else we take the address of whatever has higher ranking mData
-        LocHeapNode*& subTop = (NULL == top->mLeft) ? top->mRight :
-            ((NULL == top->mRight) ? top->mLeft :
-             (top->mLeft->outRanks(*(top->mRight)) ? top->mLeft : top->mRight));
-        // swap mData, the tree top gets updated with the new data.
-        top->swap(*subTop);
-        // pop out from the subtree
-        poppedNode = pop(subTop);
-    } else {
-        // if the top has only single node
-        // detach the poppedNode from the tree
-        // subTop is the reference of ether mLeft or mRight
-        // NOT a local stack pointer. so it MUST be NULL'ed here.
-        top = NULL;
+// move the node at index up until its parent outRanks it
+void LocHeap::siftUp(uint32_t index) {
+    LocRankable* node = mNodes[index];
+    while (index > 0) {
+        uint32_t parent = (index - 1) / LOC_HEAP_ARITY;
+        if (!node->outRanks(*mNodes[parent])) {
+            break;
+        }
+        place(*mNodes[parent], index);
+        index = parent;
     }
-
-    return poppedNode;
+    place(*node, index);
 }
 
-// navigating through the tree and find the node that hass the input
-// data. Since this is a heap, we do recursive linear search.
-// returns the pointer to the node removed, which would be either the
-//         same as input (if successfully removed); or NULL (if failed).
-LocHeapNode* LocHeapNode::remove(LocHeapNode*& top, LocRankable& data) {
-    LocHeapNode* removedNode = NULL;
-    // this is the node, by address
-    if (&data == (LocRankable*)(top->mData)) {
-        // pop this node out
-        removedNode = pop(top);
-    } else if (!data.outRanks(*top->mData)) {
-        // subtrees might have this node
-        if (top->mLeft) {
-            removedNode = remove(top->mLeft, data);
-        }
-        // if we did not find in mLeft, and mRight is not empty
-        if (!removedNode && top->mRight) {
-            removedNode = remove(top->mRight, data);
+// move the node at index down until it outRanks all its children
+void LocHeap::siftDown(uint32_t index) {
+    LocRankable* node = mNodes[index];
+    while (true) {
+        uint32_t first = index * LOC_HEAP_ARITY + 1;
+        if (first >= mSize) {
+            break;
         }
-
-        // top lost a node in its subtree
-        if (removedNode) {
-            top->mSize--;
+        uint32_t last = first + LOC_HEAP_ARITY;
+        if (last > mSize) {
+            last = mSize;
         }
-    }
-
-    return removedNode;
-}
-
-// checks if mSize is correct, AND this node is the highest ranking
-// of the entire subtree
-bool LocHeapNode::checkNodes() {
-    // size of the current subtree
-    int totalSize = mSize;
-    if (mLeft) {
-        // check the consistency of left subtree
-        if (mLeft->outRanks(*this) || !mLeft->checkNodes()) {
-            return false;
+        uint32_t top = first;
+        for (uint32_t child = first + 1; child < last; child++) {
+            if (mNodes[child]->outRanks(*mNodes[top])) {
+                top = child;
+            }
         }
-        // subtract the size of left subtree (with subtree head)
-        totalSize -= mLeft->mSize;
-    }
-
-    if (mRight) {
-        // check the consistency of right subtree
-        if (mRight->outRanks(*this) || !mRight->checkNodes()) {
-            return false;
+        if (!mNodes[top]->outRanks(*node)) {
+            break;
         }
-        // subtract the size of right subtree (with subtree head)
-        totalSize -= mRight->mSize;
-    }
-
-    // for the tree nodes to consistent, totalSize must be 1 now
-    return totalSize == 1;
-}
-
-LocHeap::~LocHeap() {
-    if (mTree) {
-        delete mTree;
+        place(*mNodes[top], index);
+        index = top;
     }
+    place(*node, index);
 }
 
 void LocHeap::push(LocRankable& node) {
-    LocHeapNode* heapNode = new LocHeapNode(node);
-    if (!mTree) {
-        mTree = heapNode;
-    } else {
-        mTree->push(*heapNode);
-    }
-}
-
-LocRankable* LocHeap::peek() {
-    LocRankable* top = NULL;
-    if (mTree) {
-        top = mTree->mData;
+    if (mSize == mCapacity) {
+        uint32_t capacity = (0 == mCapacity) ? LOC_HEAP_MIN_CAPACITY : (mCapacity << 1);
+        LocRankable** nodes = new LocRankable*[capacity];
+        if (mNodes) {
+            memcpy(nodes, mNodes, mSize * sizeof(LocRankable*));
+            delete[] mNodes;
+        }
+        mNodes = nodes;
+        mCapacity = capacity;
     }
-    return top;
+    place(node, mSize++);
+    siftUp(mSize - 1);
 }
 
 LocRankable* LocHeap::pop() {
     LocRankable* locNode = NULL;
-    if (mTree) {
-        // mTree may become NULL after this call
-        LocHeapNode* heapNode = LocHeapNode::pop(mTree);
-        locNode = heapNode->detachData();
-        delete heapNode;
+    if (mSize > 0) {
+        locNode = mNodes[0];
+        remove(*locNode);
     }
     return locNode;
 }
 
 LocRankable* LocHeap::remove(LocRankable& rankable) {
-    LocRankable* locNode = NULL;
-    if (mTree) {
-        // mTree may become NULL after this call
-        LocHeapNode* heapNode = LocHeapNode::remove(mTree, rankable);
-        if (heapNode) {
-            locNode = heapNode->detachData();
-            delete heapNode;
+    int index = rankable.mHeapIndex;
+    // this is the node, by address, or it is not in this heap
+    if (index < 0 || (uint32_t)index >= mSize || mNodes[index] != &rankable) {
+        return NULL;
+    }
+
+    rankable.mHeapIndex = -1;
+    mSize--;
+    if ((uint32_t)index != mSize) {
+        // fill the hole with the last node, which may need to go either way
+        place(*mNodes[mSize], index);
+        if (index > 0 &&
+                mNodes[index]->outRanks(*mNodes[(index - 1) / LOC_HEAP_ARITY])) {
+            siftUp(index);
+        } else {
+            siftDown(index);
         }
     }
-    return locNode;
+    return &rankable;
 }
 
+#if defined(__LOC_UNIT_TEST__) || defined(__LOC_DEBUG__)
+// checks if every node is in the place it thinks it is, AND no node
+// outRanks its parent
+static bool checkNodes(LocRankable** nodes, uint32_t size) {
+    for (uint32_t i = 1; i < size; i++) {
+        if (nodes[i]->outRanks(*nodes[(i - 1) / LOC_HEAP_ARITY])) {
+            return false;
+        }
+    }
+    return true;
+}
+#endif
+
 #ifdef __LOC_UNIT_TEST__
 bool LocHeap::checkTree() {
-    return ((NULL == mTree) || mTree->checkNodes());
+    return checkNodes(mNodes, mSize);
 }
 uint32_t LocHeap::getTreeSize() {
-    return (NULL == mTree) ? 0 : mTree->getSize();
+    return mSize;
 }
 #endif
 
@@ -284,11 +164,11 @@ uint32_t LocHeap::getTreeSize() {
 class LocHeapDebug : public LocHeap {
 public:
     bool checkTree() {
-        return ((NULL == mTree) || mTree->checkNodes());
+        return checkNodes(mNodes, mSize);
     }
 
     uint32_t getTreeSize() {
-        return (NULL == mTree) ? 0 : (mTree->getSize());
+        return mSize;
     }
 };
 
@@ -302,15 +182,65 @@ public:
     }
 };
 
+static double getDeltaNs(struct timespec& from, struct timespec& to) {
+    return (double)(to.tv_sec - from.tv_sec) * 1000000000 + (to.tv_nsec - from.tv_nsec);
+}
+
+// times push / remove / pop of n nodes, the way LocTimerContainer uses
+// the heap for timer start / stop / expire
+static void bench(int n, int rounds) {
+    LocHeapDebugData** data = new LocHeapDebugData*[n];
+    for (int i = 0; i < n; i++) {
+        data[i] = new LocHeapDebugData(rand());
+    }
+    double pushNs = 0, removeNs = 0, popNs = 0;
+    struct timespec t0, t1;
+    for (int r = 0; r < rounds; r++) {
+        LocHeapDebug heap;
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < n; i++) {
+            heap.push(*data[i]);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        pushNs += getDeltaNs(t0, t1);
+        // stop every other timer, in start order
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (int i = 0; i < n; i += 2) {
+            heap.remove(*data[i]);
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        removeNs += getDeltaNs(t0, t1);
+        // expire the rest
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        while (NULL != heap.pop()) {}
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+        popNs += getDeltaNs(t0, t1);
+    }
+    printf("%6d timers: push %7.1f ns, remove %7.1f ns, pop %7.1f ns\n", n,
+           pushNs / rounds / n, removeNs / rounds / ((n + 1) / 2), popNs / rounds / (n / 2));
+    for (int i = 0; i < n; i++) {
+        delete data[i];
+    }
+    delete[] data;
+}
+
 // For Linux command line testing:
 // compilation: g++ -D__LOC_HOST_DEBUG__ -D__LOC_DEBUG__ -g -I. -I../../../../vendor/qcom/proprietary/gps-internal/unit-tests/fakes_for_host -I../../../../system/core/include LocHeap.cpp
 // test: valgrind --leak-check=full ./a.out 100
+// benchmark (build with -O2): ./a.out bench
 int main(int argc, char** argv) {
     srand(time(NULL));
+    if (argc > 1 && 0 == strcmp(argv[1], "bench")) {
+        for (int n = 10; n <= 10000; n *= 10) {
+            bench(n, 100000 / n);
+        }
+        return 0;
+    }
     int tries = atoi(argv[1]);
     int checks = tries >> 3;
     LocHeapDebug heap;
     int treeSize = 0;
+    LocHeapDebugData** live = new LocHeapDebugData*[tries];
 
     for (int i = 0; i < tries; i++) {
         if (i % checks == 0 && !heap.checkTree()) {
@@ -321,17 +251,30 @@ int main(int argc, char** argv) {
         if (r & 1) {
             LocHeapDebugData* data = new LocHeapDebugData(r >> 1);
             heap.push(dynamic_cast<LocRankable&>(*data));
-            treeSize++;
-        } else {
+            live[treeSize++] = data;
+        } else if (r & 2) {
             LocRankable* rankable = heap.pop();
             if (rankable) {
+                for (int j = 0; j < treeSize; j++) {
+                    if (live[j] == rankable) {
+                        live[j] = live[--treeSize];
+                        break;
+                    }
+                }
                 delete rankable;
             }
-            treeSize ? treeSize-- : 0;
+        } else if (treeSize > 0) {
+            int j = (r >> 2) % treeSize;
+            if (heap.remove(*live[j]) != live[j]) {
+                printf("!!!!!!!!!!remove failed!!!!!!!\n");
+            }
+            delete live[j];
+            live[j] = live[--treeSize];
         }
 
-        printf("%s: %d == %d\n", (r&1)?"push":"pop", treeSize, heap.getTreeSize());
-        if (treeSize != heap.getTreeSize()) {
+        printf("%s: %d == %d\n", (r&1)?"push":((r&2)?"pop":"remove"),
+               treeSize, heap.getTreeSize());
+        if (treeSize != (int)heap.getTreeSize()) {
             printf("!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!\n");
             tries = i+1;
             break;
@@ -347,6 +290,7 @@ int main(int argc, char** argv) {
     for (LocRankable* data = heap.pop(); NULL != data; data = heap.pop()) {
         delete data;
     }
+    delete[] live;
 
     return 0;
 }
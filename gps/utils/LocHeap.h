@@ -31,10 +31,15 @@
 
 #include <stddef.h>
 #include <string.h>
+#include <stdint.h>
 
 // abstract class to be implemented by client to provide a rankable class
 class LocRankable {
+    // position in the LocHeap this obj is in, -1 if in none
+    int mHeapIndex;
+    friend class LocHeap;
 public:
+    inline LocRankable() : mHeapIndex(-1) {}
     virtual inline ~LocRankable() {}
 
     // method to rank objects of such type for sorting purposes.
@@ -48,45 +53,46 @@ public:
     inline bool outRanks(LocRankable& rankable) { return ranks(rankable) > 0; }
 };
 
-// opaque class to provide service implementation.
-class LocHeapNode;
-
-// a heap whose left and right children are not sorted. It is sorted only vertically,
-// i.e. parent always ranks higher than children, if they exist. Ranking algorithm is
-// implemented in Rankable. The reason that there is no sort between children is to
-// help beter balance the tree with lower cost. When a node is pushed to the tree,
-// it is guaranteed that the subtree that is smaller gets to have the new node.
+// A 4-ary heap kept in a flat array of LocRankable pointers. Parent always
+// ranks higher than its children, children are not sorted among themselves.
+// Each node remembers its position in the array, so remove() does not need
+// to search the heap for it. Ranking algorithm is implemented in Rankable.
+// A LocRankable obj can be in at most one LocHeap at a time.
 class LocHeap {
 protected:
-    LocHeapNode* mTree;
+    LocRankable** mNodes;
+    uint32_t mSize;
+    uint32_t mCapacity;
+
+    void place(LocRankable& node, uint32_t index);
+    void siftUp(uint32_t index);
+    void siftDown(uint32_t index);
 public:
-    inline LocHeap() : mTree(NULL) {}
+    inline LocHeap() : mNodes(NULL), mSize(0), mCapacity(0) {}
     ~LocHeap();
 
-    // push keeps the tree sorted by rank, it also tries to balance the
-    // tree by adding the new node to the smaller of the subtrees.
+    // push keeps the heap sorted by rank, O(log n).
     // node is reference to an obj that is managed by client, that client
     //      creates and destroyes. The destroy should happen after the
     //      node is popped out from the heap.
     void push(LocRankable& node);
 
-    // Peeks the node data on tree top, which has currently the highest ranking
-    // There is no change the tree structure with this operation
-    // Returns NULL if the tree is empty, otherwise pointer to the node data of
-    //         the tree top.
-    LocRankable* peek();
+    // Peeks the node data on heap top, which has currently the highest ranking
+    // There is no change the heap structure with this operation
+    // Returns NULL if the heap is empty, otherwise pointer to the node data of
+    //         the heap top.
+    inline LocRankable* peek() { return (0 == mSize) ? NULL : mNodes[0]; }
 
-    // pop keeps the tree sorted by rank, but it does not try to balance
-    // the tree.
+    // pop keeps the heap sorted by rank, O(log n).
     // Return - pointer to the node popped out, or NULL if heap is already empty
     LocRankable* pop();
 
-    // navigating through the tree and find the node that ranks the same
-    // as the input data, then remove it from the tree. Rank is implemented
-    // by rankable obj.
-    // returns the pointer to the node removed; or NULL (if failed).
+    // remove the input node, by address, from the heap, O(log n).
+    // returns the pointer to the node removed; or NULL (if not in this heap).
     LocRankable* remove(LocRankable& rankable);
 
+    inline uint32_t getSize() { return mSize; }
+
 #ifdef __LOC_UNIT_TEST__
     bool checkTree();
     uint32_t getTreeSize();
@@ -32,6 +32,19 @@
 #include <errno.h>
 #include <netinet/in.h>
 #include <netdb.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <time.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <limits.h>
+#ifndef MFD_CLOEXEC
+#define MFD_CLOEXEC 0x0001U
+#endif
 #include <loc_misc_utils.h>
 #include <log_util.h>
 #include <LocIpc.h>
@@ -68,12 +81,18 @@ ssize_t Sock::send(const void *buf, uint32_t len, int flags, const struct sockad
 }
 ssize_t Sock::recv(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb, int flags,
                    struct sockaddr *srcAddr, socklen_t *addrlen, int sid) const {
+    LocIpcRecvBuffer recvBuf(1);
+    return recv(recver, dataCb, recvBuf, flags, srcAddr, addrlen, sid);
+}
+ssize_t Sock::recv(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb,
+                   LocIpcRecvBuffer& recvBuf, int flags,
+                   struct sockaddr *srcAddr, socklen_t *addrlen, int sid) const {
     ssize_t rtv = -1;
     if (-1 == sid) {
         sid = mSid;
     } // else it sid would be connection based socket id for recv
     SOCK_OP_AND_LOG(dataCb.get(), mMaxTxSize, isValid(), rtv,
-                    recvfrom(recver, dataCb, sid, flags, srcAddr, addrlen));
+                    recvfrom(recver, dataCb, recvBuf, sid, flags, srcAddr, addrlen));
     return rtv;
 }
 ssize_t Sock::sendto(const void *buf, size_t len, int flags, const struct sockaddr *destAddr,
@@ -82,43 +101,119 @@ ssize_t Sock::sendto(const void *buf, size_t len, int flags, const struct sockad
     if (len <= mMaxTxSize) {
         rtv = ::sendto(mSid, buf, len, flags, destAddr, addrlen);
     } else {
-        std::string head(LOC_IPC_HEAD + to_string(len));
-        rtv = ::sendto(mSid, head.c_str(), head.length(), flags, destAddr, addrlen);
+        char head[sizeof(LOC_IPC_HEAD) + 24];
+        int headLen = snprintf(head, sizeof(head), "%s%zu", LOC_IPC_HEAD, len);
+        rtv = ::sendto(mSid, head, headLen, flags, destAddr, addrlen);
         if (rtv > 0) {
             for (size_t offset = 0; offset < len && rtv > 0; offset += rtv) {
                 rtv = ::sendto(mSid, (char*)buf + offset, min(len - offset, (size_t)mMaxTxSize),
                                flags, destAddr, addrlen);
             }
-            rtv = (rtv > 0) ? (head.length() + len) : -1;
+            rtv = (rtv > 0) ? (headLen + len) : -1;
         }
     }
     return rtv;
 }
-ssize_t Sock::recvfrom(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb,
-                       int sid, int flags, struct sockaddr *srcAddr, socklen_t *addrlen) const  {
-    std::string msg(mMaxTxSize, 0);
-    ssize_t nBytes = ::recvfrom(sid, (void*)msg.data(), msg.size(), flags, srcAddr, addrlen);
+void LocIpcRecvBuffer::prepare(uint32_t maxTxSize) {
+    if (mSlotSize < maxTxSize + 1) {
+        mSlotSize = maxTxSize + 1;
+        // no need to zero these, each msg gets a '\0' after its end
+        mSlots.reset(new char[(size_t)mSlotSize * mBatchSize]);
+        mMsgs.reset(new struct mmsghdr[mBatchSize]);
+        mIovs.reset(new struct iovec[mBatchSize]);
+        mAddrs.reset(new struct sockaddr_storage[mBatchSize]);
+        for (uint32_t i = 0; i < mBatchSize; i++) {
+            mIovs[i].iov_base = getSlot(i);
+            mIovs[i].iov_len = maxTxSize;
+        }
+    }
+    for (uint32_t i = 0; i < mBatchSize; i++) {
+        memset(&mMsgs[i].msg_hdr, 0, sizeof(mMsgs[i].msg_hdr));
+        mMsgs[i].msg_hdr.msg_iov = &mIovs[i];
+        mMsgs[i].msg_hdr.msg_iovlen = 1;
+        mMsgs[i].msg_hdr.msg_name = &mAddrs[i];
+        mMsgs[i].msg_hdr.msg_namelen = sizeof(mAddrs[i]);
+        mMsgs[i].msg_len = 0;
+    }
+}
+// Reassembles a long msg whose $MSGLEN$ head is passed in. Its chunks are
+// first taken from the datagrams of the batch after the head, from next
+// on, then read off the socket.
+ssize_t Sock::recvLongMsg(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb,
+                          LocIpcRecvBuffer& recvBuf, const char* head, uint32_t& next,
+                          uint32_t received, int sid, int flags) const {
+    size_t msgLen = 0;
+    sscanf(head + sizeof(LOC_IPC_HEAD) - 1, "%zu", &msgLen);
+    recvBuf.mLongMsg.resize(msgLen + 1);
+    char* msg = recvBuf.mLongMsg.data();
+    ssize_t nBytes = 1;
+    size_t msgLenReceived = 0;
+    for (; msgLenReceived < msgLen && next < received; next++) {
+        nBytes = min((size_t)recvBuf.mMsgs[next].msg_len, msgLen - msgLenReceived);
+        memcpy(msg + msgLenReceived, recvBuf.getSlot(next), nBytes);
+        msgLenReceived += nBytes;
+    }
+    for (; (msgLenReceived < msgLen) && (nBytes > 0); msgLenReceived += nBytes) {
+        nBytes = ::recvfrom(sid, msg + msgLenReceived, msgLen - msgLenReceived,
+                            flags, nullptr, nullptr);
+    }
     if (nBytes > 0) {
-        if (strncmp(msg.data(), MSG_ABORT, sizeof(MSG_ABORT)) == 0) {
-            LOC_LOGi("recvd abort msg.data %s", msg.data());
+        msg[msgLen] = 0;
+        nBytes = msgLen;
+        dataCb->onReceive(msg, nBytes, &recver);
+    }
+    return nBytes;
+}
+ssize_t Sock::recvfrom(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb,
+                       LocIpcRecvBuffer& recvBuf, int sid, int flags,
+                       struct sockaddr *srcAddr, socklen_t *addrlen) const  {
+    recvBuf.prepare(mMaxTxSize);
+    int received = -1;
+    if (recvBuf.mBatchSize > 1) {
+        // blocks for the first datagram only, then takes whatever else is queued
+        received = ::recvmmsg(sid, recvBuf.mMsgs.get(), recvBuf.mBatchSize,
+                              flags | MSG_WAITFORONE, nullptr);
+    }
+    if (received < 0) {
+        socklen_t namelen = sizeof(recvBuf.mAddrs[0]);
+        ssize_t nBytes = ::recvfrom(sid, recvBuf.getSlot(0), mMaxTxSize, flags,
+                                    (struct sockaddr*)&recvBuf.mAddrs[0], &namelen);
+        if (nBytes <= 0) {
+            return nBytes;
+        }
+        recvBuf.mMsgs[0].msg_len = nBytes;
+        recvBuf.mMsgs[0].msg_hdr.msg_namelen = namelen;
+        received = 1;
+    }
+
+    ssize_t nBytes = 0;
+    // *addrlen is overwritten with each datagram's address length, so the
+    // room in srcAddr has to be taken from the caller's value up front
+    socklen_t addrRoom = (nullptr != addrlen) ? *addrlen : 0;
+    for (uint32_t i = 0; i < (uint32_t)received; ) {
+        char* data = recvBuf.getSlot(i);
+        nBytes = recvBuf.mMsgs[i].msg_len;
+        data[nBytes] = 0;
+        if (nullptr != srcAddr && nullptr != addrlen) {
+            socklen_t namelen = recvBuf.mMsgs[i].msg_hdr.msg_namelen;
+            memcpy(srcAddr, &recvBuf.mAddrs[i], min(addrRoom, namelen));
+            *addrlen = namelen;
+        }
+        i++;
+        if (nBytes <= 0) {
+            break;
+        } else if (strncmp(data, MSG_ABORT, sizeof(MSG_ABORT)) == 0) {
+            LOC_LOGi("recvd abort msg.data %s", data);
             nBytes = 0;
-        } else if (strncmp(msg.data(), LOC_IPC_HEAD, sizeof(LOC_IPC_HEAD) - 1)) {
+            break;
+        } else if (strncmp(data, LOC_IPC_HEAD, sizeof(LOC_IPC_HEAD) - 1)) {
             // short message
-            msg.resize(nBytes);
-            dataCb->onReceive(msg.data(), nBytes, &recver);
+            dataCb->onReceive(data, nBytes, &recver);
         } else {
             // long message
-            size_t msgLen = 0;
-            sscanf(msg.data() + sizeof(LOC_IPC_HEAD) - 1, "%zu", &msgLen);
-            msg.resize(msgLen);
-            for (size_t msgLenReceived = 0; (msgLenReceived < msgLen) && (nBytes > 0);
-                 msgLenReceived += nBytes) {
-                nBytes = ::recvfrom(sid, &(msg[msgLenReceived]), msg.size() - msgLenReceived,
-                                    flags, srcAddr, addrlen);
-            }
-            if (nBytes > 0) {
-                nBytes = msgLen;
-                dataCb->onReceive(msg.data(), nBytes, &recver);
+            nBytes = recvLongMsg(recver, dataCb, recvBuf, data, i, received, sid, flags);
+            if (nBytes <= 0) {
+                break;
             }
         }
     }
@@ -160,10 +255,20 @@ public:
 };
 
 class LocIpcLocalRecver : public LocIpcLocalSender, public LocIpcRecver {
+    mutable LocIpcRecvBuffer mRecvBuf;
 protected:
     inline virtual ssize_t recv() const override {
         socklen_t size = sizeof(mAddr);
-        return mSock->recv(*this, mDataCb, 0, (struct sockaddr*)&mAddr, &size);
+        return mSock->recv(*this, mDataCb, mRecvBuf, 0, (struct sockaddr*)&mAddr, &size);
+    }
+    // takes in the datagrams queued by now; 0 on the abort msg
+    ssize_t recvQueuedDatagrams() const {
+        struct pollfd pollFd = {.fd = mSock->mSid, .events = POLLIN, .revents = 0};
+        ssize_t rtv = 1;
+        while (rtv > 0 && ::poll(&pollFd, 1, 0) > 0) {
+            rtv = LocIpcLocalRecver::recv();
+        }
+        return rtv;
     }
 public:
     inline LocIpcLocalRecver(const shared_ptr<ILocIpcListener>& listener, const char* name) :
@@ -182,6 +287,8 @@ public:
     }
     inline virtual ~LocIpcLocalRecver() { unlink(mAddr.sun_path); }
     inline virtual const char* getName() const override { return mAddr.sun_path; };
+    // readable when recv() has a datagram to take in
+    inline int getPollFd() const { return mSock->mSid; }
     inline virtual void abort() const override {
         if (isSendable()) {
             mSock->sendAbort(0, (struct sockaddr*)&mAddr, sizeof(mAddr));
@@ -189,6 +296,825 @@ public:
     }
 };
 
+// Framed local transport. Next to the datagram socket at its name, a framed
+// recver listens on a stream socket at name + LOC_IPC_FRAMED_SUFFIX. Framed
+// senders connect to that and write each msg, of any size, as one frame of
+// a uint32_t length followed by the payload, with a single sendmsg(). Each
+// sender has its own connection, so frames of concurrent senders can not
+// interleave. A framed sender whose peer does not listen for frames falls
+// back to the datagram protocol, and legacy senders can still send to a
+// framed recver over its datagram socket.
+#define LOC_IPC_FRAMED_SUFFIX ".framed"
+// frames above this are taken as a broken peer, and the connection dropped
+#define LOC_IPC_FRAMED_MAX_MSG_SIZE (16 * 1024 * 1024)
+// how long a framed or shm sender sticks to datagrams before it tries to
+// connect again
+#define LOC_IPC_CONNECT_RETRY_SEC 1
+
+static inline void getSuffixedSockName(const struct sockaddr_un& addr, const char* suffix,
+                                       struct sockaddr_un& suffixedAddr) {
+    suffixedAddr = addr;
+    snprintf(suffixedAddr.sun_path, sizeof(suffixedAddr.sun_path), "%s%s",
+             addr.sun_path, suffix);
+}
+
+// Connects a non blocking local socket of sockType to addr, unless the last
+// try was less than LOC_IPC_CONNECT_RETRY_SEC ago. Returns the fd, or -1.
+static int connectLocalSock(const struct sockaddr_un& addr, int sockType,
+                            time_t& nextConnectTime) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec < nextConnectTime) {
+        return -1;
+    }
+    int fd = ::socket(AF_UNIX, sockType | SOCK_CLOEXEC | SOCK_NONBLOCK, 0);
+    // this fails too, rather than blocks, when the peer has a full backlog
+    if (fd >= 0 && ::connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        ::close(fd);
+        fd = -1;
+    }
+    if (fd < 0) {
+        // the peer does not take connections, at least for now
+        nextConnectTime = now.tv_sec + LOC_IPC_CONNECT_RETRY_SEC;
+    }
+    return fd;
+}
+
+class LocIpcLocalFramedSender : public LocIpcLocalSender {
+    mutable mutex mMutex;
+    mutable int mConnFd;
+    mutable time_t mNextConnectTime;
+    struct sockaddr_un mFramedAddr;
+
+    // called with mMutex held
+    void connectLocked() const {
+        mConnFd = connectLocalSock(mFramedAddr, SOCK_STREAM, mNextConnectTime);
+        if (mConnFd >= 0) {
+            // frames are written whole, blocking as datagram sends do
+            int flags = fcntl(mConnFd, F_GETFL);
+            fcntl(mConnFd, F_SETFL, flags & ~O_NONBLOCK);
+            timeval timeout = {.tv_sec = 2, .tv_usec = 0};
+            setsockopt(mConnFd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        }
+    }
+    // called with mMutex held
+    ssize_t sendFrameLocked(const uint8_t data[], uint32_t length) const {
+        uint32_t frameLen = length;
+        struct iovec iov[2] = {
+            {.iov_base = &frameLen, .iov_len = sizeof(frameLen)},
+            {.iov_base = (void*)data, .iov_len = length}
+        };
+        struct msghdr msg = {};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = 2;
+        size_t total = sizeof(frameLen) + length;
+        size_t sent = 0;
+        while (sent < total) {
+            ssize_t rtv = ::sendmsg(mConnFd, &msg, MSG_NOSIGNAL);
+            if (rtv < 0) {
+                if (EINTR == errno) {
+                    continue;
+                }
+                LOC_LOGw("framed send to %s failed: %s", mFramedAddr.sun_path, strerror(errno));
+                return -1;
+            }
+            sent += rtv;
+            // a stream may take a frame in parts; skip what is already out
+            while (msg.msg_iovlen > 0 && (size_t)rtv >= msg.msg_iov[0].iov_len) {
+                rtv -= msg.msg_iov[0].iov_len;
+                msg.msg_iov++;
+                msg.msg_iovlen--;
+            }
+            if (msg.msg_iovlen > 0) {
+                msg.msg_iov[0].iov_base = (char*)msg.msg_iov[0].iov_base + rtv;
+                msg.msg_iov[0].iov_len -= rtv;
+            }
+        }
+        return total;
+    }
+protected:
+    virtual ssize_t send(const uint8_t data[], uint32_t length, int32_t msgId) const override {
+        if (nullptr == data || 0 == length) {
+            LOC_LOGe("Invalid inputs: buf - %p, length - %u", data, length);
+            return -1;
+        }
+        {
+            lock_guard<mutex> lock(mMutex);
+            if (mConnFd < 0) {
+                connectLocked();
+            }
+            if (mConnFd >= 0) {
+                ssize_t rtv = sendFrameLocked(data, length);
+                if (rtv > 0) {
+                    return rtv;
+                }
+                // the frame may be partially out, so the connection is done.
+                // Frames still queued on it may reach the recver after the
+                // datagrams sent from here on.
+                ::close(mConnFd);
+                mConnFd = -1;
+            }
+        }
+        return LocIpcLocalSender::send(data, length, msgId);
+    }
+public:
+    inline LocIpcLocalFramedSender(const char* name) : LocIpcLocalSender(name),
+            mConnFd(-1), mNextConnectTime(0) {
+        getSuffixedSockName(mAddr, LOC_IPC_FRAMED_SUFFIX, mFramedAddr);
+    }
+    inline virtual ~LocIpcLocalFramedSender() {
+        if (mConnFd >= 0) {
+            ::close(mConnFd);
+        }
+    }
+};
+
+// a connection of a framed sender, and the frames it has partially read
+struct LocIpcFramedConn {
+    int fd;
+    vector<char> buf;
+    size_t filled;
+    bool ready;
+    inline LocIpcFramedConn(int connFd) : fd(connFd), filled(0), ready(false) {}
+};
+
+class LocIpcLocalFramedRecver : public LocIpcLocalRecver {
+    const size_t mRecvChunkSize;
+    int mListenFd;
+    struct sockaddr_un mFramedAddr;
+    // the datagram socket, the listening socket and the connections, all
+    // in one epoll set, so the recver has one fd to poll on
+    int mEpollFd;
+    mutable vector<LocIpcFramedConn> mConns;
+
+    inline void watch(int fd) const {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            LOC_LOGe("epoll_ctl failed for fd %d, reason: %s", fd, strerror(errno));
+        }
+    }
+
+    // hands every complete frame in conn to the listener; false if the
+    // connection is to be dropped
+    bool recvFrames(LocIpcFramedConn& conn) const {
+        if (conn.buf.size() - conn.filled < mRecvChunkSize) {
+            conn.buf.resize(conn.filled + mRecvChunkSize);
+        }
+        ssize_t nBytes = ::read(conn.fd, conn.buf.data() + conn.filled,
+                                conn.buf.size() - conn.filled);
+        if (nBytes <= 0) {
+            return (nBytes < 0 && EINTR == errno);
+        }
+        conn.filled += nBytes;
+        size_t offset = 0;
+        while (conn.filled - offset >= sizeof(uint32_t)) {
+            uint32_t length = 0;
+            memcpy(&length, conn.buf.data() + offset, sizeof(length));
+            if (length > LOC_IPC_FRAMED_MAX_MSG_SIZE) {
+                LOC_LOGe("frame of %u bytes on %s, dropping connection",
+                         length, mFramedAddr.sun_path);
+                return false;
+            }
+            size_t frameSize = sizeof(length) + length;
+            size_t frameEnd = offset + frameSize;
+            if (conn.filled < frameEnd) {
+                // make room for the rest of the frame, and its '\0'
+                if (conn.buf.size() < frameEnd + 1) {
+                    memmove(conn.buf.data(), conn.buf.data() + offset, conn.filled - offset);
+                    conn.filled -= offset;
+                    offset = 0;
+                    if (conn.buf.size() < frameSize + 1) {
+                        conn.buf.resize(frameSize + 1);
+                    }
+                }
+                break;
+            }
+            if (conn.buf.size() <= frameEnd) {
+                conn.buf.resize(frameEnd + 1);
+            }
+            // msgs handed to listeners are '\0' terminated, as over datagrams
+            char* data = conn.buf.data() + offset + sizeof(length);
+            char next = data[length];
+            data[length] = 0;
+            mDataCb->onReceive(data, length, this);
+            data[length] = next;
+            offset = frameEnd;
+        }
+        if (offset > 0) {
+            memmove(conn.buf.data(), conn.buf.data() + offset, conn.filled - offset);
+            conn.filled -= offset;
+        }
+        return true;
+    }
+protected:
+    // waits on the datagram socket, the listening socket and the framed
+    // connections. The datagrams queued by then are taken in before the
+    // frames, so those a sender sent before it got connected come first.
+    virtual ssize_t recv() const override {
+        struct epoll_event events[8];
+        int ready = epoll_wait(mEpollFd, events, sizeof(events) / sizeof(events[0]), -1);
+        if (ready < 0) {
+            return (EINTR == errno) ? 1 : -1;
+        }
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == mSock->mSid) {
+                // taken in below
+            } else if (fd == mListenFd) {
+                int connFd = ::accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (connFd >= 0) {
+                    mConns.emplace_back(connFd);
+                    watch(connFd);
+                }
+            } else {
+                for (auto& conn : mConns) {
+                    conn.ready = conn.ready || (conn.fd == fd);
+                }
+            }
+        }
+        // legacy datagrams, those of senders not connected, and the abort msg
+        ssize_t rtv = recvQueuedDatagrams();
+        if (rtv <= 0) {
+            return rtv;
+        }
+        for (size_t i = mConns.size(); i > 0; i--) {
+            LocIpcFramedConn& conn = mConns[i - 1];
+            if (!conn.ready) {
+                continue;
+            }
+            conn.ready = false;
+            if (!recvFrames(conn)) {
+                // closing the fd takes it out of the epoll set too
+                ::close(conn.fd);
+                mConns.erase(mConns.begin() + (i - 1));
+            }
+        }
+        return 1;
+    }
+public:
+    inline LocIpcLocalFramedRecver(const shared_ptr<ILocIpcListener>& listener,
+                                   const char* name) :
+            LocIpcLocalRecver(listener, name), mRecvChunkSize(8192), mListenFd(-1),
+            mEpollFd(-1) {
+        getSuffixedSockName(mAddr, LOC_IPC_FRAMED_SUFFIX, mFramedAddr);
+        if ((unlink(mFramedAddr.sun_path) < 0) && (errno != ENOENT)) {
+            LOC_LOGw("unlink socket error. reason:%s", strerror(errno));
+        }
+        if (mSock->isValid()) {
+            mListenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            umask(0157);
+            if (mListenFd >= 0 &&
+                    (::bind(mListenFd, (struct sockaddr*)&mFramedAddr, sizeof(mFramedAddr)) < 0 ||
+                     ::listen(mListenFd, 8) < 0)) {
+                LOC_LOGe("framed socket error. %s, reason: %s",
+                         mFramedAddr.sun_path, strerror(errno));
+                ::close(mListenFd);
+                mListenFd = -1;
+            }
+            mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (mEpollFd < 0) {
+                LOC_LOGe("epoll_create1 failed, reason: %s", strerror(errno));
+                mSock->close();
+            } else {
+                watch(mSock->mSid);
+                if (mListenFd >= 0) {
+                    watch(mListenFd);
+                }
+            }
+        }
+    }
+    inline virtual ~LocIpcLocalFramedRecver() {
+        for (auto& conn : mConns) {
+            ::close(conn.fd);
+        }
+        if (mListenFd >= 0) {
+            ::close(mListenFd);
+            unlink(mFramedAddr.sun_path);
+        }
+        if (mEpollFd >= 0) {
+            ::close(mEpollFd);
+        }
+    }
+    // readable when any of the sockets recv() waits on is
+    inline int getPollFd() const { return mEpollFd; }
+};
+
+// Shared memory local transport. Next to the datagram socket at its name, a
+// shm recver listens on a seqpacket socket at name + LOC_IPC_SHM_SUFFIX.
+// For each sender that connects, it sets up a single producer / single
+// consumer ring in a memfd, and passes it to the sender with an eventfd
+// doorbell. Msgs are then copied into the ring by the sender, and out of it
+// into a buffer of the recver's own for the listener, as the sender can
+// write the ring any time. There is no syscall per msg: the sender rings the
+// doorbell only when the recver has found the ring empty and is about to
+// sleep, and the recver wakes the sender through a futex only when the
+// sender waits for room. A shm sender sends datagrams, as legacy senders
+// do, till the recver has passed it a ring, and whenever it can not use
+// one. The recver takes in all datagrams queued before it drains the rings
+// up to where they were, so the msgs of a sender stay in order.
+#define LOC_IPC_SHM_SUFFIX ".shm"
+#define LOC_IPC_SHM_MAGIC 0x4c495352  // "LISR"
+// data bytes of a ring, a power of 2
+#define LOC_IPC_SHM_RING_SIZE (256 * 1024)
+// length of the record that tells the rest of the ring up to its end is unused
+#define LOC_IPC_SHM_WRAP 0xffffffff
+// how long a shm sender waits for room in the ring before failing a send
+#define LOC_IPC_SHM_SEND_TIMEOUT_MS 2000
+// how often a shm sender waiting for room checks that its recver is still there
+#define LOC_IPC_SHM_PEER_CHECK_MS 100
+
+// At the start of the memfd, followed by the ring data. Records in the ring
+// are a uint32_t length, the msg, a '\0', and padding to 8 bytes. head and
+// tail are byte positions that only go up; at 64 bits they never wrap.
+struct LocIpcShmRing {
+    uint32_t magic;
+    uint32_t size;
+    // set by the recver when it drops the ring, so the sender stops using it
+    atomic<uint32_t> closed;
+    alignas(64) atomic<uint64_t> tail;
+    atomic<uint32_t> recverWaiting;
+    alignas(64) atomic<uint64_t> head;
+    // also the futex word the sender sleeps on
+    atomic<uint32_t> senderWaiting;
+    alignas(64) char data[0];
+
+    static inline uint32_t getRecordSize(uint32_t length) {
+        return (sizeof(uint32_t) + length + 1 + 7) & ~7u;
+    }
+    // a msg plus a wrap record must fit in the ring
+    inline uint32_t getMaxMsgSize() const { return size / 2 - sizeof(uint32_t) - 8; }
+};
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t) &&
+              sizeof(atomic<uint64_t>) == sizeof(uint64_t) && 2 == ATOMIC_LLONG_LOCK_FREE,
+              "LocIpcShmRing atomics must be lock free plain words shared across processes");
+
+static inline long futexWait(atomic<uint32_t>* word, uint32_t value, const struct timespec* timeout) {
+    // not FUTEX_PRIVATE_FLAG, the word is shared with another process
+    return syscall(__NR_futex, (uint32_t*)word, FUTEX_WAIT, value, timeout, nullptr, 0);
+}
+static inline long futexWake(atomic<uint32_t>* word) {
+    return syscall(__NR_futex, (uint32_t*)word, FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+class LocIpcShmSender : public LocIpcLocalSender {
+    mutable mutex mMutex;
+    // connected to the recver, with or still without the ring it passes
+    mutable int mConnFd;
+    mutable int mDoorbellFd;
+    mutable LocIpcShmRing* mRing;
+    mutable size_t mMapSize;
+    // ring head as of the last send, to tell when the recver falls behind
+    mutable uint64_t mLastHead;
+    mutable time_t mNextConnectTime;
+    struct sockaddr_un mShmAddr;
+
+    // called with mMutex held; connects to the recver, and takes in the
+    // memfd and doorbell it answers with. This does not block: till the
+    // answer is there, it returns false, and msgs go over datagrams.
+    bool setUpLocked() const {
+        if (mConnFd < 0) {
+            mConnFd = connectLocalSock(mShmAddr, SOCK_SEQPACKET, mNextConnectTime);
+            if (mConnFd < 0) {
+                return false;
+            }
+        }
+        uint32_t magic = 0;
+        struct iovec iov = {.iov_base = &magic, .iov_len = sizeof(magic)};
+        char control[CMSG_SPACE(2 * sizeof(int))] = {};
+        struct msghdr msg = {};
+        msg.msg_iov = &iov;
+        msg.msg_iovlen = 1;
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        ssize_t received = ::recvmsg(mConnFd, &msg, MSG_DONTWAIT | MSG_CMSG_CLOEXEC);
+        if (received < 0 && (EAGAIN == errno || EWOULDBLOCK == errno)) {
+            // the recver has not got to the connection yet
+            return false;
+        }
+        struct cmsghdr* cmsg = nullptr;
+        int memFd = -1;
+        struct stat memStat = {};
+        if (sizeof(magic) == received &&
+                LOC_IPC_SHM_MAGIC == magic && nullptr != (cmsg = CMSG_FIRSTHDR(&msg)) &&
+                SCM_RIGHTS == cmsg->cmsg_type &&
+                CMSG_LEN(2 * sizeof(int)) == cmsg->cmsg_len) {
+            int fds[2];
+            memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+            memFd = fds[0];
+            mDoorbellFd = fds[1];
+            if (fstat(memFd, &memStat) == 0 && (size_t)memStat.st_size > sizeof(LocIpcShmRing)) {
+                void* map = mmap(nullptr, memStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                                 memFd, 0);
+                if (MAP_FAILED != map) {
+                    mRing = (LocIpcShmRing*)map;
+                    mMapSize = memStat.st_size;
+                }
+            }
+            ::close(memFd);
+        }
+        if (nullptr == mRing || LOC_IPC_SHM_MAGIC != mRing->magic ||
+                sizeof(LocIpcShmRing) + mRing->size != mMapSize) {
+            LOC_LOGw("failed to set up shm ring with %s", mShmAddr.sun_path);
+            tearDownLocked();
+            // try again later, in case the recver was just starting up
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            mNextConnectTime = now.tv_sec + LOC_IPC_CONNECT_RETRY_SEC;
+            return false;
+        }
+        mLastHead = mRing->head.load(memory_order_relaxed);
+        return true;
+    }
+    // called with mMutex held
+    void tearDownLocked() const {
+        if (nullptr != mRing) {
+            munmap(mRing, mMapSize);
+            mRing = nullptr;
+        }
+        if (mDoorbellFd >= 0) {
+            ::close(mDoorbellFd);
+            mDoorbellFd = -1;
+        }
+        if (mConnFd >= 0) {
+            ::close(mConnFd);
+            mConnFd = -1;
+        }
+    }
+    // called with mMutex held; the recver sends nothing more on the
+    // connection once it passed the ring, so it turning readable means the
+    // recver hung up, e.g. died without a chance to set closed
+    inline bool isRecverGoneLocked() const {
+        struct pollfd pollFd = {.fd = mConnFd, .events = POLLIN, .revents = 0};
+        return ::poll(&pollFd, 1, 0) != 0;
+    }
+    // called with mMutex held; waits till the ring has room for bytes more
+    bool waitForRoomLocked(uint64_t tail, uint32_t bytes) const {
+        struct timespec deadline;
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += LOC_IPC_SHM_SEND_TIMEOUT_MS / 1000;
+        while (true) {
+            uint64_t head = mRing->head.load(memory_order_acquire);
+            if (mRing->size - (tail - head) >= bytes) {
+                return true;
+            }
+            if (mRing->closed.load(memory_order_relaxed) || isRecverGoneLocked()) {
+                return false;
+            }
+            mRing->senderWaiting.store(1, memory_order_seq_cst);
+            if (mRing->head.load(memory_order_seq_cst) != head) {
+                continue;
+            }
+            struct timespec now, timeout;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            timeout.tv_sec = deadline.tv_sec - now.tv_sec;
+            timeout.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+            if (timeout.tv_nsec < 0) {
+                timeout.tv_sec--;
+                timeout.tv_nsec += 1000000000;
+            }
+            if (timeout.tv_sec < 0) {
+                LOC_LOGw("shm ring to %s stays full", mShmAddr.sun_path);
+                return false;
+            }
+            // wake up now and then to see if the recver is still there
+            if (timeout.tv_sec > 0 || timeout.tv_nsec > LOC_IPC_SHM_PEER_CHECK_MS * 1000000L) {
+                timeout.tv_sec = 0;
+                timeout.tv_nsec = LOC_IPC_SHM_PEER_CHECK_MS * 1000000L;
+            }
+            // the recver clears senderWaiting before it wakes this up
+            futexWait(&mRing->senderWaiting, 1, &timeout);
+        }
+    }
+    // called with mMutex held
+    ssize_t writeLocked(const uint8_t data[], uint32_t length) const {
+        uint64_t tail = mRing->tail.load(memory_order_relaxed);
+        uint64_t head = mRing->head.load(memory_order_acquire);
+        // a recver that took nothing in since the last send may be gone; the
+        // one syscall to check is only paid while it falls behind
+        if (head == mLastHead && head != tail && isRecverGoneLocked()) {
+            return -1;
+        }
+        mLastHead = head;
+        uint32_t mask = mRing->size - 1;
+        uint32_t offset = (uint32_t)(tail & mask);
+        uint32_t recordSize = LocIpcShmRing::getRecordSize(length);
+        uint32_t untilEnd = mRing->size - offset;
+        bool wrap = untilEnd < recordSize;
+        if (!waitForRoomLocked(tail, recordSize + (wrap ? untilEnd : 0))) {
+            return -1;
+        }
+        if (wrap) {
+            uint32_t wrapLength = LOC_IPC_SHM_WRAP;
+            memcpy(mRing->data + offset, &wrapLength, sizeof(wrapLength));
+            tail += untilEnd;
+            offset = 0;
+        }
+        char* record = mRing->data + offset;
+        memcpy(record, &length, sizeof(length));
+        memcpy(record + sizeof(length), data, length);
+        record[sizeof(length) + length] = 0;
+        mRing->tail.store(tail + recordSize, memory_order_seq_cst);
+        // the recver sets recverWaiting before it checks tail one last time
+        if (mRing->recverWaiting.load(memory_order_seq_cst) &&
+                mRing->recverWaiting.exchange(0)) {
+            uint64_t one = 1;
+            if (::write(mDoorbellFd, &one, sizeof(one)) < 0) {
+                LOC_LOGw("failed to ring %s, reason: %s", mShmAddr.sun_path, strerror(errno));
+            }
+        }
+        return length;
+    }
+protected:
+    virtual ssize_t send(const uint8_t data[], uint32_t length, int32_t msgId) const override {
+        if (nullptr == data || 0 == length) {
+            LOC_LOGe("Invalid inputs: buf - %p, length - %u", data, length);
+            return -1;
+        }
+        lock_guard<mutex> lock(mMutex);
+        if (nullptr != mRing && mRing->closed.load(memory_order_relaxed)) {
+            tearDownLocked();
+        }
+        if (nullptr == mRing && !setUpLocked()) {
+            return LocIpcLocalSender::send(data, length, msgId);
+        }
+        if (length > mRing->getMaxMsgSize()) {
+            // too big for the ring; send it over datagrams, once all msgs
+            // before it are taken out of the ring, to keep the order
+            return waitForRoomLocked(mRing->tail.load(memory_order_relaxed), mRing->size) ?
+                    LocIpcLocalSender::send(data, length, msgId) : -1;
+        }
+        ssize_t rtv = writeLocked(data, length);
+        if (rtv < 0) {
+            // the recver is gone, or stuck; start over with the next msg
+            tearDownLocked();
+        }
+        return rtv;
+    }
+public:
+    inline LocIpcShmSender(const char* name) : LocIpcLocalSender(name),
+            mConnFd(-1), mDoorbellFd(-1), mRing(nullptr), mMapSize(0), mLastHead(0),
+            mNextConnectTime(0) {
+        getSuffixedSockName(mAddr, LOC_IPC_SHM_SUFFIX, mShmAddr);
+    }
+    inline virtual ~LocIpcShmSender() {
+        tearDownLocked();
+    }
+};
+
+// a ring the recver set up for a shm sender
+struct LocIpcShmConn {
+    int connFd;
+    int doorbellFd;
+    LocIpcShmRing* ring;
+    size_t mapSize;
+    // ring tail as of before the recver last took in the queued datagrams,
+    // which it drains the ring up to
+    uint64_t tail;
+    // the sender sends nothing on its connection, so it turning readable
+    // means it hung up
+    bool senderGone;
+};
+
+class LocIpcShmRecver : public LocIpcLocalRecver {
+    int mListenFd;
+    struct sockaddr_un mShmAddr;
+    // the datagram socket, the listening socket, and the connection and
+    // doorbell of each ring, all in one epoll set
+    int mEpollFd;
+    mutable vector<LocIpcShmConn> mConns;
+    // where each msg is copied out of its ring to, and handed to the listener from
+    mutable vector<char> mMsg;
+
+    inline void watch(int fd) const {
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            LOC_LOGe("epoll_ctl failed for fd %d, reason: %s", fd, strerror(errno));
+        }
+    }
+    void setUpConn(int connFd) const {
+        LocIpcShmConn conn = {.connFd = connFd, .doorbellFd = -1, .ring = nullptr,
+                              .mapSize = sizeof(LocIpcShmRing) + LOC_IPC_SHM_RING_SIZE,
+                              .tail = 0, .senderGone = false};
+        int memFd = syscall(__NR_memfd_create, "LocIpcShm", MFD_CLOEXEC);
+        conn.doorbellFd = eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+        if (memFd >= 0 && conn.doorbellFd >= 0 && ftruncate(memFd, conn.mapSize) == 0) {
+            void* map = mmap(nullptr, conn.mapSize, PROT_READ | PROT_WRITE, MAP_SHARED, memFd, 0);
+            if (MAP_FAILED != map) {
+                conn.ring = new (map) LocIpcShmRing();
+                conn.ring->magic = LOC_IPC_SHM_MAGIC;
+                conn.ring->size = LOC_IPC_SHM_RING_SIZE;
+                // till recv() first finds the ring empty
+                conn.ring->recverWaiting.store(1, memory_order_relaxed);
+            }
+        }
+        if (nullptr != conn.ring) {
+            uint32_t magic = LOC_IPC_SHM_MAGIC;
+            struct iovec iov = {.iov_base = &magic, .iov_len = sizeof(magic)};
+            char control[CMSG_SPACE(2 * sizeof(int))] = {};
+            struct msghdr msg = {};
+            msg.msg_iov = &iov;
+            msg.msg_iovlen = 1;
+            msg.msg_control = control;
+            msg.msg_controllen = sizeof(control);
+            struct cmsghdr* cmsg = CMSG_FIRSTHDR(&msg);
+            cmsg->cmsg_level = SOL_SOCKET;
+            cmsg->cmsg_type = SCM_RIGHTS;
+            cmsg->cmsg_len = CMSG_LEN(2 * sizeof(int));
+            int fds[2] = {memFd, conn.doorbellFd};
+            memcpy(CMSG_DATA(cmsg), fds, sizeof(fds));
+            if (::sendmsg(connFd, &msg, MSG_NOSIGNAL) < 0) {
+                LOC_LOGw("failed to pass shm ring on %s, reason: %s",
+                         mShmAddr.sun_path, strerror(errno));
+                munmap(conn.ring, conn.mapSize);
+                conn.ring = nullptr;
+            }
+        } else {
+            LOC_LOGe("failed to create shm ring on %s, reason: %s",
+                     mShmAddr.sun_path, strerror(errno));
+        }
+        if (memFd >= 0) {
+            ::close(memFd);
+        }
+        if (nullptr == conn.ring) {
+            // the sender falls back to datagrams
+            if (conn.doorbellFd >= 0) {
+                ::close(conn.doorbellFd);
+            }
+            ::close(connFd);
+            return;
+        }
+        mConns.push_back(conn);
+        watch(conn.connFd);
+        watch(conn.doorbellFd);
+    }
+    void tearDownConn(LocIpcShmConn& conn) const {
+        conn.ring->closed.store(1, memory_order_relaxed);
+        conn.ring->senderWaiting.store(0, memory_order_relaxed);
+        futexWake(&conn.ring->senderWaiting);
+        munmap(conn.ring, conn.mapSize);
+        // closing the fds takes them out of the epoll set too
+        ::close(conn.doorbellFd);
+        ::close(conn.connFd);
+    }
+    // hands the msgs in the ring up to conn.tail to the listener, each from a
+    // copy, which the sender can not change under it; false if the ring is
+    // corrupted, and to be dropped
+    bool drain(LocIpcShmConn& conn) const {
+        LocIpcShmRing* ring = conn.ring;
+        uint32_t mask = ring->size - 1;
+        uint64_t head = ring->head.load(memory_order_relaxed);
+        uint64_t tail = conn.tail;
+        if (tail < head || tail - head > ring->size) {
+            LOC_LOGe("corrupted shm ring on %s", mShmAddr.sun_path);
+            return false;
+        }
+        while (head != tail) {
+            uint32_t offset = (uint32_t)(head & mask);
+            uint32_t length = 0;
+            memcpy(&length, ring->data + offset, sizeof(length));
+            uint32_t recordSize = 0;
+            if (LOC_IPC_SHM_WRAP == length) {
+                recordSize = ring->size - offset;
+            } else if (length <= ring->getMaxMsgSize() &&
+                       offset + LocIpcShmRing::getRecordSize(length) <= ring->size) {
+                recordSize = LocIpcShmRing::getRecordSize(length);
+                // with its '\0', checked in the copy, as the ring may change after
+                mMsg.resize(length + 1);
+                memcpy(mMsg.data(), ring->data + offset + sizeof(length), length + 1);
+                if (0 != mMsg[length]) {
+                    recordSize = 0;
+                }
+            }
+            if (0 == recordSize || tail - head < recordSize) {
+                LOC_LOGe("corrupted shm ring on %s", mShmAddr.sun_path);
+                return false;
+            }
+            if (LOC_IPC_SHM_WRAP != length) {
+                mDataCb->onReceive(mMsg.data(), length, this);
+            }
+            // only now, so a sender sees a recver that died in onReceive()
+            // has not moved head
+            head += recordSize;
+            ring->head.store(head, memory_order_seq_cst);
+            if (ring->senderWaiting.load(memory_order_seq_cst) &&
+                    ring->senderWaiting.exchange(0)) {
+                futexWake(&ring->senderWaiting);
+            }
+        }
+        return true;
+    }
+protected:
+    // waits on the sockets and doorbells, and takes in the datagrams and
+    // drains every ring till they are empty, with recverWaiting set, so
+    // each sender rings when it adds to its ring
+    virtual ssize_t recv() const override {
+        struct epoll_event events[8];
+        int ready = epoll_wait(mEpollFd, events, sizeof(events) / sizeof(events[0]), -1);
+        if (ready < 0) {
+            return (EINTR == errno) ? 1 : -1;
+        }
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == mSock->mSid) {
+                // taken in below
+            } else if (fd == mListenFd) {
+                int connFd = ::accept4(mListenFd, nullptr, nullptr, SOCK_CLOEXEC);
+                if (connFd >= 0) {
+                    setUpConn(connFd);
+                }
+            } else {
+                auto conn = find_if(mConns.begin(), mConns.end(),
+                                    [fd] (const LocIpcShmConn& c) {
+                                        return c.doorbellFd == fd || c.connFd == fd;
+                                    });
+                uint64_t count = 0;
+                if (conn == mConns.end()) {
+                    continue;
+                } else if (fd == conn->connFd) {
+                    conn->senderGone = true;
+                } else if (::read(fd, &count, sizeof(count)) < 0) {
+                    LOC_LOGw("failed to read doorbell, reason: %s", strerror(errno));
+                }
+            }
+        }
+        bool more = false;
+        do {
+            // a msg a sender put in its ring after a datagram is only
+            // drained once that datagram is taken in
+            for (auto& conn : mConns) {
+                conn.tail = conn.ring->tail.load(memory_order_acquire);
+            }
+            // legacy datagrams, those of senders without a ring, and the abort msg
+            ssize_t rtv = recvQueuedDatagrams();
+            if (rtv <= 0) {
+                return rtv;
+            }
+            more = false;
+            for (size_t i = mConns.size(); i > 0; i--) {
+                LocIpcShmConn& conn = mConns[i - 1];
+                if (drain(conn) && !conn.senderGone) {
+                    conn.ring->recverWaiting.store(1, memory_order_seq_cst);
+                    more = more || (conn.ring->tail.load(memory_order_seq_cst) !=
+                                    conn.ring->head.load(memory_order_relaxed));
+                } else {
+                    tearDownConn(conn);
+                    mConns.erase(mConns.begin() + (i - 1));
+                }
+            }
+        } while (more);
+        return 1;
+    }
+public:
+    inline LocIpcShmRecver(const shared_ptr<ILocIpcListener>& listener, const char* name) :
+            LocIpcLocalRecver(listener, name), mListenFd(-1), mEpollFd(-1) {
+        // the most any ring can carry, so it is never grown
+        mMsg.reserve(LOC_IPC_SHM_RING_SIZE / 2);
+        getSuffixedSockName(mAddr, LOC_IPC_SHM_SUFFIX, mShmAddr);
+        if ((unlink(mShmAddr.sun_path) < 0) && (errno != ENOENT)) {
+            LOC_LOGw("unlink socket error. reason:%s", strerror(errno));
+        }
+        if (mSock->isValid()) {
+            mListenFd = ::socket(AF_UNIX, SOCK_SEQPACKET | SOCK_CLOEXEC, 0);
+            umask(0157);
+            if (mListenFd >= 0 &&
+                    (::bind(mListenFd, (struct sockaddr*)&mShmAddr, sizeof(mShmAddr)) < 0 ||
+                     ::listen(mListenFd, 8) < 0)) {
+                LOC_LOGe("shm socket error. %s, reason: %s", mShmAddr.sun_path, strerror(errno));
+                ::close(mListenFd);
+                mListenFd = -1;
+            }
+            mEpollFd = epoll_create1(EPOLL_CLOEXEC);
+            if (mEpollFd < 0) {
+                LOC_LOGe("epoll_create1 failed, reason: %s", strerror(errno));
+                mSock->close();
+            } else {
+                watch(mSock->mSid);
+                if (mListenFd >= 0) {
+                    watch(mListenFd);
+                }
+            }
+        }
+    }
+    inline virtual ~LocIpcShmRecver() {
+        for (auto& conn : mConns) {
+            tearDownConn(conn);
+        }
+        if (mListenFd >= 0) {
+            ::close(mListenFd);
+            unlink(mShmAddr.sun_path);
+        }
+        if (mEpollFd >= 0) {
+            ::close(mEpollFd);
+        }
+    }
+    // readable when any of the sockets and doorbells recv() waits on is
+    inline int getPollFd() const { return mEpollFd; }
+};
+
 class LocIpcInetSender : public LocIpcSender {
 protected:
     int mSockType;
@@ -271,6 +1197,8 @@ public:
 
 class LocIpcInetTcpRecver : public LocIpcInetRecver {
     mutable int32_t mConnFd;
+    // a stream has no msg boundaries to batch on
+    mutable LocIpcRecvBuffer mRecvBuf;
 protected:
     inline virtual ssize_t recv() const override {
         socklen_t size = sizeof(mAddr);
@@ -281,20 +1209,22 @@ protected:
                 mConnFd = -1;
             }
         }
-        return mSock->recv(*this, mDataCb, 0, (struct sockaddr*)&mAddr, &size, mConnFd);
+        return mSock->recv(*this, mDataCb, mRecvBuf, 0, (struct sockaddr*)&mAddr, &size,
+                           mConnFd);
     }
 public:
     inline LocIpcInetTcpRecver(const shared_ptr<ILocIpcListener>& listener, const char* name,
                                int32_t port) :
-            LocIpcInetRecver(listener, name, port, SOCK_STREAM), mConnFd(-1) {}
+            LocIpcInetRecver(listener, name, port, SOCK_STREAM), mConnFd(-1), mRecvBuf(1) {}
     inline virtual ~LocIpcInetTcpRecver() { if (-1 != mConnFd) ::close(mConnFd);}
 };
 
 class LocIpcInetUdpRecver : public LocIpcInetRecver {
+    mutable LocIpcRecvBuffer mRecvBuf;
 protected:
     inline virtual ssize_t recv() const override {
         socklen_t size = sizeof(mAddr);
-        return mSock->recv(*this, mDataCb, 0, (struct sockaddr*)&mAddr, &size);
+        return mSock->recv(*this, mDataCb, mRecvBuf, 0, (struct sockaddr*)&mAddr, &size);
     }
 public:
     inline LocIpcInetUdpRecver(const shared_ptr<ILocIpcListener>& listener, const char* name,
@@ -302,6 +1232,8 @@ public:
             LocIpcInetRecver(listener, name, port, SOCK_DGRAM) {}
 
     inline virtual ~LocIpcInetUdpRecver() {}
+    // readable when recv() has a datagram to take in
+    inline int getPollFd() const { return mSock->mSid; }
 };
 
 class LocIpcRunnable : public LocRunnable {
@@ -369,6 +1301,211 @@ void LocIpc::stopBlockingListening(LocIpcRecver& ipcRecver) {
     }
 }
 
+// max events a LocIpcReactor takes in with one epoll_wait()
+#define LOC_IPC_REACTOR_MAX_EVENTS 16
+
+// passes the msgs of a recver made by a LocIpcReactor on to its listener,
+// and counts them
+class LocIpcReactorListener : public ILocIpcListener {
+    const shared_ptr<ILocIpcListener> mListener;
+public:
+    atomic<uint64_t> mMsgs;
+    inline LocIpcReactorListener(const shared_ptr<ILocIpcListener>& listener) :
+            mListener(listener), mMsgs(0) {}
+    inline virtual ~LocIpcReactorListener() {}
+    inline virtual void onListenerReady() override { mListener->onListenerReady(); }
+    inline virtual void onReceive(const char* data, uint32_t len,
+                                  const LocIpcRecver* recver) override {
+        mListener->onReceive(data, len, recver);
+        mMsgs.fetch_add(1, memory_order_relaxed);
+    }
+};
+
+struct LocIpcReactorEntry {
+    unique_ptr<LocIpcRecver> recver;
+    int fd;
+    // null for recvers from addRecver(), whose msgs are not seen here
+    shared_ptr<LocIpcReactorListener> counter;
+    atomic<uint64_t> wakeups;
+    bool done;
+    inline LocIpcReactorEntry(unique_ptr<LocIpcRecver>& ipcRecver, int pollFd,
+                              const shared_ptr<LocIpcReactorListener>& msgCounter) :
+            recver(move(ipcRecver)), fd(pollFd), counter(msgCounter), wakeups(0),
+            done(false) {}
+};
+
+class LocIpcReactorRunnable : public LocRunnable {
+    LocIpcReactor& mReactor;
+public:
+    inline LocIpcReactorRunnable(LocIpcReactor& reactor) : mReactor(reactor) {}
+    inline bool run() override { return mReactor.runOnce(); }
+};
+
+LocIpcReactor::LocIpcReactor() :
+        mEpollFd(epoll_create1(EPOLL_CLOEXEC)),
+        mAbortFd(eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK)) {
+    if (mEpollFd < 0 || mAbortFd < 0) {
+        LOC_LOGe("epoll / eventfd failed, reason: %s", strerror(errno));
+    } else {
+        // the abort eventfd is the one event with no entry
+        struct epoll_event event = {};
+        event.events = EPOLLIN;
+        event.data.ptr = nullptr;
+        epoll_ctl(mEpollFd, EPOLL_CTL_ADD, mAbortFd, &event);
+    }
+}
+
+LocIpcReactor::~LocIpcReactor() {
+    stop();
+    if (mEpollFd >= 0) {
+        ::close(mEpollFd);
+    }
+    if (mAbortFd >= 0) {
+        ::close(mAbortFd);
+    }
+}
+
+bool LocIpcReactor::start(const char* threadName) {
+    if (mEpollFd < 0 || mAbortFd < 0) {
+        return false;
+    }
+    LocIpcReactorRunnable* runnable = new LocIpcReactorRunnable(*this);
+    if (!mThread.start(threadName, runnable)) {
+        delete runnable;
+        return false;
+    }
+    return true;
+}
+
+void LocIpcReactor::stop() {
+    if (mAbortFd >= 0) {
+        uint64_t one = 1;
+        if (::write(mAbortFd, &one, sizeof(one)) < 0) {
+            LOC_LOGw("failed to abort reactor, reason: %s", strerror(errno));
+        }
+    }
+    mThread.stop();
+    if (mAbortFd >= 0) {
+        // so a later start() does not see this abort
+        uint64_t count = 0;
+        while (::read(mAbortFd, &count, sizeof(count)) > 0);
+    }
+    lock_guard<mutex> lock(mMutex);
+    mEntries.clear();
+}
+
+bool LocIpcReactor::addLocalRecver(const shared_ptr<ILocIpcListener>& listener,
+                                   const char* localSockName) {
+    auto counter = make_shared<LocIpcReactorListener>(listener);
+    auto recver = make_unique<LocIpcLocalRecver>(counter, localSockName);
+    int pollFd = recver->getPollFd();
+    unique_ptr<LocIpcRecver> ipcRecver(move(recver));
+    return addRecver(ipcRecver, pollFd, counter);
+}
+
+bool LocIpcReactor::addLocalFramedRecver(const shared_ptr<ILocIpcListener>& listener,
+                                         const char* localSockName) {
+    auto counter = make_shared<LocIpcReactorListener>(listener);
+    auto recver = make_unique<LocIpcLocalFramedRecver>(counter, localSockName);
+    int pollFd = recver->getPollFd();
+    unique_ptr<LocIpcRecver> ipcRecver(move(recver));
+    return addRecver(ipcRecver, pollFd, counter);
+}
+
+bool LocIpcReactor::addShmRecver(const shared_ptr<ILocIpcListener>& listener,
+                                 const char* localSockName) {
+    auto counter = make_shared<LocIpcReactorListener>(listener);
+    auto recver = make_unique<LocIpcShmRecver>(counter, localSockName);
+    int pollFd = recver->getPollFd();
+    unique_ptr<LocIpcRecver> ipcRecver(move(recver));
+    return addRecver(ipcRecver, pollFd, counter);
+}
+
+bool LocIpcReactor::addInetUdpRecver(const shared_ptr<ILocIpcListener>& listener,
+                                     const char* serverName, int32_t port) {
+    auto counter = make_shared<LocIpcReactorListener>(listener);
+    auto recver = make_unique<LocIpcInetUdpRecver>(counter, serverName, port);
+    int pollFd = recver->getPollFd();
+    unique_ptr<LocIpcRecver> ipcRecver(move(recver));
+    return addRecver(ipcRecver, pollFd, counter);
+}
+
+bool LocIpcReactor::addRecver(unique_ptr<LocIpcRecver>& ipcRecver, int pollFd) {
+    return addRecver(ipcRecver, pollFd, nullptr);
+}
+
+bool LocIpcReactor::addRecver(unique_ptr<LocIpcRecver>& ipcRecver, int pollFd,
+                              const shared_ptr<LocIpcReactorListener>& counter) {
+    if (mEpollFd < 0 || ipcRecver == nullptr || !ipcRecver->isRecvable() || pollFd < 0) {
+        LOC_LOGe("ipcRecver is null, not recvable, or has no fd to poll on");
+        return false;
+    }
+    // inform that the socket is ready to receive message
+    ipcRecver->onListenerReady();
+    LocIpcReactorEntry* entry = new LocIpcReactorEntry(ipcRecver, pollFd, counter);
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.ptr = entry;
+    lock_guard<mutex> lock(mMutex);
+    if (epoll_ctl(mEpollFd, EPOLL_CTL_ADD, entry->fd, &event) < 0) {
+        LOC_LOGe("epoll_ctl failed for %s, reason: %s",
+                 entry->recver->getName(), strerror(errno));
+        ipcRecver = move(entry->recver);
+        delete entry;
+        return false;
+    }
+    mEntries.emplace_back(entry);
+    return true;
+}
+
+bool LocIpcReactor::runOnce() {
+    struct epoll_event events[LOC_IPC_REACTOR_MAX_EVENTS];
+    int ready = epoll_wait(mEpollFd, events, LOC_IPC_REACTOR_MAX_EVENTS, -1);
+    if (ready < 0) {
+        if (EINTR == errno) {
+            return true;
+        }
+        LOC_LOGe("epoll_wait failed, reason: %s", strerror(errno));
+        return false;
+    }
+    bool anyDone = false;
+    for (int i = 0; i < ready; i++) {
+        LocIpcReactorEntry* entry = (LocIpcReactorEntry*)events[i].data.ptr;
+        if (nullptr == entry) {
+            return false;
+        }
+        // entries are only ever freed on this thread, below, or after it is joined
+        entry->wakeups.fetch_add(1, memory_order_relaxed);
+        if (!entry->recver->recvData()) {
+            // aborted, or its peer is gone, as a listening thread would end
+            LOC_LOGi("stop listening on %s", entry->recver->getName());
+            epoll_ctl(mEpollFd, EPOLL_CTL_DEL, entry->fd, nullptr);
+            entry->done = true;
+            anyDone = true;
+        }
+    }
+    if (anyDone) {
+        lock_guard<mutex> lock(mMutex);
+        mEntries.erase(remove_if(mEntries.begin(), mEntries.end(),
+                                 [] (const unique_ptr<LocIpcReactorEntry>& entry) {
+                                     return entry->done;
+                                 }),
+                       mEntries.end());
+    }
+    return true;
+}
+
+void LocIpcReactor::getStats(vector<RecverStats>& stats) const {
+    lock_guard<mutex> lock(mMutex);
+    stats.clear();
+    for (auto& entry : mEntries) {
+        uint64_t msgs = (nullptr == entry->counter) ? 0 :
+                entry->counter->mMsgs.load(memory_order_relaxed);
+        stats.push_back({entry->recver->getName(), msgs,
+                         entry->wakeups.load(memory_order_relaxed)});
+    }
+}
+
 bool LocIpc::send(LocIpcSender& sender, const uint8_t data[], uint32_t length, int32_t msgId) {
     return sender.sendData(data, length, msgId);
 }
@@ -380,6 +1517,20 @@ unique_ptr<LocIpcRecver> LocIpc::getLocIpcLocalRecver(const shared_ptr<ILocIpcLi
                                                       const char* localSockName) {
     return make_unique<LocIpcLocalRecver>(listener, localSockName);
 }
+shared_ptr<LocIpcSender> LocIpc::getLocIpcLocalFramedSender(const char* localSockName) {
+    return make_shared<LocIpcLocalFramedSender>(localSockName);
+}
+unique_ptr<LocIpcRecver> LocIpc::getLocIpcLocalFramedRecver(
+        const shared_ptr<ILocIpcListener>& listener, const char* localSockName) {
+    return make_unique<LocIpcLocalFramedRecver>(listener, localSockName);
+}
+shared_ptr<LocIpcSender> LocIpc::getLocIpcShmSender(const char* localSockName) {
+    return make_shared<LocIpcShmSender>(localSockName);
+}
+unique_ptr<LocIpcRecver> LocIpc::getLocIpcShmRecver(const shared_ptr<ILocIpcListener>& listener,
+                                                    const char* localSockName) {
+    return make_unique<LocIpcShmRecver>(listener, localSockName);
+}
 static void* sLibQrtrHandle = nullptr;
 static const char* sLibQrtrName = "libloc_socket.so";
 shared_ptr<LocIpcSender> LocIpc::getLocIpcQrtrSender(int service, int instance) {
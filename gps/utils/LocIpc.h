@@ -32,11 +32,13 @@
 
 #include <string>
 #include <memory>
+#include <vector>
 #include <unistd.h>
 #include <sys/socket.h>
 #include <sys/un.h>
 #include <unordered_set>
 #include <mutex>
+#include <atomic>
 #include <LocThread.h>
 
 using namespace std;
@@ -46,6 +48,8 @@ namespace loc_util {
 class LocIpcRecver;
 class LocIpcSender;
 class LocIpcRunnable;
+struct LocIpcReactorEntry;
+class LocIpcReactorListener;
 
 class ILocIpcListener {
 protected:
@@ -102,10 +106,26 @@ public:
             getLocIpcInetTcpSender(const char* serverName, int32_t port);
     static shared_ptr<LocIpcSender>
             getLocIpcQrtrSender(int service, int instance);
+    // Local sender / recver that carry each msg, of any size, as one frame
+    // over a stream connection. Either end also works with a peer from
+    // getLocIpcLocalSender() / getLocIpcLocalRecver(), over datagrams.
+    static shared_ptr<LocIpcSender>
+            getLocIpcLocalFramedSender(const char* localSockName);
+    // Local sender / recver that pass msgs through a shared memory ring per
+    // sender, with no syscall per msg while the recver keeps up. Either end
+    // falls back to datagrams, and works with the getLocIpcLocal*() peers.
+    static shared_ptr<LocIpcSender>
+            getLocIpcShmSender(const char* localSockName);
 
     static unique_ptr<LocIpcRecver>
             getLocIpcLocalRecver(const shared_ptr<ILocIpcListener>& listener,
                                  const char* localSockName);
+    static unique_ptr<LocIpcRecver>
+            getLocIpcLocalFramedRecver(const shared_ptr<ILocIpcListener>& listener,
+                                       const char* localSockName);
+    static unique_ptr<LocIpcRecver>
+            getLocIpcShmRecver(const shared_ptr<ILocIpcListener>& listener,
+                               const char* localSockName);
     static unique_ptr<LocIpcRecver>
             getLocIpcInetUdpRecver(const shared_ptr<ILocIpcListener>& listener,
                                  const char* serverName, int32_t port);
@@ -154,6 +174,58 @@ private:
     LocIpcRunnable *mRunnable;
 };
 
+// Listens for msgs of any number of recvers in one thread, on one epoll
+// loop, where LocIpc::startNonBlockingListening() takes a thread each.
+class LocIpcReactor {
+public:
+    struct RecverStats {
+        string name;
+        // msgs handed to the listener, and wakeups of the loop for them
+        uint64_t msgs;
+        uint64_t wakeups;
+    };
+
+    LocIpcReactor();
+    // stops the loop, and frees the recvers
+    virtual ~LocIpcReactor();
+
+    // Create the LocThread that runs the loop. Recvers can be added
+    // before or after.
+    bool start(const char* threadName = "LocIpcReactor");
+    // Make a recver as the LocIpc::getLocIpc*Recver() factories do, and
+    // listen for its msgs till the reactor stops.
+    bool addLocalRecver(const shared_ptr<ILocIpcListener>& listener,
+                        const char* localSockName);
+    bool addLocalFramedRecver(const shared_ptr<ILocIpcListener>& listener,
+                              const char* localSockName);
+    bool addShmRecver(const shared_ptr<ILocIpcListener>& listener,
+                      const char* localSockName);
+    bool addInetUdpRecver(const shared_ptr<ILocIpcListener>& listener,
+                          const char* serverName, int32_t port);
+    // Takes over ipcRecver and listens for its msgs till it is aborted,
+    // e.g. by LocIpc::stopBlockingListening(), or its peer goes away.
+    // pollFd has to turn readable when ipcRecver has a msg to take in, so
+    // its recv() does not block for long. Its msgs go to its listener
+    // directly, and are not counted in the stats.
+    bool addRecver(unique_ptr<LocIpcRecver>& ipcRecver, int pollFd);
+    // Wakes up the loop through an eventfd, joins the thread, and frees
+    // the recvers.
+    void stop();
+    void getStats(vector<RecverStats>& stats) const;
+
+private:
+    friend class LocIpcReactorRunnable;
+    int mEpollFd;
+    int mAbortFd;
+    LocThread mThread;
+    mutable mutex mMutex;
+    vector<unique_ptr<LocIpcReactorEntry>> mEntries;
+    bool addRecver(unique_ptr<LocIpcRecver>& ipcRecver, int pollFd,
+                   const shared_ptr<LocIpcReactorListener>& counter);
+    // waits for, and dispatches, one round of events; false once aborted
+    bool runOnce();
+};
+
 /* this is only when client needs to implement Sender / Recver that are not already provided by
    the factor methods prvoided by LocIpc. */
 
@@ -195,6 +267,31 @@ public:
     virtual const char* getName() const = 0;
 };
 
+// max datagrams a LocIpcRecvBuffer takes in with one recvmmsg()
+#define LOC_IPC_RECV_BATCH_SIZE 8
+
+// Receive buffer kept by a recver across recv() calls, so receiving does
+// not allocate. Has room for up to batchSize datagrams of a Sock's max size,
+// each followed by a '\0', and for reassembling $MSGLEN$ long messages.
+// ILocIpcListener::onReceive() gets pointers into it, valid during the call.
+class LocIpcRecvBuffer {
+    friend class Sock;
+    const uint32_t mBatchSize;
+    uint32_t mSlotSize;
+    unique_ptr<char[]> mSlots;
+    unique_ptr<struct mmsghdr[]> mMsgs;
+    unique_ptr<struct iovec[]> mIovs;
+    unique_ptr<struct sockaddr_storage[]> mAddrs;
+    vector<char> mLongMsg;
+    // sizes the slots for datagrams of up to maxTxSize, on first use only
+    void prepare(uint32_t maxTxSize);
+    inline char* getSlot(uint32_t index) { return mSlots.get() + (size_t)index * mSlotSize; }
+public:
+    // batchSize > 1 only makes sense for datagram sockets
+    inline LocIpcRecvBuffer(uint32_t batchSize = LOC_IPC_RECV_BATCH_SIZE) :
+            mBatchSize((0 == batchSize) ? 1 : batchSize), mSlotSize(0) {}
+};
+
 class Sock {
     static const char MSG_ABORT[];
     static const char LOC_IPC_HEAD[];
@@ -202,7 +299,11 @@ class Sock {
     ssize_t sendto(const void *buf, size_t len, int flags, const struct sockaddr *destAddr,
                    socklen_t addrlen) const;
     ssize_t recvfrom(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb,
-                     int sid, int flags, struct sockaddr *srcAddr, socklen_t *addrlen) const;
+                     LocIpcRecvBuffer& recvBuf, int sid, int flags,
+                     struct sockaddr *srcAddr, socklen_t *addrlen) const;
+    ssize_t recvLongMsg(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb,
+                        LocIpcRecvBuffer& recvBuf, const char* head, uint32_t& next,
+                        uint32_t received, int sid, int flags) const;
 public:
     int mSid;
     inline Sock(int sid, const uint32_t maxTxSize = 8192) : mMaxTxSize(maxTxSize), mSid(sid) {}
@@ -212,6 +313,12 @@ public:
                  socklen_t addrlen) const;
     ssize_t recv(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb, int flags,
                  struct sockaddr *srcAddr, socklen_t *addrlen, int sid = -1) const;
+    // same as above, but receives into, and reuses, recvBuf; on datagram
+    // sockets it takes in up to its batch size of datagrams per syscall.
+    // srcAddr is updated to the source of each msg before its onReceive().
+    ssize_t recv(const LocIpcRecver& recver, const shared_ptr<ILocIpcListener>& dataCb,
+                 LocIpcRecvBuffer& recvBuf, int flags,
+                 struct sockaddr *srcAddr, socklen_t *addrlen, int sid = -1) const;
     ssize_t sendAbort(int flags, const struct sockaddr *destAddr, socklen_t addrlen);
     inline void close() {
         if (isValid()) {
@@ -223,14 +330,16 @@ public:
 
 class SockRecver : public LocIpcRecver {
     shared_ptr<Sock> mSock;
+    // type of mSock is not known here, so one msg per syscall
+    mutable LocIpcRecvBuffer mRecvBuf;
 protected:
     inline virtual ssize_t recv() const override {
-        return mSock->recv(*this, mDataCb, 0, nullptr, nullptr);
+        return mSock->recv(*this, mDataCb, mRecvBuf, 0, nullptr, nullptr);
     }
 public:
     inline SockRecver(const shared_ptr<ILocIpcListener>& listener,
                   LocIpcSender& sender, shared_ptr<Sock> sock) :
-            LocIpcRecver(listener, sender), mSock(sock) {
+            LocIpcRecver(listener, sender), mSock(sock), mRecvBuf(1) {
     }
     inline virtual const char* getName() const override {
         return "SockRecver";
@@ -34,6 +34,9 @@
 #include <errno.h>
 #include <sys/timerfd.h>
 #include <sys/epoll.h>
+#include <atomic>
+#include <mutex>
+#include <sstream>
 #include <log_util.h>
 #include <loc_timer.h>
 #include <LocTimer.h>
@@ -41,6 +44,7 @@
 #include <LocThread.h>
 #include <LocSharedLock.h>
 #include <MsgTask.h>
+#include <LogBuffer.h>
 
 #ifdef __HOST_UNIT_TEST__
 #define EPOLLWAKEUP 0
@@ -83,6 +87,9 @@ LocTimerWrapper - a LocTimer client itself, to implement the existing C API with
 
 class LocTimerPollTask;
 
+// max timers taken out of the heap at once, ahead of their deadline
+#define LOC_TIMER_MAX_COALESCED 16
+
 // This is a multi-functaional class that:
 // * extends the LocHeap class for the detection of head update upon add / remove
 //   events. When that happens, soonest time out changes, so timerfd needs update.
@@ -104,6 +111,13 @@ class LocTimerContainer : public LocHeap {
     static LocTimerPollTask* mPollTask;
     // timer / alarm fd
     int mDevFd;
+    // start of the window of every timer with slack, soonest on top
+    LocHeap mStarts;
+    // expiration stats, updated in the MsgTask context
+    std::atomic<uint64_t> mWakeups;
+    std::atomic<uint64_t> mExpired;
+    std::atomic<uint64_t> mCoalesced;
+    std::atomic<uint32_t> mMaxExpiredPerWakeup;
     // ctor
     LocTimerContainer(bool wakeOnExpire);
     // dtor
@@ -114,6 +128,10 @@ class LocTimerContainer : public LocHeap {
     LocTimerDelegate* popIfOutRanks(LocTimerDelegate& timer);
     // update the timer POSIX calls with updated soonest timer spec
     void updateSoonestTime(LocTimerDelegate* priorTop);
+    // remove the timers not due yet, but whose slack window has started
+    uint32_t popStarted(struct timespec& now, LocTimerDelegate** timers, uint32_t maxCount);
+    // LogBuffer dump hook, logs the expiration stats of both containers
+    static void dumpExpireStats(const std::function<void(std::stringstream&)>& log);
 
 public:
     // factory method to control the creation of mSwTimers / mHwTimers
@@ -127,6 +145,8 @@ public:
     void remove(LocTimerDelegate& timer);
     // handling of timer / alarm expiration
     void expire();
+    // returns false if the container for wakeOnExpire was never created
+    static bool getExpireStats(bool wakeOnExpire, LocTimerExpireStats& stats);
 };
 
 // This class implements the polling thread that epolls imer / alarm fds.
@@ -169,30 +189,68 @@ public:
     virtual bool run();
 };
 
+// Start of the window of a LocTimerDelegate with slack. It is ranked by
+// LocTimerDelegate::mFutureTime in the container's mStarts heap, so the
+// timers that may already fire are found without a walk over all timers.
+class LocTimerWindowStart : public LocRankable {
+public:
+    LocTimerDelegate& mTimer;
+    inline LocTimerWindowStart(LocTimerDelegate& timer) : mTimer(timer) {}
+    // LocRankable virtual method
+    virtual int ranks(LocRankable& rankable);
+};
+
 // Internal class of timer obj. It gets born when client calls LocTimer::start();
 // and gets deleted when client calls LocTimer::stop() or when the it expire()'s.
 // This class implements LocRankable::ranks() so that when an obj is added into
 // the container (of LocHeap), it gets placed in sorted order.
+// A timer may fire anywhere in [mFutureTime, mDeadline]. It is ranked by
+// mDeadline, which is what the container arms the kernel timer with; when
+// that fires, every timer whose window has started by then fires with it.
 class LocTimerDelegate : public LocRankable {
     friend class LocTimerContainer;
     friend class LocTimer;
+    friend class LocTimerWindowStart;
     LocTimer* mClient;
     LocSharedLock* mLock;
     struct timespec mFutureTime;
+    struct timespec mDeadline;
+    LocTimerWindowStart mStart;
     LocTimerContainer* mContainer;
     // not a complete obj, just ctor for LocRankable comparisons
     inline LocTimerDelegate(struct timespec& delay)
-        : mClient(NULL), mLock(NULL), mFutureTime(delay), mContainer(NULL) {}
+        : mClient(NULL), mLock(NULL), mFutureTime(delay), mDeadline(delay),
+          mStart(*this), mContainer(NULL) {}
     inline ~LocTimerDelegate() { if (mLock) { mLock->drop(); mLock = NULL; } }
 public:
-    LocTimerDelegate(LocTimer& client, struct timespec& futureTime, LocTimerContainer* container);
+    LocTimerDelegate(LocTimer& client, struct timespec& futureTime,
+                     struct timespec& deadline, LocTimerContainer* container);
     void destroyLocked();
     // LocRankable virtual method
     virtual int ranks(LocRankable& rankable);
     void expire();
     inline struct timespec getFutureTime() { return mFutureTime; }
+    inline struct timespec getDeadline() { return mDeadline; }
+    inline bool hasSlack() {
+        return mDeadline.tv_sec != mFutureTime.tv_sec ||
+               mDeadline.tv_nsec != mFutureTime.tv_nsec;
+    }
 };
 
+static inline bool isNotAfter(const struct timespec& time, const struct timespec& ref) {
+    return (time.tv_sec < ref.tv_sec) ||
+           (time.tv_sec == ref.tv_sec && time.tv_nsec <= ref.tv_nsec);
+}
+
+static inline void addMs(struct timespec& time, uint32_t ms) {
+    time.tv_sec += ms / 1000;
+    time.tv_nsec += (ms % 1000) * 1000000;
+    if (time.tv_nsec >= 1000000000) {
+        time.tv_sec += time.tv_nsec / 1000000000;
+        time.tv_nsec %= 1000000000;
+    }
+}
+
 /***************************LocTimerContainer methods***************************/
 
 // Most of these static recources are created on demand. They however are never
@@ -210,7 +268,8 @@ LocTimerPollTask* LocTimerContainer::mPollTask = NULL;
 // A container for swTimer (timer) is created, when wakeOnExpire is true; or
 // HwTimer (alarm), when wakeOnExpire is false.
 LocTimerContainer::LocTimerContainer(bool wakeOnExpire) :
-    mDevFd(timerfd_create(wakeOnExpire ? CLOCK_BOOTTIME_ALARM : CLOCK_BOOTTIME, 0)) {
+    mDevFd(timerfd_create(wakeOnExpire ? CLOCK_BOOTTIME_ALARM : CLOCK_BOOTTIME, 0)),
+    mWakeups(0), mExpired(0), mCoalesced(0), mMaxExpiredPerWakeup(0) {
 
     if ((-1 == mDevFd) && (errno == EINVAL)) {
         LOC_LOGW("%s: timerfd_create failure, fallback to CLOCK_MONOTONIC - %s",
@@ -247,6 +306,11 @@ LocTimerContainer* LocTimerContainer::get(bool wakeOnExpire) {
             if (-1 == container->getTimerFd()) {
                 delete container;
                 container = NULL;
+            } else {
+                static std::once_flag sDumpHookOnce;
+                std::call_once(sDumpHookOnce, []() {
+                    loc_util::LogBuffer::registerDumpHook(&LocTimerContainer::dumpExpireStats);
+                });
             }
         }
         pthread_mutex_unlock(&mMutex);
@@ -299,7 +363,7 @@ void LocTimerContainer::updateSoonestTime(LocTimerDelegate* priorTop) {
             // do this first to avoid race condition, in case settime is called
             // with too small an interval
             mPollTask->addPoll(*this);
-            delay.it_value = curTop->getFutureTime();
+            delay.it_value = curTop->getDeadline();
             toSetTime = true;
         }
         if (toSetTime) {
@@ -313,13 +377,15 @@ inline
 void LocTimerContainer::add(LocTimerDelegate& timer) {
     struct MsgTimerPush : public LocMsg {
         LocTimerContainer* mTimerContainer;
-        LocHeapNode* mTree;
         LocTimerDelegate* mTimer;
         inline MsgTimerPush(LocTimerContainer& container, LocTimerDelegate& timer) :
             LocMsg(), mTimerContainer(&container), mTimer(&timer) {}
         inline virtual void proc() const {
             LocTimerDelegate* priorTop = mTimerContainer->getSoonestTimer();
             mTimerContainer->push((LocRankable&)(*mTimer));
+            if (mTimer->hasSlack()) {
+                mTimerContainer->mStarts.push(mTimer->mStart);
+            }
             mTimerContainer->updateSoonestTime(priorTop);
         }
     };
@@ -336,6 +402,7 @@ void LocTimerContainer::remove(LocTimerDelegate& timer) {
             LocMsg(), mTimerContainer(&container), mTimer(&timer) {}
         inline virtual void proc() const {
             LocTimerDelegate* priorTop = mTimerContainer->getSoonestTimer();
+            mTimerContainer->mStarts.remove(mTimer->mStart);
 
             // update soonest timer only if mTimer is actually removed from
             // mTimerContainer AND mTimer is not priorTop.
@@ -365,13 +432,33 @@ void LocTimerContainer::expire() {
             // get time spec of now
             clock_gettime(CLOCK_BOOTTIME, &now);
             LocTimerDelegate timerOfNow(now);
+            uint32_t expired = 0;
             // pop everything in the heap that outRanks now, i.e. has time older than now
             // and then call expire() on that timer.
             for (LocTimerDelegate* timer = (LocTimerDelegate*)mTimerContainer->pop();
                  NULL != timer;
                  timer = mTimerContainer->popIfOutRanks(timerOfNow)) {
+                mTimerContainer->mStarts.remove(timer->mStart);
                 // the timer delegate obj will be deleted before the return of this call
                 timer->expire();
+                expired++;
+            }
+            // then whatever is not due yet, but may fire now, to save it a wakeup
+            LocTimerDelegate* started[LOC_TIMER_MAX_COALESCED];
+            uint32_t coalesced = 0;
+            do {
+                coalesced = mTimerContainer->popStarted(now, started, LOC_TIMER_MAX_COALESCED);
+                for (uint32_t i = 0; i < coalesced; i++) {
+                    started[i]->expire();
+                }
+                expired += coalesced;
+                mTimerContainer->mCoalesced += coalesced;
+            } while (LOC_TIMER_MAX_COALESCED == coalesced);
+
+            mTimerContainer->mWakeups++;
+            mTimerContainer->mExpired += expired;
+            if (expired > mTimerContainer->mMaxExpiredPerWakeup) {
+                mTimerContainer->mMaxExpiredPerWakeup = expired;
             }
             mTimerContainer->updateSoonestTime(NULL);
         }
@@ -384,9 +471,53 @@ void LocTimerContainer::expire() {
     mMsgTask->sendMsg(new MsgTimerExpire(*this));
 }
 
+// Collects up to maxCount timers whose window has started by now and takes
+// them out of the heap, before any of them is expired, as expire() may
+// lead the client to start timers again.
+uint32_t LocTimerContainer::popStarted(struct timespec& now,
+                                       LocTimerDelegate** timers, uint32_t maxCount) {
+    uint32_t count = 0;
+    for (LocTimerWindowStart* start = (LocTimerWindowStart*)mStarts.peek();
+         NULL != start && count < maxCount &&
+                 isNotAfter(start->mTimer.mFutureTime, now);
+         start = (LocTimerWindowStart*)mStarts.peek()) {
+        mStarts.pop();
+        LocHeap::remove(start->mTimer);
+        timers[count++] = &start->mTimer;
+    }
+    return count;
+}
+
+// no LOC_LOG* in here, LogBuffer::dump() may be what calls this
+void LocTimerContainer::dumpExpireStats(const std::function<void(std::stringstream&)>& log) {
+    for (bool wakeOnExpire : {true, false}) {
+        LocTimerExpireStats stats;
+        if (getExpireStats(wakeOnExpire, stats)) {
+            std::stringstream ss;
+            ss << "LocTimer " << (wakeOnExpire ? "alarms" : "timers")
+               << ": wakeups " << stats.wakeups << ", expired " << stats.expired
+               << ", coalesced " << stats.coalesced
+               << ", max expired per wakeup " << stats.maxExpiredPerWakeup << std::endl;
+            log(ss);
+        }
+    }
+}
+
+bool LocTimerContainer::getExpireStats(bool wakeOnExpire, LocTimerExpireStats& stats) {
+    LocTimerContainer* container = wakeOnExpire ? mHwTimers : mSwTimers;
+    memset(&stats, 0, sizeof(stats));
+    if (NULL != container) {
+        stats.wakeups = container->mWakeups;
+        stats.expired = container->mExpired;
+        stats.coalesced = container->mCoalesced;
+        stats.maxExpiredPerWakeup = container->mMaxExpiredPerWakeup;
+    }
+    return (NULL != container);
+}
+
 LocTimerDelegate* LocTimerContainer::popIfOutRanks(LocTimerDelegate& timer) {
     LocTimerDelegate* poppedNode = NULL;
-    if (mTree && !timer.outRanks(*peek())) {
+    if (mSize > 0 && !timer.outRanks(*peek())) {
         poppedNode = (LocTimerDelegate*)(pop());
     }
 
@@ -478,10 +609,13 @@ bool LocTimerPollTask::run() {
 inline
 LocTimerDelegate::LocTimerDelegate(LocTimer& client,
                                    struct timespec& futureTime,
+                                   struct timespec& deadline,
                                    LocTimerContainer* container)
     : mClient(&client),
       mLock(mClient->mLock->share()),
       mFutureTime(futureTime),
+      mDeadline(deadline),
+      mStart(*this),
       mContainer(container) {
     // adding the timer into the container
     mContainer->add(*this);
@@ -512,16 +646,26 @@ int LocTimerDelegate::ranks(LocRankable& rankable) {
     if (timer) {
         // larger time ranks lower!!!
         // IOW, if input obj has bigger tv_sec/tv_nsec, this obj outRanks higher
-        rank = timer->mFutureTime.tv_sec - mFutureTime.tv_sec;
+        rank = timer->mDeadline.tv_sec - mDeadline.tv_sec;
         if(0 == rank)
         {
             //rank against tv_nsec for msec accuracy
-            rank = (int)(timer->mFutureTime.tv_nsec - mFutureTime.tv_nsec);
+            rank = (int)(timer->mDeadline.tv_nsec - mDeadline.tv_nsec);
         }
     }
     return rank;
 }
 
+int LocTimerWindowStart::ranks(LocRankable& rankable) {
+    LocTimerWindowStart* start = (LocTimerWindowStart*)(&rankable);
+    // earlier window start ranks higher
+    int rank = start->mTimer.mFutureTime.tv_sec - mTimer.mFutureTime.tv_sec;
+    if (0 == rank) {
+        rank = (int)(start->mTimer.mFutureTime.tv_nsec - mTimer.mFutureTime.tv_nsec);
+    }
+    return rank;
+}
+
 inline
 void LocTimerDelegate::expire() {
     // keeping a copy of client pointer to be safe
@@ -551,22 +695,23 @@ LocTimer::~LocTimer() {
 }
 
 bool LocTimer::start(unsigned int timeOutInMs, bool wakeOnExpire) {
+    return start(timeOutInMs, wakeOnExpire, 0);
+}
+
+bool LocTimer::start(unsigned int timeOutInMs, bool wakeOnExpire, uint32_t slackInMs) {
     bool success = false;
     mLock->lock();
     if (!mTimer) {
         struct timespec futureTime;
         clock_gettime(CLOCK_BOOTTIME, &futureTime);
-        futureTime.tv_sec += timeOutInMs / 1000;
-        futureTime.tv_nsec += (timeOutInMs % 1000) * 1000000;
-        if (futureTime.tv_nsec >= 1000000000) {
-            futureTime.tv_sec += futureTime.tv_nsec / 1000000000;
-            futureTime.tv_nsec %= 1000000000;
-        }
+        addMs(futureTime, timeOutInMs);
+        struct timespec deadline = futureTime;
+        addMs(deadline, slackInMs);
 
         LocTimerContainer* container;
         container = LocTimerContainer::get(wakeOnExpire);
         if (NULL != container) {
-            mTimer = new LocTimerDelegate(*this, futureTime, container);
+            mTimer = new LocTimerDelegate(*this, futureTime, deadline, container);
             // if mTimer is non 0, success should be 0; or vice versa
         }
         success = (NULL != mTimer);
@@ -575,6 +720,10 @@ bool LocTimer::start(unsigned int timeOutInMs, bool wakeOnExpire) {
     return success;
 }
 
+bool LocTimer::getExpireStats(bool wakeOnExpire, LocTimerExpireStats& stats) {
+    return LocTimerContainer::getExpireStats(wakeOnExpire, stats);
+}
+
 bool LocTimer::stop() {
     bool success = false;
     mLock->lock();
@@ -31,8 +31,22 @@
 #define __LOC_TIMER_CPP_H__
 
 #include <stddef.h>
+#include <stdint.h>
 #include <loc_pla.h>
 
+// expirations of the timers in one container, i.e. the wake on expire
+// (alarm) ones or the others, see LocTimer::getExpireStats()
+struct LocTimerExpireStats {
+    // timerfd expirations handled
+    uint64_t wakeups;
+    // timers fired by them
+    uint64_t expired;
+    // timers fired ahead of their deadline, within their slack, to share
+    // a wakeup with another timer
+    uint64_t coalesced;
+    uint32_t maxExpiredPerWakeup;
+};
+
 // opaque class to provide service implementation.
 class LocTimerDelegate;
 class LocSharedLock;
@@ -61,6 +75,18 @@ public:
     //               false on failure, e.g. timer is already running.
     bool start(uint32_t timeOutInMs, bool wakeOnExpire);
 
+    // Same as above, but the timer may fire up to slackInMs later than
+    // timeOutInMs. Timers whose [timeOut, timeOut + slack] windows overlap
+    // fire together, on one wakeup, at the earliest deadline among them.
+    // A slackInMs of 0 is the same as start(timeOutInMs, wakeOnExpire).
+    // Slack only saves wakeups for wakeOnExpire timers; a non wake timer
+    // already waits for the CPU to be up, so slack just makes it later.
+    bool start(uint32_t timeOutInMs, bool wakeOnExpire, uint32_t slackInMs);
+
+    // fills stats of the container of wakeOnExpire timers, or the other one
+    // return:       false if no timer of the kind has ever been started.
+    static bool getExpireStats(bool wakeOnExpire, LocTimerExpireStats& stats);
+
     // return:       true on success;
     //               false on failure, e.g. timer is not running.
     bool stop();
@@ -29,6 +29,9 @@
 #ifndef __LOC_UNORDERDED_SETMAP_H__
 #define __LOC_UNORDERDED_SETMAP_H__
 
+#include <stdint.h>
+#include <iterator>
+#include <initializer_list>
 #include <algorithm>
 #include <loc_pla.h>
 
@@ -45,6 +48,152 @@ using std::unordered_map;
 
 namespace loc_util {
 
+// Set of values of a small dense enum type T, all of them in [0, N), kept as
+// a fixed bitset. Has the subset of the unordered_set interface used with
+// LocUnorderedSetMap, plus word level union, intersection and difference.
+template <typename T, size_t N>
+class LocBitSet {
+    static const size_t kWords = (N + 63) / 64;
+    uint64_t mWords[kWords];
+
+    static inline bool inRange(T val) { return (size_t)val < N; }
+
+public:
+    typedef T value_type;
+
+    class const_iterator {
+        const LocBitSet* mSet;
+        size_t mPos;
+    public:
+        typedef std::forward_iterator_tag iterator_category;
+        typedef T value_type;
+        typedef ptrdiff_t difference_type;
+        typedef const T* pointer;
+        typedef T reference;
+
+        inline const_iterator(const LocBitSet* set, size_t pos) :
+                mSet(set), mPos(set->next(pos)) {}
+        inline T operator*() const { return (T)mPos; }
+        inline const_iterator& operator++() {
+            mPos = mSet->next(mPos + 1);
+            return *this;
+        }
+        inline const_iterator operator++(int) {
+            const_iterator old(*this);
+            ++(*this);
+            return old;
+        }
+        inline bool operator==(const const_iterator& other) const { return mPos == other.mPos; }
+        inline bool operator!=(const const_iterator& other) const { return mPos != other.mPos; }
+    };
+    typedef const_iterator iterator;
+
+    inline LocBitSet() : mWords() {}
+    inline LocBitSet(std::initializer_list<T> vals) : LocBitSet() {
+        for (auto val : vals) {
+            insert(val);
+        }
+    }
+
+    // first value at or after pos, or N if there is none
+    size_t next(size_t pos) const {
+        for (size_t w = pos / 64; pos < N; w++, pos = w * 64) {
+            uint64_t bits = mWords[w] & (~0ULL << (pos % 64));
+            if (0 != bits) {
+                return std::min(N, w * 64 + __builtin_ctzll(bits));
+            }
+        }
+        return N;
+    }
+    inline const_iterator begin() const { return const_iterator(this, 0); }
+    inline const_iterator end() const { return const_iterator(this, N); }
+
+    inline bool empty() const {
+        for (size_t w = 0; w < kWords; w++) {
+            if (0 != mWords[w]) {
+                return false;
+            }
+        }
+        return true;
+    }
+    inline size_t size() const {
+        size_t count = 0;
+        for (size_t w = 0; w < kWords; w++) {
+            count += __builtin_popcountll(mWords[w]);
+        }
+        return count;
+    }
+    inline void clear() {
+        for (size_t w = 0; w < kWords; w++) {
+            mWords[w] = 0;
+        }
+    }
+    inline size_t count(T val) const {
+        return (inRange(val) && (mWords[val / 64] & (1ULL << (val % 64)))) ? 1 : 0;
+    }
+    // returns true if val was not in the set yet; out of range values are dropped
+    inline bool insert(T val) {
+        if (!inRange(val) || count(val)) {
+            return false;
+        }
+        mWords[val / 64] |= (1ULL << (val % 64));
+        return true;
+    }
+    // the hint is ignored, this is for std::inserter and the like
+    inline const_iterator insert(const_iterator /*hint*/, T val) {
+        insert(val);
+        return const_iterator(this, val);
+    }
+    inline size_t erase(T val) {
+        size_t erased = count(val);
+        if (erased) {
+            mWords[val / 64] &= ~(1ULL << (val % 64));
+        }
+        return erased;
+    }
+
+    inline LocBitSet& operator|=(const LocBitSet& other) {
+        for (size_t w = 0; w < kWords; w++) {
+            mWords[w] |= other.mWords[w];
+        }
+        return *this;
+    }
+    inline LocBitSet& operator&=(const LocBitSet& other) {
+        for (size_t w = 0; w < kWords; w++) {
+            mWords[w] &= other.mWords[w];
+        }
+        return *this;
+    }
+    inline LocBitSet& operator-=(const LocBitSet& other) {
+        for (size_t w = 0; w < kWords; w++) {
+            mWords[w] &= ~other.mWords[w];
+        }
+        return *this;
+    }
+    inline LocBitSet operator|(const LocBitSet& other) const { return LocBitSet(*this) |= other; }
+    inline LocBitSet operator&(const LocBitSet& other) const { return LocBitSet(*this) &= other; }
+    inline LocBitSet operator-(const LocBitSet& other) const { return LocBitSet(*this) -= other; }
+    inline bool operator==(const LocBitSet& other) const {
+        return std::equal(mWords, mWords + kWords, other.mWords);
+    }
+    inline bool operator!=(const LocBitSet& other) const { return !(*this == other); }
+};
+
+// The set type LocUnorderedSetMap keeps for a KEY or VAL parameter. A plain
+// type T is kept in unordered_set<T>; passing LocBitSet<T, N> instead keeps
+// T values in that bitset.
+template <typename T>
+struct LocSetOf {
+    typedef T value_type;
+    typedef unordered_set<T> type;
+};
+
+template <typename T, size_t N>
+struct LocSetOf<LocBitSet<T, N>> {
+    typedef T value_type;
+    typedef LocBitSet<T, N> type;
+};
+
 // Trim from *fromSet* any elements that also exist in *rVals*.
 // The optional *goneVals*, if not null, will be populated with removed elements.
 template <typename T>
@@ -57,35 +206,72 @@ inline static void trimSet(unordered_set<T>& fromSet, const unordered_set<T>& rV
     }
 }
 
+template <typename T, size_t N>
+inline static void trimSet(LocBitSet<T, N>& fromSet, const LocBitSet<T, N>& rVals,
+                           LocBitSet<T, N>* goneVals) {
+    if (nullptr != goneVals) {
+        *goneVals |= (fromSet & rVals);
+    }
+    fromSet -= rVals;
+}
+
+// Add all of *newVals* to *toSet*.
+template <typename T>
+inline static void addSet(unordered_set<T>& toSet, const unordered_set<T>& newVals) {
+    toSet.insert(newVals.begin(), newVals.end());
+}
+
+template <typename T, size_t N>
+inline static void addSet(LocBitSet<T, N>& toSet, const LocBitSet<T, N>& newVals) {
+    toSet |= newVals;
+}
+
 // this method is destructive to the input unordered_sets.
 // the return set is the interset extracted out from the two input sets, *s1* and *s2*.
 // *s1* and *s2* will be left with the intersect removed from them.
 template <typename T>
 static unordered_set<T> removeAndReturnInterset(unordered_set<T>& s1, unordered_set<T>& s2) {
     unordered_set<T> common = {};
-    for (auto b = s2.begin(); b != s2.end(); b++) {
-        auto a = find(s1.begin(), s1.end(), *b);
-        if (a != s1.end()) {
+    for (auto b = s2.begin(); b != s2.end(); ) {
+        if (s1.erase(*b) > 0) {
             // this is a common item of both l1 and l2, remove from both
             // but after we add to common
-            common.insert(*a);
-            s1.erase(a);
-            s2.erase(b);
+            common.insert(*b);
+            b = s2.erase(b);
+        } else {
+            b++;
         }
     }
     return common;
 }
 
+template <typename T, size_t N>
+static LocBitSet<T, N> removeAndReturnInterset(LocBitSet<T, N>& s1, LocBitSet<T, N>& s2) {
+    LocBitSet<T, N> common = s1 & s2;
+    s1 -= common;
+    s2 -= common;
+    return common;
+}
+
+// KEY and VAL can each be a LocBitSet<T, N>, for a small dense enum type T,
+// to have the sets of that side kept as bitsets; see LocSetOf.
 template <typename KEY, typename VAL>
 class LocUnorderedSetMap {
-    unordered_map<KEY, unordered_set<VAL>> mMap;
+public:
+    typedef typename LocSetOf<KEY>::value_type Key;
+    typedef typename LocSetOf<KEY>::type KeySet;
+    typedef typename LocSetOf<VAL>::value_type Val;
+    typedef typename LocSetOf<VAL>::type ValSet;
+
+private:
+    unordered_map<Key, ValSet> mMap;
 
     // Trim the VALs pointed to by *iter*, with everything that also exist in *rVals*.
     // If the set becomes empty, remove the map entry. *goneVals*, if not null, records
     // the trimmed VALs.
-    bool trimOrRemove(typename unordered_map<KEY, unordered_set<VAL>>::iterator iter,
-                      const unordered_set<VAL>& rVals, unordered_set<VAL>* goneVals) {
-        trimSet<VAL>(iter->second, rVals, goneVals);
+    bool trimOrRemove(typename unordered_map<Key, ValSet>::iterator iter,
+                      const ValSet& rVals, ValSet* goneVals) {
+        trimSet(iter->second, rVals, goneVals);
         bool removeEntry = (iter->second.empty());
         if (removeEntry) {
             mMap.erase(iter);
@@ -96,35 +282,35 @@ class LocUnorderedSetMap {
 public:
     inline LocUnorderedSetMap() {}
     inline LocUnorderedSetMap(size_t size) : LocUnorderedSetMap() {
-        mMap.get_allocator().allocate(size);
+        mMap.reserve(size);
     }
 
     inline bool empty() { return mMap.empty(); }
 
     // This gets the raw pointer to the VALs pointed to by *key*
     // If the entry is not in the map, nullptr will be returned.
-    inline unordered_set<VAL>* getValSetPtr(const KEY& key) {
+    inline ValSet* getValSetPtr(const Key& key) {
         auto entry = mMap.find(key);
         return (entry != mMap.end()) ? &(entry->second) : nullptr;
     }
 
     //  This gets a copy of VALs pointed to by *key*
     // If the entry is not in the map, an empty set will be returned.
-    inline unordered_set<VAL> getValSet(const KEY& key) {
+    inline ValSet getValSet(const Key& key) {
         auto entry = mMap.find(key);
-        return (entry != mMap.end()) ? entry->second : unordered_set<VAL>{};
+        return (entry != mMap.end()) ? entry->second : ValSet{};
     }
 
     // This gets all the KEYs from the map
-    inline unordered_set<KEY> getKeys() {
-        unordered_set<KEY> keys = {};
-        for (auto entry : mMap) {
+    inline KeySet getKeys() {
+        KeySet keys = {};
+        for (auto& entry : mMap) {
             keys.insert(entry.first);
         }
         return keys;
     }
 
-    inline bool remove(const KEY& key) {
+    inline bool remove(const Key& key) {
         return mMap.erase(key) > 0;
     }
 
@@ -132,29 +318,29 @@ public:
     // that also exist in *rVals*. If the entry is left with an empty set, the entry will
     // be removed. The optional parameters *goneKeys* and *goneVals* will record the KEYs
     // (or entries) and the collapsed VALs removed from the map, respectively.
-    inline void trimOrRemove(unordered_set<KEY>&& keys, const unordered_set<VAL>& rVals,
-                             unordered_set<KEY>* goneKeys, unordered_set<VAL>* goneVals) {
+    inline void trimOrRemove(KeySet&& keys, const ValSet& rVals,
+                             KeySet* goneKeys, ValSet* goneVals) {
         trimOrRemove(keys, rVals, goneKeys, goneVals);
     }
 
-    inline void trimOrRemove(unordered_set<KEY>& keys, const unordered_set<VAL>& rVals,
-                             unordered_set<KEY>* goneKeys, unordered_set<VAL>* goneVals) {
+    inline void trimOrRemove(KeySet& keys, const ValSet& rVals,
+                             KeySet* goneKeys, ValSet* goneVals) {
         for (auto key : keys) {
             auto iter = mMap.find(key);
             if (iter != mMap.end() && trimOrRemove(iter, rVals, goneVals) && nullptr != goneKeys) {
-                goneKeys->insert(iter->first);
+                goneKeys->insert(key);
             }
         }
     }
 
     // This adds all VALs from *newVals* to the map entry keyed by *key*. Or if it
     // doesn't exist yet, add the set to the map.
-    bool add(const KEY& key, const unordered_set<VAL>& newVals) {
+    bool add(const Key& key, const ValSet& newVals) {
         bool newEntryAdded = false;
         if (!newVals.empty()) {
             auto iter = mMap.find(key);
             if (iter != mMap.end()) {
-                iter->second.insert(newVals.begin(), newVals.end());
+                addSet(iter->second, newVals);
             } else {
                 mMap[key] = newVals;
                 newEntryAdded = true;
@@ -166,13 +352,11 @@ public:
     // This adds to each of entries in the map keyed by *keys* with the VALs in the
     // *enwVals*. If there new entries added (new key in *keys*), *newKeys*, if not
     // null, would be populated with those keys.
-    inline void add(const unordered_set<KEY>& keys, const unordered_set<VAL>&& newVals,
-                    unordered_set<KEY>* newKeys) {
+    inline void add(const KeySet& keys, const ValSet&& newVals, KeySet* newKeys) {
         add(keys, newVals, newKeys);
     }
 
-    inline void add(const unordered_set<KEY>& keys, const unordered_set<VAL>& newVals,
-                    unordered_set<KEY>* newKeys) {
+    inline void add(const KeySet& keys, const ValSet& newVals, KeySet* newKeys) {
         for (auto key : keys) {
             if (add(key, newVals) && nullptr != newKeys) {
                 newKeys->insert(key);
@@ -183,14 +367,15 @@ public:
     // This puts *newVals* into the map keyed by *key*, and returns the VALs that are
     // in effect removed from the keyed VAL set in the map entry.
     // This call would also remove those same VALs from *newVals*.
-    inline unordered_set<VAL> update(const KEY& key, unordered_set<VAL>& newVals) {
-        unordered_set<VAL> goneVals = {};
+    inline ValSet update(const Key& key, ValSet& newVals) {
+        ValSet goneVals = {};
         if (newVals.empty()) {
             mMap.erase(key);
         } else {
-            auto curVals = mMap[key];
+            goneVals = mMap[key];
             mMap[key] = newVals;
-            goneVals = removeAndReturnInterset(curVals, newVals);
+            // what is left of the current VALs is gone, what is left of newVals is new
+            removeAndReturnInterset(goneVals, newVals);
         }
         return goneVals;
     }
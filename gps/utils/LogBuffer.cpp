@@ -28,6 +28,8 @@
  */
 
 #include "LogBuffer.h"
+#include <fcntl.h>
+#include <unistd.h>
 #ifdef USE_GLIB
 #include <execinfo.h>
 #endif
@@ -43,6 +45,7 @@ LogBuffer* LogBuffer::mInstance;
 struct sigaction LogBuffer::mOriSigAction[NSIG];
 struct sigaction LogBuffer::mNewSigAction;
 mutex LogBuffer::sLock;
+vector<LogBuffer::DumpHook> LogBuffer::sDumpHooks;
 
 LogBuffer* LogBuffer::getInstance() {
     if (mInstance == nullptr) {
@@ -54,9 +57,11 @@ LogBuffer* LogBuffer::getInstance() {
     return mInstance;
 }
 
-LogBuffer::LogBuffer(): mLogList(TOTAL_LOG_LEVELS),
+LogBuffer::LogBuffer():
         mConfigVec(TOTAL_LOG_LEVELS, ConfigsInLevel(TIME_DEPTH_THRESHOLD_MINIMAL_IN_SEC,
-                    MAXIMUM_NUM_IN_LIST, 0)) {
+                    MAXIMUM_NUM_IN_LIST)), mNumRecords(0), mOrder(0), mDumpDirFd(-1),
+        mCrashDumping(false) {
+    uint32_t sizeInKb = LOG_BUFFER_DEFAULT_SIZE_KB;
     loc_param_s_type log_buff_config_table[] =
     {
         {"E_LEVEL_TIME_DEPTH",      &mConfigVec[0].mTimeDepthThres,  NULL, 'n'},
@@ -69,47 +74,293 @@ LogBuffer::LogBuffer(): mLogList(TOTAL_LOG_LEVELS),
         {"D_LEVEL_MAX_CAPACITY",    &mConfigVec[3].mMaxNumThres,     NULL, 'n'},
         {"V_LEVEL_TIME_DEPTH",      &mConfigVec[4].mTimeDepthThres,  NULL, 'n'},
         {"V_LEVEL_MAX_CAPACITY",    &mConfigVec[4].mMaxNumThres,     NULL, 'n'},
+        {"LOG_BUFFER_SIZE_KB",      &sizeInKb,                       NULL, 'n'},
     };
     loc_read_conf(LOC_PATH_GPS_CONF_STR, log_buff_config_table,
             sizeof(log_buff_config_table)/sizeof(log_buff_config_table[0]));
+
+    // all records are allocated here, scaled down per level if the
+    // capacities add up to more than the size
+    uint64_t totalNum = 0;
+    for (auto& config : mConfigVec) {
+        totalNum += config.mMaxNumThres;
+    }
+    uint64_t budgetNum = (uint64_t)sizeInKb * 1024 / sizeof(LogRecord);
+    uint32_t allocated = 0;
+    for (int level = 0; level < TOTAL_LOG_LEVELS; level++) {
+        uint64_t num = mConfigVec[level].mMaxNumThres;
+        if (totalNum > budgetNum && num > 0) {
+            num = max((uint64_t)1, num * budgetNum / totalNum);
+        }
+        mRings[level].mCapacity = num;
+        allocated += num;
+    }
+    mRecords.reset(new LogRecord[allocated]);
+    mNumRecords = allocated;
+    LogRecord* records = mRecords.get();
+    for (int level = 0; level < TOTAL_LOG_LEVELS; level++) {
+        mRings[level].mRecords = records;
+        for (uint32_t i = 0; i < mRings[level].mCapacity; i++) {
+            records[i].mSeq.store(0, memory_order_relaxed);
+        }
+        records += mRings[level].mCapacity;
+    }
+    mDumpDirFd = open(LOG_BUFFER_FILE_PATH, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (mDumpDirFd < 0) {
+        ALOGE("no crash dump, failed to open %s: %s", LOG_BUFFER_FILE_PATH, strerror(errno));
+    }
+    sem_init(&mLiveDumpSem, 0, 0);
     registerSignalHandler();
 }
 
-void LogBuffer::append(string& data, int level, uint64_t timestamp) {
-    lock_guard<mutex> guard(mLock);
-    pair<uint64_t, string> item(timestamp, data);
-    mLogList.append(item, level);
-    mConfigVec[level].mCurrentSize++;
+void LogBuffer::registerDumpHook(const DumpHook& hook) {
+    lock_guard<mutex> guard(sLock);
+    sDumpHooks.push_back(hook);
+}
+
+LogRecord* LogBuffer::claim(int level, uint64_t& index) {
+    if (level < 0 || level >= TOTAL_LOG_LEVELS || 0 == mRings[level].mCapacity) {
+        return nullptr;
+    }
+    LogRing& ring = mRings[level];
+    index = ring.mNext.fetch_add(1, memory_order_relaxed);
+    LogRecord& record = ring.mRecords[index % ring.mCapacity];
+    uint64_t seq = record.mSeq.load(memory_order_relaxed);
+    do {
+        if (seq >= 2 * (index + 1)) {
+            // a later line already took the record over, this one is dropped
+            return nullptr;
+        }
+        if (seq & 1) {
+            // the line a lap before is still being written
+            this_thread::yield();
+            seq = record.mSeq.load(memory_order_relaxed);
+            continue;
+        }
+    } while (!record.mSeq.compare_exchange_weak(seq, 2 * index + 1, memory_order_acquire));
+    record.mOrder = mOrder.fetch_add(1, memory_order_relaxed);
+    return &record;
+}
+
+void LogBuffer::append(const char* data, size_t len, int level, uint64_t timestamp) {
+    uint64_t index;
+    LogRecord* record = claim(level, index);
+    if (nullptr == record) {
+        return;
+    }
+    record->mTimestamp = timestamp;
+    record->mLen = min(len, sizeof(record->mText));
+    memcpy(record->mText, data, record->mLen);
+    publish(record, index);
+}
+
+// Copies the args format takes into out, strings included, as
+// logFormatArgs() reads them back. False if they do not fit, or if format
+// has a conversion logFormatArgs() does not take.
+static bool captureArgs(const char* format, va_list args, char* out, size_t size,
+                        size_t& len) {
+    len = 0;
+    for (const char* p = format; '\0' != *p; p++) {
+        if ('%' != *p) {
+            continue;
+        }
+        LogFormatSpec spec;
+        logParseSpec(p, spec);
+        p += spec.len - 1;
+        if (LOG_ARG_NONE == spec.type) {
+            continue;
+        }
+        int32_t star;
+        int precision = spec.precision;
+        if (spec.starWidth) {
+            star = va_arg(args, int);
+            if (len + sizeof(star) > size) {
+                return false;
+            }
+            memcpy(out + len, &star, sizeof(star));
+            len += sizeof(star);
+        }
+        if (spec.starPrecision) {
+            star = va_arg(args, int);
+            if (len + sizeof(star) > size) {
+                return false;
+            }
+            memcpy(out + len, &star, sizeof(star));
+            len += sizeof(star);
+            precision = star;
+        }
+        uint64_t value;
+        switch (spec.type) {
+        case LOG_ARG_INT: {
+            int32_t intValue = va_arg(args, int);
+            if (len + sizeof(intValue) > size) {
+                return false;
+            }
+            memcpy(out + len, &intValue, sizeof(intValue));
+            len += sizeof(intValue);
+            continue;
+        }
+        case LOG_ARG_STRING: {
+            const char* str = va_arg(args, const char*);
+            if (nullptr == str) {
+                str = "(null)";
+            }
+            size_t strLen = (precision >= 0) ? strnlen(str, precision) : strlen(str);
+            if (len + strLen + 1 > size) {
+                return false;
+            }
+            memcpy(out + len, str, strLen);
+            out[len + strLen] = '\0';
+            len += strLen + 1;
+            continue;
+        }
+        case LOG_ARG_LONG:
+            value = (uint64_t)(int64_t)va_arg(args, long);
+            break;
+        case LOG_ARG_LONG_LONG:
+            value = (uint64_t)va_arg(args, long long);
+            break;
+        case LOG_ARG_POINTER:
+            value = (uint64_t)(uintptr_t)va_arg(args, void*);
+            break;
+        case LOG_ARG_DOUBLE: {
+            double d = spec.longDouble ? (double)va_arg(args, long double) :
+                    va_arg(args, double);
+            memcpy(&value, &d, sizeof(value));
+            break;
+        }
+        default:
+            return false;
+        }
+        if (len + sizeof(value) > size) {
+            return false;
+        }
+        memcpy(out + len, &value, sizeof(value));
+        len += sizeof(value);
+    }
+    return true;
+}
 
-    while ((timestamp - mLogList.front(level).first) > mConfigVec[level].mTimeDepthThres ||
-            mConfigVec[level].mCurrentSize > mConfigVec[level].mMaxNumThres) {
-        mLogList.pop(level);
-        mConfigVec[level].mCurrentSize--;
+void LogBuffer::appendArgs(int level, uint64_t timestamp, int32_t tid, const char* tag,
+                           const char* format, va_list args) {
+    uint64_t index;
+    LogRecord* record = claim(level, index);
+    if (nullptr == record) {
+        return;
     }
+    LogRecordHead head;
+    head.tag = (uintptr_t)tag;
+    head.format = (uintptr_t)format;
+    head.tid = tid;
+    memcpy(record->mText, &head, sizeof(head));
+    char* body = record->mText + sizeof(head);
+    size_t size = sizeof(record->mText) - sizeof(head);
+    size_t len = 0;
+    uint32_t flags = LOG_RECORD_ARGS;
+    va_list copy;
+    va_copy(copy, args);
+    if (!captureArgs(format, args, body, size, len)) {
+        // formatted here then, cut off at what the record holds
+        int n = vsnprintf(body, size, format, copy);
+        len = (n < 0) ? 0 : min((size_t)n, size - 1);
+        flags = LOG_RECORD_MESSAGE;
+    }
+    va_end(copy);
+    record->mTimestamp = timestamp;
+    record->mLen = (sizeof(head) + len) | flags;
+    publish(record, index);
 }
 
 //Dump the log buffer of specific level, level = -1 to dump all the levels in log buffer.
 void LogBuffer::dump(std::function<void(stringstream&)> log, int level) {
-    lock_guard<mutex> guard(mLock);
-    list<pair<pair<uint64_t, string>, int>> li;
-    if (-1 == level) {
-        li = mLogList.dump();
-    } else {
-        li = mLogList.dump(level);
+    struct Line {
+        uint64_t order;
+        uint64_t timestamp;
+        int level;
+        string text;
+    };
+    vector<Line> li;
+    int pid = getpid();
+    timespec tv;
+    clock_gettime(CLOCK_REALTIME, &tv);
+    int64_t realtimeOffsetNs = (int64_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+    clock_gettime(CLOCK_BOOTTIME, &tv);
+    realtimeOffsetNs -= (int64_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+    for (int l = 0; l < TOTAL_LOG_LEVELS; l++) {
+        if (-1 != level && l != level) {
+            continue;
+        }
+        LogRing& ring = mRings[l];
+        uint64_t next = ring.mNext.load(memory_order_acquire);
+        uint64_t first = max(ring.mFlushed.load(memory_order_relaxed),
+                             (next > ring.mCapacity) ? next - ring.mCapacity : 0);
+        size_t levelStart = li.size();
+        uint64_t newest = 0;
+        for (uint64_t index = first; index < next; index++) {
+            LogRecord& record = ring.mRecords[index % ring.mCapacity];
+            Line line;
+            uint64_t seq = record.mSeq.load(memory_order_acquire);
+            if (seq != 2 * (index + 1)) {
+                // being written, or already overwritten
+                continue;
+            }
+            line.order = record.mOrder;
+            line.timestamp = record.mTimestamp;
+            line.level = l;
+            uint32_t len = record.mLen;
+            line.text.assign(record.mText,
+                             min((size_t)(len & LOG_RECORD_LEN_MASK), sizeof(record.mText)));
+            atomic_thread_fence(memory_order_acquire);
+            if (record.mSeq.load(memory_order_relaxed) != seq) {
+                continue;
+            }
+            if (len & (LOG_RECORD_ARGS | LOG_RECORD_MESSAGE)) {
+                // binary record, formatted now
+                LogRecordHead head;
+                memcpy(&head, line.text.data(), sizeof(head));
+                char text[LOGGING_BUFFER_MAX_LEN];
+                size_t textLen = logFormatRecord(line.text.data(), len, line.timestamp,
+                        (const char*)(uintptr_t)head.tag,
+                        (const char*)(uintptr_t)head.format, pid, realtimeOffsetNs,
+                        text, sizeof(text));
+                line.text.assign(text, textLen);
+            }
+            newest = max(newest, line.timestamp);
+            li.push_back(move(line));
+        }
+        // lines older than the time depth, counting from the newest line of
+        // the level, are out
+        uint64_t depth = (uint64_t)mConfigVec[l].mTimeDepthThres * 1000000000;
+        li.erase(remove_if(li.begin() + levelStart, li.end(), [&](const Line& line) {
+                    return newest - line.timestamp > depth;
+                }), li.end());
     }
+    sort(li.begin(), li.end(), [](const Line& a, const Line& b) { return a.order < b.order; });
+
     ALOGE("Begining of dump, buffer size: %d", (int)li.size());
     stringstream ln;
     ln << "dump log buffer, level[" << level << "]" << ", buffer size: " << li.size() << endl;
     log(ln);
-    for_each (li.begin(), li.end(), [&, this](const pair<pair<uint64_t, string>, int> &item){
+    for_each (li.begin(), li.end(), [&, this](const Line& item){
         stringstream line;
-        line << "["<<item.first.first << "] ";
-        line << "Level " << mLevelMap[item.second] << ": ";
-        line << item.first.second << endl;
+        line << "["<<item.timestamp / 1000000000 << "] ";
+        line << "Level " << mLevelMap[item.level] << ": ";
+        line << item.text << endl;
         if (log != nullptr) {
             log(line);
         }
     });
+
+    vector<DumpHook> hooks;
+    {
+        lock_guard<mutex> hooksGuard(sLock);
+        hooks = sDumpHooks;
+    }
+    for (auto& hook : hooks) {
+        if (log != nullptr) {
+            hook(log);
+        }
+    }
     ALOGE("End of dump");
 }
 
@@ -130,59 +381,208 @@ void LogBuffer::dumpToLogFile(string filePath) {
 }
 
 void LogBuffer::flush() {
-    mLogList.flush();
+    for (auto& ring : mRings) {
+        ring.mFlushed.store(ring.mNext.load(memory_order_relaxed), memory_order_relaxed);
+    }
+}
+
+// async signal safe helpers for dumpRaw()
+static void writeAll(int fd, const void* data, size_t len) {
+    const char* p = (const char*)data;
+    while (len > 0) {
+        ssize_t written = write(fd, p, len);
+        if (written < 0 && EINTR == errno) {
+            continue;
+        } else if (written <= 0) {
+            return;
+        }
+        p += written;
+        len -= written;
+    }
+}
+
+static void appendStr(char* buf, size_t size, size_t& len, const char* str) {
+    while (*str && len + 1 < size) {
+        buf[len++] = *str++;
+    }
+    buf[len] = 0;
+}
+
+static void appendDec(char* buf, size_t size, size_t& len, uint64_t value) {
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0 && n < (int)sizeof(digits));
+    while (n > 0 && len + 1 < size) {
+        buf[len++] = digits[--n];
+    }
+    buf[len] = 0;
+}
+
+// async signal safe: writes the tag and format strings of the binary
+// records, once each as long as the table of the ones written holds them
+void LogBuffer::dumpRawStrings(int fd) {
+    uint64_t written[LOG_BUFFER_DUMP_STRING_SLOTS] = {};
+    for (uint32_t i = 0; i < mNumRecords; i++) {
+        LogRecord& record = mRecords[i];
+        uint64_t seq = record.mSeq.load(memory_order_acquire);
+        uint32_t len = record.mLen;
+        if ((seq & 1) || 0 == seq || !(len & (LOG_RECORD_ARGS | LOG_RECORD_MESSAGE))) {
+            continue;
+        }
+        LogRecordHead head;
+        memcpy(&head, record.mText, sizeof(head));
+        atomic_thread_fence(memory_order_acquire);
+        if (record.mSeq.load(memory_order_relaxed) != seq) {
+            continue;
+        }
+        uint64_t addresses[] = {head.tag, (len & LOG_RECORD_ARGS) ? head.format : 0};
+        for (uint64_t address : addresses) {
+            if (0 == address) {
+                continue;
+            }
+            uint32_t slot = (address >> 3) % LOG_BUFFER_DUMP_STRING_SLOTS;
+            uint32_t probes = 0;
+            while (0 != written[slot] && address != written[slot] &&
+                   probes++ < LOG_BUFFER_DUMP_STRING_SLOTS) {
+                slot = (slot + 1) % LOG_BUFFER_DUMP_STRING_SLOTS;
+            }
+            if (address == written[slot]) {
+                continue;
+            }
+            if (0 == written[slot]) {
+                written[slot] = address;
+            }
+            const char* str = (const char*)(uintptr_t)address;
+            LogBufferDumpString entry;
+            entry.address = address;
+            entry.len = strnlen(str, LOGGING_BUFFER_MAX_LEN);
+            entry.reserved = 0;
+            writeAll(fd, &entry, sizeof(entry));
+            writeAll(fd, str, entry.len);
+        }
+    }
+    LogBufferDumpString end;
+    memset(&end, 0, sizeof(end));
+    writeAll(fd, &end, sizeof(end));
+}
+
+void LogBuffer::dumpRaw(int code) {
+    if (mDumpDirFd < 0) {
+        return;
+    }
+    LogBufferDumpHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, LOG_BUFFER_DUMP_MAGIC, sizeof(LOG_BUFFER_DUMP_MAGIC));
+    header.version = LOG_BUFFER_DUMP_VERSION;
+    header.recordSize = sizeof(LogRecord);
+    header.numLevels = TOTAL_LOG_LEVELS;
+    header.pid = getpid();
+    header.signal = code;
+    timespec tv;
+    clock_gettime(CLOCK_REALTIME, &tv);
+    header.realtimeSec = tv.tv_sec;
+    header.realtimeOffsetNs = (int64_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+    clock_gettime(CLOCK_BOOTTIME, &tv);
+    header.boottimeSec = tv.tv_sec;
+    header.realtimeOffsetNs -= (int64_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+    for (int level = 0; level < TOTAL_LOG_LEVELS; level++) {
+        header.levels[level].capacity = mRings[level].mCapacity;
+        header.levels[level].timeDepth = mConfigVec[level].mTimeDepthThres;
+        header.levels[level].next = mRings[level].mNext.load(memory_order_relaxed);
+        header.levels[level].flushed = mRings[level].mFlushed.load(memory_order_relaxed);
+    }
+
+    char name[64];
+    size_t len = 0;
+    appendStr(name, sizeof(name), len, "gpslog_crash_");
+    appendDec(name, sizeof(name), len, header.pid);
+    appendStr(name, sizeof(name), len, "_");
+    appendDec(name, sizeof(name), len, header.realtimeSec);
+    appendStr(name, sizeof(name), len, ".bin");
+    int fd = openat(mDumpDirFd, name, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0640);
+    if (fd < 0) {
+        return;
+    }
+    writeAll(fd, &header, sizeof(header));
+    // records being written show up torn, the decoder skips them
+    writeAll(fd, mRecords.get(), sizeof(LogRecord) * mNumRecords);
+    dumpRawStrings(fd);
+#ifdef USE_GLIB
+    void *buffer[100];
+    int nptrs = backtrace(buffer, sizeof(buffer)/sizeof(*buffer));
+    backtrace_symbols_fd(buffer, nptrs, fd);
+#endif
+    close(fd);
+}
+
+void LogBuffer::runLiveDumps() {
+    while (true) {
+        if (sem_wait(&mLiveDumpSem) < 0) {
+            continue;
+        }
+        //Dump the log buffer to adb logcat
+        dumpToAdbLogcat();
+
+        //Dump the log buffer to file
+        time_t now = time(NULL);
+        struct tm curr_time;
+        localtime_r(&now, &curr_time);
+        char path[50];
+        snprintf(path, 50, LOG_BUFFER_FILE_PATH "gpslog_%d%d%d-%d%d%d.log",
+                (1900 + curr_time.tm_year), ( 1 + curr_time.tm_mon), curr_time.tm_mday,
+                curr_time.tm_hour, curr_time.tm_min, curr_time.tm_sec);
+        dumpToLogFile(path);
+    }
 }
 
 void LogBuffer::registerSignalHandler() {
     ALOGE("Singal handler registered");
+#ifdef USE_GLIB
+    // the first backtrace() may load libgcc, which is not safe in a handler
+    void *buffer[1];
+    backtrace(buffer, 1);
+#endif
+    // SIGUSR1 dumps are formatted here, so the handler only posts, and the
+    // logging threads go on while the rings are read
+    thread([this] { runLiveDumps(); }).detach();
+
     mNewSigAction.sa_sigaction = &LogBuffer::signalHandler;
     mNewSigAction.sa_flags = SA_SIGINFO | SA_RESTART;
     sigemptyset(&mNewSigAction.sa_mask);
 
     sigaction(SIGINT, &mNewSigAction, &mOriSigAction[SIGINT]);
-    sigaction(SIGKILL, &mNewSigAction, &mOriSigAction[SIGKILL]);
     sigaction(SIGSEGV, &mNewSigAction, &mOriSigAction[SIGSEGV]);
     sigaction(SIGABRT, &mNewSigAction, &mOriSigAction[SIGABRT]);
     sigaction(SIGTRAP, &mNewSigAction, &mOriSigAction[SIGTRAP]);
     sigaction(SIGUSR1, &mNewSigAction, &mOriSigAction[SIGUSR1]);
 }
 
+// No locks, allocation or stdio in here, it runs on crashes, where any of
+// those may be held or broken.
 void LogBuffer::signalHandler(const int code, siginfo_t *const si, void *const sc) {
-    ALOGE("[Gnss Log buffer]Singal handler, signal ID: %d", code);
-
-#ifdef USE_GLIB
-    int nptrs;
-    void *buffer[100];
-    char **strings;
-
-    nptrs = backtrace(buffer, sizeof(buffer)/sizeof(*buffer));
-    strings = backtrace_symbols(buffer, nptrs);
-    if (strings != NULL) {
-        timespec tv;
-        clock_gettime(CLOCK_BOOTTIME, &tv);
-        uint64_t elapsedTime = (uint64_t)tv.tv_sec + (uint64_t)tv.tv_nsec/1000000000;
-        for (int i = 0; i < nptrs; i++) {
-            string s(strings[i]);
-            mInstance->append(s, 0, elapsedTime);
+    if (SIGUSR1 == code) {
+        //Process won't be terminated if SIGUSR1 is recieved
+        if (nullptr != mInstance) {
+            sem_post(&mInstance->mLiveDumpSem);
         }
+        return;
     }
-#endif
-    //Dump the log buffer to adb logcat
-    mInstance->dumpToAdbLogcat();
-
-    //Dump the log buffer to file
-    time_t now = time(NULL);
-    struct tm *curr_time = localtime(&now);
-    char path[50];
-    snprintf(path, 50, LOG_BUFFER_FILE_PATH "gpslog_%d%d%d-%d%d%d.log",
-            (1900 + curr_time->tm_year), ( 1 + curr_time->tm_mon), curr_time->tm_mday,
-            curr_time->tm_hour, curr_time->tm_min, curr_time->tm_sec);
-
-    mInstance->dumpToLogFile(path);
-
-    //Process won't be terminated if SIGUSR1 is recieved
-    if (code != SIGUSR1) {
-        mOriSigAction[code].sa_sigaction(code, si, sc);
+    if (nullptr != mInstance && !mInstance->mCrashDumping.exchange(true)) {
+        mInstance->dumpRaw(code);
+    }
+
+    // hand the signal on, to the handler before ours, or the default action
+    struct sigaction& oriAction = mOriSigAction[code];
+    if ((oriAction.sa_flags & SA_SIGINFO) && nullptr != oriAction.sa_sigaction) {
+        oriAction.sa_sigaction(code, si, sc);
+    } else if (SIG_IGN != oriAction.sa_handler && SIG_DFL != oriAction.sa_handler) {
+        oriAction.sa_handler(code);
+    } else if (SIG_DFL == oriAction.sa_handler) {
+        sigaction(code, &oriAction, nullptr);
+        raise(code);
     }
 }
 
@@ -32,6 +32,7 @@
 
 #include "SkipList.h"
 #include "log_util.h"
+#include "LogBufferDump.h"
 #include <loc_cfg.h>
 #include <loc_pla.h>
 #include <string>
@@ -39,15 +40,27 @@
 #include <ostream>
 #include <fstream>
 #include <time.h>
+#include <stdarg.h>
 #include <mutex>
 #include <signal.h>
+#include <semaphore.h>
 #include <thread>
 #include <functional>
+#include <atomic>
+#include <vector>
+#include <memory>
+#include <algorithm>
+
+using namespace std;
 
 //default error level time depth threshold,
 #define TIME_DEPTH_THRESHOLD_MINIMAL_IN_SEC 60
 //default maximum log buffer size
 #define MAXIMUM_NUM_IN_LIST 50
+//default memory for all records of all levels, in KB
+#define LOG_BUFFER_DEFAULT_SIZE_KB 512
+//slots of the table of strings already in a crash dump
+#define LOG_BUFFER_DUMP_STRING_SLOTS 512
 //file path of dumped log buffer
 #define LOG_BUFFER_FILE_PATH "/data/vendor/location/"
 
@@ -57,36 +70,79 @@ class ConfigsInLevel{
 public:
     uint32_t mTimeDepthThres;
     uint32_t mMaxNumThres;
-    int mCurrentSize;
 
-    ConfigsInLevel(uint32_t time, int num, int size):
-        mTimeDepthThres(time), mMaxNumThres(num), mCurrentSize(size) {}
+    ConfigsInLevel(uint32_t time, int num):
+        mTimeDepthThres(time), mMaxNumThres(num) {}
+};
+
+// Fixed ring of records of one level. Appending takes the next index with
+// one atomic add, and overwrites the oldest record, so there is no lock
+// and no allocation.
+class LogRing {
+public:
+    LogRecord* mRecords;
+    uint32_t mCapacity;
+    atomic<uint64_t> mNext;
+    // records below this index were flushed
+    atomic<uint64_t> mFlushed;
+
+    LogRing(): mRecords(nullptr), mCapacity(0), mNext(0), mFlushed(0) {}
 };
 
 class LogBuffer {
+public:
+    // dumps extra state into the sink it is given, e.g. MsgTask stats
+    typedef std::function<void(const std::function<void(stringstream&)>&)> DumpHook;
 private:
     static LogBuffer* mInstance;
     static struct sigaction mOriSigAction[NSIG];
     static struct sigaction mNewSigAction;
     static mutex sLock;
+    static vector<DumpHook> sDumpHooks;
 
-    SkipList<pair<uint64_t, string>> mLogList;
     vector<ConfigsInLevel> mConfigVec;
-    mutex mLock;
+    unique_ptr<LogRecord[]> mRecords;
+    uint32_t mNumRecords;
+    LogRing mRings[TOTAL_LOG_LEVELS];
+    atomic<uint64_t> mOrder;
+    // opened up front, so a crash dump only needs openat() and write()
+    int mDumpDirFd;
+    // posted by SIGUSR1, for the live dump thread
+    sem_t mLiveDumpSem;
+    atomic<bool> mCrashDumping;
 
     const vector<string> mLevelMap {"E", "W", "I", "D", "V"};
 
 public:
     static LogBuffer* getInstance();
-    void append(string& data, int level, uint64_t timestamp);
+    // hooks run at the end of every dump(), outside of the buffer lock
+    static void registerDumpHook(const DumpHook& hook);
+    void append(const char* data, size_t len, int level, uint64_t timestamp);
+    inline void append(string& data, int level, uint64_t timestamp) {
+        append(data.c_str(), data.length(), level, timestamp);
+    }
+    // binary mode: keeps the tag and format pointers, both must be
+    // literals, and the raw args. The line is formatted only when dumped.
+    void appendArgs(int level, uint64_t timestamp, int32_t tid, const char* tag,
+                    const char* format, va_list args);
     void dump(std::function<void(stringstream&)> log, int level = -1);
     void dumpToAdbLogcat();
     void dumpToLogFile(string filePath);
     void flush();
 private:
     LogBuffer();
+    // takes the next record of the level for writing, nullptr if none
+    LogRecord* claim(int level, uint64_t& index);
+    inline void publish(LogRecord* record, uint64_t index) {
+        record->mSeq.store(2 * (index + 1), memory_order_release);
+    }
     void registerSignalHandler();
     static void signalHandler(const int code, siginfo_t *const si, void *const sc);
+    // async signal safe: writes the raw records to a new file in
+    // LOG_BUFFER_FILE_PATH, for loc_logbuffer_decoder
+    void dumpRaw(int code);
+    void dumpRawStrings(int fd);
+    void runLiveDumps();
 
 };
 
@@ -0,0 +1,201 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// loc_logbuffer_decoder: turns a raw crash dump of the log buffer, a
+// gpslog_crash_<pid>_<time>.bin from LOG_BUFFER_FILE_PATH, into the text a
+// live dump of the buffer gives, followed by the backtrace, if any.
+//
+// usage: loc_logbuffer_decoder [-a] <dump file>
+//     -a  also print the lines older than the time depth of their level
+
+#include <stdio.h>
+#include <errno.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <algorithm>
+#include "LogBufferDump.h"
+
+using namespace std;
+using namespace loc_util;
+
+static const char* const sLevelNames[] = {"E", "W", "I", "D", "V"};
+
+struct DecodedLine {
+    uint64_t order;
+    uint64_t timestamp;
+    uint32_t level;
+    uint32_t len;
+    string text;
+};
+
+int main(int argc, char** argv) {
+    bool all = false;
+    const char* path = nullptr;
+    for (int i = 1; i < argc; i++) {
+        if (0 == strcmp(argv[i], "-a")) {
+            all = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (nullptr == path) {
+        fprintf(stderr, "usage: %s [-a] <dump file>\n", argv[0]);
+        return 1;
+    }
+    FILE* file = fopen(path, "rb");
+    if (nullptr == file) {
+        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+        return 1;
+    }
+    vector<char> content;
+    char chunk[65536];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        content.insert(content.end(), chunk, chunk + n);
+    }
+    fclose(file);
+
+    LogBufferDumpHeader header;
+    if (content.size() < sizeof(header)) {
+        fprintf(stderr, "%s: too short for a log buffer dump\n", path);
+        return 1;
+    }
+    memcpy(&header, content.data(), sizeof(header));
+    if (0 != memcmp(header.magic, LOG_BUFFER_DUMP_MAGIC, sizeof(LOG_BUFFER_DUMP_MAGIC)) ||
+            LOG_BUFFER_DUMP_VERSION != header.version ||
+            sizeof(LogRecord) != header.recordSize ||
+            header.numLevels > LOG_BUFFER_DUMP_MAX_LEVELS) {
+        fprintf(stderr, "%s: not a log buffer dump this decoder knows\n", path);
+        return 1;
+    }
+    size_t numRecords = 0;
+    for (uint32_t level = 0; level < header.numLevels; level++) {
+        numRecords += header.levels[level].capacity;
+    }
+    size_t recordsEnd = sizeof(header) + numRecords * sizeof(LogRecord);
+    if (content.size() < recordsEnd) {
+        fprintf(stderr, "%s: truncated, %zu of %zu bytes\n", path, content.size(), recordsEnd);
+        return 1;
+    }
+
+    vector<DecodedLine> lines;
+    size_t torn = 0;
+    const char* records = content.data() + sizeof(header);
+    for (uint32_t level = 0; level < header.numLevels; level++) {
+        const LogBufferDumpLevel& info = header.levels[level];
+        uint64_t first = max(info.flushed, (info.next > info.capacity) ?
+                             info.next - info.capacity : (uint64_t)0);
+        size_t levelStart = lines.size();
+        uint64_t newest = 0;
+        for (uint64_t index = first; index < info.next; index++) {
+            LogRecord record;
+            memcpy((void*)&record, records + (index % info.capacity) * sizeof(LogRecord),
+                   sizeof(record));
+            if (record.mSeq.load() != 2 * (index + 1)) {
+                // was being written when the dump was taken
+                torn++;
+                continue;
+            }
+            DecodedLine line;
+            line.order = record.mOrder;
+            line.timestamp = record.mTimestamp;
+            line.level = level;
+            line.len = record.mLen;
+            line.text.assign(record.mText, min((size_t)(record.mLen & LOG_RECORD_LEN_MASK),
+                                               sizeof(record.mText)));
+            newest = max(newest, line.timestamp);
+            lines.push_back(line);
+        }
+        if (!all) {
+            lines.erase(remove_if(lines.begin() + levelStart, lines.end(),
+                                  [&](const DecodedLine& line) {
+                                      return newest - line.timestamp >
+                                              (uint64_t)info.timeDepth * 1000000000;
+                                  }), lines.end());
+        }
+        records += info.capacity * sizeof(LogRecord);
+    }
+    sort(lines.begin(), lines.end(), [](const DecodedLine& a, const DecodedLine& b) {
+        return a.order < b.order;
+    });
+
+    // the tag and format strings of the binary records
+    unordered_map<uint64_t, string> strings;
+    size_t stringsEnd = recordsEnd;
+    while (stringsEnd + sizeof(LogBufferDumpString) <= content.size()) {
+        LogBufferDumpString entry;
+        memcpy(&entry, content.data() + stringsEnd, sizeof(entry));
+        stringsEnd += sizeof(entry);
+        if (0 == entry.address) {
+            break;
+        }
+        if (stringsEnd + entry.len > content.size()) {
+            fprintf(stderr, "%s: truncated strings\n", path);
+            stringsEnd = content.size();
+            break;
+        }
+        strings[entry.address].assign(content.data() + stringsEnd, entry.len);
+        stringsEnd += entry.len;
+    }
+    for (auto& line : lines) {
+        if (line.len & (LOG_RECORD_ARGS | LOG_RECORD_MESSAGE)) {
+            LogRecordHead head;
+            if (line.text.size() < sizeof(head)) {
+                continue;
+            }
+            memcpy(&head, line.text.data(), sizeof(head));
+            auto tag = strings.find(head.tag);
+            auto format = strings.find(head.format);
+            char text[1024];
+            size_t len = logFormatRecord(line.text.data(), line.len, line.timestamp,
+                    (strings.end() == tag) ? "?" : tag->second.c_str(),
+                    (strings.end() == format) ? nullptr : format->second.c_str(),
+                    header.pid, header.realtimeOffsetNs, text, sizeof(text));
+            line.text.assign(text, len);
+        }
+    }
+
+    printf("crash dump of pid %d on signal %d, at %lld (boot time %llu s)\n",
+           header.pid, header.signal, (long long)header.realtimeSec,
+           (unsigned long long)header.boottimeSec);
+    printf("dump log buffer, level[-1], buffer size: %zu, torn: %zu\n", lines.size(), torn);
+    for (auto& line : lines) {
+        const char* levelName = (line.level < sizeof(sLevelNames) / sizeof(sLevelNames[0])) ?
+                sLevelNames[line.level] : "?";
+        printf("[%llu] Level %s: %s\n", (unsigned long long)line.timestamp / 1000000000,
+               levelName, line.text.c_str());
+    }
+    if (content.size() > stringsEnd) {
+        printf("backtrace:\n");
+        fwrite(content.data() + stringsEnd, 1, content.size() - stringsEnd, stdout);
+    }
+    return 0;
+}
@@ -0,0 +1,342 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+#ifndef LOG_BUFFER_DUMP_H
+#define LOG_BUFFER_DUMP_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+
+// Layout of the log buffer records, and of the raw dump of them that
+// LogBuffer writes on a crash. Kept free of other loc headers so that the
+// decoder, loc_logbuffer_decoder, builds on its own.
+
+//bytes per record, lines longer than what a record holds are cut off
+#define LOG_BUFFER_RECORD_SIZE 256
+#define LOG_BUFFER_DUMP_MAGIC "LOCLOGB"
+#define LOG_BUFFER_DUMP_VERSION 2
+#define LOG_BUFFER_DUMP_MAX_LEVELS 8
+
+//flags in the high bits of LogRecord::mLen, the rest is the length
+#define LOG_RECORD_LEN_MASK 0x0000ffffu
+//mText is a LogRecordHead, then the arguments of the line, as
+//logFormatArgs() takes them
+#define LOG_RECORD_ARGS 0x80000000u
+//mText is a LogRecordHead, then the line, formatted when logged
+#define LOG_RECORD_MESSAGE 0x40000000u
+
+namespace loc_util {
+
+// A line in the buffer, mTimestamp is CLOCK_BOOTTIME in ns. mSeq is 2 * (index in its level + 1) once written,
+// and odd while being written, so dump() can tell a torn copy.
+struct LogRecord {
+    std::atomic<uint64_t> mSeq;
+    // order across all levels
+    uint64_t mOrder;
+    uint64_t mTimestamp;
+    uint32_t mLen;
+    char mText[LOG_BUFFER_RECORD_SIZE - 3 * sizeof(uint64_t) - sizeof(uint32_t)];
+};
+static_assert(sizeof(LogRecord) == LOG_BUFFER_RECORD_SIZE, "LogRecord is not packed");
+
+// Starts the text of a binary record. tag and format point to literals,
+// they are resolved only when the record is formatted.
+struct LogRecordHead {
+    uint64_t tag;
+    uint64_t format;
+    uint64_t tid;
+};
+
+enum LogArgType {
+    LOG_ARG_NONE,
+    LOG_ARG_INT,
+    LOG_ARG_LONG,
+    LOG_ARG_LONG_LONG,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER,
+    LOG_ARG_UNSUPPORTED
+};
+
+// A printf conversion, as far as the arguments it takes go
+struct LogFormatSpec {
+    // of the spec, from the '%' on
+    size_t len;
+    LogArgType type;
+    bool starWidth;
+    bool starPrecision;
+    // -1 if none or *
+    int precision;
+    bool longDouble;
+};
+
+// p points to a '%'
+inline void logParseSpec(const char* p, LogFormatSpec& spec) {
+    const char* s = p + 1;
+    spec.type = LOG_ARG_UNSUPPORTED;
+    spec.starWidth = false;
+    spec.starPrecision = false;
+    spec.precision = -1;
+    spec.longDouble = false;
+    while ('-' == *s || '+' == *s || ' ' == *s || '#' == *s || '0' == *s || '\'' == *s) {
+        s++;
+    }
+    if ('*' == *s) {
+        spec.starWidth = true;
+        s++;
+    } else {
+        while (*s >= '0' && *s <= '9') {
+            s++;
+        }
+    }
+    if ('.' == *s) {
+        s++;
+        if ('*' == *s) {
+            spec.starPrecision = true;
+            s++;
+        } else {
+            spec.precision = 0;
+            while (*s >= '0' && *s <= '9') {
+                spec.precision = spec.precision * 10 + (*s++ - '0');
+            }
+        }
+    }
+    // 'H' for hh, 'q' for ll
+    char length = 0;
+    if ('h' == *s || 'l' == *s) {
+        length = *s++;
+        if (length == *s) {
+            length = ('h' == length) ? 'H' : 'q';
+            s++;
+        }
+    } else if ('q' == *s || 'L' == *s || 'j' == *s || 'z' == *s || 't' == *s) {
+        length = *s++;
+    }
+    switch (*s) {
+    case '%':
+        spec.type = LOG_ARG_NONE;
+        break;
+    case 'd': case 'i': case 'u': case 'o': case 'x': case 'X': case 'c':
+        if (0 == length || 'h' == length || 'H' == length) {
+            spec.type = LOG_ARG_INT;
+        } else if ('l' == length && 'c' != *s) {
+            spec.type = LOG_ARG_LONG;
+        } else if ('z' == length || 't' == length) {
+            // size_t and ptrdiff_t are as wide as long
+            spec.type = LOG_ARG_LONG;
+        } else if ('q' == length || 'j' == length || 'L' == length) {
+            spec.type = LOG_ARG_LONG_LONG;
+        }
+        break;
+    case 'e': case 'E': case 'f': case 'F': case 'g': case 'G': case 'a': case 'A':
+        spec.type = LOG_ARG_DOUBLE;
+        spec.longDouble = ('L' == length);
+        break;
+    case 's':
+        if (0 == length) {
+            spec.type = LOG_ARG_STRING;
+        }
+        break;
+    case 'p':
+        spec.type = LOG_ARG_POINTER;
+        break;
+    default:
+        // %n, %m, wide chars
+        break;
+    }
+    spec.len = s - p + (('\0' != *s) ? 1 : 0);
+}
+
+// Formats the arguments a binary record took with format into out, the
+// way snprintf would have when the line was logged. Stops at whatever it
+// can not make sense of. Returns the length, out is always terminated.
+inline size_t logFormatArgs(const char* format, const char* args, size_t argsLen,
+                            char* out, size_t outSize) {
+    size_t len = 0;
+    size_t pos = 0;
+    const char* p = format;
+    if (0 == outSize) {
+        return 0;
+    }
+    while ('\0' != *p && len + 1 < outSize) {
+        if ('%' != *p) {
+            out[len++] = *p++;
+            continue;
+        }
+        LogFormatSpec spec;
+        logParseSpec(p, spec);
+        if (LOG_ARG_NONE == spec.type) {
+            out[len++] = '%';
+            p += spec.len;
+            continue;
+        }
+        if (LOG_ARG_UNSUPPORTED == spec.type || spec.len > 16) {
+            break;
+        }
+        // the spec, with * replaced by the value taken and L dropped, as
+        // long doubles are kept as doubles
+        char fmt[48];
+        size_t fmtLen = 0;
+        bool ok = true;
+        for (size_t i = 0; i < spec.len && ok; i++) {
+            if ('*' == p[i]) {
+                int32_t value;
+                if (pos + sizeof(value) > argsLen) {
+                    ok = false;
+                    break;
+                }
+                memcpy(&value, args + pos, sizeof(value));
+                pos += sizeof(value);
+                fmtLen += snprintf(fmt + fmtLen, sizeof(fmt) - fmtLen, "%d", (int)value);
+            } else if ('L' != p[i] || !spec.longDouble) {
+                fmt[fmtLen++] = p[i];
+            }
+        }
+        if (!ok || fmtLen >= sizeof(fmt)) {
+            break;
+        }
+        fmt[fmtLen] = '\0';
+        int n = -1;
+        if (LOG_ARG_INT == spec.type) {
+            int32_t value;
+            if (pos + sizeof(value) <= argsLen) {
+                memcpy(&value, args + pos, sizeof(value));
+                pos += sizeof(value);
+                n = snprintf(out + len, outSize - len, fmt, (int)value);
+            }
+        } else if (LOG_ARG_STRING == spec.type) {
+            size_t strLen = strnlen(args + pos, argsLen - pos);
+            if (pos + strLen < argsLen) {
+                n = snprintf(out + len, outSize - len, fmt, args + pos);
+                pos += strLen + 1;
+            }
+        } else {
+            uint64_t value;
+            if (pos + sizeof(value) <= argsLen) {
+                memcpy(&value, args + pos, sizeof(value));
+                pos += sizeof(value);
+                if (LOG_ARG_LONG == spec.type) {
+                    n = snprintf(out + len, outSize - len, fmt, (long)value);
+                } else if (LOG_ARG_LONG_LONG == spec.type) {
+                    n = snprintf(out + len, outSize - len, fmt, (long long)value);
+                } else if (LOG_ARG_POINTER == spec.type) {
+                    n = snprintf(out + len, outSize - len, fmt, (void*)(uintptr_t)value);
+                } else {
+                    double d;
+                    memcpy(&d, &value, sizeof(d));
+                    n = snprintf(out + len, outSize - len, fmt, d);
+                }
+            }
+        }
+        if (n < 0) {
+            break;
+        }
+        len += ((size_t)n < outSize - len) ? n : outSize - len - 1;
+        p += spec.len;
+    }
+    out[len] = '\0';
+    return len;
+}
+
+// Formats a binary record the way INSERT_BUFFER formats a line when
+// logged, "HH:MM:SS.uuuuuu pid tid tag :line". tag and format are what
+// the head points to, realtimeOffsetNs takes the boot time of the record
+// to wall time.
+inline size_t logFormatRecord(const char* text, uint32_t len, uint64_t timestamp,
+                              const char* tag, const char* format, int pid,
+                              int64_t realtimeOffsetNs, char* out, size_t outSize) {
+    LogRecordHead head;
+    uint32_t textLen = len & LOG_RECORD_LEN_MASK;
+    if (textLen < sizeof(head) || outSize == 0) {
+        return 0;
+    }
+    memcpy(&head, text, sizeof(head));
+    int64_t now = (int64_t)timestamp + realtimeOffsetNs;
+    time_t sec = now / 1000000000;
+    int n = snprintf(out, outSize, "%02d:%02d:%02d.%06d %d %d %s :",
+                     (int)(sec / 3600 % 24), (int)(sec % 3600 / 60), (int)(sec % 60),
+                     (int)(now % 1000000000 / 1000), pid, (int)head.tid,
+                     (nullptr == tag) ? "" : tag);
+    size_t outLen = (n < 0) ? 0 : (((size_t)n < outSize) ? n : outSize - 1);
+    const char* body = text + sizeof(head);
+    size_t bodyLen = textLen - sizeof(head);
+    if (len & LOG_RECORD_ARGS) {
+        if (nullptr == format) {
+            format = "<format unknown>";
+            bodyLen = 0;
+        }
+        outLen += logFormatArgs(format, body, bodyLen, out + outLen, outSize - outLen);
+    } else {
+        size_t copyLen = (bodyLen < outSize - outLen - 1) ? bodyLen : outSize - outLen - 1;
+        memcpy(out + outLen, body, copyLen);
+        outLen += copyLen;
+        out[outLen] = '\0';
+    }
+    return outLen;
+}
+
+struct LogBufferDumpLevel {
+    uint32_t capacity;
+    uint32_t timeDepth;
+    uint64_t next;
+    uint64_t flushed;
+};
+
+// A raw dump is this header, then the records of each level, capacity of
+// them per level, as they are in memory, then the tag and format strings
+// binary records point to, each a LogBufferDumpString and len bytes, up to
+// one with address 0, then backtrace text, if any, up to the end of the
+// file.
+struct LogBufferDumpHeader {
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint32_t numLevels;
+    int32_t pid;
+    int32_t signal;
+    uint32_t reserved;
+    int64_t realtimeSec;
+    uint64_t boottimeSec;
+    // CLOCK_REALTIME - CLOCK_BOOTTIME when dumped
+    int64_t realtimeOffsetNs;
+    LogBufferDumpLevel levels[LOG_BUFFER_DUMP_MAX_LEVELS];
+};
+
+struct LogBufferDumpString {
+    uint64_t address;
+    uint32_t len;
+    uint32_t reserved;
+};
+
+}
+
+#endif
@@ -30,19 +30,398 @@
 #define LOG_TAG "LocSvc_MsgTask"
 
 #include <unistd.h>
+#include <stddef.h>
+#include <inttypes.h>
+#include <string.h>
+#include <time.h>
+#include <dlfcn.h>
+#include <cxxabi.h>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <fstream>
+#ifdef __GXX_RTTI
+#include <typeinfo>
+#endif
 #include <MsgTask.h>
 #include <msg_q.h>
 #include <log_util.h>
 #include <loc_log.h>
 #include <loc_pla.h>
+#include <LogBuffer.h>
+
+static_assert(LOC_MSG_PRIORITY_MAX <= MSG_Q_MAX_LANES,
+              "msg_q does not have enough lanes for all LocMsgPriority");
+
+// LocMsgPool size classes: 64, 128, ... 64K bytes
+#define LOC_MSG_POOL_MIN_SHIFT 6
+#define LOC_MSG_POOL_NUM_CLASSES 11
+// free blocks a size class may keep around, at least LOC_MSG_POOL_MIN_CACHED
+#define LOC_MSG_POOL_MAX_CACHED_BYTES (256 * 1024)
+#define LOC_MSG_POOL_MIN_CACHED 4
+
+struct alignas(max_align_t) LocMsgPoolHeader {
+    uint32_t sizeClass;
+    LocMsgPoolHeader* next;
+};
+
+struct LocMsgPoolClass {
+    std::mutex lock;
+    LocMsgPoolHeader* freeList;
+    LocMsgPoolStats stats;
+};
+
+// the extra class at LOC_MSG_POOL_NUM_CLASSES tracks oversized blocks
+static LocMsgPoolClass sLocMsgPoolClasses[LOC_MSG_POOL_NUM_CLASSES + 1];
+
+static inline size_t locMsgPoolClassSize(uint32_t sizeClass) {
+    return (size_t)1 << (sizeClass + LOC_MSG_POOL_MIN_SHIFT);
+}
+
+static inline uint32_t locMsgPoolSizeClass(size_t size) {
+    uint32_t sizeClass = 0;
+    while (sizeClass < LOC_MSG_POOL_NUM_CLASSES && locMsgPoolClassSize(sizeClass) < size) {
+        sizeClass++;
+    }
+    return sizeClass;
+}
+
+static inline uint32_t locMsgPoolMaxCached(uint32_t sizeClass) {
+    uint32_t maxCached = LOC_MSG_POOL_MAX_CACHED_BYTES / locMsgPoolClassSize(sizeClass);
+    return (maxCached < LOC_MSG_POOL_MIN_CACHED) ? LOC_MSG_POOL_MIN_CACHED : maxCached;
+}
+
+// called with the class lock held
+static inline void locMsgPoolCountAlloc(LocMsgPoolStats& stats) {
+    stats.allocs++;
+    if (++stats.inUse > stats.highWater) {
+        stats.highWater = stats.inUse;
+    }
+}
+
+void* LocMsgPool::alloc(size_t size, bool nothrow) {
+    uint32_t sizeClass = locMsgPoolSizeClass(size);
+    LocMsgPoolClass& poolClass = sLocMsgPoolClasses[sizeClass];
+    LocMsgPoolHeader* block = nullptr;
+
+    if (sizeClass < LOC_MSG_POOL_NUM_CLASSES) {
+        std::lock_guard<std::mutex> guard(poolClass.lock);
+        block = poolClass.freeList;
+        if (nullptr != block) {
+            poolClass.freeList = block->next;
+            poolClass.stats.cached--;
+            locMsgPoolCountAlloc(poolClass.stats);
+            return block + 1;
+        }
+    }
+
+    size_t bytes = sizeof(LocMsgPoolHeader) +
+            ((sizeClass < LOC_MSG_POOL_NUM_CLASSES) ? locMsgPoolClassSize(sizeClass) : size);
+    block = (LocMsgPoolHeader*)(nothrow ? ::operator new(bytes, std::nothrow) :
+                                          ::operator new(bytes));
+    if (nullptr == block) {
+        LOC_LOGe("failed to allocate %zu bytes", bytes);
+        return nullptr;
+    }
+    block->sizeClass = sizeClass;
+
+    std::lock_guard<std::mutex> guard(poolClass.lock);
+    poolClass.stats.heapAllocs++;
+    locMsgPoolCountAlloc(poolClass.stats);
+    return block + 1;
+}
+
+void LocMsgPool::free(void* ptr) {
+    if (nullptr == ptr) {
+        return;
+    }
+
+    LocMsgPoolHeader* block = (LocMsgPoolHeader*)ptr - 1;
+    uint32_t sizeClass = block->sizeClass;
+    LocMsgPoolClass& poolClass = sLocMsgPoolClasses[sizeClass];
+    bool cached = false;
+    {
+        std::lock_guard<std::mutex> guard(poolClass.lock);
+        poolClass.stats.inUse--;
+        if (sizeClass < LOC_MSG_POOL_NUM_CLASSES &&
+                poolClass.stats.cached < locMsgPoolMaxCached(sizeClass)) {
+            block->next = poolClass.freeList;
+            poolClass.freeList = block;
+            poolClass.stats.cached++;
+            cached = true;
+        }
+    }
+    if (!cached) {
+        ::operator delete(block);
+    }
+}
+
+uint32_t LocMsgPool::getStats(LocMsgPoolStats* stats, uint32_t maxCount) {
+    uint32_t count = 0;
+    for (; nullptr != stats && count < maxCount && count <= LOC_MSG_POOL_NUM_CLASSES; count++) {
+        LocMsgPoolClass& poolClass = sLocMsgPoolClasses[count];
+        std::lock_guard<std::mutex> guard(poolClass.lock);
+        stats[count] = poolClass.stats;
+        stats[count].blockSize =
+                (count < LOC_MSG_POOL_NUM_CLASSES) ? locMsgPoolClassSize(count) : 0;
+    }
+    return count;
+}
+
+void LocMsgPool::logStats() {
+    LocMsgPoolStats stats[LOC_MSG_POOL_NUM_CLASSES + 1];
+    uint32_t count = getStats(stats, LOC_MSG_POOL_NUM_CLASSES + 1);
+    for (uint32_t i = 0; i < count; i++) {
+        if (stats[i].allocs > 0) {
+            LOC_LOGd("block size %zu: in use %u, high water %u, cached %u, "
+                     "allocs %" PRIu64 ", heap allocs %" PRIu64,
+                     stats[i].blockSize, stats[i].inUse, stats[i].highWater,
+                     stats[i].cached, stats[i].allocs, stats[i].heapAllocs);
+        }
+    }
+}
+
+// MsgTask stats: log2 histograms of microseconds, bucket 0 counting < 1us,
+// bucket n [2^(n-1), 2^n) us and the last bucket anything above
+#define MSG_TASK_HISTOGRAM_BUCKETS 24
+// distinct msg types accounted per MsgTask, the rest go under "other"
+#define MSG_TASK_MAX_MSG_TYPES 64
+
+// written by the MsgTask thread only, so no RMW is needed; the atomics
+// only make the dump from other threads (or SIGUSR1) well defined
+struct MsgTaskHistogram {
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> totalUs;
+    std::atomic<uint32_t> maxUs;
+    std::atomic<uint32_t> buckets[MSG_TASK_HISTOGRAM_BUCKETS];
+
+    inline MsgTaskHistogram() : count(0), totalUs(0), maxUs(0) {
+        for (int i = 0; i < MSG_TASK_HISTOGRAM_BUCKETS; i++) {
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+    }
+    inline void add(uint64_t ns) {
+        uint64_t us = ns / 1000;
+        int bucket = (0 == us) ? 0 : (64 - __builtin_clzll(us));
+        if (bucket >= MSG_TASK_HISTOGRAM_BUCKETS) {
+            bucket = MSG_TASK_HISTOGRAM_BUCKETS - 1;
+        }
+        buckets[bucket].store(buckets[bucket].load(std::memory_order_relaxed) + 1,
+                              std::memory_order_relaxed);
+        count.store(count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        totalUs.store(totalUs.load(std::memory_order_relaxed) + us,
+                      std::memory_order_relaxed);
+        if (us > maxUs.load(std::memory_order_relaxed)) {
+            maxUs.store((us > UINT32_MAX) ? UINT32_MAX : (uint32_t)us,
+                        std::memory_order_relaxed);
+        }
+    }
+    void dump(std::stringstream& ss) const;
+};
+
+enum MsgTaskMsgTypeKey {
+    MSG_TASK_MSG_TYPE_KEY_TAG = 0,      // key is the getTag() string
+    MSG_TASK_MSG_TYPE_KEY_TYPEINFO,     // key is the std::type_info of the msg
+    MSG_TASK_MSG_TYPE_KEY_VTABLE,       // key is the vtable of the msg
+};
+
+struct MsgTaskMsgTypeStats {
+    // published with release once keyType is set, never changed after
+    std::atomic<const void*> key;
+    uint32_t keyType;
+    MsgTaskHistogram procTime;
+    inline MsgTaskMsgTypeStats() : key(nullptr), keyType(MSG_TASK_MSG_TYPE_KEY_TAG) {}
+};
+
+struct MsgTaskStats {
+    std::string name;
+    MsgTaskHistogram latency;
+    MsgTaskMsgTypeStats types[MSG_TASK_MAX_MSG_TYPES];
+    MsgTaskMsgTypeStats otherTypes;
+
+    inline MsgTaskStats(const char* threadName) :
+            name((nullptr != threadName) ? threadName : "MsgTask") {
+        otherTypes.keyType = MSG_TASK_MSG_TYPE_KEY_TAG;
+        otherTypes.key.store("other", std::memory_order_relaxed);
+    }
+    void record(const LocMsg* msg, uint64_t sentNs, uint64_t startNs, uint64_t endNs);
+};
+
+// stats of the MsgTask whose thread this is, and the time the msg in proc()
+// got queued, for LocMsgLatestSlot::procLatest()
+static thread_local MsgTaskStats* sCurrentMsgTaskStats = nullptr;
+static thread_local uint64_t sCurrentMsgSentNs = 0;
+
+// every MsgTask alive, for MsgTask::dumpStats()
+struct MsgTaskRegistry {
+    std::mutex lock;
+    std::vector<const MsgTask*> tasks;
+};
+
+static MsgTaskRegistry& getMsgTaskRegistry() {
+    static MsgTaskRegistry registry;
+    return registry;
+}
+
+static inline uint64_t getMonotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static const char sLocMsgLatestTokenTag[] = "LocMsgLatestToken";
+
+void MsgTaskStats::record(const LocMsg* msg, uint64_t sentNs,
+                          uint64_t startNs, uint64_t endNs) {
+    const void* key = msg->getTag();
+    uint32_t keyType = MSG_TASK_MSG_TYPE_KEY_TAG;
+    if (sLocMsgLatestTokenTag == key) {
+        // the msg it stands for is recorded by LocMsgLatestSlot::procLatest()
+        return;
+    }
+    if (nullptr == key) {
+#ifdef __GXX_RTTI
+        key = &typeid(*msg);
+        keyType = MSG_TASK_MSG_TYPE_KEY_TYPEINFO;
+#else
+        key = *(const void* const*)msg;
+        keyType = MSG_TASK_MSG_TYPE_KEY_VTABLE;
+#endif
+    }
+
+    if (0 != sentNs && startNs >= sentNs) {
+        latency.add(startNs - sentNs);
+    }
+
+    // keys are type_info / vtable / tag addresses, so folding the aligned
+    // address down to 32 bits spreads them well enough for a modulo
+    uint64_t keyBits = (uint64_t)(uintptr_t)key >> 3;
+    uint32_t index = ((uint32_t)(keyBits & 0xFFFFFFFF) ^ (uint32_t)(keyBits >> 32)) %
+            MSG_TASK_MAX_MSG_TYPES;
+    MsgTaskMsgTypeStats* typeStats = &otherTypes;
+    for (uint32_t i = 0; i < MSG_TASK_MAX_MSG_TYPES; i++) {
+        MsgTaskMsgTypeStats& entry = types[(index + i) % MSG_TASK_MAX_MSG_TYPES];
+        const void* entryKey = entry.key.load(std::memory_order_relaxed);
+        if (key == entryKey) {
+            typeStats = &entry;
+            break;
+        } else if (nullptr == entryKey) {
+            entry.keyType = keyType;
+            entry.key.store(key, std::memory_order_release);
+            typeStats = &entry;
+            break;
+        }
+    }
+    typeStats->procTime.add(endNs - startNs);
+}
+
+void MsgTaskHistogram::dump(std::stringstream& ss) const {
+    uint64_t n = count.load(std::memory_order_relaxed);
+    ss << "count " << n << ", avg us "
+       << ((n > 0) ? totalUs.load(std::memory_order_relaxed) / n : 0)
+       << ", max us " << maxUs.load(std::memory_order_relaxed) << ", us histogram";
+    for (int i = 0; i < MSG_TASK_HISTOGRAM_BUCKETS; i++) {
+        uint32_t bucketCount = buckets[i].load(std::memory_order_relaxed);
+        if (bucketCount > 0) {
+            if (MSG_TASK_HISTOGRAM_BUCKETS - 1 == i) {
+                ss << " >=" << (1ULL << (i - 1));
+            } else {
+                ss << " <" << (1ULL << i);
+            }
+            ss << ":" << bucketCount;
+        }
+    }
+}
+
+static std::string demangleMsgTypeName(const char* name) {
+    std::string demangled(name);
+    int status = 0;
+    char* buf = abi::__cxa_demangle(name, nullptr, nullptr, &status);
+    if (nullptr != buf) {
+        demangled = buf;
+        ::free(buf);
+    }
+    return demangled;
+}
+
+static std::string getMsgTypeName(const MsgTaskMsgTypeStats& entry, const void* key) {
+    std::string name;
+    switch (entry.keyType) {
+#ifdef __GXX_RTTI
+    case MSG_TASK_MSG_TYPE_KEY_TYPEINFO:
+        name = demangleMsgTypeName(((const std::type_info*)key)->name());
+        break;
+#endif
+    case MSG_TASK_MSG_TYPE_KEY_VTABLE: {
+        // Without RTTI the vtable symbol names the type, if it is exported;
+        // else library + offset, which the host can resolve with symbols.
+        Dl_info info = {};
+        if (0 != dladdr(key, &info) && nullptr != info.dli_sname &&
+                0 == strncmp(info.dli_sname, "_ZTV", 4)) {
+            name = demangleMsgTypeName(info.dli_sname);
+            if (0 == name.compare(0, 11, "vtable for ")) {
+                name.erase(0, 11);
+            }
+        } else if (nullptr != info.dli_fname) {
+            std::stringstream ss;
+            ss << info.dli_fname << "+0x" << std::hex
+               << ((uintptr_t)key - (uintptr_t)info.dli_fbase);
+            name = ss.str();
+        } else {
+            std::stringstream ss;
+            ss << "vtable " << key;
+            name = ss.str();
+        }
+        break;
+    }
+    default:
+        name = (const char*)key;
+        break;
+    }
+    return name;
+}
 
 static void LocMsgDestroy(void* msg) {
     delete (LocMsg*)msg;
 }
 
+// queued in place of the msgs sent through a LocMsgLatestSlot
+struct LocMsgLatestToken : public LocMsg {
+    LocMsgLatestSlot& mSlot;
+    inline LocMsgLatestToken(LocMsgLatestSlot& slot) : LocMsg(), mSlot(slot) {}
+    inline virtual void proc() const {
+        mSlot.procLatest();
+    }
+    inline virtual const char* getTag() const {
+        return sLocMsgLatestTokenTag;
+    }
+};
+
+LocMsgLatestSlot::~LocMsgLatestSlot() {
+    delete mLatest.exchange(nullptr);
+}
+
+void LocMsgLatestSlot::procLatest() {
+    const LocMsg* msg = mLatest.exchange(nullptr);
+    if (nullptr != msg) {
+        msg->log();
+        uint64_t startNs = getMonotonicNs();
+        msg->proc();
+        if (nullptr != sCurrentMsgTaskStats) {
+            // the wait counts from when the slot got its token queued
+            sCurrentMsgTaskStats->record(msg, sCurrentMsgSentNs, startNs, getMonotonicNs());
+        }
+        delete msg;
+    }
+}
+
 MsgTask::MsgTask(LocThread::tCreate tCreator,
                  const char* threadName, bool joinable) :
-    mQ(msg_q_init2()), mThread(new LocThread()) {
+    mQ(msg_q_init2()), mThread(new LocThread()),
+    mStats(new MsgTaskStats(threadName)),
+    mMaxBatchSize(MSG_TASK_DEFAULT_BATCH_SIZE), mWakeups(0), mMsgs(0),
+    mLastBatch(0), mMaxBatch(0) {
+    registerStats();
     if (!mThread->start(tCreator, threadName, this, joinable)) {
         delete mThread;
         mThread = NULL;
@@ -50,7 +429,11 @@ MsgTask::MsgTask(LocThread::tCreate tCreator,
 }
 
 MsgTask::MsgTask(const char* threadName, bool joinable) :
-    mQ(msg_q_init2()), mThread(new LocThread()) {
+    mQ(msg_q_init2()), mThread(new LocThread()),
+    mStats(new MsgTaskStats(threadName)),
+    mMaxBatchSize(MSG_TASK_DEFAULT_BATCH_SIZE), mWakeups(0), mMsgs(0),
+    mLastBatch(0), mMaxBatch(0) {
+    registerStats();
     if (!mThread->start(threadName, this, joinable)) {
         delete mThread;
         mThread = NULL;
@@ -58,8 +441,10 @@ MsgTask::MsgTask(const char* threadName, bool joinable) :
 }
 
 MsgTask::~MsgTask() {
+    unregisterStats();
     msg_q_flush((void*)mQ);
     msg_q_destroy((void**)&mQ);
+    delete mStats;
 }
 
 void MsgTask::destroy() {
@@ -74,33 +459,180 @@ void MsgTask::destroy() {
 }
 
 void MsgTask::sendMsg(const LocMsg* msg) const {
+    sendMsg(msg, LOC_MSG_PRIORITY_CONTROL);
+}
+
+void MsgTask::sendMsg(const LocMsg* msg, LocMsgPriority priority) const {
     if (msg && this) {
-        msg_q_snd((void*)mQ, (void*)msg, LocMsgDestroy);
+        if (priority < LOC_MSG_PRIORITY_CONTROL || priority >= LOC_MSG_PRIORITY_MAX) {
+            priority = LOC_MSG_PRIORITY_CONTROL;
+        }
+        msg_q_snd_tag((void*)mQ, (void*)msg, LocMsgDestroy, (int)priority,
+                      getMonotonicNs());
     } else {
         LOC_LOGE("%s: msg is %p and this is %p",
                  __func__, msg, this);
     }
 }
 
+void MsgTask::sendLatestMsg(const LocMsg* msg, LocMsgLatestSlot& slot,
+                            LocMsgPriority priority) const {
+    if (msg && this) {
+        // Only the consumer ever empties the slot, so a non null stale msg
+        // can not be in use by anyone else: the token queued when the slot
+        // last went from empty to non empty will pick msg up instead.
+        const LocMsg* stale = slot.mLatest.exchange(msg);
+        if (nullptr == stale) {
+            sendMsg(new LocMsgLatestToken(slot), priority);
+        } else {
+            slot.mCoalesced.fetch_add(1, std::memory_order_relaxed);
+            delete stale;
+        }
+    } else {
+        LOC_LOGE("%s: msg is %p and this is %p",
+                 __func__, msg, this);
+    }
+}
+
+void MsgTask::setMaxBatchSize(uint32_t maxBatchSize) {
+    if (maxBatchSize < 1) {
+        maxBatchSize = 1;
+    } else if (maxBatchSize > MSG_TASK_MAX_BATCH_SIZE) {
+        maxBatchSize = MSG_TASK_MAX_BATCH_SIZE;
+    }
+    mMaxBatchSize = maxBatchSize;
+}
+
+void MsgTask::getDrainStats(MsgTaskDrainStats& stats) const {
+    stats.wakeups = mWakeups;
+    stats.msgs = mMsgs;
+    stats.lastBatch = mLastBatch;
+    stats.maxBatch = mMaxBatch;
+}
+
+void MsgTask::getQueueDepth(LocMsgPriority priority,
+                            uint32_t& depth, uint32_t& peak) const {
+    int d = 0, p = 0;
+    if (priority >= LOC_MSG_PRIORITY_CONTROL && priority < LOC_MSG_PRIORITY_MAX) {
+        msg_q_depth((void*)mQ, (int)priority, &d, &p);
+    }
+    depth = (d > 0) ? d : 0;
+    peak = p;
+}
+
+void MsgTask::registerStats() {
+    static std::once_flag sDumpHookOnce;
+    std::call_once(sDumpHookOnce, []() {
+        loc_util::LogBuffer::registerDumpHook(&MsgTask::dumpStats);
+    });
+    MsgTaskRegistry& registry = getMsgTaskRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    registry.tasks.push_back(this);
+}
+
+void MsgTask::unregisterStats() {
+    MsgTaskRegistry& registry = getMsgTaskRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    for (auto it = registry.tasks.begin(); it != registry.tasks.end(); ++it) {
+        if (this == *it) {
+            registry.tasks.erase(it);
+            break;
+        }
+    }
+}
+
+// no LOC_LOG* in here, LogBuffer::dump() may be what calls this
+void MsgTask::dumpStats(const std::function<void(std::stringstream&)>& log) {
+    static const char* const laneNames[LOC_MSG_PRIORITY_MAX] =
+            {"control", "report", "background"};
+    MsgTaskRegistry& registry = getMsgTaskRegistry();
+    std::lock_guard<std::mutex> guard(registry.lock);
+    for (const MsgTask* task : registry.tasks) {
+        const MsgTaskStats& stats = *task->mStats;
+        MsgTaskDrainStats drainStats;
+        task->getDrainStats(drainStats);
+        std::stringstream ss;
+        ss << "MsgTask " << stats.name << ": wakeups " << drainStats.wakeups
+           << ", msgs " << drainStats.msgs << ", max batch " << drainStats.maxBatch;
+        for (int lane = LOC_MSG_PRIORITY_CONTROL; lane < LOC_MSG_PRIORITY_MAX; lane++) {
+            uint32_t depth = 0, peak = 0;
+            task->getQueueDepth((LocMsgPriority)lane, depth, peak);
+            ss << ", " << laneNames[lane] << " depth " << depth << " peak " << peak;
+        }
+        ss << std::endl;
+        log(ss);
+
+        std::stringstream latency;
+        latency << "MsgTask " << stats.name << " send to proc latency: ";
+        stats.latency.dump(latency);
+        latency << std::endl;
+        log(latency);
+
+        for (int i = 0; i <= MSG_TASK_MAX_MSG_TYPES; i++) {
+            const MsgTaskMsgTypeStats& entry =
+                    (i < MSG_TASK_MAX_MSG_TYPES) ? stats.types[i] : stats.otherTypes;
+            const void* key = entry.key.load(std::memory_order_acquire);
+            if (nullptr != key && entry.procTime.count.load(std::memory_order_relaxed) > 0) {
+                std::stringstream proc;
+                proc << "MsgTask " << stats.name << " proc "
+                     << getMsgTypeName(entry, key) << ": ";
+                entry.procTime.dump(proc);
+                proc << std::endl;
+                log(proc);
+            }
+        }
+    }
+}
+
+void MsgTask::dumpStatsToFile(const char* filePath) {
+    std::fstream s;
+    s.open(filePath, std::fstream::out | std::fstream::trunc);
+    if (!s.is_open()) {
+        LOC_LOGe("failed to open %s", filePath);
+        return;
+    }
+    dumpStats([&s](std::stringstream& line) {
+        s << line.str();
+    });
+    s.close();
+}
+
 void MsgTask::prerun() {
     // make sure we do not run in background scheduling group
      set_sched_policy(gettid(), SP_FOREGROUND);
 }
 
 bool MsgTask::run() {
-    LocMsg* msg;
-    msq_q_err_type result = msg_q_rcv((void*)mQ, (void **)&msg);
+    LocMsg* msgs[MSG_TASK_MAX_BATCH_SIZE];
+    uint64_t sentNs[MSG_TASK_MAX_BATCH_SIZE];
+    int count = 0;
+    // drain whatever is pending, up to mMaxBatchSize, in one wakeup
+    msq_q_err_type result = msg_q_rcv_batch_tag((void*)mQ, (void**)msgs, sentNs,
+                                                (int)mMaxBatchSize, &count);
     if (eMSG_Q_SUCCESS != result) {
         LOC_LOGE("%s:%d] fail receiving msg: %s\n", __func__, __LINE__,
                  loc_get_msg_q_status(result));
         return false;
     }
 
-    msg->log();
-    // there is where each individual msg handling is invoked
-    msg->proc();
+    mWakeups.fetch_add(1, std::memory_order_relaxed);
+    mMsgs.fetch_add(count, std::memory_order_relaxed);
+    mLastBatch.store(count, std::memory_order_relaxed);
+    if ((uint32_t)count > mMaxBatch.load(std::memory_order_relaxed)) {
+        mMaxBatch.store(count, std::memory_order_relaxed);
+    }
+
+    sCurrentMsgTaskStats = mStats;
+    for (int i = 0; i < count; i++) {
+        msgs[i]->log();
+        uint64_t startNs = getMonotonicNs();
+        sCurrentMsgSentNs = sentNs[i];
+        // there is where each individual msg handling is invoked
+        msgs[i]->proc();
+        mStats->record(msgs[i], sentNs[i], startNs, getMonotonicNs());
 
-    delete msg;
+        delete msgs[i];
+    }
 
     return true;
 }
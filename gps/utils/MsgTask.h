@@ -29,19 +29,121 @@
 #ifndef __MSG_TASK__
 #define __MSG_TASK__
 
+#include <stdint.h>
+#include <atomic>
+#include <new>
+#include <type_traits>
+#include <functional>
+#include <sstream>
 #include <LocThread.h>
 
+// upper bound of MsgTask::setMaxBatchSize()
+#define MSG_TASK_MAX_BATCH_SIZE 64
+#define MSG_TASK_DEFAULT_BATCH_SIZE 16
+
+// Priority class of a msg, each class is queued in its own lane.
+// CONTROL is always serviced first; REPORT and BACKGROUND in that order,
+// with BACKGROUND still getting a turn every so often under a report flood.
+enum LocMsgPriority {
+    LOC_MSG_PRIORITY_CONTROL = 0,   // commands, config, session start / stop
+    LOC_MSG_PRIORITY_REPORT,        // realtime reports, e.g. position, sv, nmea
+    LOC_MSG_PRIORITY_BACKGROUND,    // status updates that can wait
+    LOC_MSG_PRIORITY_MAX
+};
+
+// usage of one LocMsgPool size class, blockSize 0 being the oversized
+// blocks that always come from, and go back to, the heap
+struct LocMsgPoolStats {
+    size_t blockSize;
+    uint32_t inUse;
+    uint32_t highWater;
+    uint32_t cached;
+    uint64_t allocs;
+    uint64_t heapAllocs;
+};
+
+// Size class pool behind LocMsg objects and their payloads. Memory of a
+// msg goes back to the pool once the msg is deleted after proc(), so a
+// steady stream of reports keeps reusing the same blocks instead of going
+// to the heap for every one of them. Each class keeps a bounded number of
+// free blocks; anything beyond that is returned to the heap.
+class LocMsgPool {
+public:
+    static void* alloc(size_t size, bool nothrow = false);
+    static void free(void* ptr);
+    // payload buffers for LocMsg subclasses, e.g. a copy of an array
+    template <typename T>
+    static inline T* allocArray(size_t count) {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "LocMsgPool arrays are not constructed / destructed");
+        return static_cast<T*>(alloc(sizeof(T) * count, true));
+    }
+    static inline void freeArray(const void* ptr) { free(const_cast<void*>(ptr)); }
+    // fills up to maxCount entries, one per size class; returns the count
+    static uint32_t getStats(LocMsgPoolStats* stats, uint32_t maxCount);
+    static void logStats();
+};
+
 struct LocMsg {
     inline LocMsg() {}
     inline virtual ~LocMsg() {}
+    static inline void* operator new(size_t size) {
+        return LocMsgPool::alloc(size);
+    }
+    static inline void* operator new(size_t size, const std::nothrow_t&) noexcept {
+        return LocMsgPool::alloc(size, true);
+    }
+    static inline void operator delete(void* ptr) {
+        LocMsgPool::free(ptr);
+    }
+    static inline void operator delete(void* ptr, const std::nothrow_t&) noexcept {
+        LocMsgPool::free(ptr);
+    }
     virtual void proc() const = 0;
     inline virtual void log() const {}
+    // Name the msg is accounted under in MsgTask proc() time stats. By
+    // default each msg type is accounted on its own, under its type name.
+    inline virtual const char* getTag() const { return nullptr; }
+};
+
+// Pending slot of a "latest wins" msg type, see MsgTask::sendLatestMsg().
+// Owned by whoever sends the msg type, and must outlive the MsgTask queue.
+class LocMsgLatestSlot {
+    std::atomic<const LocMsg*> mLatest;
+    std::atomic<uint64_t> mCoalesced;
+    friend class MsgTask;
+public:
+    inline LocMsgLatestSlot() : mLatest(nullptr), mCoalesced(0) {}
+    ~LocMsgLatestSlot();
+    // number of msgs dropped because a newer one replaced them while pending
+    inline uint64_t getCoalescedCount() const { return mCoalesced; }
+    // runs the msg currently pending in the slot, if any, in MsgTask thread
+    void procLatest();
 };
 
+// how many messages each wakeup of a MsgTask thread handled
+struct MsgTaskDrainStats {
+    uint64_t wakeups;
+    uint64_t msgs;
+    uint32_t lastBatch;
+    uint32_t maxBatch;
+};
+
+// per MsgTask latency and msg type stats, see MsgTask::dumpStats()
+struct MsgTaskStats;
+
 class MsgTask : public LocRunnable {
     const void* mQ;
     LocThread* mThread;
+    MsgTaskStats* mStats;
+    std::atomic<uint32_t> mMaxBatchSize;
+    std::atomic<uint64_t> mWakeups;
+    std::atomic<uint64_t> mMsgs;
+    std::atomic<uint32_t> mLastBatch;
+    std::atomic<uint32_t> mMaxBatch;
     friend class LocThreadDelegate;
+    void registerStats();
+    void unregisterStats();
 protected:
     virtual ~MsgTask();
 public:
@@ -49,7 +151,28 @@ public:
     MsgTask(const char* threadName = NULL, bool joinable = true);
     // this obj will be deleted once thread is deleted
     void destroy();
+    // sends msg in the LOC_MSG_PRIORITY_CONTROL lane
     void sendMsg(const LocMsg* msg) const;
+    void sendMsg(const LocMsg* msg, LocMsgPriority priority) const;
+    // Sends msg as the latest value of a "latest wins" msg type. If a msg
+    // sent through the same slot is still pending, msg replaces it in place
+    // (the stale one is deleted without proc()) instead of being appended.
+    void sendLatestMsg(const LocMsg* msg, LocMsgLatestSlot& slot,
+                       LocMsgPriority priority = LOC_MSG_PRIORITY_REPORT) const;
+    // Max number of messages run() drains per wakeup, clamped to
+    // [1, MSG_TASK_MAX_BATCH_SIZE]. Keeps a control msg from waiting
+    // behind more than this many already pending msgs.
+    void setMaxBatchSize(uint32_t maxBatchSize);
+    inline uint32_t getMaxBatchSize() const { return mMaxBatchSize; }
+    void getDrainStats(MsgTaskDrainStats& stats) const;
+    // current and peak number of msgs queued in the lane of the priority
+    void getQueueDepth(LocMsgPriority priority, uint32_t& depth, uint32_t& peak) const;
+    // Dumps, for every MsgTask alive, the queue depth of each lane, a
+    // histogram of the time msgs wait between sendMsg() and proc(), and
+    // one of the time proc() takes per msg type. Also part of the
+    // LogBuffer dump, i.e. SIGUSR1 when the log buffer is enabled.
+    static void dumpStats(const std::function<void(std::stringstream&)>& log);
+    static void dumpStatsToFile(const char* filePath);
     // Overrides of LocRunnable methods
     // This method will be repeated called until it returns false; or
     // until thread is stopped.
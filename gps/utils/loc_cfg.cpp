@@ -47,6 +47,18 @@
 #include <glib.h>
 #endif
 #include "log_util.h"
+#include <sys/stat.h>
+#include <string>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+using std::string;
+using std::unordered_map;
+using std::shared_ptr;
+using std::make_shared;
+using std::mutex;
+using std::lock_guard;
 
 /*=============================================================================
  *
@@ -60,6 +72,7 @@ static uint32_t TIMESTAMP = 0;
 static uint32_t DATUM_TYPE = 0;
 static bool sVendorEnhanced = true;
 static uint32_t sLogBufferEnabled = 0;
+static uint32_t sLogBufferBinaryLevel = 0;
 
 /* Parameter spec table */
 static const loc_param_s_type loc_param_table[] =
@@ -68,6 +81,7 @@ static const loc_param_s_type loc_param_table[] =
     {"TIMESTAMP",               &TIMESTAMP,          NULL, 'n'},
     {"DATUM_TYPE",              &DATUM_TYPE,         NULL, 'n'},
     {"LOG_BUFFER_ENABLED",      &sLogBufferEnabled,  NULL, 'n'},
+    {"LOG_BUFFER_BINARY_LEVEL", &sLogBufferBinaryLevel, NULL, 'n'},
 };
 static const int loc_param_num = sizeof(loc_param_table) / sizeof(loc_param_s_type);
 
@@ -232,47 +246,56 @@ RETURN VALUE
 SIDE EFFECTS
    N/A
 ===========================================================================*/
+static bool loc_parse_conf_item(char* input_buf, loc_param_v_type* config_value)
+{
+    char *lasts;
+    memset(config_value, 0, sizeof(*config_value));
+
+    /* Separate variable and value */
+    config_value->param_name = strtok_r(input_buf, "=", &lasts);
+    /* skip lines that do not contain "=" */
+    if (NULL == config_value->param_name) {
+        return false;
+    }
+    config_value->param_str_value = strtok_r(NULL, "\0", &lasts);
+
+    /* skip lines that do not contain two operands */
+    if (NULL == config_value->param_str_value) {
+        return false;
+    }
+    /* Trim leading and trailing spaces */
+    loc_util_trim_space(config_value->param_name);
+    loc_util_trim_space(config_value->param_str_value);
+
+    /* Parse numerical value */
+    if ((strlen(config_value->param_str_value) >=3) &&
+        (config_value->param_str_value[0] == '0') &&
+        (tolower(config_value->param_str_value[1]) == 'x'))
+    {
+        /* hex */
+        config_value->param_int_value = (int) strtol(&config_value->param_str_value[2],
+                                                     (char**) NULL, 16);
+    }
+    else {
+        config_value->param_double_value = (double) atof(config_value->param_str_value); /* float */
+        config_value->param_int_value = atoi(config_value->param_str_value); /* dec */
+    }
+    return true;
+}
+
 int loc_fill_conf_item(char* input_buf,
                        const loc_param_s_type* config_table, uint32_t table_length)
 {
     int ret = 0;
 
     if (input_buf && config_table) {
-        char *lasts;
         loc_param_v_type config_value;
-        memset(&config_value, 0, sizeof(config_value));
-
-        /* Separate variable and value */
-        config_value.param_name = strtok_r(input_buf, "=", &lasts);
-        /* skip lines that do not contain "=" */
-        if (config_value.param_name) {
-            config_value.param_str_value = strtok_r(NULL, "\0", &lasts);
-
-            /* skip lines that do not contain two operands */
-            if (config_value.param_str_value) {
-                /* Trim leading and trailing spaces */
-                loc_util_trim_space(config_value.param_name);
-                loc_util_trim_space(config_value.param_str_value);
-
-                /* Parse numerical value */
-                if ((strlen(config_value.param_str_value) >=3) &&
-                    (config_value.param_str_value[0] == '0') &&
-                    (tolower(config_value.param_str_value[1]) == 'x'))
-                {
-                    /* hex */
-                    config_value.param_int_value = (int) strtol(&config_value.param_str_value[2],
-                                                                (char**) NULL, 16);
-                }
-                else {
-                    config_value.param_double_value = (double) atof(config_value.param_str_value); /* float */
-                    config_value.param_int_value = atoi(config_value.param_str_value); /* dec */
-                }
 
-                for(uint32_t i = 0; NULL != config_table && i < table_length; i++)
-                {
-                    if(!loc_set_config_entry(&config_table[i], &config_value)) {
-                        ret += 1;
-                    }
+        if (loc_parse_conf_item(input_buf, &config_value)) {
+            for(uint32_t i = 0; NULL != config_table && i < table_length; i++)
+            {
+                if(!loc_set_config_entry(&config_table[i], &config_value)) {
+                    ret += 1;
                 }
             }
         }
@@ -281,6 +304,139 @@ int loc_fill_conf_item(char* input_buf,
     return ret;
 }
 
+/*=============================================================================
+ *
+ *   Conf file store: each conf file is parsed once into a map of its items,
+ *   until its mtime, size or inode changes, and loc_read_conf fills tables
+ *   from the map.
+ *
+ *============================================================================*/
+typedef struct
+{
+    string str_value;
+    int int_value;
+    double double_value;
+} loc_conf_value;
+
+typedef struct
+{
+    struct timespec mtime;
+    off_t size;
+    ino_t ino;
+    /* the last one wins if an item is in the file more than once */
+    unordered_map<string, loc_conf_value> items;
+} loc_conf_file;
+
+static mutex sConfStoreLock;
+static unordered_map<string, shared_ptr<const loc_conf_file>> sConfStore;
+
+/*===========================================================================
+FUNCTION loc_get_conf_file
+
+DESCRIPTION
+   Gets the parsed items of a conf file, parsing it only if it is not in the
+   store yet, or if it changed since it was parsed.
+
+PARAMETERS:
+   conf_file_name: configuration file to read
+
+RETURN VALUE
+   the parsed file, NULL if it can not be read
+
+SIDE EFFECTS
+   N/A
+===========================================================================*/
+static shared_ptr<const loc_conf_file> loc_get_conf_file(const char* conf_file_name)
+{
+    struct stat st;
+    shared_ptr<loc_conf_file> file;
+    {
+        /* no logging while locked, the log buffer may read conf too */
+        lock_guard<mutex> guard(sConfStoreLock);
+        if (0 != stat(conf_file_name, &st)) {
+            sConfStore.erase(conf_file_name);
+            return nullptr;
+        }
+        auto it = sConfStore.find(conf_file_name);
+        if (it != sConfStore.end() && it->second->size == st.st_size &&
+            it->second->ino == st.st_ino &&
+            it->second->mtime.tv_sec == st.st_mtim.tv_sec &&
+            it->second->mtime.tv_nsec == st.st_mtim.tv_nsec) {
+            return it->second;
+        }
+
+        FILE *conf_fp = fopen(conf_file_name, "r");
+        if (NULL == conf_fp) {
+            sConfStore.erase(conf_file_name);
+            return nullptr;
+        }
+        file = make_shared<loc_conf_file>();
+        file->mtime = st.st_mtim;
+        file->size = st.st_size;
+        file->ino = st.st_ino;
+        char input_buf[LOC_MAX_PARAM_LINE];
+        loc_param_v_type config_value;
+        while (fgets(input_buf, LOC_MAX_PARAM_LINE, conf_fp)) {
+            if (loc_parse_conf_item(input_buf, &config_value) &&
+                '#' != config_value.param_name[0]) {
+                loc_conf_value& value = file->items[config_value.param_name];
+                value.str_value = config_value.param_str_value;
+                value.int_value = config_value.param_int_value;
+                value.double_value = config_value.param_double_value;
+            }
+        }
+        fclose(conf_fp);
+        sConfStore[conf_file_name] = file;
+    }
+    LOC_LOGD("%s: parsed %s, %zu items", __FUNCTION__, conf_file_name, file->items.size());
+    return file;
+}
+
+/*===========================================================================
+FUNCTION loc_fill_conf_table
+
+DESCRIPTION
+   Sets the values of a configuration table from the parsed items of a conf
+   file, with one look up per table entry.
+
+PARAMETERS:
+   conf_file: parsed conf file
+   config_table: table definition of strings to places to store information
+   table_length: length of the configuration table
+
+RETURN VALUE
+   number of the records in the table that are set
+
+SIDE EFFECTS
+   N/A
+===========================================================================*/
+static int loc_fill_conf_table(const loc_conf_file& conf_file,
+                               const loc_param_s_type* config_table, uint32_t table_length)
+{
+    int ret = 0;
+    loc_param_v_type config_value;
+    for (uint32_t i = 0; NULL != config_table && i < table_length; i++) {
+        /* Clear validity bit */
+        if (NULL != config_table[i].param_set) {
+            *(config_table[i].param_set) = 0;
+        }
+        if (NULL == config_table[i].param_name) {
+            continue;
+        }
+        auto it = conf_file.items.find(config_table[i].param_name);
+        if (it != conf_file.items.end()) {
+            config_value.param_name = (char*)config_table[i].param_name;
+            config_value.param_str_value = (char*)it->second.str_value.c_str();
+            config_value.param_int_value = it->second.int_value;
+            config_value.param_double_value = it->second.double_value;
+            if (!loc_set_config_entry(&config_table[i], &config_value)) {
+                ret += 1;
+            }
+        }
+    }
+    return ret;
+}
+
 /*===========================================================================
 FUNCTION loc_read_conf_r (repetitive)
 
@@ -432,22 +588,19 @@ SIDE EFFECTS
 void loc_read_conf(const char* conf_file_name, const loc_param_s_type* config_table,
                    uint32_t table_length)
 {
-    FILE *conf_fp = NULL;
-
-    log_buffer_init(false);
-    if((conf_fp = fopen(conf_file_name, "r")) != NULL)
+    log_buffer_init(false, 0);
+    shared_ptr<const loc_conf_file> conf_file = loc_get_conf_file(conf_file_name);
+    if (nullptr != conf_file)
     {
         LOC_LOGD("%s: using %s", __FUNCTION__, conf_file_name);
         if(table_length && config_table) {
-            loc_read_conf_r(conf_fp, config_table, table_length);
-            rewind(conf_fp);
+            loc_fill_conf_table(*conf_file, config_table, table_length);
         }
-        loc_read_conf_r(conf_fp, loc_param_table, loc_param_num);
-        fclose(conf_fp);
+        loc_fill_conf_table(*conf_file, loc_param_table, loc_param_num);
     }
     /* Initialize logging mechanism with parsed data */
     loc_logger_init(DEBUG_LEVEL, TIMESTAMP);
-    log_buffer_init(sLogBufferEnabled);
+    log_buffer_init(sLogBufferEnabled, sLogBufferBinaryLevel);
 }
 
 /*=============================================================================
@@ -31,6 +31,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdarg.h>
 #include <unistd.h>
 #include <sys/time.h>
 #include "log_util.h"
@@ -215,7 +216,35 @@ void log_buffer_insert(char *str, unsigned long buf_size, int level)
 {
     timespec tv;
     clock_gettime(CLOCK_BOOTTIME, &tv);
-    uint64_t elapsedTime = (uint64_t)tv.tv_sec + (uint64_t)tv.tv_nsec/1000000000;
-    string ss = str;
-    loc_util::LogBuffer::getInstance()->append(ss, level, elapsedTime);
+    uint64_t elapsedTime = (uint64_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+    loc_util::LogBuffer::getInstance()->append(str, strnlen(str, buf_size), level, elapsedTime);
+}
+
+/*===========================================================================
+
+FUNCTION log_buffer_insert_args
+
+DESCRIPTION
+   Insert a log sentence with specific level to the log buffer, in binary
+   mode: the tag and format pointers and the raw args are kept, and the
+   sentence is formatted only when the buffer is dumped. tag and format
+   must be literals.
+
+RETURN VALUE
+   N/A
+
+===========================================================================*/
+void log_buffer_insert_args(int level, const char* tag, const char* format, ...)
+{
+    static thread_local int32_t sTid = 0;
+    if (0 == sTid) {
+        sTid = syscall(SYS_gettid);
+    }
+    timespec tv;
+    clock_gettime(CLOCK_BOOTTIME, &tv);
+    uint64_t elapsedTime = (uint64_t)tv.tv_sec * 1000000000 + tv.tv_nsec;
+    va_list args;
+    va_start(args, format);
+    loc_util::LogBuffer::getInstance()->appendArgs(level, elapsedTime, sTid, tag, format, args);
+    va_end(args);
 }
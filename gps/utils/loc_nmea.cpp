@@ -524,41 +524,253 @@ static loc_nmea_sv_meta* loc_nmea_sv_meta_init(loc_nmea_sv_meta& sv_meta,
 }
 
 /*===========================================================================
-FUNCTION    loc_nmea_put_checksum
+FUNCTION    loc_nmea_start / loc_nmea_put_* / loc_nmea_finish
 
 DESCRIPTION
-   Generate NMEA sentences generated based on position report
+   Append one sentence to the caller's LocNmeaBuffer. Fields are formatted
+   in place, numbers in fixed point, and the checksum is folded in as each
+   character is written. A sentence that does not fit is dropped whole,
+   along with all that follow it.
 
 DEPENDENCIES
    NONE
 
 RETURN VALUE
-   Total length of the nmea sentence
+   loc_nmea_finish: true if the sentence was added
 
 SIDE EFFECTS
    N/A
 
 ===========================================================================*/
-static int loc_nmea_put_checksum(char *pNmea, int maxSize)
+// "*hh\r\n"
+#define NMEA_TRAILER_LENGTH 5
+
+typedef struct loc_nmea_writer_s
 {
-    uint8_t checksum = 0;
-    int length = 0;
-    if(NULL == pNmea)
-        return 0;
+    LocNmeaBuffer* out;
+    char* p;
+    char* end;
+    uint8_t checksum;
+    bool overflow;
+} loc_nmea_writer;
 
-    pNmea++; //skip the $
-    while (*pNmea != '\0')
-    {
-        checksum ^= *pNmea++;
-        length++;
+static const uint32_t sPow10[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+
+static void loc_nmea_start(loc_nmea_writer& w, LocNmeaBuffer& out)
+{
+    // room is kept for the trailer and the terminating NUL
+    uint32_t limit = (out.size > NMEA_TRAILER_LENGTH) ? out.size - NMEA_TRAILER_LENGTH - 1 : 0;
+    w.out = &out;
+    w.p = out.buf + out.length;
+    w.end = out.buf + limit;
+    w.checksum = 0;
+    // once a sentence is dropped the rest are too, out keeps a clean prefix
+    w.overflow = (out.truncated || out.count >= NMEA_SENTENCE_COUNT_MAX ||
+                  out.length >= limit);
+    if (!w.overflow) {
+        // $ is not part of the checksum
+        *w.p++ = '$';
+    }
+}
+
+static inline void loc_nmea_put_char(loc_nmea_writer& w, char c)
+{
+    if (w.p < w.end) {
+        *w.p++ = c;
+        w.checksum ^= (uint8_t)c;
+    } else {
+        w.overflow = true;
+    }
+}
+
+static inline void loc_nmea_put_str(loc_nmea_writer& w, const char* s)
+{
+    while (*s != '\0') {
+        loc_nmea_put_char(w, *s++);
+    }
+}
+
+// as "%0<width>llu"
+static void loc_nmea_put_uint(loc_nmea_writer& w, uint64_t value, int width)
+{
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = '0' + (value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (width-- > n) {
+        loc_nmea_put_char(w, '0');
+    }
+    while (n > 0) {
+        loc_nmea_put_char(w, digits[--n]);
+    }
+}
+
+// as "%0<width>d", the sign counts into the width
+static void loc_nmea_put_int(loc_nmea_writer& w, int32_t value, int width)
+{
+    if (value < 0) {
+        loc_nmea_put_char(w, '-');
+        loc_nmea_put_uint(w, (uint64_t)(-(int64_t)value), width - 1);
+    } else {
+        loc_nmea_put_uint(w, value, width);
+    }
+}
+
+// as "%X"
+static void loc_nmea_put_hex(loc_nmea_writer& w, uint32_t value)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    int shift = 28;
+    while (shift > 0 && 0 == (value >> shift)) {
+        shift -= 4;
+    }
+    for (; shift >= 0; shift -= 4) {
+        loc_nmea_put_char(w, hex[(value >> shift) & 0xF]);
+    }
+}
+
+// as "%.<decimals>f", which rounds the exact binary value of value
+static void loc_nmea_put_fixed(loc_nmea_writer& w, double value, int decimals)
+{
+    double magnitude = fabs(value);
+    double scaled = magnitude * sPow10[decimals];
+    if (!(scaled < 4503599627370496.0)) {
+        // nan, inf, or too big for a double to keep a fraction; DBL_MAX
+        // takes 309 digits
+        char field[320];
+        snprintf(field, sizeof(field), "%.*f", decimals, value);
+        loc_nmea_put_str(w, field);
+        return;
+    }
+    // scaled is rounded, and rounding it again to an integer can go the
+    // wrong way around .5, e.g. 1.45 * 10 is 14.5 while 1.45 is below it.
+    // The exact product is scaled + error, with error exact through fma().
+    double error = fma(magnitude, (double)sPow10[decimals], -scaled);
+    double whole = floor(scaled);
+    // the sign of a rounded sum is that of the exact one, ties go to even
+    double aboveHalf = ((scaled - whole) - 0.5) + error;
+    uint64_t fixed = (uint64_t)whole;
+    if (aboveHalf > 0 || (0 == aboveHalf && (fixed & 1))) {
+        fixed++;
+    }
+    // printf keeps the sign of what rounds to 0, as in "-0.0"
+    if (signbit(value)) {
+        loc_nmea_put_char(w, '-');
+    }
+    loc_nmea_put_uint(w, fixed / sPow10[decimals], 1);
+    if (decimals > 0) {
+        loc_nmea_put_char(w, '.');
+        loc_nmea_put_uint(w, fixed % sPow10[decimals], decimals);
+    }
+}
+
+// non-negative degrees as "dd" or "ddd" followed by "mm.mmmmmm"
+static void loc_nmea_put_degrees(loc_nmea_writer& w, double degrees, int degreeWidth)
+{
+    // rounded in whole micro minutes, so 59.9999996' carries into the degrees
+    uint64_t microMinutes = (uint64_t)(degrees * 60.0 * 1000000.0 + 0.5);
+    loc_nmea_put_uint(w, microMinutes / 60000000, degreeWidth);
+    microMinutes %= 60000000;
+    loc_nmea_put_uint(w, microMinutes / 1000000, 2);
+    loc_nmea_put_char(w, '.');
+    loc_nmea_put_uint(w, microMinutes % 1000000, 6);
+}
+
+// "hhmmss.ss,"
+static void loc_nmea_put_utc_time(loc_nmea_writer& w, int hours, int minutes,
+                                  int seconds, int mSeconds)
+{
+    loc_nmea_put_uint(w, hours, 2);
+    loc_nmea_put_uint(w, minutes, 2);
+    loc_nmea_put_uint(w, seconds, 2);
+    loc_nmea_put_char(w, '.');
+    loc_nmea_put_uint(w, mSeconds / 10, 2);
+    loc_nmea_put_char(w, ',');
+}
+
+// "ddmm.mmmmmm,N,dddmm.mmmmmm,E," or ",,,,"
+static void loc_nmea_put_lat_long(loc_nmea_writer& w, bool hasLatLong,
+                                  double latitude, double longitude)
+{
+    if (!hasLatLong) {
+        loc_nmea_put_str(w, ",,,,");
+        return;
+    }
+    char latHemisphere = 'N';
+    char lonHemisphere = 'E';
+    if (!(latitude > 0)) {
+        latHemisphere = 'S';
+        latitude *= -1.0;
+    }
+    if (longitude < 0) {
+        lonHemisphere = 'W';
+        longitude *= -1.0;
+    }
+    loc_nmea_put_degrees(w, latitude, 2);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_char(w, latHemisphere);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_degrees(w, longitude, 3);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_char(w, lonHemisphere);
+    loc_nmea_put_char(w, ',');
+}
+
+static bool loc_nmea_finish(loc_nmea_writer& w)
+{
+    static const char hex[] = "0123456789ABCDEF";
+    LocNmeaBuffer& out = *w.out;
+
+    if (w.overflow) {
+        if (!out.truncated) {
+            LOC_LOGE("NMEA Error buffer full at sentence %u, %u bytes",
+                     out.count, out.length);
+        }
+        out.truncated = true;
+        if (out.size > 0) {
+            out.buf[out.length] = '\0';
+        }
+        return false;
     }
+    // loc_nmea_start kept the room for these
+    *w.p++ = '*';
+    *w.p++ = hex[w.checksum >> 4];
+    *w.p++ = hex[w.checksum & 0xF];
+    *w.p++ = '\r';
+    *w.p++ = '\n';
+    *w.p = '\0';
+    out.offsets[out.count] = out.length;
+    out.length = (uint32_t)(w.p - out.buf);
+    out.count++;
+    out.offsets[out.count] = out.length;
+    return true;
+}
 
-    // length now contains nmea sentence string length not including $ sign.
-    int checksumLength = snprintf(pNmea,(maxSize-length-1),"*%02X\r\n", checksum);
+static void loc_nmea_put_sentence(LocNmeaBuffer& out, const char* body)
+{
+    loc_nmea_writer w;
+    loc_nmea_start(w, out);
+    loc_nmea_put_str(w, body);
+    loc_nmea_finish(w);
+}
 
-    // total length of nmea sentence is length of nmea sentence inc $ sign plus
-    // length of checksum (+1 is to cover the $ character in the length).
-    return (length + checksumLength + 1);
+static void loc_nmea_repeat_sentence(LocNmeaBuffer& out, uint32_t index)
+{
+    uint32_t length = loc_nmea_sentence_length(out, index);
+    if (out.truncated) {
+        return;
+    } else if (out.count >= NMEA_SENTENCE_COUNT_MAX || out.length + length >= out.size) {
+        LOC_LOGE("NMEA Error buffer full at sentence %u, %u bytes", out.count, out.length);
+        out.truncated = true;
+        return;
+    }
+    memcpy(out.buf + out.length, out.buf + out.offsets[index], length);
+    out.length += length;
+    out.buf[out.length] = '\0';
+    out.count++;
+    out.offsets[out.count] = out.length;
 }
 
 /*===========================================================================
@@ -583,21 +795,15 @@ SIDE EFFECTS
 
 ===========================================================================*/
 static uint32_t loc_nmea_generate_GSA(const GpsLocationExtended &locationExtended,
-                              char* sentence,
-                              int bufSize,
                               loc_nmea_sv_meta* sv_meta_p,
-                              std::vector<std::string> &nmeaArraystr)
+                              LocNmeaBuffer &out)
 {
-    if (!sentence || bufSize <= 0 || !sv_meta_p)
+    if (!sv_meta_p)
     {
         LOC_LOGE("NMEA Error invalid arguments.");
         return 0;
     }
 
-    char* pMarker = sentence;
-    int lengthRemaining = bufSize;
-    int length = 0;
-
     uint32_t svUsedCount = 0;
     uint32_t svUsedList[64] = {0};
 
@@ -638,56 +844,41 @@ static uint32_t loc_nmea_generate_GSA(const GpsLocationExtended &locationExtende
     // v.v : Vertical DOP
     // s : GNSS System Id
     // cc : Checksum value
-    length = snprintf(pMarker, lengthRemaining, "$%sGSA,A,%c,", talker, fixType);
-
-    if (length < 0 || length >= lengthRemaining)
-    {
-        LOC_LOGE("NMEA Error in string formatting");
-        return 0;
-    }
-    pMarker += length;
-    lengthRemaining -= length;
+    loc_nmea_writer w;
+    loc_nmea_start(w, out);
+    loc_nmea_put_str(w, talker);
+    loc_nmea_put_str(w, "GSA,A,");
+    loc_nmea_put_char(w, fixType);
+    loc_nmea_put_char(w, ',');
 
     // Add first 12 satellite IDs
     for (uint8_t i = 0; i < 12; i++)
     {
         if (i < svUsedCount)
-            length = snprintf(pMarker, lengthRemaining, "%02d,", svUsedList[i]);
-        else
-            length = snprintf(pMarker, lengthRemaining, ",");
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return 0;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+            loc_nmea_put_uint(w, svUsedList[i], 2);
+        loc_nmea_put_char(w, ',');
     }
 
     // Add the position/horizontal/vertical DOP values
     if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DOP)
     {
-        length = snprintf(pMarker, lengthRemaining, "%.1f,%.1f,%.1f,",
-                locationExtended.pdop,
-                locationExtended.hdop,
-                locationExtended.vdop);
+        loc_nmea_put_fixed(w, locationExtended.pdop, 1);
+        loc_nmea_put_char(w, ',');
+        loc_nmea_put_fixed(w, locationExtended.hdop, 1);
+        loc_nmea_put_char(w, ',');
+        loc_nmea_put_fixed(w, locationExtended.vdop, 1);
+        loc_nmea_put_char(w, ',');
     }
     else
     {   // no dop
-        length = snprintf(pMarker, lengthRemaining, ",,,");
+        loc_nmea_put_str(w, ",,,");
     }
-    pMarker += length;
-    lengthRemaining -= length;
 
     // system id
-    length = snprintf(pMarker, lengthRemaining, "%d", sv_meta_p->systemId);
-    pMarker += length;
-    lengthRemaining -= length;
+    loc_nmea_put_uint(w, sv_meta_p->systemId, 1);
 
-    /* Sentence is ready, add checksum and broadcast */
-    length = loc_nmea_put_checksum(sentence, bufSize);
-    nmeaArraystr.push_back(sentence);
+    /* Sentence is ready, add checksum */
+    loc_nmea_finish(w);
 
     return svUsedCount;
 }
@@ -713,20 +904,15 @@ SIDE EFFECTS
 
 ===========================================================================*/
 static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
-                              char* sentence,
-                              int bufSize,
                               loc_nmea_sv_meta* sv_meta_p,
-                              std::vector<std::string> &nmeaArraystr)
+                              LocNmeaBuffer &out)
 {
-    if (!sentence || bufSize <= 0)
+    if (!sv_meta_p)
     {
         LOC_LOGE("NMEA Error invalid argument.");
         return;
     }
 
-    char* pMarker = sentence;
-    int lengthRemaining = bufSize;
-    int length = 0;
     int sentenceCount = 0;
     int sentenceNumber = 1;
     size_t svNumber = 1;
@@ -749,19 +935,15 @@ static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
 
     while (sentenceNumber <= sentenceCount)
     {
-        pMarker = sentence;
-        lengthRemaining = bufSize;
-
-        length = snprintf(pMarker, lengthRemaining, "$%sGSV,%d,%d,%02d",
-                talker, sentenceCount, sentenceNumber, svCount);
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_writer w;
+        loc_nmea_start(w, out);
+        loc_nmea_put_str(w, talker);
+        loc_nmea_put_str(w, "GSV,");
+        loc_nmea_put_int(w, sentenceCount, 1);
+        loc_nmea_put_char(w, ',');
+        loc_nmea_put_int(w, sentenceNumber, 1);
+        loc_nmea_put_char(w, ',');
+        loc_nmea_put_int(w, svCount, 2);
 
         for (int i=0; (svNumber <= svNotify.count) && (i < 4);  svNumber++)
         {
@@ -801,31 +983,20 @@ static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
             if (sv_meta_p->svType == svNotify.gnssSvs[svNumber - 1].type &&
                     sv_meta_p->signalId == convert_signalType_to_signalId(signalType))
             {
-                length = snprintf(pMarker, lengthRemaining,",%02d,%02d,%03d,",
-                        svNotify.gnssSvs[svNumber - 1].svId - svIdOffset,
-                        (int)(0.5 + svNotify.gnssSvs[svNumber - 1].elevation), //float to int
-                        (int)(0.5 + svNotify.gnssSvs[svNumber - 1].azimuth)); //float to int
-
-                if (length < 0 || length >= lengthRemaining)
-                {
-                    LOC_LOGE("NMEA Error in string formatting");
-                    return;
-                }
-                pMarker += length;
-                lengthRemaining -= length;
+                loc_nmea_put_char(w, ',');
+                loc_nmea_put_int(w, svNotify.gnssSvs[svNumber - 1].svId - svIdOffset, 2);
+                loc_nmea_put_char(w, ',');
+                loc_nmea_put_int(w,
+                        (int)(0.5 + svNotify.gnssSvs[svNumber - 1].elevation), 2); //float to int
+                loc_nmea_put_char(w, ',');
+                loc_nmea_put_int(w,
+                        (int)(0.5 + svNotify.gnssSvs[svNumber - 1].azimuth), 3); //float to int
+                loc_nmea_put_char(w, ',');
 
                 if (svNotify.gnssSvs[svNumber - 1].cN0Dbhz > 0)
                 {
-                    length = snprintf(pMarker, lengthRemaining,"%02d",
-                            (int)(0.5 + svNotify.gnssSvs[svNumber - 1].cN0Dbhz)); //float to int
-
-                    if (length < 0 || length >= lengthRemaining)
-                    {
-                        LOC_LOGE("NMEA Error in string formatting");
-                        return;
-                    }
-                    pMarker += length;
-                    lengthRemaining -= length;
+                    loc_nmea_put_int(w,
+                            (int)(0.5 + svNotify.gnssSvs[svNumber - 1].cN0Dbhz), 2); //float to int
                 }
 
                 i++;
@@ -834,12 +1005,10 @@ static void loc_nmea_generate_GSV(const GnssSvNotification &svNotify,
         }
 
         // append signalId
-        length = snprintf(pMarker, lengthRemaining,",%X",sv_meta_p->signalId);
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
+        loc_nmea_put_hex(w, sv_meta_p->signalId);
 
-        length = loc_nmea_put_checksum(sentence, bufSize);
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_finish(w);
         sentenceNumber++;
 
     }  //while
@@ -855,27 +1024,22 @@ DEPENDENCIES
    NONE
 
 RETURN VALUE
-   NONE
+   true if the sentence was added
 
 SIDE EFFECTS
    N/A
 
 ===========================================================================*/
-static void loc_nmea_generate_DTM(const LocLla &ref_lla,
+static bool loc_nmea_generate_DTM(const LocLla &ref_lla,
                                   const LocLla &local_lla,
-                                  char *talker,
-                                  char *sentence,
-                                  int bufSize)
+                                  const char *talker,
+                                  LocNmeaBuffer &out)
 {
-    char* pMarker = sentence;
-    int lengthRemaining = bufSize;
-    int length = 0;
     int datum_type;
     char ref_datum[4] = {0};
     char local_datum[4] = {0};
     double lla_offset[3] = {0};
     char latHem, longHem;
-    double latMins, longMins;
 
 
 
@@ -900,13 +1064,12 @@ static void loc_nmea_generate_DTM(const LocLla &ref_lla,
         default:
             break;
     }
-    length = snprintf(pMarker , lengthRemaining , "$%sDTM,%s,," , talker, local_datum);
-    if (length < 0 || length >= lengthRemaining) {
-        LOC_LOGE("NMEA Error in string formatting");
-        return;
-    }
-    pMarker += length;
-    lengthRemaining -= length;
+    loc_nmea_writer w;
+    loc_nmea_start(w, out);
+    loc_nmea_put_str(w, talker);
+    loc_nmea_put_str(w, "DTM,");
+    loc_nmea_put_str(w, local_datum);
+    loc_nmea_put_str(w, ",,");
 
     lla_offset[0] = local_lla.lat - ref_lla.lat;
     lla_offset[1] = fmod(local_lla.lon - ref_lla.lon, 360.0);
@@ -922,32 +1085,25 @@ static void loc_nmea_generate_DTM(const LocLla &ref_lla,
         latHem = 'S';
         lla_offset[0] *= -1.0;
     }
-    latMins = fmod(lla_offset[0] * 60.0, 60.0);
     if (lla_offset[1] < 0.0) {
         longHem = 'W';
         lla_offset[1] *= -1.0;
     }else {
         longHem = 'E';
     }
-    longMins = fmod(lla_offset[1] * 60.0, 60.0);
-    length = snprintf(pMarker, lengthRemaining, "%02d%09.6lf,%c,%03d%09.6lf,%c,%.3lf,",
-                     (uint8_t)floor(lla_offset[0]), latMins, latHem,
-                     (uint8_t)floor(lla_offset[1]), longMins, longHem, lla_offset[2]);
-    if (length < 0 || length >= lengthRemaining) {
-        LOC_LOGE("NMEA Error in string formatting");
-        return;
-    }
-    pMarker += length;
-    lengthRemaining -= length;
-    length = snprintf(pMarker , lengthRemaining , "%s" , ref_datum);
-    if (length < 0 || length >= lengthRemaining) {
-        LOC_LOGE("NMEA Error in string formatting");
-        return;
-    }
-    pMarker += length;
-    lengthRemaining -= length;
-
-    length = loc_nmea_put_checksum(sentence, bufSize);
+    loc_nmea_put_degrees(w, lla_offset[0], 2);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_char(w, latHem);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_degrees(w, lla_offset[1], 3);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_char(w, longHem);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_fixed(w, lla_offset[2], 3);
+    loc_nmea_put_char(w, ',');
+    loc_nmea_put_str(w, ref_datum);
+
+    return loc_nmea_finish(w);
 }
 
 /*===========================================================================
@@ -1258,6 +1414,9 @@ DESCRIPTION
    - $--RMC : Recommended minimum navigation information
    - $--GGA : Time, position and fix related data
 
+   Sentences are appended to out, out.indexOfGGA is set to the GGA
+   sentence if one is generated.
+
 DEPENDENCIES
    NONE
 
@@ -1273,12 +1432,11 @@ void loc_nmea_generate_pos(const UlpLocation &location,
                                const LocationSystemInfo &systemInfo,
                                unsigned char generate_nmea,
                                bool custom_gga_fix_quality,
-                               std::vector<std::string> &nmeaArraystr,
-                               int& indexOfGGA)
+                               LocNmeaBuffer &out)
 {
     ENTRY_LOG();
 
-    indexOfGGA = -1;
+    out.indexOfGGA = -1;
     LocGpsUtcTime utcPosTimestamp = 0;
     bool inLsTransition = false;
 
@@ -1293,14 +1451,7 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         return;
     }
 
-    char sentence[NMEA_SENTENCE_MAX_LENGTH] = {0};
-    char sentence_DTM[NMEA_SENTENCE_MAX_LENGTH] = {0};
-    char sentence_RMC[NMEA_SENTENCE_MAX_LENGTH] = {0};
-    char sentence_GNS[NMEA_SENTENCE_MAX_LENGTH] = {0};
-    char sentence_GGA[NMEA_SENTENCE_MAX_LENGTH] = {0};
-    char* pMarker = sentence;
-    int lengthRemaining = sizeof(sentence);
-    int length = 0;
+    loc_nmea_writer w;
     int utcYear = pTm->tm_year % 100; // 2 digit year
     int utcMonth = pTm->tm_mon + 1; // tm_mon starts at zero
     int utcDay = pTm->tm_mday;
@@ -1353,9 +1504,9 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$GPGSA/$GNGSA---
         // -------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
+        count = loc_nmea_generate_GSA(locationExtended,
                         loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GPS,
-                        GNSS_SIGNAL_GPS_L1CA, true), nmeaArraystr);
+                        GNSS_SIGNAL_GPS_L1CA, true), out);
         if (count > 0)
         {
             svUsedCount += count;
@@ -1367,9 +1518,9 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$GLGSA/$GNGSA---
         // -------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
+        count = loc_nmea_generate_GSA(locationExtended,
                         loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GLONASS,
-                        GNSS_SIGNAL_GLONASS_G1, true), nmeaArraystr);
+                        GNSS_SIGNAL_GLONASS_G1, true), out);
         if (count > 0)
         {
             svUsedCount += count;
@@ -1381,9 +1532,9 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$GAGSA/$GNGSA---
         // -------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
+        count = loc_nmea_generate_GSA(locationExtended,
                         loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GALILEO,
-                        GNSS_SIGNAL_GALILEO_E1, true), nmeaArraystr);
+                        GNSS_SIGNAL_GALILEO_E1, true), out);
         if (count > 0)
         {
             svUsedCount += count;
@@ -1394,9 +1545,9 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ----------------------------
         // ---$GBGSA/$GNGSA (BEIDOU)---
         // ----------------------------
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
+        count = loc_nmea_generate_GSA(locationExtended,
                         loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_BEIDOU,
-                        GNSS_SIGNAL_BEIDOU_B1I, true), nmeaArraystr);
+                        GNSS_SIGNAL_BEIDOU_B1I, true), out);
         if (count > 0)
         {
             svUsedCount += count;
@@ -1408,9 +1559,9 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ---$GQGSA/$GNGSA (QZSS)---
         // --------------------------
 
-        count = loc_nmea_generate_GSA(locationExtended, sentence, sizeof(sentence),
+        count = loc_nmea_generate_GSA(locationExtended,
                         loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_QZSS,
-                        GNSS_SIGNAL_QZSS_L1CA, true), nmeaArraystr);
+                        GNSS_SIGNAL_QZSS_L1CA, true), out);
         if (count > 0)
         {
             svUsedCount += count;
@@ -1421,9 +1572,7 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // if svUsedCount is 0, it means we do not generate any GSA sentence yet.
         // in this case, generate an empty GSA sentence
         if (svUsedCount == 0) {
-            strlcpy(sentence, "$GPGSA,A,1,,,,,,,,,,,,,,,,", sizeof(sentence));
-            length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-            nmeaArraystr.push_back(sentence);
+            loc_nmea_put_sentence(out, "GPGSA,A,1,,,,,,,,,,,,,,,,");
         }
 
         char ggaGpsQuality[3] = {'0', '\0', '\0'};
@@ -1437,9 +1586,8 @@ void loc_nmea_generate_pos(const UlpLocation &location,
         // ------$--VTG-------
         // -------------------
 
-        pMarker = sentence;
-        lengthRemaining = sizeof(sentence);
-
+        loc_nmea_start(w, out);
+        loc_nmea_put_str(w, talker);
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_BEARING)
         {
             float magTrack = location.gpsLocation.bearing;
@@ -1452,45 +1600,35 @@ void loc_nmea_generate_pos(const UlpLocation &location,
                     magTrack -= 360.0;
             }
 
-            length = snprintf(pMarker, lengthRemaining, "$%sVTG,%.1lf,T,%.1lf,M,", talker, location.gpsLocation.bearing, magTrack);
+            loc_nmea_put_str(w, "VTG,");
+            loc_nmea_put_fixed(w, location.gpsLocation.bearing, 1);
+            loc_nmea_put_str(w, ",T,");
+            loc_nmea_put_fixed(w, magTrack, 1);
+            loc_nmea_put_str(w, ",M,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining, "$%sVTG,,T,,M,", talker);
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_str(w, "VTG,,T,,M,");
         }
-        pMarker += length;
-        lengthRemaining -= length;
 
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_SPEED)
         {
             float speedKnots = location.gpsLocation.speed * (3600.0/1852.0);
             float speedKmPerHour = location.gpsLocation.speed * 3.6;
 
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,N,%.1lf,K,", speedKnots, speedKmPerHour);
+            loc_nmea_put_fixed(w, speedKnots, 1);
+            loc_nmea_put_str(w, ",N,");
+            loc_nmea_put_fixed(w, speedKmPerHour, 1);
+            loc_nmea_put_str(w, ",K,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining, ",N,,K,");
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_str(w, ",N,,K,");
         }
-        pMarker += length;
-        lengthRemaining -= length;
 
-        length = snprintf(pMarker, lengthRemaining, "%c", vtgModeIndicator);
+        loc_nmea_put_char(w, vtgModeIndicator);
 
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_finish(w);
 
         memset(&ecef_w84, 0, sizeof(ecef_w84));
         memset(&ecef_p90, 0, sizeof(ecef_p90));
@@ -1527,134 +1665,52 @@ void loc_nmea_generate_pos(const UlpLocation &location,
                 break;
         }
 
+        bool hasLatLong = (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG);
+
         // -------------------
         // ------$--DTM-------
         // -------------------
-        loc_nmea_generate_DTM(ref_lla, local_lla, talker, sentence_DTM, sizeof(sentence_DTM));
+        // written once, then repeated ahead of GNS and GGA for PZ90
+        int32_t indexOfDTM = -1;
+        if (loc_nmea_generate_DTM(ref_lla, local_lla, talker, out)) {
+            indexOfDTM = out.count - 1;
+        }
 
         // -------------------
         // ------$--RMC-------
         // -------------------
 
-        pMarker = sentence_RMC;
-        lengthRemaining = sizeof(sentence_RMC);
-
         bool validFix = ((0 != sv_cache_info.gps_used_mask) ||
                 (0 != sv_cache_info.glo_used_mask) ||
                 (0 != sv_cache_info.gal_used_mask) ||
                 (0 != sv_cache_info.qzss_used_mask) ||
                 (0 != sv_cache_info.bds_used_mask));
 
-        if (validFix) {
-            length = snprintf(pMarker, lengthRemaining, "$%sRMC,%02d%02d%02d.%02d,A,",
-                              talker, utcHours, utcMinutes, utcSeconds, utcMSeconds/10);
-        } else {
-            length = snprintf(pMarker, lengthRemaining, "$%sRMC,%02d%02d%02d.%02d,V,",
-                              talker, utcHours, utcMinutes, utcSeconds, utcMSeconds/10);
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
-        if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG)
-        {
-            double latitude = ref_lla.lat;
-            double longitude = ref_lla.lon;
-            char latHemisphere;
-            char lonHemisphere;
-            double latMinutes;
-            double lonMinutes;
-
-            if (latitude > 0)
-            {
-                latHemisphere = 'N';
-            }
-            else
-            {
-                latHemisphere = 'S';
-                latitude *= -1.0;
-            }
-
-            if (longitude < 0)
-            {
-                lonHemisphere = 'W';
-                longitude *= -1.0;
-            }
-            else
-            {
-                lonHemisphere = 'E';
-            }
-
-            latMinutes = fmod(latitude * 60.0 , 60.0);
-            lonMinutes = fmod(longitude * 60.0 , 60.0);
-
-            length = snprintf(pMarker, lengthRemaining, "%02d%09.6lf,%c,%03d%09.6lf,%c,",
-                              (uint8_t)floor(latitude), latMinutes, latHemisphere,
-                              (uint8_t)floor(longitude),lonMinutes, lonHemisphere);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining,",,,,");
-        }
+        loc_nmea_start(w, out);
+        loc_nmea_put_str(w, talker);
+        loc_nmea_put_str(w, "RMC,");
+        loc_nmea_put_utc_time(w, utcHours, utcMinutes, utcSeconds, utcMSeconds);
+        loc_nmea_put_str(w, validFix ? "A," : "V,");
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_lat_long(w, hasLatLong, ref_lla.lat, ref_lla.lon);
 
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_SPEED)
         {
             float speedKnots = location.gpsLocation.speed * (3600.0/1852.0);
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,", speedKnots);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining, ",");
+            loc_nmea_put_fixed(w, speedKnots, 1);
         }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
 
         if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_BEARING)
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,", location.gpsLocation.bearing);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining, ",");
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_fixed(w, location.gpsLocation.bearing, 1);
         }
-        pMarker += length;
-        lengthRemaining -= length;
-
-        length = snprintf(pMarker, lengthRemaining, "%2.2d%2.2d%2.2d,",
-                          utcDay, utcMonth, utcYear);
+        loc_nmea_put_char(w, ',');
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_uint(w, utcDay, 2);
+        loc_nmea_put_uint(w, utcMonth, 2);
+        loc_nmea_put_uint(w, utcYear, 2);
+        loc_nmea_put_char(w, ',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_MAG_DEV)
         {
@@ -1670,393 +1726,151 @@ void loc_nmea_generate_pos(const UlpLocation &location,
                 direction = 'E';
             }
 
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,%c,",
-                              magneticVariation, direction);
+            loc_nmea_put_fixed(w, magneticVariation, 1);
+            loc_nmea_put_char(w, ',');
+            loc_nmea_put_char(w, direction);
+            loc_nmea_put_char(w, ',');
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining, ",,");
+            loc_nmea_put_str(w, ",,");
         }
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
-        length = snprintf(pMarker, lengthRemaining, "%c", rmcModeIndicator);
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, rmcModeIndicator);
 
         // hardcode Navigation Status field to 'V'
-        length = snprintf(pMarker, lengthRemaining, ",%c", 'V');
+        loc_nmea_put_str(w, ",V");
+
+        loc_nmea_finish(w);
 
-        length = loc_nmea_put_checksum(sentence_RMC, sizeof(sentence_RMC));
+        if (LOC_GNSS_DATUM_PZ90 == datum_type && indexOfDTM >= 0) {
+            // ------$--DTM-------
+            loc_nmea_repeat_sentence(out, indexOfDTM);
+        }
 
         // -------------------
         // ------$--GNS-------
         // -------------------
 
-        pMarker = sentence_GNS;
-        lengthRemaining = sizeof(sentence_GNS);
-
-        length = snprintf(pMarker, lengthRemaining, "$%sGNS,%02d%02d%02d.%02d," ,
-                          talker, utcHours, utcMinutes, utcSeconds, utcMSeconds/10);
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
-        if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG)
-        {
-            double latitude = ref_lla.lat;
-            double longitude = ref_lla.lon;
-            char latHemisphere;
-            char lonHemisphere;
-            double latMinutes;
-            double lonMinutes;
-
-            if (latitude > 0)
-            {
-                latHemisphere = 'N';
-            }
-            else
-            {
-                latHemisphere = 'S';
-                latitude *= -1.0;
-            }
-
-            if (longitude < 0)
-            {
-                lonHemisphere = 'W';
-                longitude *= -1.0;
-            }
-            else
-            {
-                lonHemisphere = 'E';
-            }
-
-            latMinutes = fmod(latitude * 60.0 , 60.0);
-            lonMinutes = fmod(longitude * 60.0 , 60.0);
-
-            length = snprintf(pMarker, lengthRemaining, "%02d%09.6lf,%c,%03d%09.6lf,%c,",
-                              (uint8_t)floor(latitude), latMinutes, latHemisphere,
-                              (uint8_t)floor(longitude),lonMinutes, lonHemisphere);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining,",,,,");
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_start(w, out);
+        loc_nmea_put_str(w, talker);
+        loc_nmea_put_str(w, "GNS,");
+        loc_nmea_put_utc_time(w, utcHours, utcMinutes, utcSeconds, utcMSeconds);
 
-        length = snprintf(pMarker, lengthRemaining, "%s,", gnsModeIndicator);
+        loc_nmea_put_lat_long(w, hasLatLong, ref_lla.lat, ref_lla.lon);
 
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_str(w, gnsModeIndicator);
+        loc_nmea_put_char(w, ',');
 
+        loc_nmea_put_uint(w, svUsedCount, 2);
+        loc_nmea_put_char(w, ',');
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DOP) {
-            length = snprintf(pMarker, lengthRemaining, "%02d,%.1f,",
-                              svUsedCount, locationExtended.hdop);
+            loc_nmea_put_fixed(w, locationExtended.hdop, 1);
         }
-        else {   // no hdop
-            length = snprintf(pMarker, lengthRemaining, "%02d,,",
-                              svUsedCount);
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL)
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,",
-                              locationExtended.altitudeMeanSeaLevel);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining,",");
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_fixed(w, locationExtended.altitudeMeanSeaLevel, 1);
         }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
 
         if ((location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_ALTITUDE) &&
             (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL))
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,",
-                              ref_lla.alt - locationExtended.altitudeMeanSeaLevel);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining, ",");
-        }
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_fixed(w, ref_lla.alt - locationExtended.altitudeMeanSeaLevel, 1);
         }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DGNSS_DATA_AGE)
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1f,",
-                              (float)locationExtended.dgnssDataAgeMsec / 1000);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining, ",");
-        }
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_fixed(w, (float)locationExtended.dgnssDataAgeMsec / 1000, 1);
         }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DGNSS_REF_STATION_ID)
         {
-            length = snprintf(pMarker, lengthRemaining, "%04d",
-                              locationExtended.dgnssRefStationId);
-            if (length < 0 || length >= lengthRemaining)
-            {
-                LOC_LOGE("NMEA Error in string formatting");
-                return;
-            }
-            pMarker += length;
-            lengthRemaining -= length;
+            loc_nmea_put_uint(w, locationExtended.dgnssRefStationId, 4);
         }
 
         // hardcode Navigation Status field to 'V'
-        length = snprintf(pMarker, lengthRemaining, ",%c", 'V');
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_str(w, ",V");
 
-        length = loc_nmea_put_checksum(sentence_GNS, sizeof(sentence_GNS));
+        loc_nmea_finish(w);
+
+        if (LOC_GNSS_DATUM_PZ90 == datum_type && indexOfDTM >= 0) {
+            // ------$--DTM-------
+            loc_nmea_repeat_sentence(out, indexOfDTM);
+        }
 
         // -------------------
         // ------$--GGA-------
         // -------------------
 
-        pMarker = sentence_GGA;
-        lengthRemaining = sizeof(sentence_GGA);
-
-        length = snprintf(pMarker, lengthRemaining, "$%sGGA,%02d%02d%02d.%02d," ,
-                          talker, utcHours, utcMinutes, utcSeconds, utcMSeconds/10);
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
-
-        if (location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_LAT_LONG)
-        {
-            double latitude = ref_lla.lat;
-            double longitude = ref_lla.lon;
-            char latHemisphere;
-            char lonHemisphere;
-            double latMinutes;
-            double lonMinutes;
-
-            if (latitude > 0)
-            {
-                latHemisphere = 'N';
-            }
-            else
-            {
-                latHemisphere = 'S';
-                latitude *= -1.0;
-            }
-
-            if (longitude < 0)
-            {
-                lonHemisphere = 'W';
-                longitude *= -1.0;
-            }
-            else
-            {
-                lonHemisphere = 'E';
-            }
-
-            latMinutes = fmod(latitude * 60.0 , 60.0);
-            lonMinutes = fmod(longitude * 60.0 , 60.0);
-
-            length = snprintf(pMarker, lengthRemaining, "%02d%09.6lf,%c,%03d%09.6lf,%c,",
-                              (uint8_t)floor(latitude), latMinutes, latHemisphere,
-                              (uint8_t)floor(longitude),lonMinutes, lonHemisphere);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining,",,,,");
-        }
+        loc_nmea_start(w, out);
+        loc_nmea_put_str(w, talker);
+        loc_nmea_put_str(w, "GGA,");
+        loc_nmea_put_utc_time(w, utcHours, utcMinutes, utcSeconds, utcMSeconds);
 
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
-        }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_lat_long(w, hasLatLong, ref_lla.lat, ref_lla.lon);
 
         // Number of satellites in use, 00-12
         if (svUsedCount > MAX_SATELLITES_IN_USE)
             svUsedCount = MAX_SATELLITES_IN_USE;
+        loc_nmea_put_str(w, ggaGpsQuality);
+        loc_nmea_put_char(w, ',');
+        loc_nmea_put_uint(w, svUsedCount, 2);
+        loc_nmea_put_char(w, ',');
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DOP)
         {
-            length = snprintf(pMarker, lengthRemaining, "%s,%02d,%.1f,",
-                              ggaGpsQuality, svUsedCount, locationExtended.hdop);
-        }
-        else
-        {   // no hdop
-            length = snprintf(pMarker, lengthRemaining, "%s,%02d,,",
-                              ggaGpsQuality, svUsedCount);
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_fixed(w, locationExtended.hdop, 1);
         }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL)
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,M,",
-                              locationExtended.altitudeMeanSeaLevel);
+            loc_nmea_put_fixed(w, locationExtended.altitudeMeanSeaLevel, 1);
+            loc_nmea_put_str(w, ",M,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining,",,");
-        }
-
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_str(w, ",,");
         }
-        pMarker += length;
-        lengthRemaining -= length;
 
         if ((location.gpsLocation.flags & LOC_GPS_LOCATION_HAS_ALTITUDE) &&
             (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL))
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1lf,M,",
-                              ref_lla.alt - locationExtended.altitudeMeanSeaLevel);
+            loc_nmea_put_fixed(w, ref_lla.alt - locationExtended.altitudeMeanSeaLevel, 1);
+            loc_nmea_put_str(w, ",M,");
         }
         else
         {
-            length = snprintf(pMarker, lengthRemaining, ",,");
-        }
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_str(w, ",,");
         }
-        pMarker += length;
-        lengthRemaining -= length;
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DGNSS_DATA_AGE)
         {
-            length = snprintf(pMarker, lengthRemaining, "%.1f,",
-                              (float)locationExtended.dgnssDataAgeMsec / 1000);
-        }
-        else
-        {
-            length = snprintf(pMarker, lengthRemaining, ",");
-        }
-        if (length < 0 || length >= lengthRemaining)
-        {
-            LOC_LOGE("NMEA Error in string formatting");
-            return;
+            loc_nmea_put_fixed(w, (float)locationExtended.dgnssDataAgeMsec / 1000, 1);
         }
-        pMarker += length;
-        lengthRemaining -= length;
+        loc_nmea_put_char(w, ',');
 
         if (locationExtended.flags & GPS_LOCATION_EXTENDED_HAS_DGNSS_REF_STATION_ID)
         {
-            length = snprintf(pMarker, lengthRemaining, "%04d",
-                              locationExtended.dgnssRefStationId);
-            if (length < 0 || length >= lengthRemaining)
-            {
-                LOC_LOGE("NMEA Error in string formatting");
-                return;
-            }
-            pMarker += length;
-            lengthRemaining -= length;
+            loc_nmea_put_uint(w, locationExtended.dgnssRefStationId, 4);
         }
 
-        length = loc_nmea_put_checksum(sentence_GGA, sizeof(sentence_GGA));
-
-        // ------$--DTM-------
-        nmeaArraystr.push_back(sentence_DTM);
-        // ------$--RMC-------
-        nmeaArraystr.push_back(sentence_RMC);
-        if(LOC_GNSS_DATUM_PZ90 == datum_type) {
-            // ------$--DTM-------
-            nmeaArraystr.push_back(sentence_DTM);
-        }
-        // ------$--GNS-------
-        nmeaArraystr.push_back(sentence_GNS);
-        if(LOC_GNSS_DATUM_PZ90 == datum_type) {
-            // ------$--DTM-------
-            nmeaArraystr.push_back(sentence_DTM);
+        if (loc_nmea_finish(w)) {
+            out.indexOfGGA = out.count - 1;
         }
-        // ------$--GGA-------
-        nmeaArraystr.push_back(sentence_GGA);
-        indexOfGGA = static_cast<int>(nmeaArraystr.size() - 1);
     }
     //Send blank NMEA reports for non-final fixes
     else {
-        strlcpy(sentence, "$GPGSA,A,1,,,,,,,,,,,,,,,,", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPVTG,,T,,M,,N,,K,N", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPDTM,,,,,,,,", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPRMC,,V,,,,,,,,,,N,V", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPGNS,,,,,,N,,,,,,,V", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
-
-        strlcpy(sentence, "$GPGGA,,,,,,0,,,,,,,,", sizeof(sentence));
-        length = loc_nmea_put_checksum(sentence, sizeof(sentence));
-        nmeaArraystr.push_back(sentence);
+        loc_nmea_put_sentence(out, "GPGSA,A,1,,,,,,,,,,,,,,,,");
+        loc_nmea_put_sentence(out, "GPVTG,,T,,M,,N,,K,N");
+        loc_nmea_put_sentence(out, "GPDTM,,,,,,,,");
+        loc_nmea_put_sentence(out, "GPRMC,,V,,,,,,,,,,N,V");
+        loc_nmea_put_sentence(out, "GPGNS,,,,,,N,,,,,,,V");
+        loc_nmea_put_sentence(out, "GPGGA,,,,,,0,,,,,,,,");
     }
 
     EXIT_LOG(%d, 0);
@@ -2081,11 +1895,10 @@ SIDE EFFECTS
 
 ===========================================================================*/
 void loc_nmea_generate_sv(const GnssSvNotification &svNotify,
-                              std::vector<std::string> &nmeaArraystr)
+                              LocNmeaBuffer &out)
 {
     ENTRY_LOG();
 
-    char sentence[NMEA_SENTENCE_MAX_LENGTH] = {0};
     loc_sv_cache_info sv_cache_info = {};
 
     //Count GPS SVs for saparating GPS from GLONASS and throw others
@@ -2159,108 +1972,108 @@ void loc_nmea_generate_sv(const GnssSvNotification &svNotify,
     // ------$GPGSV:L1CA----
     // ---------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GPS,
-            GNSS_SIGNAL_GPS_L1CA, false), nmeaArraystr);
+            GNSS_SIGNAL_GPS_L1CA, false), out);
 
     // ---------------------
     // ------$GPGSV:L5------
     // ---------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GPS,
-            GNSS_SIGNAL_GPS_L5, false), nmeaArraystr);
+            GNSS_SIGNAL_GPS_L5, false), out);
 
     // ---------------------
     // ------$GPGSV:L2------
     // ---------------------
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GPS,
-            GNSS_SIGNAL_GPS_L2, false), nmeaArraystr);
+            GNSS_SIGNAL_GPS_L2, false), out);
 
     // ---------------------
     // ------$GLGSV:G1------
     // ---------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GLONASS,
-            GNSS_SIGNAL_GLONASS_G1, false), nmeaArraystr);
+            GNSS_SIGNAL_GLONASS_G1, false), out);
 
     // ---------------------
     // ------$GLGSV:G2------
     // ---------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GLONASS,
-            GNSS_SIGNAL_GLONASS_G2, false), nmeaArraystr);
+            GNSS_SIGNAL_GLONASS_G2, false), out);
 
     // ---------------------
     // ------$GAGSV:E1------
     // ---------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GALILEO,
-            GNSS_SIGNAL_GALILEO_E1, false), nmeaArraystr);
+            GNSS_SIGNAL_GALILEO_E1, false), out);
 
     // -------------------------
     // ------$GAGSV:E5A---------
     // -------------------------
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GALILEO,
-            GNSS_SIGNAL_GALILEO_E5A, false), nmeaArraystr);
+            GNSS_SIGNAL_GALILEO_E5A, false), out);
 
     // -------------------------
     // ------$GAGSV:E5B---------
     // -------------------------
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_GALILEO,
-            GNSS_SIGNAL_GALILEO_E5B, false), nmeaArraystr);
+            GNSS_SIGNAL_GALILEO_E5B, false), out);
 
     // -----------------------------
     // ------$GQGSV (QZSS):L1CA-----
     // -----------------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_QZSS,
-            GNSS_SIGNAL_QZSS_L1CA, false), nmeaArraystr);
+            GNSS_SIGNAL_QZSS_L1CA, false), out);
 
     // -----------------------------
     // ------$GQGSV (QZSS):L5-------
     // -----------------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_QZSS,
-            GNSS_SIGNAL_QZSS_L5, false), nmeaArraystr);
+            GNSS_SIGNAL_QZSS_L5, false), out);
     // -----------------------------
     // ------$GBGSV (BEIDOU:B1I)----
     // -----------------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_BEIDOU,
-            GNSS_SIGNAL_BEIDOU_B1I, false), nmeaArraystr);
+            GNSS_SIGNAL_BEIDOU_B1I, false), out);
 
     // -----------------------------
     // ------$GBGSV (BEIDOU:B1C)----
     // -----------------------------
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_BEIDOU,
-            GNSS_SIGNAL_BEIDOU_B1C, false), nmeaArraystr);
+            GNSS_SIGNAL_BEIDOU_B1C, false), out);
 
     // -----------------------------
     // ------$GBGSV (BEIDOU:B2AI)---
     // -----------------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_BEIDOU,
-            GNSS_SIGNAL_BEIDOU_B2AI, false), nmeaArraystr);
+            GNSS_SIGNAL_BEIDOU_B2AI, false), out);
 
     // -----------------------------
     // ------$GIGSV (NAVIC:L5)------
     // -----------------------------
 
-    loc_nmea_generate_GSV(svNotify, sentence, sizeof(sentence),
+    loc_nmea_generate_GSV(svNotify,
             loc_nmea_sv_meta_init(sv_meta, sv_cache_info, GNSS_SV_TYPE_NAVIC,
-            GNSS_SIGNAL_NAVIC_L5,false), nmeaArraystr);
+            GNSS_SIGNAL_NAVIC_L5,false), out);
 
     EXIT_LOG(%d, 0);
 }
@@ -31,8 +31,6 @@
 #define LOC_ENG_NMEA_H
 
 #include <gps_extended.h>
-#include <vector>
-#include <string>
 #define NMEA_SENTENCE_MAX_LENGTH 200
 
 /** gnss datum type */
@@ -72,16 +70,52 @@ typedef struct {
     double     Z;
 } LocEcef;
 
+/* an sv report with GNSS_SV_MAX SVs takes under 50 sentences */
+#define NMEA_SENTENCE_COUNT_MAX 64
+#define NMEA_BUFFER_MAX_LENGTH  8192
+
+/** Caller supplied output of the NMEA generators. Sentences, each with
+ *  its "*hh\r\n" trailer, are written back to back into buf, which is
+ *  kept NUL terminated. Sentence i spans [offsets[i], offsets[i + 1]),
+ *  and offsets[count] == length. A sentence that does not fit is dropped
+ *  whole and sets truncated. */
+typedef struct {
+    char*    buf;
+    uint32_t size;
+    uint32_t length;
+    uint32_t count;
+    uint32_t offsets[NMEA_SENTENCE_COUNT_MAX + 1];
+    /* index of the GGA sentence, -1 if none */
+    int32_t  indexOfGGA;
+    bool     truncated;
+} LocNmeaBuffer;
+
+inline void loc_nmea_buffer_init(LocNmeaBuffer& out, char* buf, uint32_t size) {
+    out.buf = buf;
+    out.size = size;
+    out.length = 0;
+    out.count = 0;
+    out.offsets[0] = 0;
+    out.indexOfGGA = -1;
+    out.truncated = false;
+    if (size > 0) {
+        buf[0] = '\0';
+    }
+}
+
+inline uint32_t loc_nmea_sentence_length(const LocNmeaBuffer& out, uint32_t index) {
+    return out.offsets[index + 1] - out.offsets[index];
+}
+
 void loc_nmea_generate_sv(const GnssSvNotification &svNotify,
-                              std::vector<std::string> &nmeaArraystr);
+                              LocNmeaBuffer &out);
 
 void loc_nmea_generate_pos(const UlpLocation &location,
                                const GpsLocationExtended &locationExtended,
                                const LocationSystemInfo &systemInfo,
                                unsigned char generate_nmea,
                                bool custom_gga_fix_quality,
-                               std::vector<std::string> &nmeaArraystr,
-                               int& indexOfGGA);
+                               LocNmeaBuffer &out);
 
 #define DEBUG_NMEA_MINSIZE 6
 #define DEBUG_NMEA_MAXSIZE 4096
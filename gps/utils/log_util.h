@@ -97,6 +97,7 @@ typedef struct loc_logger_s
   unsigned long  DEBUG_LEVEL;
   unsigned long  TIMESTAMP;
   bool           LOG_BUFFER_ENABLE;
+  unsigned long  LOG_BUFFER_BINARY_LEVEL;
 } loc_logger_s_type;
 
 
@@ -157,12 +158,15 @@ inline void loc_logger_init(unsigned long debug, unsigned long timestamp)
     loc_logger.TIMESTAMP = timestamp;
 }
 
-inline void log_buffer_init(bool enabled) {
+inline void log_buffer_init(bool enabled, unsigned long binaryLevel) {
     loc_logger.LOG_BUFFER_ENABLE = enabled;
+    loc_logger.LOG_BUFFER_BINARY_LEVEL = enabled ? binaryLevel : 0;
 }
 
 extern char* get_timestamp(char* str, unsigned long buf_size);
 extern void log_buffer_insert(char *str, unsigned long buf_size, int level);
+extern void log_buffer_insert_args(int level, const char* tag, const char* format, ...)
+        __attribute__((format(printf, 3, 4)));
 
 /*=============================================================================
  *
@@ -175,9 +179,25 @@ extern void log_buffer_insert(char *str, unsigned long buf_size, int level);
 #define TOTAL_LOG_LEVELS 5
 #define LOGGING_BUFFER_MAX_LEN 1024
 #define IF_LOG_BUFFER_ENABLE if (loc_logger.LOG_BUFFER_ENABLE)
+/* binary mode, LOG_BUFFER_BINARY_LEVEL in gps.conf: lines up to that level
+   go to the buffer as format pointer and raw args, even if DEBUG_LEVEL
+   keeps them out of logcat, and are formatted only when the buffer is
+   dumped. "" format keeps the format a literal, as its pointer is kept. */
+#define IF_LOG_BUFFER_BINARY(level) \
+    if ((unsigned long)(level) < loc_logger.LOG_BUFFER_BINARY_LEVEL)
+#define INSERT_BUFFER_BINARY(flag, level, format, x...)                                       \
+{                                                                                             \
+    IF_LOG_BUFFER_BINARY(level) {                                                             \
+        if (flag == 0) {                                                                      \
+            log_buffer_insert_args(level, LOG_TAG, "" format, ##x);                           \
+        }                                                                                     \
+    }                                                                                         \
+}
 #define INSERT_BUFFER(flag, level, format, x...)                                              \
 {                                                                                             \
-    IF_LOG_BUFFER_ENABLE {                                                                    \
+    if (loc_logger.LOG_BUFFER_BINARY_LEVEL > 0) {                                             \
+        INSERT_BUFFER_BINARY(flag, level, format, ##x);                                       \
+    } else IF_LOG_BUFFER_ENABLE {                                                             \
         if (flag == 0) {                                                                      \
             char timestr[32];                                                                 \
             get_timestamp(timestr, sizeof(timestr));                                          \
@@ -202,11 +222,16 @@ extern void log_buffer_insert(char *str, unsigned long buf_size, int level);
 #define IF_LOC_LOGD if((loc_logger.DEBUG_LEVEL >= 4) && (loc_logger.DEBUG_LEVEL <= 5))
 #define IF_LOC_LOGV if((loc_logger.DEBUG_LEVEL >= 5) && (loc_logger.DEBUG_LEVEL <= 5))
 
-#define LOC_LOGE(...) IF_LOC_LOGE { ALOGE(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 0, __VA_ARGS__);}
-#define LOC_LOGW(...) IF_LOC_LOGW { ALOGW(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 1, __VA_ARGS__);}
-#define LOC_LOGI(...) IF_LOC_LOGI { ALOGI(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 2, __VA_ARGS__);}
-#define LOC_LOGD(...) IF_LOC_LOGD { ALOGD(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 3, __VA_ARGS__);}
-#define LOC_LOGV(...) IF_LOC_LOGV { ALOGV(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 4, __VA_ARGS__);}
+#define LOC_LOGE(...) IF_LOC_LOGE { ALOGE(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 0, __VA_ARGS__);} \
+                      else INSERT_BUFFER_BINARY(LOG_NDEBUG, 0, __VA_ARGS__)
+#define LOC_LOGW(...) IF_LOC_LOGW { ALOGW(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 1, __VA_ARGS__);} \
+                      else INSERT_BUFFER_BINARY(LOG_NDEBUG, 1, __VA_ARGS__)
+#define LOC_LOGI(...) IF_LOC_LOGI { ALOGI(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 2, __VA_ARGS__);} \
+                      else INSERT_BUFFER_BINARY(LOG_NDEBUG, 2, __VA_ARGS__)
+#define LOC_LOGD(...) IF_LOC_LOGD { ALOGD(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 3, __VA_ARGS__);} \
+                      else INSERT_BUFFER_BINARY(LOG_NDEBUG, 3, __VA_ARGS__)
+#define LOC_LOGV(...) IF_LOC_LOGV { ALOGV(__VA_ARGS__); INSERT_BUFFER(LOG_NDEBUG, 4, __VA_ARGS__);} \
+                      else INSERT_BUFFER_BINARY(LOG_NDEBUG, 4, __VA_ARGS__)
 
 #else /* DEBUG_DMN_LOC_API */
 
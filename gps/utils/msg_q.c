@@ -25,61 +25,411 @@
  * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
  * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-
 // Uncomment to log verbose logs
 #define LOG_NDEBUG 1
 #define LOG_TAG "LocSvc_utils_q"
 #include <stdio.h>
 #include <stdlib.h>
-#include <pthread.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sched.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
 #include <loc_pla.h>
 #include <log_util.h>
 #include "linked_list.h"
 #include "msg_q.h"
 
+/* Size used to keep the producer and consumer ends on separate cache lines */
+#define MSG_Q_CACHE_LINE_SIZE 64
+
+/* Nodes each queue keeps for reuse, so that a queue with a steady stream
+   of messages does not go to the heap for every one of them. */
+#define MSG_Q_NODE_CACHE_SIZE 128
+
+/* A lower priority lane that has been passed over this many times in a row
+   while not empty gets served once, ahead of a busier higher priority lane.
+   The control lane (lane 0) is always served strictly first. */
+#define MSG_Q_STARVATION_LIMIT 16
+
+typedef struct msg_q_node {
+   struct msg_q_node* next;         /* Next (newer) node, linked in by the producer */
+   void* msg_obj;                   /* Message carried by this node */
+   void (*dealloc_func)(void*);     /* Deallocator used when flushing the message */
+   uint64_t tag;                    /* Opaque value given by the sender, see msg_q_snd_tag */
+   uint32_t free_next;              /* Next free node_cache index + 1, 0 for none */
+} msg_q_node;
+
+/* Multi-producer / single-consumer list. Producers swap themselves in at
+   head, the consumer walks from tail, which always points at a stub node
+   whose payload has already been handed out. */
+typedef struct msg_q_lane {
+   msg_q_node* head;                /* Newest node, shared by all the producers */
+   char head_pad[MSG_Q_CACHE_LINE_SIZE - sizeof(msg_q_node*)];
+   msg_q_node* tail;                /* Stub node, only touched by the consumer */
+   int skipped;                     /* Consumer only, times passed over while not empty */
+   char tail_pad[MSG_Q_CACHE_LINE_SIZE - sizeof(msg_q_node*) - sizeof(int)];
+   int depth;                       /* Messages currently queued in this lane */
+   int peak;                        /* Highest depth seen */
+} msg_q_lane;
+
 typedef struct msg_q {
-   void* msg_list;                  /* Linked list to store information */
-   pthread_cond_t  list_cond;       /* Condition variable for waiting on msg queue */
-   pthread_mutex_t list_mutex;      /* Mutex for exclusive access to message queue */
+   msg_q_lane lanes[MSG_Q_MAX_LANES]; /* Lane 0 is the highest priority */
+   int parked;                      /* Futex word, 1 while the consumer may sleep */
    int unblocked;                   /* Has this message queue been unblocked? */
+   uint64_t free_top;               /* Free node stack: ABA tag << 32 | index + 1 */
+   msg_q_node node_cache[MSG_Q_NODE_CACHE_SIZE];
 } msg_q;
 
+static inline void msg_q_futex(int* uaddr, int op, int val)
+{
+   syscall(SYS_futex, uaddr, op, val, NULL, NULL, 0);
+}
+
 /*===========================================================================
-FUNCTION    convert_linked_list_err_type
+FUNCTION    msg_q_node_alloc
 
 DESCRIPTION
-   Converts from one set of enum values to another.
+   Takes a node off the queue's free node stack, or from the heap if the
+   stack is empty. Safe to be called concurrently by any number of
+   producers. The ABA tag in the upper half of free_top makes a pop fail
+   if the stack changed under it, even if the same node is back on top.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   the node; NULL if out of memory
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static msg_q_node* msg_q_node_alloc(msg_q* p_msg_q)
+{
+   uint64_t top = __atomic_load_n(&p_msg_q->free_top, __ATOMIC_ACQUIRE);
+   for( ;; )
+   {
+      uint32_t index = (uint32_t)top;
+      if( index == 0 )
+      {
+         return (msg_q_node*)malloc(sizeof(msg_q_node));
+      }
+      msg_q_node* node = &p_msg_q->node_cache[index - 1];
+      uint32_t next = __atomic_load_n(&node->free_next, __ATOMIC_RELAXED);
+      uint64_t new_top = (((top >> 32) + 1) << 32) | next;
+      if( __atomic_compare_exchange_n(&p_msg_q->free_top, &top, new_top, 1,
+                                      __ATOMIC_ACQUIRE, __ATOMIC_ACQUIRE) )
+      {
+         return node;
+      }
+   }
+}
 
-   linked_list_val: Value to convert to msg_q_enum_type
+/*===========================================================================
+FUNCTION    msg_q_node_free
+
+DESCRIPTION
+   Returns a node to the queue's free node stack, or to the heap if it
+   did not come from the stack.
 
 DEPENDENCIES
    N/A
 
 RETURN VALUE
-   Corresponding linked_list_enum_type in msg_q_enum_type
+   N/A
 
 SIDE EFFECTS
    N/A
 
 ===========================================================================*/
-static msq_q_err_type convert_linked_list_err_type(linked_list_err_type linked_list_val)
+static void msg_q_node_free(msg_q* p_msg_q, msg_q_node* node)
 {
-   switch( linked_list_val )
+   if( node < p_msg_q->node_cache || node >= p_msg_q->node_cache + MSG_Q_NODE_CACHE_SIZE )
    {
-   case eLINKED_LIST_SUCCESS:
-      return eMSG_Q_SUCCESS;
-   case eLINKED_LIST_INVALID_PARAMETER:
-      return eMSG_Q_INVALID_PARAMETER;
-   case eLINKED_LIST_INVALID_HANDLE:
-      return eMSG_Q_INVALID_HANDLE;
-   case eLINKED_LIST_UNAVAILABLE_RESOURCE:
-      return eMSG_Q_UNAVAILABLE_RESOURCE;
-   case eLINKED_LIST_INSUFFICIENT_BUFFER:
-      return eMSG_Q_INSUFFICIENT_BUFFER;
+      free(node);
+      return;
+   }
 
-   case eLINKED_LIST_FAILURE_GENERAL:
-   default:
-      return eMSG_Q_FAILURE_GENERAL;
+   uint32_t index = (uint32_t)(node - p_msg_q->node_cache) + 1;
+   uint64_t top = __atomic_load_n(&p_msg_q->free_top, __ATOMIC_RELAXED);
+   uint64_t new_top;
+   do
+   {
+      __atomic_store_n(&node->free_next, (uint32_t)top, __ATOMIC_RELAXED);
+      new_top = (((top >> 32) + 1) << 32) | index;
+   } while( !__atomic_compare_exchange_n(&p_msg_q->free_top, &top, new_top, 1,
+                                         __ATOMIC_RELEASE, __ATOMIC_RELAXED) );
+}
+
+/*===========================================================================
+FUNCTION    msg_q_push
+
+DESCRIPTION
+   Links a node in at the head of a lane. Safe to be called concurrently
+   by any number of producers; never blocks.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   N/A
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static void msg_q_push(msg_q_lane* p_lane, msg_q_node* node)
+{
+   int depth = __atomic_add_fetch(&p_lane->depth, 1, __ATOMIC_RELAXED);
+   int peak = __atomic_load_n(&p_lane->peak, __ATOMIC_RELAXED);
+   while( depth > peak &&
+          !__atomic_compare_exchange_n(&p_lane->peak, &peak, depth, 1,
+                                       __ATOMIC_RELAXED, __ATOMIC_RELAXED) );
+
+   node->next = NULL;
+   msg_q_node* prev = __atomic_exchange_n(&p_lane->head, node, __ATOMIC_SEQ_CST);
+   /* until this store the consumer sees the lane as momentarily not linked */
+   __atomic_store_n(&prev->next, node, __ATOMIC_RELEASE);
+}
+
+/*===========================================================================
+FUNCTION    msg_q_lane_ready
+
+DESCRIPTION
+   Tells whether a lane has anything queued (or about to be linked in).
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   1 if not empty; 0 if empty
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static inline int msg_q_lane_ready(msg_q_lane* p_lane)
+{
+   return __atomic_load_n(&p_lane->head, __ATOMIC_SEQ_CST) != p_lane->tail;
+}
+
+/*===========================================================================
+FUNCTION    msg_q_lane_pop
+
+DESCRIPTION
+   Takes the oldest message off a lane. Must only be called by the consumer.
+
+   msg_obj:    Pointer to space to copy the message to.
+   dealloc:    Pointer to space to copy the message dealloc function to,
+               may be NULL.
+   tag:        Pointer to space to copy the message tag to, may be NULL.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   1 if a message was taken; 0 if the lane is empty
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static int msg_q_lane_pop(msg_q* p_msg_q, msg_q_lane* p_lane,
+                          void** msg_obj, void (**dealloc)(void*), uint64_t* tag)
+{
+   msg_q_node* tail = p_lane->tail;
+   msg_q_node* next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+
+   while( next == NULL )
+   {
+      if( tail == __atomic_load_n(&p_lane->head, __ATOMIC_SEQ_CST) )
+      {
+         return 0;
+      }
+      /* A producer swapped the head but has not linked its node yet,
+         it is only a couple of instructions away from doing so. */
+      sched_yield();
+      next = __atomic_load_n(&tail->next, __ATOMIC_ACQUIRE);
+   }
+
+   /* next becomes the new stub node once its payload is handed out */
+   p_lane->tail = next;
+   *msg_obj = next->msg_obj;
+   if( dealloc != NULL )
+   {
+      *dealloc = next->dealloc_func;
+   }
+   if( tag != NULL )
+   {
+      *tag = next->tag;
+   }
+   next->msg_obj = NULL;
+   next->dealloc_func = NULL;
+   msg_q_node_free(p_msg_q, tail);
+
+   __atomic_sub_fetch(&p_lane->depth, 1, __ATOMIC_RELAXED);
+
+   return 1;
+}
+
+/*===========================================================================
+FUNCTION    msg_q_pop
+
+DESCRIPTION
+   Takes the next message to be serviced off the queue: the oldest message
+   of the highest priority lane that is not empty, unless a lower priority
+   lane is starving. Must only be called by the consumer.
+
+   msg_obj:    Pointer to space to copy the message to.
+   dealloc:    Pointer to space to copy the message dealloc function to,
+               may be NULL.
+   tag:        Pointer to space to copy the message tag to, may be NULL.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   1 if a message was taken; 0 if the queue is empty
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static int msg_q_pop(msg_q* p_msg_q, void** msg_obj, void (**dealloc)(void*),
+                     uint64_t* tag)
+{
+   int lane, first = -1, starved = -1;
+
+   for( lane = 0; lane < MSG_Q_MAX_LANES; lane++ )
+   {
+      if( msg_q_lane_ready(&p_msg_q->lanes[lane]) )
+      {
+         if( first < 0 )
+         {
+            first = lane;
+         }
+         else if( ++p_msg_q->lanes[lane].skipped >= MSG_Q_STARVATION_LIMIT &&
+                  starved < 0 )
+         {
+            starved = lane;
+         }
+      }
+   }
+
+   if( first < 0 )
+   {
+      return 0;
+   }
+   if( first > 0 && starved > 0 )
+   {
+      first = starved;
+   }
+
+   p_msg_q->lanes[first].skipped = 0;
+   return msg_q_lane_pop(p_msg_q, &p_msg_q->lanes[first], msg_obj, dealloc, tag);
+}
+
+/*===========================================================================
+FUNCTION    msg_q_ready
+
+DESCRIPTION
+   Tells whether any lane of the queue has anything queued.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   1 if not empty; 0 if empty
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static int msg_q_ready(msg_q* p_msg_q)
+{
+   int lane;
+   for( lane = 0; lane < MSG_Q_MAX_LANES; lane++ )
+   {
+      if( msg_q_lane_ready(&p_msg_q->lanes[lane]) )
+      {
+         return 1;
+      }
+   }
+   return 0;
+}
+
+/*===========================================================================
+FUNCTION    msg_q_wait_pop
+
+DESCRIPTION
+   Takes the next message to be serviced off the queue, sleeping until
+   there is one or the queue gets unblocked. Must only be called by the
+   consumer.
+
+   msg_obj:    Pointer to space to copy the message to.
+   tag:        Pointer to space to copy the message tag to, may be NULL.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   Look at error codes above.
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static msq_q_err_type msg_q_wait_pop(msg_q* p_msg_q, void** msg_obj, uint64_t* tag)
+{
+   for( ;; )
+   {
+      if( __atomic_load_n(&p_msg_q->unblocked, __ATOMIC_SEQ_CST) )
+      {
+         LOC_LOGE("%s: Message queue has been unblocked.\n", __FUNCTION__);
+         return eMSG_Q_UNAVAILABLE_RESOURCE;
+      }
+
+      if( msg_q_pop(p_msg_q, msg_obj, NULL, tag) )
+      {
+         return eMSG_Q_SUCCESS;
+      }
+
+      /* Announce we are about to sleep, then look again so that a producer
+         racing with us either sees the flag or gets seen by the re-check. */
+      __atomic_store_n(&p_msg_q->parked, 1, __ATOMIC_SEQ_CST);
+      if( !__atomic_load_n(&p_msg_q->unblocked, __ATOMIC_SEQ_CST) &&
+          !msg_q_ready(p_msg_q) )
+      {
+         msg_q_futex(&p_msg_q->parked, FUTEX_WAIT_PRIVATE, 1);
+      }
+      __atomic_store_n(&p_msg_q->parked, 0, __ATOMIC_SEQ_CST);
+   }
+}
+
+/*===========================================================================
+FUNCTION    msg_q_wake
+
+DESCRIPTION
+   Wakes the consumer up, but only if it is parked (or about to park).
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   N/A
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+static void msg_q_wake(msg_q* p_msg_q, int waiters)
+{
+   if( __atomic_load_n(&p_msg_q->parked, __ATOMIC_SEQ_CST) &&
+       __atomic_exchange_n(&p_msg_q->parked, 0, __ATOMIC_SEQ_CST) )
+   {
+      msg_q_futex(&p_msg_q->parked, FUTEX_WAKE_PRIVATE, waiters);
    }
 }
 
@@ -106,31 +456,34 @@ msq_q_err_type msg_q_init(void** msg_q_data)
       return eMSG_Q_FAILURE_GENERAL;
    }
 
-   if( linked_list_init(&tmp_msg_q->msg_list) != 0 )
+   int lane;
+   for( lane = 0; lane < MSG_Q_MAX_LANES; lane++ )
    {
-      LOC_LOGE("%s: Unable to initialize storage list!\n", __FUNCTION__);
-      free(tmp_msg_q);
-      return eMSG_Q_FAILURE_GENERAL;
+      msg_q_node* stub = (msg_q_node*)calloc(1, sizeof(msg_q_node));
+      if( stub == NULL )
+      {
+         LOC_LOGE("%s: Unable to allocate space for message queue stub!\n", __FUNCTION__);
+         while( --lane >= 0 )
+         {
+            free(tmp_msg_q->lanes[lane].tail);
+         }
+         free(tmp_msg_q);
+         return eMSG_Q_FAILURE_GENERAL;
+      }
+      tmp_msg_q->lanes[lane].head = stub;
+      tmp_msg_q->lanes[lane].tail = stub;
    }
 
-   if( pthread_mutex_init(&tmp_msg_q->list_mutex, NULL) != 0 )
-   {
-      LOC_LOGE("%s: Unable to initialize list mutex!\n", __FUNCTION__);
-      linked_list_destroy(&tmp_msg_q->msg_list);
-      free(tmp_msg_q);
-      return eMSG_Q_FAILURE_GENERAL;
-   }
+   tmp_msg_q->parked = 0;
+   tmp_msg_q->unblocked = 0;
 
-   if( pthread_cond_init(&tmp_msg_q->list_cond, NULL) != 0 )
+   /* Chain all the cached nodes up as free */
+   int i;
+   for( i = 0; i < MSG_Q_NODE_CACHE_SIZE; i++ )
    {
-      LOC_LOGE("%s: Unable to initialize msg q cond var!\n", __FUNCTION__);
-      linked_list_destroy(&tmp_msg_q->msg_list);
-      pthread_mutex_destroy(&tmp_msg_q->list_mutex);
-      free(tmp_msg_q);
-      return eMSG_Q_FAILURE_GENERAL;
+      tmp_msg_q->node_cache[i].free_next = (uint32_t)i;
    }
-
-   tmp_msg_q->unblocked = 0;
+   tmp_msg_q->free_top = MSG_Q_NODE_CACHE_SIZE;
 
    *msg_q_data = tmp_msg_q;
 
@@ -158,7 +511,7 @@ const void* msg_q_init2()
   ===========================================================================*/
 msq_q_err_type msg_q_destroy(void** msg_q_data)
 {
-   if( msg_q_data == NULL )
+   if( msg_q_data == NULL || *msg_q_data == NULL )
    {
       LOC_LOGE("%s: Invalid msg_q_data parameter!\n", __FUNCTION__);
       return eMSG_Q_INVALID_HANDLE;
@@ -166,11 +519,13 @@ msq_q_err_type msg_q_destroy(void** msg_q_data)
 
    msg_q* p_msg_q = (msg_q*)*msg_q_data;
 
-   linked_list_destroy(&p_msg_q->msg_list);
-   pthread_mutex_destroy(&p_msg_q->list_mutex);
-   pthread_cond_destroy(&p_msg_q->list_cond);
-
-   p_msg_q->unblocked = 0;
+   msg_q_flush(p_msg_q);
+   /* only the stubs are left after a flush */
+   int lane;
+   for( lane = 0; lane < MSG_Q_MAX_LANES; lane++ )
+   {
+      msg_q_node_free(p_msg_q, p_msg_q->lanes[lane].tail);
+   }
 
    free(*msg_q_data);
    *msg_q_data = NULL;
@@ -185,40 +540,67 @@ msq_q_err_type msg_q_destroy(void** msg_q_data)
   ===========================================================================*/
 msq_q_err_type msg_q_snd(void* msg_q_data, void* msg_obj, void (*dealloc)(void*))
 {
-   msq_q_err_type rv;
+   return msg_q_snd_lane(msg_q_data, msg_obj, dealloc, 0);
+}
+
+/*===========================================================================
+
+  FUNCTION:   msg_q_snd_lane
+
+  ===========================================================================*/
+msq_q_err_type msg_q_snd_lane(void* msg_q_data, void* msg_obj, void (*dealloc)(void*),
+                              int lane)
+{
+   return msg_q_snd_tag(msg_q_data, msg_obj, dealloc, lane, 0);
+}
+
+/*===========================================================================
+
+  FUNCTION:   msg_q_snd_tag
+
+  ===========================================================================*/
+msq_q_err_type msg_q_snd_tag(void* msg_q_data, void* msg_obj, void (*dealloc)(void*),
+                             int lane, uint64_t tag)
+{
    if( msg_q_data == NULL )
    {
       LOC_LOGE("%s: Invalid msg_q_data parameter!\n", __FUNCTION__);
       return eMSG_Q_INVALID_HANDLE;
    }
-   if( msg_obj == NULL )
+   if( msg_obj == NULL || lane < 0 || lane >= MSG_Q_MAX_LANES )
    {
-      LOC_LOGE("%s: Invalid msg_obj parameter!\n", __FUNCTION__);
+      LOC_LOGE("%s: Invalid msg_obj %p / lane %d parameter!\n", __FUNCTION__, msg_obj, lane);
       return eMSG_Q_INVALID_PARAMETER;
    }
 
    msg_q* p_msg_q = (msg_q*)msg_q_data;
 
-   pthread_mutex_lock(&p_msg_q->list_mutex);
-   LOC_LOGV("%s: Sending message with handle = %p\n", __FUNCTION__, msg_obj);
+   LOC_LOGV("%s: Sending message with handle = %p lane %d\n", __FUNCTION__, msg_obj, lane);
 
-   if( p_msg_q->unblocked )
+   if( __atomic_load_n(&p_msg_q->unblocked, __ATOMIC_ACQUIRE) )
    {
       LOC_LOGE("%s: Message queue has been unblocked.\n", __FUNCTION__);
-      pthread_mutex_unlock(&p_msg_q->list_mutex);
       return eMSG_Q_UNAVAILABLE_RESOURCE;
    }
 
-   rv = convert_linked_list_err_type(linked_list_add(p_msg_q->msg_list, msg_obj, dealloc));
+   msg_q_node* node = msg_q_node_alloc(p_msg_q);
+   if( node == NULL )
+   {
+      LOC_LOGE("%s: Memory allocation failed\n", __FUNCTION__);
+      return eMSG_Q_FAILURE_GENERAL;
+   }
+   node->msg_obj = msg_obj;
+   node->dealloc_func = dealloc;
+   node->tag = tag;
+
+   msg_q_push(&p_msg_q->lanes[lane], node);
 
    /* Show data is in the message queue. */
-   pthread_cond_signal(&p_msg_q->list_cond);
-
-   pthread_mutex_unlock(&p_msg_q->list_mutex);
+   msg_q_wake(p_msg_q, 1);
 
    LOC_LOGV("%s: Finished Sending message with handle = %p\n", __FUNCTION__, msg_obj);
 
-   return rv;
+   return eMSG_Q_SUCCESS;
 }
 
 /*===========================================================================
@@ -228,7 +610,6 @@ msq_q_err_type msg_q_snd(void* msg_q_data, void* msg_obj, void (*dealloc)(void*)
   ===========================================================================*/
 msq_q_err_type msg_q_rcv(void* msg_q_data, void** msg_obj)
 {
-   msq_q_err_type rv;
    if( msg_q_data == NULL )
    {
       LOC_LOGE("%s: Invalid msg_q_data parameter!\n", __FUNCTION__);
@@ -241,30 +622,65 @@ msq_q_err_type msg_q_rcv(void* msg_q_data, void** msg_obj)
       return eMSG_Q_INVALID_PARAMETER;
    }
 
-   msg_q* p_msg_q = (msg_q*)msg_q_data;
+   msq_q_err_type rv = msg_q_wait_pop((msg_q*)msg_q_data, msg_obj, NULL);
+   if( rv == eMSG_Q_SUCCESS )
+   {
+      LOC_LOGV("%s: Received message %p\n", __FUNCTION__, *msg_obj);
+   }
+
+   return rv;
+}
+
+/*===========================================================================
 
-   pthread_mutex_lock(&p_msg_q->list_mutex);
+  FUNCTION:   msg_q_rcv_batch
 
-   if( p_msg_q->unblocked )
+  ===========================================================================*/
+msq_q_err_type msg_q_rcv_batch(void* msg_q_data, void** msg_objs,
+                               int max_count, int* count)
+{
+   return msg_q_rcv_batch_tag(msg_q_data, msg_objs, NULL, max_count, count);
+}
+
+/*===========================================================================
+
+  FUNCTION:   msg_q_rcv_batch_tag
+
+  ===========================================================================*/
+msq_q_err_type msg_q_rcv_batch_tag(void* msg_q_data, void** msg_objs, uint64_t* tags,
+                                   int max_count, int* count)
+{
+   if( msg_q_data == NULL )
    {
-      LOC_LOGE("%s: Message queue has been unblocked.\n", __FUNCTION__);
-      pthread_mutex_unlock(&p_msg_q->list_mutex);
-      return eMSG_Q_UNAVAILABLE_RESOURCE;
+      LOC_LOGE("%s: Invalid msg_q_data parameter!\n", __FUNCTION__);
+      return eMSG_Q_INVALID_HANDLE;
    }
 
-   /* Wait for data in the message queue */
-   while( linked_list_empty(p_msg_q->msg_list) && !p_msg_q->unblocked )
+   if( msg_objs == NULL || count == NULL || max_count <= 0 )
    {
-      pthread_cond_wait(&p_msg_q->list_cond, &p_msg_q->list_mutex);
+      LOC_LOGE("%s: Invalid msg_objs/count parameter!\n", __FUNCTION__);
+      return eMSG_Q_INVALID_PARAMETER;
    }
 
-   rv = convert_linked_list_err_type(linked_list_remove(p_msg_q->msg_list, msg_obj));
+   msg_q* p_msg_q = (msg_q*)msg_q_data;
+   int n = 0;
 
-   pthread_mutex_unlock(&p_msg_q->list_mutex);
+   *count = 0;
+   /* block for the first one only */
+   msq_q_err_type rv = msg_q_wait_pop(p_msg_q, &msg_objs[n], tags);
+   if( rv != eMSG_Q_SUCCESS )
+   {
+      return rv;
+   }
 
-   LOC_LOGV("%s: Received message %p rv = %d\n", __FUNCTION__, *msg_obj, rv);
+   for( n = 1; n < max_count &&
+               msg_q_pop(p_msg_q, &msg_objs[n], NULL, (tags != NULL) ? &tags[n] : NULL);
+        n++ );
+   *count = n;
 
-   return rv;
+   LOC_LOGV("%s: Received %d messages\n", __FUNCTION__, n);
+
+   return eMSG_Q_SUCCESS;
 }
 
 /*===========================================================================
@@ -274,7 +690,6 @@ msq_q_err_type msg_q_rcv(void* msg_q_data, void** msg_obj)
   ===========================================================================*/
 msq_q_err_type msg_q_rmv(void* msg_q_data, void** msg_obj)
 {
-   msq_q_err_type rv;
    if (msg_q_data == NULL) {
       LOC_LOGE("%s: Invalid msg_q_data parameter!\n", __FUNCTION__);
       return eMSG_Q_INVALID_HANDLE;
@@ -287,27 +702,19 @@ msq_q_err_type msg_q_rmv(void* msg_q_data, void** msg_obj)
 
    msg_q* p_msg_q = (msg_q*)msg_q_data;
 
-   pthread_mutex_lock(&p_msg_q->list_mutex);
-
-   if (p_msg_q->unblocked) {
+   if (__atomic_load_n(&p_msg_q->unblocked, __ATOMIC_ACQUIRE)) {
       LOC_LOGE("%s: Message queue has been unblocked.\n", __FUNCTION__);
-      pthread_mutex_unlock(&p_msg_q->list_mutex);
       return eMSG_Q_UNAVAILABLE_RESOURCE;
    }
 
-   if (linked_list_empty(p_msg_q->msg_list)) {
+   if (!msg_q_pop(p_msg_q, msg_obj, NULL, NULL)) {
       LOC_LOGW("%s: list is empty !!\n", __FUNCTION__);
-      pthread_mutex_unlock(&p_msg_q->list_mutex);
-      return eLINKED_LIST_EMPTY;
+      return (msq_q_err_type)eLINKED_LIST_EMPTY;
    }
 
-   rv = convert_linked_list_err_type(linked_list_remove(p_msg_q->msg_list, msg_obj));
-
-   pthread_mutex_unlock(&p_msg_q->list_mutex);
+   LOC_LOGV("%s: Removed message %p\n", __FUNCTION__, *msg_obj);
 
-   LOC_LOGV("%s: Removed message %p rv = %d\n", __FUNCTION__, *msg_obj, rv);
-
-   return rv;
+   return eMSG_Q_SUCCESS;
 }
 
 
@@ -319,7 +726,6 @@ msq_q_err_type msg_q_rmv(void* msg_q_data, void** msg_obj)
   ===========================================================================*/
 msq_q_err_type msg_q_flush(void* msg_q_data)
 {
-   msq_q_err_type rv;
    if ( msg_q_data == NULL )
    {
       LOC_LOGE("%s: Invalid msg_q_data parameter!\n", __FUNCTION__);
@@ -327,19 +733,24 @@ msq_q_err_type msg_q_flush(void* msg_q_data)
    }
 
    msg_q* p_msg_q = (msg_q*)msg_q_data;
+   void* msg_obj = NULL;
+   void (*dealloc)(void*) = NULL;
 
    LOC_LOGD("%s: Flushing Message Queue\n", __FUNCTION__);
 
-   pthread_mutex_lock(&p_msg_q->list_mutex);
-
-   /* Remove all elements from the list */
-   rv = convert_linked_list_err_type(linked_list_flush(p_msg_q->msg_list));
-
-   pthread_mutex_unlock(&p_msg_q->list_mutex);
+   /* Remove all elements from all the lanes */
+   while( msg_q_pop(p_msg_q, &msg_obj, &dealloc, NULL) )
+   {
+      /* Free data pointer if told to do so. */
+      if( dealloc != NULL )
+      {
+         dealloc(msg_obj);
+      }
+   }
 
    LOC_LOGD("%s: Message Queue flushed\n", __FUNCTION__);
 
-   return rv;
+   return eMSG_Q_SUCCESS;
 }
 
 /*===========================================================================
@@ -356,25 +767,52 @@ msq_q_err_type msg_q_unblock(void* msg_q_data)
    }
 
    msg_q* p_msg_q = (msg_q*)msg_q_data;
-   pthread_mutex_lock(&p_msg_q->list_mutex);
 
-   if( p_msg_q->unblocked )
+   if( __atomic_exchange_n(&p_msg_q->unblocked, 1, __ATOMIC_SEQ_CST) )
    {
       LOC_LOGE("%s: Message queue has been unblocked.\n", __FUNCTION__);
-      pthread_mutex_unlock(&p_msg_q->list_mutex);
       return eMSG_Q_UNAVAILABLE_RESOURCE;
    }
 
    LOC_LOGD("%s: Unblocking Message Queue\n", __FUNCTION__);
-   /* Unblocking message queue */
-   p_msg_q->unblocked = 1;
 
    /* Allow all the waiters to wake up */
-   pthread_cond_broadcast(&p_msg_q->list_cond);
-
-   pthread_mutex_unlock(&p_msg_q->list_mutex);
+   msg_q_wake(p_msg_q, INT_MAX);
 
    LOC_LOGD("%s: Message Queue unblocked\n", __FUNCTION__);
 
    return eMSG_Q_SUCCESS;
 }
+
+/*===========================================================================
+
+  FUNCTION:   msg_q_depth
+
+  ===========================================================================*/
+msq_q_err_type msg_q_depth(void* msg_q_data, int lane, int* depth, int* peak)
+{
+   if ( msg_q_data == NULL )
+   {
+      LOC_LOGE("%s: Invalid msg_q_data parameter!\n", __FUNCTION__);
+      return eMSG_Q_INVALID_HANDLE;
+   }
+
+   if ( lane < 0 || lane >= MSG_Q_MAX_LANES )
+   {
+      LOC_LOGE("%s: Invalid lane %d!\n", __FUNCTION__, lane);
+      return eMSG_Q_INVALID_PARAMETER;
+   }
+
+   msg_q* p_msg_q = (msg_q*)msg_q_data;
+
+   if ( depth != NULL )
+   {
+      *depth = __atomic_load_n(&p_msg_q->lanes[lane].depth, __ATOMIC_RELAXED);
+   }
+   if ( peak != NULL )
+   {
+      *peak = __atomic_load_n(&p_msg_q->lanes[lane].peak, __ATOMIC_RELAXED);
+   }
+
+   return eMSG_Q_SUCCESS;
+}
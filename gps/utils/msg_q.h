@@ -34,6 +34,10 @@ extern "C" {
 #endif /* __cplusplus */
 
 #include <stdlib.h>
+#include <stdint.h>
+
+/** Number of priority lanes in a message queue, lane 0 being serviced first */
+#define MSG_Q_MAX_LANES 3
 
 /** Linked List Return Codes */
 typedef enum
@@ -135,12 +139,75 @@ SIDE EFFECTS
 ===========================================================================*/
 msq_q_err_type msg_q_snd(void* msg_q_data, void* msg_obj, void (*dealloc)(void*));
 
+/*===========================================================================
+FUNCTION    msg_q_snd_lane
+
+DESCRIPTION
+   Same as msg_q_snd, but queues the message in the given priority lane.
+   msg_q_snd queues into lane 0. Messages are received in order within a
+   lane; across lanes the lowest numbered lane that is not empty is served
+   first. Lane 0 is served strictly first, the other lanes get a turn after
+   being passed over a number of times so they can not starve completely.
+
+   msg_q_data: Message Queue to add the element to.
+   msgp:       Pointer to data to add into message queue.
+   dealloc:    Function used to deallocate memory for this element. Pass NULL
+               if you do not want data deallocated during a flush operation
+   lane:       0 .. MSG_Q_MAX_LANES - 1
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   Look at error codes above.
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+msq_q_err_type msg_q_snd_lane(void* msg_q_data, void* msg_obj, void (*dealloc)(void*),
+                              int lane);
+
+/*===========================================================================
+FUNCTION    msg_q_snd_tag
+
+DESCRIPTION
+   Same as msg_q_snd_lane, but also stores tag in the queue node along with
+   the message. The tag is an opaque value handed back by
+   msg_q_rcv_batch_tag, e.g. the time the message was sent, so that the
+   sender does not have to keep it in the message itself.
+
+   msg_q_data: Message Queue to add the element to.
+   msgp:       Pointer to data to add into message queue.
+   dealloc:    Function used to deallocate memory for this element. Pass NULL
+               if you do not want data deallocated during a flush operation
+   lane:       0 .. MSG_Q_MAX_LANES - 1
+   tag:        Value to be received with the message.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   Look at error codes above.
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+msq_q_err_type msg_q_snd_tag(void* msg_q_data, void* msg_obj, void (*dealloc)(void*),
+                             int lane, uint64_t tag);
+
 /*===========================================================================
 FUNCTION    msg_q_rcv
 
 DESCRIPTION
    Retrieves data from the message queue. msg_obj is the oldest message received
-   and pointer is simply removed from message queue.
+   and pointer is simply removed from message queue. Blocks until a message is
+   available or the queue is unblocked.
+
+   Senders never take a lock; the queue supports any number of concurrent
+   senders but only one receiver at a time, i.e. msg_q_rcv, msg_q_rmv and
+   msg_q_flush must not be called concurrently with each other.
 
    msg_q_data: Message Queue to copy data from into msgp.
    msg_obj:    Pointer to space to copy msg_q contents to.
@@ -157,12 +224,66 @@ SIDE EFFECTS
 ===========================================================================*/
 msq_q_err_type msg_q_rcv(void* msg_q_data, void** msg_obj);
 
+/*===========================================================================
+FUNCTION    msg_q_rcv_batch
+
+DESCRIPTION
+   Retrieves up to max_count messages from the message queue in one go,
+   oldest first. Blocks like msg_q_rcv until at least one message is
+   available, then takes whatever else is already pending without waiting
+   for more. Same single receiver rule as msg_q_rcv applies.
+
+   msg_q_data: Message Queue to copy data from into msg_objs.
+   msg_objs:   Array of at least max_count slots to copy msg_q contents to.
+   max_count:  Maximum number of messages to retrieve, must be > 0.
+   count:      Number of messages actually retrieved.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   Look at error codes above.
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+msq_q_err_type msg_q_rcv_batch(void* msg_q_data, void** msg_objs,
+                               int max_count, int* count);
+
+/*===========================================================================
+FUNCTION    msg_q_rcv_batch_tag
+
+DESCRIPTION
+   Same as msg_q_rcv_batch, but also retrieves the tag each message was
+   sent with through msg_q_snd_tag; 0 for messages sent otherwise.
+
+   msg_q_data: Message Queue to copy data from into msg_objs.
+   msg_objs:   Array of at least max_count slots to copy msg_q contents to.
+   tags:       Array of at least max_count slots to copy the tags to.
+   max_count:  Maximum number of messages to retrieve, must be > 0.
+   count:      Number of messages actually retrieved.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   Look at error codes above.
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+msq_q_err_type msg_q_rcv_batch_tag(void* msg_q_data, void** msg_objs, uint64_t* tags,
+                                   int max_count, int* count);
+
 /*===========================================================================
 FUNCTION    msg_q_rmv
 
 DESCRIPTION
    Remove data from the message queue. msg_obj is the oldest message received
-   and pointer is simply removed from message queue.
+   and pointer is simply removed from message queue. Does not block if the
+   queue is empty. Same single receiver rule as msg_q_rcv applies.
 
    msg_q_data: Message Queue to copy data from into msgp.
    msg_obj:    Pointer to space to copy msg_q contents to.
@@ -184,7 +305,8 @@ msq_q_err_type msg_q_rmv(void* msg_q_data, void** msg_obj);
 FUNCTION    msg_q_flush
 
 DESCRIPTION
-   Function removes all elements from the message queue.
+   Function removes all elements from the message queue. Same single
+   receiver rule as msg_q_rcv applies.
 
    msg_q_data: Message Queue to remove elements from.
 
@@ -223,6 +345,30 @@ SIDE EFFECTS
 ===========================================================================*/
 msq_q_err_type msg_q_unblock(void* msg_q_data);
 
+/*===========================================================================
+FUNCTION    msg_q_depth
+
+DESCRIPTION
+   Reports the number of messages currently queued in a lane, and the
+   highest number ever queued in it.
+
+   msg_q_data: Message queue to query.
+   lane:       0 .. MSG_Q_MAX_LANES - 1
+   depth:      Current depth, may be NULL.
+   peak:       Peak depth, may be NULL.
+
+DEPENDENCIES
+   N/A
+
+RETURN VALUE
+   Look at error codes above.
+
+SIDE EFFECTS
+   N/A
+
+===========================================================================*/
+msq_q_err_type msg_q_depth(void* msg_q_data, int lane, int* depth, int* peak);
+
 #ifdef __cplusplus
 }
 #endif /* __cplusplus */
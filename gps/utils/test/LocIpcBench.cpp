@@ -0,0 +1,205 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// locipc_bench: host throughput of AF_UNIX datagram loopback receiving.
+// One thread sends N datagrams of a given size to a local socket, the
+// receiving side takes them in with one recvfrom() per datagram, with
+// recvmmsg() batches of LOC_IPC_RECV_BATCH_SIZE, and end to end through
+// a LocIpc local recver, which uses the latter.
+//
+//     locipc_bench [datagram size] [datagrams]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <LocIpc.h>
+
+using namespace loc_util;
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void report(const char* name, uint32_t count, uint32_t size, double elapsed,
+                   uint64_t syscalls) {
+    printf("%-18s %10.0f msgs/s %8.1f MB/s", name, count / elapsed,
+           (double)count * size / elapsed / 1e6);
+    if (syscalls > 0) {
+        printf("  %6.2f msgs per recv call", (double)count / syscalls);
+    }
+    printf("\n");
+}
+
+// Sends count datagrams to addr. The socket buffer is the only flow
+// control, so a sender outpacing the receiver just blocks in sendto().
+static void sendAll(const struct sockaddr_un& addr, uint32_t size, uint32_t count) {
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    std::vector<char> data(size, 'a');
+    for (uint32_t i = 0; i < count; i++) {
+        while (sendto(fd, data.data(), size, 0, (const struct sockaddr*)&addr,
+                      sizeof(addr)) < 0) {
+            usleep(10);
+        }
+    }
+    close(fd);
+}
+
+static bool benchRaw(bool batched, uint32_t size, uint32_t count, const char* path) {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    unlink(path);
+    int fd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    if (fd < 0 || bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+        perror("bind");
+        return false;
+    }
+
+    const uint32_t batch = batched ? LOC_IPC_RECV_BATCH_SIZE : 1;
+    std::vector<char> bufs((size_t)(size + 1) * batch);
+    std::vector<struct iovec> iovs(batch);
+    std::vector<struct mmsghdr> msgs(batch);
+    std::vector<struct sockaddr_storage> addrs(batch);
+
+    double start = nowSec();
+    std::thread sender(sendAll, std::cref(addr), size, count);
+    uint32_t received = 0;
+    uint64_t syscalls = 0;
+    while (received < count) {
+        int n;
+        if (batched) {
+            for (uint32_t i = 0; i < batch; i++) {
+                iovs[i].iov_base = &bufs[(size_t)(size + 1) * i];
+                iovs[i].iov_len = size + 1;
+                memset(&msgs[i].msg_hdr, 0, sizeof(msgs[i].msg_hdr));
+                msgs[i].msg_hdr.msg_iov = &iovs[i];
+                msgs[i].msg_hdr.msg_iovlen = 1;
+                msgs[i].msg_hdr.msg_name = &addrs[i];
+                msgs[i].msg_hdr.msg_namelen = sizeof(addrs[i]);
+            }
+            n = recvmmsg(fd, msgs.data(), batch, MSG_WAITFORONE, nullptr);
+        } else {
+            socklen_t addrlen = sizeof(addrs[0]);
+            n = (recvfrom(fd, bufs.data(), size + 1, 0,
+                          (struct sockaddr*)&addrs[0], &addrlen) >= 0) ? 1 : -1;
+        }
+        if (n < 0) {
+            perror("recv");
+            break;
+        }
+        received += n;
+        syscalls++;
+    }
+    double elapsed = nowSec() - start;
+    sender.join();
+    close(fd);
+    unlink(path);
+
+    report(batched ? "recvmmsg" : "recvfrom", count, size, elapsed, syscalls);
+    return received == count;
+}
+
+struct BenchListener : public ILocIpcListener {
+    std::atomic<uint32_t> mCount;
+    std::atomic<uint32_t> mBadSize;
+    const uint32_t mSize;
+    inline BenchListener(uint32_t size) : mCount(0), mBadSize(0), mSize(size) {}
+    virtual void onReceive(const char* /*data*/, uint32_t length,
+                           const LocIpcRecver* /*recver*/) override {
+        if (length != mSize) {
+            mBadSize++;
+        }
+        mCount.fetch_add(1, std::memory_order_release);
+    }
+};
+
+static bool benchLocIpc(uint32_t size, uint32_t count, const char* path) {
+    auto listener = std::make_shared<BenchListener>(size);
+    LocIpc ipc;
+    unlink(path);
+    std::unique_ptr<LocIpcRecver> recver = LocIpc::getLocIpcLocalRecver(listener, path);
+    if (!ipc.startNonBlockingListening(recver)) {
+        fprintf(stderr, "LocIpc listening on %s failed\n", path);
+        return false;
+    }
+    // the recver binds in the listening thread
+    for (int i = 0; i < 1000 && 0 != access(path, F_OK); i++) {
+        usleep(1000);
+    }
+    std::shared_ptr<LocIpcSender> sender = LocIpc::getLocIpcLocalSender(path);
+    std::string data(size, 'a');
+
+    double start = nowSec();
+    for (uint32_t i = 0; i < count; i++) {
+        LocIpc::send(*sender, (const uint8_t*)data.data(), size);
+    }
+    for (int idle = 0; listener->mCount.load(std::memory_order_acquire) < count &&
+                       idle < 2000; idle++) {
+        usleep(1000);
+    }
+    double elapsed = nowSec() - start;
+    ipc.stopNonBlockingListening();
+
+    uint32_t received = listener->mCount.load();
+    report("LocIpc local", received, size, elapsed, 0);
+    if (received != count || 0 != listener->mBadSize.load()) {
+        fprintf(stderr, "LocIpc: received %u of %u, %u of wrong size\n",
+                received, count, listener->mBadSize.load());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    uint32_t size = (argc > 1) ? strtoul(argv[1], NULL, 0) : 100;
+    uint32_t count = (argc > 2) ? strtoul(argv[2], NULL, 0) : 200000;
+    if (0 == size || size > 8192 || 0 == count) {
+        fprintf(stderr, "usage: %s [datagram size 1..8192] [datagrams]\n", argv[0]);
+        return 2;
+    }
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/locipc_bench.%d", (int)getpid());
+    printf("%u datagrams of %u bytes\n", count, size);
+
+    bool ok = benchRaw(false, size, count, path);
+    ok = benchRaw(true, size, count, path) && ok;
+    ok = benchLocIpc(size, count, path) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// locipc_framed_test: the framed local transport, with a LocIpcReactor
+// listening in the same process.
+//  - framed: msgs of all sizes, up to 256 KB, from concurrent framed
+//    senders arrive whole and in order per sender.
+//  - legacy sender: a getLocIpcLocalSender() peer still gets through to a
+//    framed recver, over datagrams, long msgs included.
+//  - legacy recver: a framed sender falls back to datagrams for a
+//    getLocIpcLocalRecver() peer.
+//
+//     locipc_framed_test [msgs per sender]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include <LocIpc.h>
+
+using namespace loc_util;
+
+#define MAX_SENDERS 4
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// a msg is its sender's digit and its seq in 8 digits, padded with a fill
+// char to its size
+static uint32_t getMsgSize(uint32_t seq) {
+    if (seq % 100 == 99) {
+        return 256 * 1024;
+    } else if (seq % 10 == 5) {
+        // longer than a datagram
+        return 20000;
+    }
+    return 16 + seq % 200;
+}
+static std::string makeMsg(uint32_t sender, uint32_t seq) {
+    char head[16];
+    snprintf(head, sizeof(head), "%u%08u", sender, seq);
+    std::string msg(getMsgSize(seq), (char)('a' + (sender + seq) % 26));
+    memcpy(&msg[0], head, 9);
+    return msg;
+}
+
+class TestListener : public ILocIpcListener {
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    uint32_t mNext[MAX_SENDERS];
+    uint32_t mReceived;
+public:
+    const uint32_t mTotal;
+    bool mOk;
+    inline TestListener(uint32_t total) : mNext(), mReceived(0), mTotal(total), mOk(true) {}
+    virtual void onReceive(const char* data, uint32_t length,
+                           const LocIpcRecver* /*recver*/) override {
+        uint32_t sender = (length >= 9) ? data[0] - '0' : MAX_SENDERS;
+        uint32_t seq = (length >= 9) ? strtoul(std::string(data + 1, 8).c_str(), nullptr, 10) : 0;
+        std::lock_guard<std::mutex> lock(mMutex);
+        if (sender >= MAX_SENDERS || seq != mNext[sender] || '\0' != data[length] ||
+                makeMsg(sender, seq) != std::string(data, length)) {
+            if (mOk) {
+                printf("got a msg of %u bytes from sender %u, seq %u, expected seq %u\n",
+                       length, sender, seq, sender < MAX_SENDERS ? mNext[sender] : 0);
+            }
+            mOk = false;
+        } else {
+            mNext[sender]++;
+        }
+        mReceived++;
+        mCond.notify_all();
+    }
+    bool waitDone(int seconds) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCond.wait_for(lock, std::chrono::seconds(seconds),
+                              [this] { return mReceived >= mTotal; }) && mOk;
+    }
+};
+
+// count msgs from each of senders, sent from a thread each
+static bool sendAll(const std::vector<std::shared_ptr<LocIpcSender>>& senders,
+                    uint32_t count, uint32_t& failed) {
+    std::atomic<uint32_t> failures(0);
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < senders.size(); i++) {
+        threads.emplace_back([&senders, &failures, i, count] {
+            for (uint32_t seq = 0; seq < count; seq++) {
+                std::string msg = makeMsg(i, seq);
+                if (!LocIpc::send(*senders[i], (const uint8_t*)msg.data(), msg.size())) {
+                    failures++;
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    failed = failures;
+    return 0 == failed;
+}
+
+static bool testFramed(const char* path, uint32_t count) {
+    const uint32_t senderCount = MAX_SENDERS;
+    auto listener = std::make_shared<TestListener>(senderCount * count);
+    LocIpcReactor reactor;
+    if (!reactor.addLocalFramedRecver(listener, path) || !reactor.start("FramedTest")) {
+        printf("FAIL: framed, no recver on %s\n", path);
+        return false;
+    }
+    std::vector<std::shared_ptr<LocIpcSender>> senders;
+    for (uint32_t i = 0; i < senderCount; i++) {
+        senders.push_back(LocIpc::getLocIpcLocalFramedSender(path));
+    }
+    uint32_t failed = 0;
+    double start = nowSec();
+    sendAll(senders, count, failed);
+    bool ok = listener->waitDone(20) && 0 == failed;
+    double elapsed = nowSec() - start;
+    reactor.stop();
+    printf("%s: framed, %u senders of %u msgs in %.3f s, %u sends failed\n",
+           ok ? "PASS" : "FAIL", senderCount, count, elapsed, failed);
+    return ok;
+}
+
+static bool testLegacySender(const char* path, uint32_t count) {
+    auto listener = std::make_shared<TestListener>(count);
+    LocIpcReactor reactor;
+    if (!reactor.addLocalFramedRecver(listener, path) || !reactor.start("FramedTest")) {
+        printf("FAIL: legacy sender, no recver on %s\n", path);
+        return false;
+    }
+    std::vector<std::shared_ptr<LocIpcSender>> senders = {LocIpc::getLocIpcLocalSender(path)};
+    uint32_t failed = 0;
+    sendAll(senders, count, failed);
+    bool ok = listener->waitDone(20) && 0 == failed;
+    reactor.stop();
+    printf("%s: legacy sender to a framed recver, %u msgs, %u sends failed\n",
+           ok ? "PASS" : "FAIL", count, failed);
+    return ok;
+}
+
+static bool testLegacyRecver(const char* path, uint32_t count) {
+    auto listener = std::make_shared<TestListener>(count);
+    LocIpcReactor reactor;
+    if (!reactor.addLocalRecver(listener, path) || !reactor.start("FramedTest")) {
+        printf("FAIL: legacy recver, no recver on %s\n", path);
+        return false;
+    }
+    std::vector<std::shared_ptr<LocIpcSender>> senders = {
+        LocIpc::getLocIpcLocalFramedSender(path)
+    };
+    uint32_t failed = 0;
+    sendAll(senders, count, failed);
+    bool ok = listener->waitDone(20) && 0 == failed;
+    reactor.stop();
+    printf("%s: framed sender to a legacy recver, %u msgs, %u sends failed\n",
+           ok ? "PASS" : "FAIL", count, failed);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = (argc > 1) ? strtoul(argv[1], NULL, 0) : 2000;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/locipc_framed_test.%d", (int)getpid());
+    signal(SIGPIPE, SIG_IGN);
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    bool ok = testFramed(path, count);
+    ok = testLegacySender(path, count) && ok;
+    ok = testLegacyRecver(path, count) && ok;
+    char framedPath[80];
+    snprintf(framedPath, sizeof(framedPath), "%s.framed", path);
+    unlink(path);
+    unlink(framedPath);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,447 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// locipc_shm_test: the shm ring transport between two local processes. A
+// forked child listens through a LocIpc shm recver, the parent sends.
+//  - order: msgs of all sizes, some too big for the ring, all arrive in
+//    order, across the datagrams sent before the ring is set up, and those
+//    the ring falls back to.
+//  - dead recver: a recver killed in the middle of a msg, or while the ring
+//    is full, fails the next send at once, instead of blocking it.
+//  - no blocking setup: a recver that never takes the shm connection does
+//    not hold up the sender, which uses datagrams meanwhile.
+//  - rewrite during delivery: a raw sender that rewrites a msg in its ring
+//    while the listener has it does not change what the listener sees.
+//
+//     locipc_shm_test [msgs]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <signal.h>
+#include <sys/eventfd.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <LocIpc.h>
+
+using namespace loc_util;
+
+// the ring takes msgs of up to about half its 256 KB
+#define TOO_BIG_FOR_RING (160 * 1024)
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// msg seq is its number in 8 digits, padded with its fill char to its size
+static uint32_t getMsgSize(uint32_t seq) {
+    if (seq % 1000 == 999) {
+        return TOO_BIG_FOR_RING;
+    } else if (seq % 100 == 50) {
+        // longer than a datagram, when it has to go as one
+        return 9000;
+    }
+    return 16 + seq % 200;
+}
+static std::string makeMsg(uint32_t seq) {
+    char head[16];
+    snprintf(head, sizeof(head), "%08u", seq);
+    std::string msg(getMsgSize(seq), (char)('a' + seq % 26));
+    memcpy(&msg[0], head, 8);
+    return msg;
+}
+
+class TestListener : public ILocIpcListener {
+    std::mutex mMutex;
+    std::condition_variable mCond;
+    bool mDone;
+public:
+    const uint32_t mCount;
+    // the msg to die in, if any
+    const uint32_t mDieAt;
+    // the msg to stall in, if any
+    const uint32_t mStallAt;
+    uint32_t mNext;
+    bool mOk;
+    inline TestListener(uint32_t count, uint32_t dieAt = UINT32_MAX,
+                        uint32_t stallAt = UINT32_MAX) :
+            mDone(false), mCount(count), mDieAt(dieAt), mStallAt(stallAt), mNext(0),
+            mOk(true) {}
+    virtual void onReceive(const char* data, uint32_t length,
+                           const LocIpcRecver* /*recver*/) override {
+        uint32_t seq = strtoul(std::string(data, 8).c_str(), nullptr, 10);
+        if (seq == mDieAt) {
+            kill(getpid(), SIGKILL);
+        } else if (seq == mStallAt) {
+            pause();
+        }
+        if (seq != mNext || makeMsg(seq) != std::string(data, length)) {
+            fprintf(stderr, "child: got msg %u of %u bytes, expected msg %u\n",
+                    seq, length, mNext);
+            mOk = false;
+        }
+        mNext = seq + 1;
+        if (mNext == mCount || !mOk) {
+            std::lock_guard<std::mutex> lock(mMutex);
+            mDone = true;
+            mCond.notify_all();
+        }
+    }
+    bool waitDone(int seconds) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCond.wait_for(lock, std::chrono::seconds(seconds), [this] { return mDone; });
+    }
+};
+
+// Forks a child that listens on path through a shm recver, and exits with 0
+// once it got count msgs in order. Returns its pid once it listens.
+static pid_t forkRecver(const char* path, uint32_t count, uint32_t dieAt = UINT32_MAX,
+                        uint32_t stallAt = UINT32_MAX) {
+    int ready[2];
+    if (pipe(ready) < 0) {
+        return -1;
+    }
+    pid_t pid = fork();
+    if (0 == pid) {
+        close(ready[0]);
+        auto listener = std::make_shared<TestListener>(count, dieAt, stallAt);
+        LocIpcReactor reactor;
+        if (!reactor.addShmRecver(listener, path) || !reactor.start("ShmTestRecver")) {
+            _exit(3);
+        }
+        char one = 1;
+        if (write(ready[1], &one, 1) < 0) {
+            _exit(3);
+        }
+        bool ok = listener->waitDone(20) && listener->mOk;
+        _exit(ok ? 0 : 1);
+    }
+    close(ready[1]);
+    char one = 0;
+    if (pid < 0 || read(ready[0], &one, 1) != 1) {
+        fprintf(stderr, "child failed to listen on %s\n", path);
+        pid = -1;
+    }
+    close(ready[0]);
+    return pid;
+}
+
+static bool waitChild(pid_t pid, int& status) {
+    for (int i = 0; i < 3000; i++) {
+        if (waitpid(pid, &status, WNOHANG) == pid) {
+            return true;
+        }
+        usleep(10000);
+    }
+    kill(pid, SIGKILL);
+    waitpid(pid, &status, 0);
+    return false;
+}
+
+static bool testOrder(const char* path, uint32_t count) {
+    pid_t pid = forkRecver(path, count);
+    if (pid < 0) {
+        return false;
+    }
+    std::shared_ptr<LocIpcSender> sender = LocIpc::getLocIpcShmSender(path);
+    uint32_t failed = 0;
+    double start = nowSec();
+    for (uint32_t seq = 0; seq < count; seq++) {
+        std::string msg = makeMsg(seq);
+        if (!LocIpc::send(*sender, (const uint8_t*)msg.data(), msg.size())) {
+            failed++;
+        }
+    }
+    double elapsed = nowSec() - start;
+    int status = 0;
+    bool exited = waitChild(pid, status);
+    bool ok = exited && WIFEXITED(status) && 0 == WEXITSTATUS(status) && 0 == failed;
+    printf("%s: order, %u msgs in %.3f s, %u sends failed\n",
+           ok ? "PASS" : "FAIL", count, elapsed, failed);
+    return ok;
+}
+
+// gives the child time to take the shm connection, so the sender is on the ring
+static void warmUp(LocIpcSender& sender, uint32_t& seq) {
+    for (int i = 0; i < 10; i++, seq++) {
+        std::string msg = makeMsg(seq);
+        LocIpc::send(sender, (const uint8_t*)msg.data(), msg.size());
+        usleep(10000);
+    }
+}
+
+static bool testDeadRecver(const char* path) {
+    const uint32_t dieAt = 10;
+    pid_t pid = forkRecver(path, UINT32_MAX, dieAt);
+    if (pid < 0) {
+        return false;
+    }
+    std::shared_ptr<LocIpcSender> sender = LocIpc::getLocIpcShmSender(path);
+    uint32_t seq = 0;
+    warmUp(*sender, seq);
+    std::string msg = makeMsg(seq++);
+    LocIpc::send(*sender, (const uint8_t*)msg.data(), msg.size());
+    int status = 0;
+    waitChild(pid, status);
+    bool killed = WIFSIGNALED(status) && SIGKILL == WTERMSIG(status);
+    msg = makeMsg(seq++);
+    double start = nowSec();
+    bool sent = LocIpc::send(*sender, (const uint8_t*)msg.data(), msg.size());
+    double elapsed = nowSec() - start;
+    bool ok = killed && !sent && elapsed < 0.5;
+    printf("%s: dead recver, next send %s in %.3f s\n",
+           ok ? "PASS" : "FAIL", sent ? "succeeded" : "failed", elapsed);
+    return ok;
+}
+
+static bool testDeadRecverFullRing(const char* path) {
+    const uint32_t stallAt = 10;
+    pid_t pid = forkRecver(path, UINT32_MAX, UINT32_MAX, stallAt);
+    if (pid < 0) {
+        return false;
+    }
+    std::shared_ptr<LocIpcSender> sender = LocIpc::getLocIpcShmSender(path);
+    uint32_t seq = 0;
+    warmUp(*sender, seq);
+    // the child stalls in msg 10, and the ring fills up behind it
+    std::thread killer([pid] {
+        usleep(300000);
+        kill(pid, SIGKILL);
+    });
+    double start = nowSec();
+    uint32_t sent = 0;
+    std::string msg(1024, 'x');
+    for (; sent < 100000; sent++) {
+        snprintf(&msg[0], 9, "%08u", seq++);
+        if (!LocIpc::send(*sender, (const uint8_t*)msg.data(), msg.size())) {
+            break;
+        }
+    }
+    double elapsed = nowSec() - start;
+    killer.join();
+    int status = 0;
+    waitChild(pid, status);
+    // the send waiting for room fails well before LOC_IPC_SHM_SEND_TIMEOUT_MS
+    bool ok = sent < 100000 && elapsed < 1.0;
+    printf("%s: dead recver with a full ring, send failed after %.3f s\n",
+           ok ? "PASS" : "FAIL", elapsed);
+    return ok;
+}
+
+static bool testSetUpDoesNotBlock(const char* path) {
+    // a recver that binds both sockets, but never takes the shm connection
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    snprintf(addr.sun_path, sizeof(addr.sun_path), "%s", path);
+    struct sockaddr_un shmAddr = addr;
+    snprintf(shmAddr.sun_path, sizeof(shmAddr.sun_path), "%s.shm", path);
+    unlink(addr.sun_path);
+    unlink(shmAddr.sun_path);
+    int dgramFd = socket(AF_UNIX, SOCK_DGRAM, 0);
+    int listenFd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    if (bind(dgramFd, (struct sockaddr*)&addr, sizeof(addr)) < 0 ||
+            bind(listenFd, (struct sockaddr*)&shmAddr, sizeof(shmAddr)) < 0 ||
+            listen(listenFd, 8) < 0) {
+        perror("bind");
+        return false;
+    }
+    const uint32_t count = 100;
+    // the datagram queue of a socket is short, so take them in as they come
+    std::atomic<uint32_t> received(0);
+    std::thread reader([dgramFd, &received] {
+        struct timeval timeout = {.tv_sec = 1, .tv_usec = 0};
+        setsockopt(dgramFd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        char buf[256];
+        while (received < count && recv(dgramFd, buf, sizeof(buf), 0) > 0) {
+            received++;
+        }
+    });
+    std::shared_ptr<LocIpcSender> sender = LocIpc::getLocIpcShmSender(path);
+    uint32_t sent = 0;
+    double start = nowSec();
+    for (uint32_t seq = 0; seq < count; seq++) {
+        std::string msg = makeMsg(seq);
+        sent += LocIpc::send(*sender, (const uint8_t*)msg.data(), msg.size()) ? 1 : 0;
+    }
+    double elapsed = nowSec() - start;
+    reader.join();
+    close(dgramFd);
+    close(listenFd);
+    unlink(addr.sun_path);
+    unlink(shmAddr.sun_path);
+    bool ok = count == sent && count == received.load() && elapsed < 0.5;
+    printf("%s: no blocking setup, %u of %u msgs over datagrams in %.3f s\n",
+           ok ? "PASS" : "FAIL", received.load(), count, elapsed);
+    return ok;
+}
+
+// the layout of the ring header the recver puts at the start of the memfd
+struct RawShmRing {
+    uint32_t magic;
+    uint32_t size;
+    std::atomic<uint32_t> closed;
+    alignas(64) std::atomic<uint64_t> tail;
+    std::atomic<uint32_t> recverWaiting;
+    alignas(64) std::atomic<uint64_t> head;
+    std::atomic<uint32_t> senderWaiting;
+    alignas(64) char data[0];
+};
+
+// holds on to the msg it gets till the test has rewritten it in the ring
+class RewriteListener : public ILocIpcListener {
+    std::mutex mMutex;
+    std::condition_variable mCond;
+public:
+    const std::string mExpected;
+    bool mInDelivery;
+    bool mRewritten;
+    bool mDone;
+    bool mOk;
+    inline RewriteListener(const std::string& expected) : mExpected(expected),
+            mInDelivery(false), mRewritten(false), mDone(false), mOk(false) {}
+    virtual void onReceive(const char* data, uint32_t length,
+                           const LocIpcRecver* /*recver*/) override {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mInDelivery = true;
+        mCond.notify_all();
+        mCond.wait_for(lock, std::chrono::seconds(5), [this] { return mRewritten; });
+        mOk = mExpected == std::string(data, length) && 0 == data[length];
+        mDone = true;
+        mCond.notify_all();
+    }
+    bool waitFor(bool RewriteListener::* flag) {
+        std::unique_lock<std::mutex> lock(mMutex);
+        return mCond.wait_for(lock, std::chrono::seconds(5), [this, flag] { return this->*flag; });
+    }
+    void setRewritten() {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mRewritten = true;
+        mCond.notify_all();
+    }
+};
+
+static bool testRewriteDuringDelivery(const char* path) {
+    std::string expected = makeMsg(0);
+    auto listener = std::make_shared<RewriteListener>(expected);
+    LocIpcReactor reactor;
+    if (!reactor.addShmRecver(listener, path) || !reactor.start("ShmTestRewrite")) {
+        return false;
+    }
+    // takes the ring and doorbell as a shm sender does, to write the ring itself
+    struct sockaddr_un shmAddr = {};
+    shmAddr.sun_family = AF_UNIX;
+    snprintf(shmAddr.sun_path, sizeof(shmAddr.sun_path), "%s.shm", path);
+    int connFd = socket(AF_UNIX, SOCK_SEQPACKET, 0);
+    uint32_t magic = 0;
+    struct iovec iov = {.iov_base = &magic, .iov_len = sizeof(magic)};
+    char control[CMSG_SPACE(2 * sizeof(int))] = {};
+    struct msghdr msg = {};
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    struct cmsghdr* cmsg = nullptr;
+    if (connect(connFd, (struct sockaddr*)&shmAddr, sizeof(shmAddr)) < 0 ||
+            recvmsg(connFd, &msg, 0) != sizeof(magic) ||
+            nullptr == (cmsg = CMSG_FIRSTHDR(&msg)) || SCM_RIGHTS != cmsg->cmsg_type) {
+        perror("shm connect");
+        close(connFd);
+        return false;
+    }
+    int fds[2];
+    memcpy(fds, CMSG_DATA(cmsg), sizeof(fds));
+    struct stat memStat = {};
+    fstat(fds[0], &memStat);
+    void* map = mmap(nullptr, memStat.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fds[0], 0);
+    if (MAP_FAILED == map) {
+        perror("mmap");
+        close(fds[0]);
+        close(fds[1]);
+        close(connFd);
+        return false;
+    }
+    RawShmRing* ring = (RawShmRing*)map;
+    // a record: the length, the msg, a '\0', and padding to 8 bytes
+    uint32_t length = expected.size();
+    memcpy(ring->data, &length, sizeof(length));
+    memcpy(ring->data + sizeof(length), expected.c_str(), length + 1);
+    ring->tail.store((sizeof(length) + length + 1 + 7) & ~7u, std::memory_order_release);
+    uint64_t one = 1;
+    bool rang = write(fds[1], &one, sizeof(one)) == sizeof(one);
+    bool delivered = rang && listener->waitFor(&RewriteListener::mInDelivery);
+    if (delivered) {
+        // while the listener has the msg, as a sender reusing the room would
+        memset(ring->data + sizeof(length), 'X', length + 1);
+    }
+    listener->setRewritten();
+    bool done = delivered && listener->waitFor(&RewriteListener::mDone);
+    bool ok = done && listener->mOk;
+    printf("%s: rewrite during delivery, the listener %s\n", ok ? "PASS" : "FAIL",
+           !done ? "got no msg" : (listener->mOk ? "kept the msg as sent" :
+                                                  "saw the rewritten ring"));
+    reactor.stop();
+    munmap(map, memStat.st_size);
+    close(fds[0]);
+    close(fds[1]);
+    close(connFd);
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    uint32_t count = (argc > 1) ? strtoul(argv[1], NULL, 0) : 20000;
+    char path[64];
+    snprintf(path, sizeof(path), "/tmp/locipc_shm_test.%d", (int)getpid());
+    // the sender sees a dead recver as a closed socket, not a signal
+    signal(SIGPIPE, SIG_IGN);
+    setvbuf(stdout, nullptr, _IOLBF, 0);
+
+    bool ok = testOrder(path, count);
+    ok = testDeadRecver(path) && ok;
+    ok = testDeadRecverFullRing(path) && ok;
+    ok = testSetUpDoesNotBlock(path) && ok;
+    ok = testRewriteDuringDelivery(path) && ok;
+    char shmPath[80];
+    snprintf(shmPath, sizeof(shmPath), "%s.shm", path);
+    unlink(path);
+    unlink(shmPath);
+    return ok ? 0 : 1;
+}
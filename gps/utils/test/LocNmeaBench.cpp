@@ -0,0 +1,153 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// loc_nmea_bench: host cost of NMEA generation. Formats the same fix with
+// every field present, then the same sv report, into a caller supplied
+// buffer and reports the time and heap allocations per call, counted by
+// replacing the global operator new, and the sentences per second.
+//
+//     loc_nmea_bench [iterations] [svs]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <atomic>
+#include <new>
+#include <loc_nmea.h>
+
+static std::atomic<uint64_t> sAllocs(0);
+
+void* operator new(size_t size) {
+    sAllocs++;
+    void* p = malloc(size > 0 ? size : 1);
+    if (nullptr == p) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void fill(UlpLocation& l, GpsLocationExtended& e, LocationSystemInfo& si,
+                 GnssSvNotification& sv, uint32_t svs) {
+    memset(&l, 0, sizeof(l));
+    memset(&e, 0, sizeof(e));
+    memset(&si, 0, sizeof(si));
+    memset(&sv, 0, sizeof(sv));
+    l.gpsLocation.flags = 0xff;
+    l.gpsLocation.latitude = 37.4219983;
+    l.gpsLocation.longitude = -122.084;
+    l.gpsLocation.altitude = 12.34;
+    l.gpsLocation.speed = 13.4;
+    l.gpsLocation.bearing = 271.5;
+    l.gpsLocation.timestamp = 1600000000123ULL;
+    l.tech_mask = LOC_POS_TECH_MASK_SATELLITE;
+    e.flags = ~0ULL;
+    e.altitudeMeanSeaLevel = 40.25;
+    e.pdop = 1.8;
+    e.hdop = 0.9;
+    e.vdop = 1.5;
+    e.magneticDeviation = 13.2;
+    e.gnss_sv_used_ids.gps_sv_used_ids_mask = 0x3f5;
+    e.gnss_sv_used_ids.glo_sv_used_ids_mask = 0x1c;
+    e.gnss_sv_used_ids.gal_sv_used_ids_mask = 0x62;
+    e.gnss_sv_used_ids.bds_sv_used_ids_mask = 0x109;
+    e.dgnssDataAgeMsec = 2500;
+    e.dgnssRefStationId = 117;
+
+    static const GnssSvType types[] = {GNSS_SV_TYPE_GPS, GNSS_SV_TYPE_GLONASS,
+            GNSS_SV_TYPE_GALILEO, GNSS_SV_TYPE_QZSS, GNSS_SV_TYPE_BEIDOU, GNSS_SV_TYPE_NAVIC};
+    sv.count = svs;
+    for (uint32_t i = 0; i < svs; i++) {
+        sv.gnssSvs[i].type = types[i % 6];
+        sv.gnssSvs[i].svId = 1 + i / 6 +
+                (GNSS_SV_TYPE_GLONASS == sv.gnssSvs[i].type ? 64 : 0);
+        sv.gnssSvs[i].cN0Dbhz = 20 + i % 25;
+        sv.gnssSvs[i].elevation = (i * 7) % 90;
+        sv.gnssSvs[i].azimuth = (i * 37) % 360;
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    uint32_t svs = argc > 2 ? atoi(argv[2]) : 40;
+    if (svs > GNSS_SV_MAX) {
+        svs = GNSS_SV_MAX;
+    }
+
+    static UlpLocation l;
+    static GpsLocationExtended e;
+    static LocationSystemInfo si;
+    static GnssSvNotification sv;
+    static char buf[NMEA_BUFFER_MAX_LENGTH];
+    fill(l, e, si, sv, svs);
+
+    uint64_t sentences = 0;
+    uint64_t allocs = sAllocs;
+    double start = nowSec();
+    for (uint32_t i = 0; i < iterations; i++) {
+        LocNmeaBuffer out;
+        loc_nmea_buffer_init(out, buf, sizeof(buf));
+        loc_nmea_generate_pos(l, e, si, true, false, out);
+        sentences += out.count;
+    }
+    double posTime = nowSec() - start;
+    uint64_t posAllocs = sAllocs - allocs;
+
+    allocs = sAllocs;
+    start = nowSec();
+    for (uint32_t i = 0; i < iterations; i++) {
+        LocNmeaBuffer out;
+        loc_nmea_buffer_init(out, buf, sizeof(buf));
+        loc_nmea_generate_sv(sv, out);
+        sentences += out.count;
+    }
+    double svTime = nowSec() - start;
+    uint64_t svAllocs = sAllocs - allocs;
+
+    printf("pos: %8.2f us/fix    %6.2f allocs/fix\n", posTime / iterations * 1e6,
+           (double)posAllocs / iterations);
+    printf("sv:  %8.2f us/report %6.2f allocs/report (%u svs)\n", svTime / iterations * 1e6,
+           (double)svAllocs / iterations, svs);
+    printf("%.0f sentences/s\n", sentences / (posTime + svTime));
+    return 0;
+}
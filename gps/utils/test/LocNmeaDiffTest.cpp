@@ -0,0 +1,185 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// loc_nmea_diff_test: checks the decimal fields of generated GGA, GNS and
+// VTG sentences against snprintf("%.1f") of the same values, which is how
+// they were formatted before loc_nmea_put_fixed(). Altitudes and DOPs are
+// drawn on a 0.01 grid as well, so many of them sit next to a rounding
+// tie. Every sentence's checksum is verified too. Uses the WGS84 datum,
+// the default when no gps.conf is found.
+//
+//     loc_nmea_diff_test [fixes] [seed]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <loc_nmea.h>
+
+static uint32_t sFields = 0;
+static uint32_t sFailures = 0;
+
+static double rnd(double lo, double hi) {
+    return lo + (hi - lo) * (rand() / (double)RAND_MAX);
+}
+
+// half of the values are multiples of 0.01, the rest are arbitrary
+static double rndValue(double lo, double hi) {
+    if (rand() & 1) {
+        return (double)(long)(rnd(lo, hi) * 100) / 100;
+    }
+    return rnd(lo, hi);
+}
+
+static void fill(UlpLocation& l, GpsLocationExtended& e, LocationSystemInfo& si) {
+    memset(&l, 0, sizeof(l));
+    memset(&e, 0, sizeof(e));
+    memset(&si, 0, sizeof(si));
+    l.gpsLocation.flags = LOC_GPS_LOCATION_HAS_LAT_LONG | LOC_GPS_LOCATION_HAS_ALTITUDE |
+            LOC_GPS_LOCATION_HAS_SPEED | LOC_GPS_LOCATION_HAS_BEARING;
+    l.gpsLocation.latitude = rnd(-90, 90);
+    l.gpsLocation.longitude = rnd(-180, 180);
+    l.gpsLocation.altitude = rndValue(-500, 9000);
+    l.gpsLocation.speed = rndValue(0, 100);
+    l.gpsLocation.bearing = rndValue(0, 360);
+    l.gpsLocation.timestamp = 1600000000000ULL + (uint64_t)rand() * 1000 + rand() % 1000;
+    e.flags = GPS_LOCATION_EXTENDED_HAS_DOP | GPS_LOCATION_EXTENDED_HAS_ALTITUDE_MEAN_SEA_LEVEL |
+            GPS_LOCATION_EXTENDED_HAS_DGNSS_DATA_AGE;
+    e.altitudeMeanSeaLevel = rndValue(-500, 9000);
+    e.pdop = rndValue(0, 30);
+    e.hdop = rndValue(0, 30);
+    e.vdop = rndValue(0, 30);
+    e.dgnssDataAgeMsec = rand() % 100000;
+    e.gnss_sv_used_ids.gps_sv_used_ids_mask = rand();
+}
+
+static std::vector<std::string> split(const std::string& sentence) {
+    std::vector<std::string> fields;
+    size_t start = 0;
+    size_t end = sentence.find('*');
+    for (size_t i = 0; i <= end; i++) {
+        if (i == end || ',' == sentence[i]) {
+            fields.push_back(sentence.substr(start, i - start));
+            start = i + 1;
+        }
+    }
+    return fields;
+}
+
+static bool checksumOk(const std::string& sentence) {
+    size_t star = sentence.find('*');
+    if ('$' != sentence[0] || std::string::npos == star || sentence.size() < star + 5) {
+        return false;
+    }
+    uint8_t checksum = 0;
+    for (size_t i = 1; i < star; i++) {
+        checksum ^= (uint8_t)sentence[i];
+    }
+    char expected[8];
+    snprintf(expected, sizeof(expected), "*%02X\r\n", checksum);
+    return 0 == sentence.compare(star, std::string::npos, expected);
+}
+
+static void expect(const std::string& sentence, const std::vector<std::string>& fields,
+                   size_t index, double value) {
+    char expected[320];
+    snprintf(expected, sizeof(expected), "%.1f", value);
+    sFields++;
+    if (index >= fields.size() || fields[index] != expected) {
+        if (sFailures++ < 10) {
+            printf("FAIL field %zu: expected %s (%.17g) in %s", index, expected, value,
+                   sentence.c_str());
+        }
+    }
+}
+
+// the expressions are those loc_nmea_generate_pos() formats, with the
+// same float and double types
+static void check(const UlpLocation& l, const GpsLocationExtended& e,
+                  const std::string& sentence) {
+    std::vector<std::string> fields = split(sentence);
+    std::string type = fields[0].substr(3);
+    double geoid = l.gpsLocation.altitude - e.altitudeMeanSeaLevel;
+    float age = (float)e.dgnssDataAgeMsec / 1000;
+    if ("GGA" == type) {
+        expect(sentence, fields, 8, e.hdop);
+        expect(sentence, fields, 9, e.altitudeMeanSeaLevel);
+        expect(sentence, fields, 11, geoid);
+        expect(sentence, fields, 13, age);
+    } else if ("GNS" == type) {
+        expect(sentence, fields, 8, e.hdop);
+        expect(sentence, fields, 9, e.altitudeMeanSeaLevel);
+        expect(sentence, fields, 10, geoid);
+        expect(sentence, fields, 11, age);
+    } else if ("VTG" == type) {
+        float speedKnots = l.gpsLocation.speed * (3600.0/1852.0);
+        float speedKmPerHour = l.gpsLocation.speed * 3.6;
+        expect(sentence, fields, 1, l.gpsLocation.bearing);
+        expect(sentence, fields, 5, speedKnots);
+        expect(sentence, fields, 7, speedKmPerHour);
+    }
+}
+
+int main(int argc, char** argv) {
+    uint32_t fixes = argc > 1 ? atoi(argv[1]) : 100000;
+    srand(argc > 2 ? atoi(argv[2]) : 1);
+
+    static UlpLocation l;
+    static GpsLocationExtended e;
+    static LocationSystemInfo si;
+    static char buf[NMEA_BUFFER_MAX_LENGTH];
+    uint32_t sentences = 0;
+    uint32_t badChecksums = 0;
+    for (uint32_t i = 0; i < fixes; i++) {
+        fill(l, e, si);
+        LocNmeaBuffer out;
+        loc_nmea_buffer_init(out, buf, sizeof(buf));
+        loc_nmea_generate_pos(l, e, si, true, false, out);
+        for (uint32_t s = 0; s < out.count; s++) {
+            std::string sentence(out.buf + out.offsets[s], loc_nmea_sentence_length(out, s));
+            sentences++;
+            if (!checksumOk(sentence)) {
+                if (badChecksums++ < 10) {
+                    printf("FAIL checksum: %s", sentence.c_str());
+                }
+                continue;
+            }
+            check(l, e, sentence);
+        }
+    }
+
+    printf("%u fixes, %u sentences, %u decimal fields compared\n", fixes, sentences, sFields);
+    if (0 == sFields || sFailures > 0 || badChecksums > 0) {
+        printf("FAIL %u fields differ, %u bad checksums\n", sFailures, badChecksums);
+        return 1;
+    }
+    printf("PASS\n");
+    return 0;
+}
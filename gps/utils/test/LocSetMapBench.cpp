@@ -0,0 +1,111 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// locsetmap_bench: host cost of the subscription churn SystemStatusOsObserver
+// puts on its two LocUnorderedSetMaps, client to ids and id to clients.
+// Random subscribe, updateSubscription and unsubscribeAll requests from a
+// few clients are applied with the ids kept in unordered_sets and in
+// LocBitSets. There are about as many ids as DataItemId has.
+//
+//     locsetmap_bench [requests] [clients]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <vector>
+#include <LocUnorderedSetMap.h>
+
+using namespace loc_util;
+
+enum BenchItemId { kBenchItemIds = 40 };
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// ID is BenchItemId for unordered_set<BenchItemId> sets of ids, or
+// LocBitSet<BenchItemId, kBenchItemIds> for bitsets
+template <typename ID>
+static void churn(const char* name, uint32_t requests, uint32_t clients) {
+    typedef typename LocSetOf<ID>::type IdSet;
+    typedef unordered_set<void*> ClientSet;
+    LocUnorderedSetMap<void*, ID> clientToIds(clients);
+    LocUnorderedSetMap<ID, void*> idToClients(kBenchItemIds);
+
+    // the same requests for every set type
+    srand(1);
+    uint64_t changes = 0;
+    double start = nowSec();
+    for (uint32_t i = 0; i < requests; i++) {
+        void* client = (void*)(uintptr_t)(1 + rand() % clients);
+        IdSet ids;
+        for (int n = 1 + rand() % 8; n > 0; n--) {
+            ids.insert((BenchItemId)(rand() % kBenchItemIds));
+        }
+        IdSet newIds;
+        IdSet goneIds;
+        ClientSet clientSet = {client};
+        switch (rand() % 3) {
+        case 0:
+            // subscribe
+            clientToIds.add(client, ids);
+            idToClients.add(ids, clientSet, &newIds);
+            break;
+        case 1:
+            // updateSubscription, ids is left with the ones new to the client
+            idToClients.trimOrRemove(clientToIds.update(client, ids), clientSet,
+                                     &goneIds, nullptr);
+            idToClients.add(ids, clientSet, &newIds);
+            break;
+        default:
+            // unsubscribeAll
+            idToClients.trimOrRemove(clientToIds.getValSet(client), clientSet,
+                                     &goneIds, nullptr);
+            clientToIds.remove(client);
+            break;
+        }
+        changes += newIds.size() + goneIds.size();
+    }
+    double elapsed = nowSec() - start;
+    printf("%-14s %8.1f ns/request (%llu ids added or dropped)\n", name,
+           elapsed / requests * 1e9, (unsigned long long)changes);
+}
+
+int main(int argc, char** argv) {
+    uint32_t requests = argc > 1 ? atoi(argv[1]) : 1000000;
+    uint32_t clients = argc > 2 ? atoi(argv[2]) : 8;
+    if (0 == clients) {
+        clients = 1;
+    }
+    churn<BenchItemId>("unordered_set", requests, clients);
+    churn<LocBitSet<BenchItemId, kBenchItemIds>>("LocBitSet", requests, clients);
+    return 0;
+}
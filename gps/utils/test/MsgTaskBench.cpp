@@ -0,0 +1,245 @@
+/* Copyright (c) 2020 The Linux Foundation. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above
+ *       copyright notice, this list of conditions and the following
+ *       disclaimer in the documentation and/or other materials provided
+ *       with the distribution.
+ *     * Neither the name of The Linux Foundation, nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED "AS IS" AND ANY EXPRESS OR IMPLIED
+ * WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NON-INFRINGEMENT
+ * ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS
+ * BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+ * BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY,
+ * WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE
+ * OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN
+ * IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ *
+ */
+
+// msgtask_bench: host throughput of the MsgTask queue. N producer threads
+// push into one consumer, first through msg_q and then through a reference
+// queue built the way msg_q used to be (a mutex and a condition variable
+// around linked_list.c), and finally end to end through MsgTask::sendMsg.
+// Per-producer FIFO order is checked on every run.
+//
+//     msgtask_bench [producers] [msgs per producer]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <pthread.h>
+#include <time.h>
+#include <atomic>
+#include <vector>
+#include <msg_q.h>
+#include <linked_list.h>
+#include <MsgTask.h>
+
+static double nowSec() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+// The mutex/condition variable queue over linked_list.c, as msg_q_snd() and
+// msg_q_rcv() were implemented before the lock-free queue.
+class RefQueue {
+    void* mList;
+    pthread_mutex_t mLock;
+    pthread_cond_t mCond;
+public:
+    RefQueue() : mList(NULL) {
+        linked_list_init(&mList);
+        pthread_mutex_init(&mLock, NULL);
+        pthread_cond_init(&mCond, NULL);
+    }
+    ~RefQueue() {
+        linked_list_destroy(&mList);
+        pthread_cond_destroy(&mCond);
+        pthread_mutex_destroy(&mLock);
+    }
+    void snd(void* obj) {
+        pthread_mutex_lock(&mLock);
+        linked_list_add(mList, obj, NULL);
+        pthread_cond_signal(&mCond);
+        pthread_mutex_unlock(&mLock);
+    }
+    void* rcv() {
+        void* obj = NULL;
+        pthread_mutex_lock(&mLock);
+        while (linked_list_empty(mList)) {
+            pthread_cond_wait(&mCond, &mLock);
+        }
+        linked_list_remove(mList, &obj);
+        pthread_mutex_unlock(&mLock);
+        return obj;
+    }
+};
+
+struct QueueRun {
+    bool useRef;
+    void* msgQ;
+    RefQueue* refQ;
+    uintptr_t id;
+    uint32_t count;
+};
+
+// Payloads encode the producer id in the upper bits and a 1-based
+// sequence number in the lower 24 bits, so no allocation is timed.
+static void* produce(void* arg) {
+    QueueRun* run = (QueueRun*)arg;
+    for (uintptr_t seq = 1; seq <= run->count; seq++) {
+        void* obj = (void*)((run->id << 24) | seq);
+        if (run->useRef) {
+            run->refQ->snd(obj);
+        } else {
+            msg_q_snd(run->msgQ, obj, NULL);
+        }
+    }
+    return NULL;
+}
+
+static bool benchQueue(bool useRef, uint32_t producers, uint32_t count) {
+    void* msgQ = NULL;
+    RefQueue* refQ = useRef ? new RefQueue() : NULL;
+    if (!useRef && eMSG_Q_SUCCESS != msg_q_init(&msgQ)) {
+        fprintf(stderr, "msg_q_init failed\n");
+        return false;
+    }
+
+    std::vector<QueueRun> runs(producers);
+    std::vector<pthread_t> threads(producers);
+    std::vector<uintptr_t> last(producers + 1, 0);
+    uint64_t outOfOrder = 0;
+
+    double start = nowSec();
+    for (uint32_t i = 0; i < producers; i++) {
+        runs[i] = {useRef, msgQ, refQ, i + 1, count};
+        pthread_create(&threads[i], NULL, produce, &runs[i]);
+    }
+    for (uint64_t n = 0; n < (uint64_t)producers * count; n++) {
+        void* obj = NULL;
+        if (useRef) {
+            obj = refQ->rcv();
+        } else if (eMSG_Q_SUCCESS != msg_q_rcv(msgQ, &obj)) {
+            fprintf(stderr, "msg_q_rcv failed\n");
+            return false;
+        }
+        uintptr_t id = (uintptr_t)obj >> 24;
+        uintptr_t seq = (uintptr_t)obj & 0xFFFFFF;
+        if (id > producers || seq != last[id] + 1) {
+            outOfOrder++;
+        } else {
+            last[id] = seq;
+        }
+    }
+    double elapsed = nowSec() - start;
+    for (uint32_t i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    printf("%-22s %8.1f ns/msg %10.0f msgs/s  out of order %llu\n",
+           useRef ? "mutex+linked_list" : "msg_q",
+           elapsed * 1e9 / ((double)producers * count),
+           (double)producers * count / elapsed,
+           (unsigned long long)outOfOrder);
+
+    if (useRef) {
+        delete refQ;
+    } else {
+        msg_q_destroy(&msgQ);
+    }
+    return 0 == outOfOrder;
+}
+
+struct TaskRun {
+    MsgTask* task;
+    uint32_t id;
+    uint32_t count;
+    std::vector<uint32_t>* last;
+    std::atomic<uint64_t>* done;
+    std::atomic<uint64_t>* outOfOrder;
+};
+
+struct BenchMsg : public LocMsg {
+    uint32_t mId;
+    uint32_t mSeq;
+    std::vector<uint32_t>& mLast;
+    std::atomic<uint64_t>& mDone;
+    std::atomic<uint64_t>& mOutOfOrder;
+    inline BenchMsg(const TaskRun& run, uint32_t seq) :
+        LocMsg(), mId(run.id), mSeq(seq), mLast(*run.last),
+        mDone(*run.done), mOutOfOrder(*run.outOfOrder) {}
+    virtual void proc() const {
+        if (mSeq != mLast[mId] + 1) {
+            mOutOfOrder.fetch_add(1, std::memory_order_relaxed);
+        }
+        mLast[mId] = mSeq;
+        mDone.fetch_add(1, std::memory_order_release);
+    }
+};
+
+static void* produceMsgs(void* arg) {
+    TaskRun* run = (TaskRun*)arg;
+    for (uint32_t seq = 1; seq <= run->count; seq++) {
+        run->task->sendMsg(new BenchMsg(*run, seq));
+    }
+    return NULL;
+}
+
+static bool benchMsgTask(uint32_t producers, uint32_t count) {
+    MsgTask* task = new MsgTask("msgtask_bench");
+    std::vector<uint32_t> last(producers + 1, 0);
+    std::atomic<uint64_t> done(0);
+    std::atomic<uint64_t> outOfOrder(0);
+    std::vector<TaskRun> runs(producers);
+    std::vector<pthread_t> threads(producers);
+    uint64_t total = (uint64_t)producers * count;
+
+    double start = nowSec();
+    for (uint32_t i = 0; i < producers; i++) {
+        runs[i] = {task, i + 1, count, &last, &done, &outOfOrder};
+        pthread_create(&threads[i], NULL, produceMsgs, &runs[i]);
+    }
+    for (uint32_t i = 0; i < producers; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    while (done.load(std::memory_order_acquire) < total) {
+        struct timespec ts = {0, 100000};
+        nanosleep(&ts, NULL);
+    }
+    double elapsed = nowSec() - start;
+
+    printf("%-22s %8.1f ns/msg %10.0f msgs/s  out of order %llu\n",
+           "MsgTask::sendMsg", elapsed * 1e9 / total, total / elapsed,
+           (unsigned long long)outOfOrder.load());
+    task->destroy();
+    return 0 == outOfOrder.load();
+}
+
+int main(int argc, char** argv) {
+    uint32_t producers = (argc > 1) ? strtoul(argv[1], NULL, 0) : 4;
+    uint32_t count = (argc > 2) ? strtoul(argv[2], NULL, 0) : 1000000;
+    if (0 == producers || 0 == count || count > 0xFFFFFF) {
+        fprintf(stderr, "usage: %s [producers] [msgs per producer <= %u]\n",
+                argv[0], 0xFFFFFF);
+        return 2;
+    }
+    printf("%u producers x %u msgs\n", producers, count);
+
+    bool ok = benchQueue(true, producers, count);
+    ok = benchQueue(false, producers, count) && ok;
+    ok = benchMsgTask(producers, count) && ok;
+    return ok ? 0 : 1;
+}